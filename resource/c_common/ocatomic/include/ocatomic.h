@@ -42,6 +42,33 @@ int32_t oc_atomic_increment(volatile int32_t *addend);
  */
 int32_t oc_atomic_decrement(volatile int32_t *addend);
 
+/**
+ * Atomically replaces the value of the specified int32_t variable with exchange,
+ * if it is equal to comparand.
+ *
+ * @param[in] destination  Pointer to the variable to be updated.
+ * @param[in] comparand    Value expected in the variable.
+ * @param[in] exchange     Value to store if the variable holds comparand.
+ * @return int32_t  The value of the variable before the operation.
+ */
+int32_t oc_atomic_cmpxchg(volatile int32_t *destination, int32_t comparand, int32_t exchange);
+
+/**
+ * Reads the value of the specified int32_t variable atomically, with full ordering.
+ *
+ * @param[in] source  Pointer to the variable to be read.
+ * @return int32_t  The value of the variable.
+ */
+int32_t oc_atomic_load(volatile int32_t *source);
+
+/**
+ * Writes the value of the specified int32_t variable atomically, with full ordering.
+ *
+ * @param[in] destination  Pointer to the variable to be written.
+ * @param[in] value        Value to store.
+ */
+void oc_atomic_store(volatile int32_t *destination, int32_t value);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
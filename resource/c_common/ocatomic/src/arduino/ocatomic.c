@@ -36,3 +36,23 @@ int32_t oc_atomic_decrement(volatile int32_t *addend)
     (*addend)--;
     return *addend;
 }
+
+int32_t oc_atomic_cmpxchg(volatile int32_t *destination, int32_t comparand, int32_t exchange)
+{
+    int32_t initial = *destination;
+    if (initial == comparand)
+    {
+        *destination = exchange;
+    }
+    return initial;
+}
+
+int32_t oc_atomic_load(volatile int32_t *source)
+{
+    return *source;
+}
+
+void oc_atomic_store(volatile int32_t *destination, int32_t value)
+{
+    *destination = value;
+}
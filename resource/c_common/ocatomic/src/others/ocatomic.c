@@ -33,3 +33,18 @@ int32_t oc_atomic_decrement(volatile int32_t *addend)
 {
     return __sync_sub_and_fetch(addend, 1);
 }
+
+int32_t oc_atomic_cmpxchg(volatile int32_t *destination, int32_t comparand, int32_t exchange)
+{
+    return __sync_val_compare_and_swap(destination, comparand, exchange);
+}
+
+int32_t oc_atomic_load(volatile int32_t *source)
+{
+    return __atomic_load_n(source, __ATOMIC_SEQ_CST);
+}
+
+void oc_atomic_store(volatile int32_t *destination, int32_t value)
+{
+    __atomic_store_n(destination, value, __ATOMIC_SEQ_CST);
+}
@@ -34,3 +34,18 @@ int32_t oc_atomic_decrement(volatile int32_t *addend)
 {
     return InterlockedDecrement((volatile long*)addend);
 }
+
+int32_t oc_atomic_cmpxchg(volatile int32_t *destination, int32_t comparand, int32_t exchange)
+{
+    return InterlockedCompareExchange((volatile long*)destination, exchange, comparand);
+}
+
+int32_t oc_atomic_load(volatile int32_t *source)
+{
+    return InterlockedCompareExchange((volatile long*)source, 0, 0);
+}
+
+void oc_atomic_store(volatile int32_t *destination, int32_t value)
+{
+    InterlockedExchange((volatile long*)destination, value);
+}
@@ -0,0 +1,157 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Runtime metrics of the connectivity and stack layers.
+ *
+ * Every thread that updates a metric gets its own shard, so an update is a
+ * plain store to memory no other thread writes. Shards are summed when a
+ * snapshot is taken.
+ */
+
+#ifndef OC_METRICS_H_
+#define OC_METRICS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * Metrics known to the registry.
+ */
+typedef enum
+{
+    OC_METRIC_CA_MESSAGES_SENT = 0,         /**< counter: messages handed to an adapter. */
+    OC_METRIC_CA_MESSAGES_RECEIVED,         /**< counter: packets received from an adapter. */
+    OC_METRIC_CA_SEND_QUEUE_DEPTH,          /**< gauge: messages waiting in the send queue. */
+    OC_METRIC_CA_RECEIVE_QUEUE_DEPTH,       /**< gauge: messages waiting in the receive queues. */
+    OC_METRIC_CA_RETRANSMISSIONS,           /**< counter: CON messages sent again. */
+    OC_METRIC_CA_RETRANSMISSIONS_PENDING,   /**< gauge: CON messages awaiting an ACK. */
+    OC_METRIC_CA_RETRANSMISSION_TIMEOUTS,   /**< counter: CON messages never acknowledged. */
+    OC_METRIC_SSL_HANDSHAKES_STARTED,       /**< counter: (D)TLS handshakes started. */
+    OC_METRIC_SSL_HANDSHAKES_COMPLETED,     /**< counter: (D)TLS handshakes completed. */
+    OC_METRIC_SSL_HANDSHAKES_FAILED,        /**< counter: (D)TLS handshakes failed. */
+    OC_METRIC_OBSERVERS,                    /**< gauge: registered observers. */
+    OC_METRIC_OBSERVE_NOTIFICATIONS,        /**< counter: notifications sent to observers. */
+    OC_METRIC_OBSERVE_FANOUT,               /**< histogram: observers notified per change. */
+    OC_METRIC_SERVER_REQUESTS,              /**< counter: requests received by the server. */
+    OC_METRIC_SERVER_RESPONSES,             /**< counter: responses sent by the server. */
+    OC_METRIC_ENTITY_HANDLER_LATENCY_US,    /**< histogram: request to response time, in us. */
+    OC_METRIC_COUNT
+} OCMetricId;
+
+/**
+ * How the value of a metric is to be read.
+ */
+typedef enum
+{
+    OC_METRIC_COUNTER = 0,  /**< only grows, except by OCMetricsReset(). */
+    OC_METRIC_GAUGE,        /**< current level, goes up and down. */
+    OC_METRIC_HISTOGRAM     /**< distribution of recorded samples. */
+} OCMetricKind;
+
+/**
+ * Number of histogram buckets. Bucket 0 counts samples of 0, bucket i counts
+ * samples in [2^(i-1), 2^i), and the last bucket also counts every larger sample.
+ */
+#define OC_METRIC_HISTOGRAM_BUCKETS (24)
+
+/**
+ * Value of one metric.
+ */
+typedef struct
+{
+    /** Counter or gauge value. For a histogram, the number of samples. */
+    int64_t value;
+
+    /** Sum of the samples of a histogram. */
+    uint64_t sum;
+
+    /** Samples per bucket of a histogram. */
+    uint64_t buckets[OC_METRIC_HISTOGRAM_BUCKETS];
+} OCMetricValue;
+
+/**
+ * Values of all metrics at one point in time. Rates can be derived from the
+ * difference of two snapshots.
+ */
+typedef struct
+{
+    /** Time the snapshot was taken, as returned by OICGetCurrentTime(TIME_IN_MS). */
+    uint64_t timeMs;
+
+    /** Values, indexed by OCMetricId. */
+    OCMetricValue values[OC_METRIC_COUNT];
+} OCMetricsSnapshot;
+
+/**
+ * Add to a counter or a gauge.
+ *
+ * @param[in] id     metric.
+ * @param[in] delta  amount to add, negative to decrease a gauge.
+ */
+void OCMetricAdd(OCMetricId id, int64_t delta);
+
+/**
+ * Record a sample in a histogram.
+ *
+ * @param[in] id      metric.
+ * @param[in] sample  value of the sample.
+ */
+void OCMetricRecord(OCMetricId id, uint64_t sample);
+
+/**
+ * Take a snapshot of all metrics.
+ *
+ * @param[out] snapshot  receives the values.
+ */
+void OCMetricsGetSnapshot(OCMetricsSnapshot *snapshot);
+
+/**
+ * Restart counters and histograms from zero. Gauges keep their level.
+ */
+void OCMetricsReset(void);
+
+/**
+ * Get the name of a metric.
+ *
+ * @param[in] id  metric.
+ * @return name of the metric, or NULL for an unknown id.
+ */
+const char *OCMetricGetName(OCMetricId id);
+
+/**
+ * Get the kind of a metric.
+ *
+ * @param[in] id  metric.
+ * @return kind of the metric, OC_METRIC_COUNTER for an unknown id.
+ */
+OCMetricKind OCMetricGetKind(OCMetricId id);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OC_METRICS_H_
@@ -0,0 +1,308 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include "ocmetrics.h"
+#include "oic_time.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_PTHREAD_H) && defined(__GNUC__) && !defined(WITH_ARDUINO)
+# include <pthread.h>
+# define METRICS_SHARDED
+#elif defined(HAVE_WINDOWS_H)
+# include <windows.h>
+#endif
+
+typedef struct
+{
+    const char *name;
+    OCMetricKind kind;
+} OCMetricInfo_t;
+
+static const OCMetricInfo_t g_metricInfo[OC_METRIC_COUNT] =
+{
+    { "ca.messages_sent",                OC_METRIC_COUNTER },
+    { "ca.messages_received",            OC_METRIC_COUNTER },
+    { "ca.send_queue_depth",             OC_METRIC_GAUGE },
+    { "ca.receive_queue_depth",          OC_METRIC_GAUGE },
+    { "ca.retransmissions",              OC_METRIC_COUNTER },
+    { "ca.retransmissions_pending",      OC_METRIC_GAUGE },
+    { "ca.retransmission_timeouts",      OC_METRIC_COUNTER },
+    { "ssl.handshakes_started",          OC_METRIC_COUNTER },
+    { "ssl.handshakes_completed",        OC_METRIC_COUNTER },
+    { "ssl.handshakes_failed",           OC_METRIC_COUNTER },
+    { "oc.observers",                    OC_METRIC_GAUGE },
+    { "oc.observe_notifications",        OC_METRIC_COUNTER },
+    { "oc.observe_fanout",               OC_METRIC_HISTOGRAM },
+    { "oc.server_requests",              OC_METRIC_COUNTER },
+    { "oc.server_responses",             OC_METRIC_COUNTER },
+    { "oc.entity_handler_latency_us",    OC_METRIC_HISTOGRAM }
+};
+
+/** Counter and histogram values at the last OCMetricsReset(). */
+static OCMetricValue g_baseline[OC_METRIC_COUNT];
+
+#ifdef METRICS_SHARDED
+
+/**
+ * Metrics updated by one thread. Only the owning thread writes, so an update
+ * is a load and a store; readers load each field atomically.
+ */
+typedef struct OCMetricsShard
+{
+    struct OCMetricsShard *next;        /**< next shard in g_shards. */
+    OCMetricValue values[OC_METRIC_COUNT];
+} OCMetricsShard_t;
+
+static pthread_once_t g_shardKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_shardKey;
+static pthread_mutex_t g_shardLock = PTHREAD_MUTEX_INITIALIZER;
+
+static OCMetricsShard_t *g_shards = NULL;
+static __thread OCMetricsShard_t *t_shard = NULL;
+
+/** Values of the shards of exited threads. */
+static OCMetricValue g_retired[OC_METRIC_COUNT];
+
+#define SHARD_ADD(field, delta) \
+    __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (delta), \
+                     __ATOMIC_RELAXED)
+#define SHARD_LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static void ReleaseShard(void *data)
+{
+    OCMetricsShard_t *shard = (OCMetricsShard_t *)data;
+    t_shard = NULL;
+
+    pthread_mutex_lock(&g_shardLock);
+    for (OCMetricsShard_t **link = &g_shards; *link; link = &(*link)->next)
+    {
+        if (*link == shard)
+        {
+            *link = shard->next;
+            break;
+        }
+    }
+    for (size_t i = 0; i < OC_METRIC_COUNT; i++)
+    {
+        g_retired[i].value += shard->values[i].value;
+        g_retired[i].sum += shard->values[i].sum;
+        for (size_t b = 0; b < OC_METRIC_HISTOGRAM_BUCKETS; b++)
+        {
+            g_retired[i].buckets[b] += shard->values[i].buckets[b];
+        }
+    }
+    pthread_mutex_unlock(&g_shardLock);
+
+    free(shard);
+}
+
+static void CreateShardKey()
+{
+    pthread_key_create(&g_shardKey, ReleaseShard);
+}
+
+static OCMetricValue *GetValues()
+{
+    if (t_shard)
+    {
+        return t_shard->values;
+    }
+
+    OCMetricsShard_t *shard = (OCMetricsShard_t *)calloc(1, sizeof(OCMetricsShard_t));
+    if (!shard)
+    {
+        return NULL;
+    }
+
+    pthread_once(&g_shardKeyOnce, CreateShardKey);
+    pthread_setspecific(g_shardKey, shard);
+
+    pthread_mutex_lock(&g_shardLock);
+    shard->next = g_shards;
+    g_shards = shard;
+    pthread_mutex_unlock(&g_shardLock);
+
+    t_shard = shard;
+    return shard->values;
+}
+
+/** Sum of all shards, without the baseline. */
+static void SumValues(OCMetricValue *values)
+{
+    memcpy(values, g_retired, sizeof(g_retired));
+    for (const OCMetricsShard_t *shard = g_shards; shard; shard = shard->next)
+    {
+        for (size_t i = 0; i < OC_METRIC_COUNT; i++)
+        {
+            values[i].value += SHARD_LOAD(shard->values[i].value);
+            if (OC_METRIC_HISTOGRAM != g_metricInfo[i].kind)
+            {
+                continue;
+            }
+            values[i].sum += SHARD_LOAD(shard->values[i].sum);
+            for (size_t b = 0; b < OC_METRIC_HISTOGRAM_BUCKETS; b++)
+            {
+                values[i].buckets[b] += SHARD_LOAD(shard->values[i].buckets[b]);
+            }
+        }
+    }
+}
+
+static void LockValues()
+{
+    pthread_mutex_lock(&g_shardLock);
+}
+
+static void UnlockValues()
+{
+    pthread_mutex_unlock(&g_shardLock);
+}
+
+#else // METRICS_SHARDED
+
+// Without thread local storage all threads share one set of values, updated
+// with an atomic add where the platform has one.
+static OCMetricValue g_values[OC_METRIC_COUNT];
+
+#if defined(HAVE_WINDOWS_H)
+# define SHARD_ADD(field, delta) \
+    InterlockedExchangeAdd64((volatile LONG64 *)&(field), (LONG64)(delta))
+#elif defined(__GNUC__)
+# define SHARD_ADD(field, delta) __atomic_fetch_add(&(field), (delta), __ATOMIC_RELAXED)
+#else
+# define SHARD_ADD(field, delta) ((field) += (delta))
+#endif
+
+static OCMetricValue *GetValues()
+{
+    return g_values;
+}
+
+static void SumValues(OCMetricValue *values)
+{
+    memcpy(values, g_values, sizeof(g_values));
+}
+
+static void LockValues()
+{
+}
+
+static void UnlockValues()
+{
+}
+
+#endif // METRICS_SHARDED
+
+static size_t GetBucket(uint64_t sample)
+{
+    size_t bucket = 0;
+#if defined(__GNUC__)
+    if (sample)
+    {
+        bucket = 64 - __builtin_clzll(sample);
+    }
+#else
+    while (sample)
+    {
+        bucket++;
+        sample >>= 1;
+    }
+#endif
+    return (bucket < OC_METRIC_HISTOGRAM_BUCKETS) ? bucket : OC_METRIC_HISTOGRAM_BUCKETS - 1;
+}
+
+void OCMetricAdd(OCMetricId id, int64_t delta)
+{
+    if ((unsigned)id >= OC_METRIC_COUNT || OC_METRIC_HISTOGRAM == g_metricInfo[id].kind)
+    {
+        return;
+    }
+
+    OCMetricValue *values = GetValues();
+    if (values)
+    {
+        SHARD_ADD(values[id].value, delta);
+    }
+}
+
+void OCMetricRecord(OCMetricId id, uint64_t sample)
+{
+    if ((unsigned)id >= OC_METRIC_COUNT || OC_METRIC_HISTOGRAM != g_metricInfo[id].kind)
+    {
+        return;
+    }
+
+    OCMetricValue *values = GetValues();
+    if (values)
+    {
+        SHARD_ADD(values[id].value, 1);
+        SHARD_ADD(values[id].sum, sample);
+        SHARD_ADD(values[id].buckets[GetBucket(sample)], 1);
+    }
+}
+
+void OCMetricsGetSnapshot(OCMetricsSnapshot *snapshot)
+{
+    if (!snapshot)
+    {
+        return;
+    }
+
+    LockValues();
+    SumValues(snapshot->values);
+    for (size_t i = 0; i < OC_METRIC_COUNT; i++)
+    {
+        if (OC_METRIC_GAUGE == g_metricInfo[i].kind)
+        {
+            continue;
+        }
+        snapshot->values[i].value -= g_baseline[i].value;
+        snapshot->values[i].sum -= g_baseline[i].sum;
+        for (size_t b = 0; b < OC_METRIC_HISTOGRAM_BUCKETS; b++)
+        {
+            snapshot->values[i].buckets[b] -= g_baseline[i].buckets[b];
+        }
+    }
+    UnlockValues();
+
+    snapshot->timeMs = OICGetCurrentTime(TIME_IN_MS);
+}
+
+void OCMetricsReset(void)
+{
+    // Shards are only written by their threads, so a reset moves the zero
+    // instead of clearing them.
+    LockValues();
+    SumValues(g_baseline);
+    UnlockValues();
+}
+
+const char *OCMetricGetName(OCMetricId id)
+{
+    return ((unsigned)id < OC_METRIC_COUNT) ? g_metricInfo[id].name : NULL;
+}
+
+OCMetricKind OCMetricGetKind(OCMetricId id)
+{
+    return ((unsigned)id < OC_METRIC_COUNT) ? g_metricInfo[id].kind : OC_METRIC_COUNTER;
+}
@@ -0,0 +1,116 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ocmetrics.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+TEST(MetricsTests, CounterAddsAcrossThreads)
+{
+    OCMetricsReset();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([]()
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                OCMetricAdd(OC_METRIC_CA_MESSAGES_SENT, 1);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+    OCMetricAdd(OC_METRIC_CA_MESSAGES_SENT, 2);
+
+    // Shards of exited threads are still counted.
+    OCMetricsSnapshot snapshot;
+    OCMetricsGetSnapshot(&snapshot);
+    EXPECT_EQ(4002, snapshot.values[OC_METRIC_CA_MESSAGES_SENT].value);
+    EXPECT_NE(0u, snapshot.timeMs);
+}
+
+TEST(MetricsTests, ResetKeepsGauges)
+{
+    OCMetricAdd(OC_METRIC_OBSERVERS, 3);
+    OCMetricAdd(OC_METRIC_OBSERVERS, -1);
+    OCMetricAdd(OC_METRIC_SERVER_REQUESTS, 5);
+
+    OCMetricsSnapshot before;
+    OCMetricsGetSnapshot(&before);
+
+    OCMetricsReset();
+    OCMetricAdd(OC_METRIC_SERVER_REQUESTS, 1);
+
+    OCMetricsSnapshot after;
+    OCMetricsGetSnapshot(&after);
+    EXPECT_EQ(before.values[OC_METRIC_OBSERVERS].value, after.values[OC_METRIC_OBSERVERS].value);
+    EXPECT_EQ(1, after.values[OC_METRIC_SERVER_REQUESTS].value);
+}
+
+TEST(MetricsTests, HistogramBuckets)
+{
+    OCMetricsReset();
+
+    OCMetricRecord(OC_METRIC_OBSERVE_FANOUT, 0);
+    OCMetricRecord(OC_METRIC_OBSERVE_FANOUT, 1);
+    OCMetricRecord(OC_METRIC_OBSERVE_FANOUT, 3);
+    OCMetricRecord(OC_METRIC_OBSERVE_FANOUT, UINT64_MAX / 2);
+
+    OCMetricsSnapshot snapshot;
+    OCMetricsGetSnapshot(&snapshot);
+    const OCMetricValue &fanout = snapshot.values[OC_METRIC_OBSERVE_FANOUT];
+    EXPECT_EQ(4, fanout.value);
+    EXPECT_EQ(4u + UINT64_MAX / 2, fanout.sum);
+    EXPECT_EQ(1u, fanout.buckets[0]);
+    EXPECT_EQ(1u, fanout.buckets[1]);
+    EXPECT_EQ(1u, fanout.buckets[2]);
+    EXPECT_EQ(1u, fanout.buckets[OC_METRIC_HISTOGRAM_BUCKETS - 1]);
+}
+
+TEST(MetricsTests, WrongKindOrIdIsIgnored)
+{
+    OCMetricsReset();
+
+    OCMetricAdd(OC_METRIC_OBSERVE_FANOUT, 1);
+    OCMetricRecord(OC_METRIC_SERVER_RESPONSES, 1);
+    OCMetricAdd(OC_METRIC_COUNT, 1);
+
+    OCMetricsSnapshot snapshot;
+    OCMetricsGetSnapshot(&snapshot);
+    EXPECT_EQ(0, snapshot.values[OC_METRIC_OBSERVE_FANOUT].value);
+    EXPECT_EQ(0, snapshot.values[OC_METRIC_SERVER_RESPONSES].value);
+}
+
+TEST(MetricsTests, NamesAndKinds)
+{
+    for (int i = 0; i < OC_METRIC_COUNT; i++)
+    {
+        EXPECT_TRUE(NULL != OCMetricGetName((OCMetricId)i));
+    }
+    EXPECT_TRUE(NULL == OCMetricGetName(OC_METRIC_COUNT));
+    EXPECT_EQ(OC_METRIC_GAUGE, OCMetricGetKind(OC_METRIC_CA_SEND_QUEUE_DEPTH));
+    EXPECT_EQ(OC_METRIC_HISTOGRAM, OCMetricGetKind(OC_METRIC_ENTITY_HANDLER_LATENCY_US));
+}
@@ -110,6 +110,15 @@ OCThreadResult_t oc_thread_wait(oc_thread t);
  */
 oc_mutex oc_mutex_new(void);
 
+/**
+ * Creates new recursive mutex, which the owning thread may lock again.
+ * Each lock must be balanced by an unlock.
+ *
+ * @return  Reference to newly created mutex, otherwise NULL.
+ *
+ */
+oc_mutex oc_mutex_new_recursive(void);
+
 /**
  * Lock the mutex.
  *
@@ -95,6 +95,7 @@ typedef struct _tagMutexInfo_t
      */
 #ifndef NDEBUG
     pthread_t owner;
+    uint32_t recursionCount;
 #endif
 } oc_mutex_internal;
 
@@ -187,6 +188,47 @@ oc_mutex oc_mutex_new(void)
         {
 #ifndef NDEBUG
             mutexInfo->owner = OC_INVALID_THREAD_ID;
+            mutexInfo->recursionCount = 0;
+#endif
+            retVal = (oc_mutex) mutexInfo;
+        }
+        else
+        {
+            OIC_LOG_V(ERROR, TAG, "%s Failed to initialize mutex !", __func__);
+            OICFree(mutexInfo);
+        }
+    }
+    else
+    {
+        OIC_LOG_V(ERROR, TAG, "%s Failed to allocate mutex!", __func__);
+    }
+
+    return retVal;
+}
+
+oc_mutex oc_mutex_new_recursive(void)
+{
+    oc_mutex retVal = NULL;
+    oc_mutex_internal *mutexInfo = (oc_mutex_internal*) OICMalloc(sizeof(oc_mutex_internal));
+    if (NULL != mutexInfo)
+    {
+        pthread_mutexattr_t mutexAttr;
+        int ret = pthread_mutexattr_init(&mutexAttr);
+        if (0 == ret)
+        {
+            ret = pthread_mutexattr_settype(&mutexAttr, PTHREAD_MUTEX_RECURSIVE);
+            if (0 == ret)
+            {
+                ret = pthread_mutex_init(&(mutexInfo->mutex), &mutexAttr);
+            }
+            pthread_mutexattr_destroy(&mutexAttr);
+        }
+
+        if (0 == ret)
+        {
+#ifndef NDEBUG
+            mutexInfo->owner = OC_INVALID_THREAD_ID;
+            mutexInfo->recursionCount = 0;
 #endif
             retVal = (oc_mutex) mutexInfo;
         }
@@ -247,6 +289,7 @@ void oc_mutex_lock(oc_mutex mutex)
          * to solve race conditions with other threads using the same lock.
          */
         mutexInfo->owner = oc_get_current_thread_id();
+        mutexInfo->recursionCount++;
 #endif
     }
     else
@@ -265,7 +308,10 @@ void oc_mutex_unlock(oc_mutex mutex)
          * Updating the owner field must be performed while owning the lock,
          * to solve race conditions with other threads using the same lock.
          */
-        mutexInfo->owner = OC_INVALID_THREAD_ID;
+        if (0 == --mutexInfo->recursionCount)
+        {
+            mutexInfo->owner = OC_INVALID_THREAD_ID;
+        }
 #endif
 
         int ret = pthread_mutex_unlock(&mutexInfo->mutex);
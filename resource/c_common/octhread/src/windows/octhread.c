@@ -48,6 +48,7 @@ typedef struct _tagMutexInfo_t
      */
 #ifndef NDEBUG
     DWORD owner;
+    uint32_t recursionCount;
 #endif
 } oc_mutex_internal;
 
@@ -136,6 +137,7 @@ oc_mutex oc_mutex_new(void)
     {
 #ifndef NDEBUG
         mutexInfo->owner = OC_INVALID_THREAD_ID;
+        mutexInfo->recursionCount = 0;
 #endif
         InitializeCriticalSection(&mutexInfo->mutex);
         retVal = (oc_mutex)mutexInfo;
@@ -148,6 +150,12 @@ oc_mutex oc_mutex_new(void)
     return retVal;
 }
 
+oc_mutex oc_mutex_new_recursive(void)
+{
+    // critical sections may always be entered again by their owner.
+    return oc_mutex_new();
+}
+
 bool oc_mutex_free(oc_mutex mutex)
 {
     bool bRet = false;
@@ -179,6 +187,7 @@ void oc_mutex_lock(oc_mutex mutex)
          * to solve race conditions with other threads using the same lock.
          */
         mutexInfo->owner = oc_get_current_thread_id();
+        mutexInfo->recursionCount++;
 #endif
     }
     else
@@ -197,7 +206,10 @@ void oc_mutex_unlock(oc_mutex mutex)
          * Updating the owner field must be performed while owning the lock,
          * to solve race conditions with other threads using the same lock.
          */
-        mutexInfo->owner = OC_INVALID_THREAD_ID;
+        if (0 == --mutexInfo->recursionCount)
+        {
+            mutexInfo->owner = OC_INVALID_THREAD_ID;
+        }
 #endif
 
         LeaveCriticalSection(&mutexInfo->mutex);
@@ -0,0 +1,86 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * 32-bit FNV-1a hash, for indexing in-memory tables.
+ *
+ * The hash is neither cryptographic nor stable across releases, so it must
+ * not be stored or sent to a peer.
+ */
+
+#ifndef OIC_HASH_H_
+#define OIC_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform_features.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/** Value to start a hash with. */
+#define OIC_HASH_INIT (2166136261u)
+
+/**
+ * Adds a run of bytes to a hash.
+ *
+ * @param[in] hash  Hash of the data seen so far, or ::OIC_HASH_INIT.
+ * @param[in] data  Bytes to add.
+ * @param[in] size  Number of bytes to add.
+ *
+ * @return the hash of the data seen so far followed by data.
+ */
+INLINE_API uint32_t OICHashBytes(uint32_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Adds a NUL-terminated string, without its terminator, to a hash.
+ *
+ * @param[in] hash  Hash of the data seen so far, or ::OIC_HASH_INIT.
+ * @param[in] str   String to add.
+ *
+ * @return the hash of the data seen so far followed by str.
+ */
+INLINE_API uint32_t OICHashString(uint32_t hash, const char *str)
+{
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++)
+    {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_HASH_H_
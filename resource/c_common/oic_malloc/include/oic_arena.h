@@ -0,0 +1,145 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef OIC_ARENA_H_
+#define OIC_ARENA_H_
+
+// An arena hands out memory for objects which all die together, e.g. the
+// pieces of one request. Allocations are carved from large blocks and are
+// never freed one by one; OICArenaRelease() drops all of them at once.
+//
+// Released arenas go back to the pool they came from and keep their first
+// block, so a steady stream of requests does not touch malloc at all. Each
+// thread keeps the arena it released last for its next acquire, so only
+// arenas beyond that one take the pool lock.
+//
+// Note that these functions are intended to be used ONLY within the TB
+// stack and NOT by the application code.
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+
+#ifdef WITH_ARDUINO
+/** Default size of an arena block, in bytes. */
+#define OIC_ARENA_DEFAULT_BLOCK_SIZE (256)
+
+/** Default number of released arenas a pool keeps for reuse. */
+#define OIC_ARENA_DEFAULT_POOL_SIZE (1)
+#else
+/** Default size of an arena block, in bytes. */
+#define OIC_ARENA_DEFAULT_BLOCK_SIZE (8192)
+
+/** Default number of released arenas a pool keeps for reuse. */
+#define OIC_ARENA_DEFAULT_POOL_SIZE (8)
+#endif
+
+//-----------------------------------------------------------------------------
+// Typedefs
+//-----------------------------------------------------------------------------
+typedef struct OICArena OICArena_t;
+typedef struct OICArenaPool OICArenaPool_t;
+
+//-----------------------------------------------------------------------------
+// Function prototypes
+//-----------------------------------------------------------------------------
+
+/**
+ * Creates a pool of arenas. The pool is thread safe.
+ * @param blockSize - Size of the first block of every arena from this pool.
+ *                    0 selects OIC_ARENA_DEFAULT_BLOCK_SIZE.
+ * @param maxCached - Maximum number of released arenas kept for reuse.
+ * @return
+ *     on success, a pointer to the pool
+ *     on failure, a null pointer is returned
+ */
+OICArenaPool_t *OICArenaPoolCreate(size_t blockSize, size_t maxCached);
+
+/**
+ * Destroys a pool. Arenas still acquired from the pool stay valid; the pool
+ * memory is freed once the last of them is released.
+ * @param pool - Pool to destroy. If pool is a null pointer, nothing happens.
+ */
+void OICArenaPoolDestroy(OICArenaPool_t *pool);
+
+/**
+ * Acquires an empty arena, reusing a released one from the pool if possible.
+ * @param pool - Pool to take the arena from. If pool is a null pointer, a
+ *               standalone arena with the default block size is created.
+ * @return
+ *     on success, a pointer to the arena
+ *     on failure, a null pointer is returned
+ */
+OICArena_t *OICArenaAcquire(OICArenaPool_t *pool);
+
+/**
+ * Acquires an empty arena whose first block holds at least minSize bytes.
+ * Arenas with a block larger than the one of the pool are not kept for reuse.
+ * @param pool - Pool to take the arena from. If pool is a null pointer, a
+ *               standalone arena is created.
+ * @param minSize - Bytes the first block must hold, e.g. the size of a
+ *                  request and its payload. 0 behaves like OICArenaAcquire().
+ * @return
+ *     on success, a pointer to the arena
+ *     on failure, a null pointer is returned
+ */
+OICArena_t *OICArenaAcquireSized(OICArenaPool_t *pool, size_t minSize);
+
+/**
+ * Releases an arena and everything allocated from it in one operation.
+ * @param arena - Arena to release. If arena is a null pointer, nothing happens.
+ */
+void OICArenaRelease(OICArena_t *arena);
+
+/**
+ * Allocates a block of size bytes from an arena. The block is suitably
+ * aligned for any type and lives until the arena is released.
+ * @param arena - Arena to allocate from.
+ * @param size - Size of the memory block in bytes, where size > 0
+ * @return
+ *     on success, a pointer to the allocated memory block
+ *     on failure, a null pointer is returned
+ */
+void *OICArenaMalloc(OICArena_t *arena, size_t size);
+
+/**
+ * Allocates a zero-initialized array of num elements of size bytes from an arena.
+ * @param arena - Arena to allocate from.
+ * @param num - The number of elements
+ * @param size - Size of the element type in bytes, where size > 0
+ * @return
+ *     on success, a pointer to the allocated memory block
+ *     on failure, a null pointer is returned
+ */
+void *OICArenaCalloc(OICArena_t *arena, size_t num, size_t size);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif /* OIC_ARENA_H_ */
@@ -0,0 +1,438 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "iotivity_config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "oic_arena.h"
+#include "oic_malloc.h"
+#include "octhread.h"
+
+#if defined(HAVE_PTHREAD_H) && defined(__GNUC__) && !defined(WITH_ARDUINO)
+# include <pthread.h>
+# define ARENA_THREAD_CACHE
+#endif
+
+//-----------------------------------------------------------------------------
+// Typedefs
+//-----------------------------------------------------------------------------
+
+/**
+ * Union of the types with the strictest alignment, every arena allocation
+ * is aligned to its size.
+ */
+typedef union
+{
+    void *p;
+    long l;
+    long long ll;
+    double d;
+    long double ld;
+} OICArenaAlign_t;
+
+/**
+ * A block of memory allocations are carved from. The data follows the header.
+ */
+typedef struct OICArenaChunk
+{
+    struct OICArenaChunk *next;
+    size_t size;
+    size_t used;
+} OICArenaChunk_t;
+
+struct OICArena
+{
+    OICArenaPool_t *pool;       /**< pool the arena belongs to, or NULL. */
+    OICArena_t *nextFree;       /**< next arena while cached in the pool. */
+    OICArenaChunk_t *current;   /**< chunk serving small allocations. */
+    OICArenaChunk_t *extra;     /**< chunks allocated after the first one. */
+    OICArenaChunk_t first;      /**< first chunk, its data follows the arena. */
+};
+
+struct OICArenaPool
+{
+    oc_mutex lock;
+    size_t blockSize;
+    size_t maxCached;
+    size_t numCached;
+    size_t numAcquired;
+    bool destroyed;
+    OICArena_t *cached;
+};
+
+//-----------------------------------------------------------------------------
+// Macros
+//-----------------------------------------------------------------------------
+#define ARENA_ALIGN(x) \
+    (((x) + sizeof(OICArenaAlign_t) - 1) / sizeof(OICArenaAlign_t) * sizeof(OICArenaAlign_t))
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(OICArena_t))
+#define CHUNK_HEADER_SIZE ARENA_ALIGN(sizeof(OICArenaChunk_t))
+#define CHUNK_DATA(chunk) ((uint8_t *)(chunk) + CHUNK_HEADER_SIZE)
+
+//-----------------------------------------------------------------------------
+// Private variables
+//-----------------------------------------------------------------------------
+#ifdef ARENA_THREAD_CACHE
+static pthread_once_t g_threadArenaKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_threadArenaKey;
+
+/**
+ * Arena released last on this thread, reused by the next acquire from its
+ * pool without taking the pool lock. It still counts as acquired.
+ */
+static __thread OICArena_t *t_arena = NULL;
+#endif
+
+//-----------------------------------------------------------------------------
+// Private internal functions
+//-----------------------------------------------------------------------------
+static OICArena_t *CreateArena(OICArenaPool_t *pool, size_t blockSize)
+{
+    OICArena_t *arena = (OICArena_t *)OICMalloc(ARENA_HEADER_SIZE + blockSize);
+    if (!arena)
+    {
+        return NULL;
+    }
+    arena->pool = pool;
+    arena->nextFree = NULL;
+    arena->extra = NULL;
+    arena->first.next = NULL;
+    arena->first.size = blockSize;
+    arena->first.used = 0;
+    arena->current = &arena->first;
+    return arena;
+}
+
+static void *FirstChunkData(OICArena_t *arena)
+{
+    return (uint8_t *)arena + ARENA_HEADER_SIZE;
+}
+
+static void ResetArena(OICArena_t *arena)
+{
+    OICArenaChunk_t *chunk = arena->extra;
+    while (chunk)
+    {
+        OICArenaChunk_t *next = chunk->next;
+        OICFree(chunk);
+        chunk = next;
+    }
+    arena->extra = NULL;
+    arena->first.used = 0;
+    arena->current = &arena->first;
+    arena->nextFree = NULL;
+}
+
+static void FreePool(OICArenaPool_t *pool)
+{
+    OICArena_t *arena = pool->cached;
+    while (arena)
+    {
+        OICArena_t *next = arena->nextFree;
+        OICFree(arena);
+        arena = next;
+    }
+    oc_mutex_free(pool->lock);
+    OICFree(pool);
+}
+
+/**
+ * Returns a reset arena to its pool, caching it there if the pool has room.
+ */
+static void ReturnArena(OICArena_t *arena)
+{
+    OICArenaPool_t *pool = arena->pool;
+    oc_mutex_lock(pool->lock);
+    pool->numAcquired--;
+    bool freePool = pool->destroyed && (0 == pool->numAcquired);
+    if (!pool->destroyed && pool->numCached < pool->maxCached &&
+        arena->first.size == pool->blockSize)
+    {
+        arena->nextFree = pool->cached;
+        pool->cached = arena;
+        pool->numCached++;
+        arena = NULL;
+    }
+    oc_mutex_unlock(pool->lock);
+
+    OICFree(arena);
+    if (freePool)
+    {
+        FreePool(pool);
+    }
+}
+
+#ifdef ARENA_THREAD_CACHE
+static void ReleaseThreadArena(void *data)
+{
+    t_arena = NULL;
+    ReturnArena((OICArena_t *)data);
+}
+
+static void CreateThreadArenaKey()
+{
+    pthread_key_create(&g_threadArenaKey, ReleaseThreadArena);
+}
+
+/**
+ * Takes the arena cached by this thread if it belongs to pool. An arena of
+ * another pool goes back to its own pool.
+ */
+static OICArena_t *TakeThreadArena(OICArenaPool_t *pool)
+{
+    OICArena_t *arena = t_arena;
+    if (!arena)
+    {
+        return NULL;
+    }
+    t_arena = NULL;
+    pthread_setspecific(g_threadArenaKey, NULL);
+
+    if (arena->pool != pool)
+    {
+        ReturnArena(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+/**
+ * Caches a reset arena on this thread if the slot is free and the arena would
+ * be cached by its pool.
+ */
+static bool KeepThreadArena(OICArena_t *arena)
+{
+    OICArenaPool_t *pool = arena->pool;
+    if (t_arena || arena->first.size != pool->blockSize ||
+        __atomic_load_n(&pool->destroyed, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    pthread_once(&g_threadArenaKeyOnce, CreateThreadArenaKey);
+    pthread_setspecific(g_threadArenaKey, arena);
+    t_arena = arena;
+    return true;
+}
+#endif // ARENA_THREAD_CACHE
+
+//-----------------------------------------------------------------------------
+// Public APIs
+//-----------------------------------------------------------------------------
+OICArenaPool_t *OICArenaPoolCreate(size_t blockSize, size_t maxCached)
+{
+    OICArenaPool_t *pool = (OICArenaPool_t *)OICCalloc(1, sizeof(OICArenaPool_t));
+    if (!pool)
+    {
+        return NULL;
+    }
+    pool->lock = oc_mutex_new();
+    if (!pool->lock)
+    {
+        OICFree(pool);
+        return NULL;
+    }
+    pool->blockSize = blockSize ? ARENA_ALIGN(blockSize) : OIC_ARENA_DEFAULT_BLOCK_SIZE;
+    pool->maxCached = maxCached;
+    return pool;
+}
+
+void OICArenaPoolDestroy(OICArenaPool_t *pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+#ifdef ARENA_THREAD_CACHE
+    OICArena_t *own = TakeThreadArena(pool);
+    if (own)
+    {
+        ReturnArena(own);
+    }
+#endif
+
+    oc_mutex_lock(pool->lock);
+    bool inUse = (0 != pool->numAcquired);
+#ifdef ARENA_THREAD_CACHE
+    __atomic_store_n(&pool->destroyed, true, __ATOMIC_RELEASE);
+#else
+    pool->destroyed = true;
+#endif
+    oc_mutex_unlock(pool->lock);
+
+    // The last arena released frees the pool otherwise.
+    if (!inUse)
+    {
+        FreePool(pool);
+    }
+}
+
+OICArena_t *OICArenaAcquire(OICArenaPool_t *pool)
+{
+    return OICArenaAcquireSized(pool, 0);
+}
+
+OICArena_t *OICArenaAcquireSized(OICArenaPool_t *pool, size_t minSize)
+{
+    size_t blockSize = ARENA_ALIGN(minSize);
+    if (blockSize < minSize || SIZE_MAX - ARENA_HEADER_SIZE < blockSize)
+    {
+        return NULL;
+    }
+
+    if (!pool)
+    {
+        return CreateArena(NULL, (blockSize > OIC_ARENA_DEFAULT_BLOCK_SIZE) ?
+                                 blockSize : OIC_ARENA_DEFAULT_BLOCK_SIZE);
+    }
+
+    // Cached arenas all have the block size of the pool.
+    bool sized = (blockSize > pool->blockSize);
+    OICArena_t *arena = NULL;
+#ifdef ARENA_THREAD_CACHE
+    if (!sized)
+    {
+        arena = TakeThreadArena(pool);
+        if (arena)
+        {
+            return arena;
+        }
+    }
+#endif
+
+    oc_mutex_lock(pool->lock);
+    if (!sized && pool->cached)
+    {
+        arena = pool->cached;
+        pool->cached = arena->nextFree;
+        pool->numCached--;
+        arena->nextFree = NULL;
+    }
+    pool->numAcquired++;
+    oc_mutex_unlock(pool->lock);
+
+    if (!arena)
+    {
+        arena = CreateArena(pool, sized ? blockSize : pool->blockSize);
+        if (!arena)
+        {
+            oc_mutex_lock(pool->lock);
+            pool->numAcquired--;
+            oc_mutex_unlock(pool->lock);
+        }
+    }
+    return arena;
+}
+
+void OICArenaRelease(OICArena_t *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    ResetArena(arena);
+
+    if (!arena->pool)
+    {
+        OICFree(arena);
+        return;
+    }
+
+#ifdef ARENA_THREAD_CACHE
+    if (KeepThreadArena(arena))
+    {
+        return;
+    }
+#endif
+    ReturnArena(arena);
+}
+
+void *OICArenaMalloc(OICArena_t *arena, size_t size)
+{
+    if (!arena || 0 == size)
+    {
+        return NULL;
+    }
+
+    size_t alignedSize = ARENA_ALIGN(size);
+    if (alignedSize < size)
+    {
+        return NULL;
+    }
+
+    OICArenaChunk_t *chunk = arena->current;
+    if (chunk->size - chunk->used >= alignedSize)
+    {
+        uint8_t *data = (chunk == &arena->first) ? (uint8_t *)FirstChunkData(arena)
+                                                 : CHUNK_DATA(chunk);
+        void *ptr = data + chunk->used;
+        chunk->used += alignedSize;
+        return ptr;
+    }
+
+    // Large allocations get a chunk of their own, so that the space left in the
+    // current chunk can still be used by the allocations that follow.
+    size_t chunkSize = arena->first.size;
+    bool dedicated = (alignedSize > chunkSize / 2);
+    if (dedicated)
+    {
+        chunkSize = alignedSize;
+    }
+    if (SIZE_MAX - CHUNK_HEADER_SIZE < chunkSize)
+    {
+        return NULL;
+    }
+
+    OICArenaChunk_t *newChunk = (OICArenaChunk_t *)OICMalloc(CHUNK_HEADER_SIZE + chunkSize);
+    if (!newChunk)
+    {
+        return NULL;
+    }
+    newChunk->size = chunkSize;
+    newChunk->used = alignedSize;
+    newChunk->next = arena->extra;
+    arena->extra = newChunk;
+    if (!dedicated)
+    {
+        arena->current = newChunk;
+    }
+    return CHUNK_DATA(newChunk);
+}
+
+void *OICArenaCalloc(OICArena_t *arena, size_t num, size_t size)
+{
+    if (0 == size || 0 == num || SIZE_MAX / num < size)
+    {
+        return NULL;
+    }
+
+    void *ptr = OICArenaMalloc(arena, num * size);
+    if (ptr)
+    {
+        memset(ptr, 0, num * size);
+    }
+    return ptr;
+}
@@ -0,0 +1,197 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+extern "C" {
+    #include "oic_arena.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+//-----------------------------------------------------------------------------
+//  Tests
+//-----------------------------------------------------------------------------
+
+TEST(OICArenaTests, AllocationsAreAlignedAndDistinct)
+{
+    OICArena_t *arena = OICArenaAcquire(NULL);
+    ASSERT_TRUE(NULL != arena);
+
+    uint8_t *first = (uint8_t *)OICArenaMalloc(arena, 3);
+    uint8_t *second = (uint8_t *)OICArenaMalloc(arena, 5);
+    ASSERT_TRUE(NULL != first);
+    ASSERT_TRUE(NULL != second);
+    EXPECT_EQ(0u, (uintptr_t)first % sizeof(void *));
+    EXPECT_EQ(0u, (uintptr_t)second % sizeof(void *));
+    EXPECT_TRUE(second >= first + 3);
+
+    memset(first, 0xAA, 3);
+    memset(second, 0x55, 5);
+    EXPECT_EQ(0xAA, first[2]);
+
+    OICArenaRelease(arena);
+}
+
+TEST(OICArenaTests, InvalidArguments)
+{
+    EXPECT_TRUE(NULL == OICArenaMalloc(NULL, 10));
+
+    OICArena_t *arena = OICArenaAcquire(NULL);
+    ASSERT_TRUE(NULL != arena);
+    EXPECT_TRUE(NULL == OICArenaMalloc(arena, 0));
+    EXPECT_TRUE(NULL == OICArenaCalloc(arena, 0, 10));
+    EXPECT_TRUE(NULL == OICArenaCalloc(arena, SIZE_MAX / 2, 4));
+    OICArenaRelease(arena);
+
+    // Releasing nothing is fine.
+    OICArenaRelease(NULL);
+    OICArenaPoolDestroy(NULL);
+}
+
+TEST(OICArenaTests, CallocZeroes)
+{
+    OICArena_t *arena = OICArenaAcquire(NULL);
+    ASSERT_TRUE(NULL != arena);
+
+    uint8_t *ptr = (uint8_t *)OICArenaCalloc(arena, 16, 4);
+    ASSERT_TRUE(NULL != ptr);
+    for (size_t i = 0; i < 64; i++)
+    {
+        EXPECT_EQ(0, ptr[i]);
+    }
+
+    OICArenaRelease(arena);
+}
+
+TEST(OICArenaTests, GrowsBeyondFirstBlock)
+{
+    OICArenaPool_t *pool = OICArenaPoolCreate(256, 1);
+    ASSERT_TRUE(NULL != pool);
+
+    OICArena_t *arena = OICArenaAcquire(pool);
+    ASSERT_TRUE(NULL != arena);
+
+    // Many small allocations spill into further blocks.
+    for (int i = 0; i < 100; i++)
+    {
+        uint8_t *ptr = (uint8_t *)OICArenaMalloc(arena, 24);
+        ASSERT_TRUE(NULL != ptr);
+        memset(ptr, i, 24);
+    }
+
+    // A large allocation gets a block of its own.
+    uint8_t *large = (uint8_t *)OICArenaMalloc(arena, 4096);
+    ASSERT_TRUE(NULL != large);
+    memset(large, 0x11, 4096);
+
+    OICArenaRelease(arena);
+    OICArenaPoolDestroy(pool);
+}
+
+TEST(OICArenaTests, PoolReusesReleasedArena)
+{
+    OICArenaPool_t *pool = OICArenaPoolCreate(0, 1);
+    ASSERT_TRUE(NULL != pool);
+
+    OICArena_t *arena = OICArenaAcquire(pool);
+    ASSERT_TRUE(NULL != arena);
+    void *ptr = OICArenaMalloc(arena, 32);
+    ASSERT_TRUE(NULL != ptr);
+    OICArenaRelease(arena);
+
+    // The cached arena comes back empty.
+    OICArena_t *reused = OICArenaAcquire(pool);
+    EXPECT_EQ(arena, reused);
+    EXPECT_EQ(ptr, OICArenaMalloc(reused, 32));
+
+    // One arena is kept by the thread and one by the pool.
+    OICArena_t *other = OICArenaAcquire(pool);
+    ASSERT_TRUE(NULL != other);
+    EXPECT_NE(reused, other);
+    OICArenaRelease(other);
+    OICArenaRelease(reused);
+
+    OICArenaPoolDestroy(pool);
+}
+
+TEST(OICArenaTests, SizedArenaIsNotReused)
+{
+    OICArenaPool_t *pool = OICArenaPoolCreate(256, 1);
+    ASSERT_TRUE(NULL != pool);
+
+    // The first block holds the whole request, and is freed on release.
+    OICArena_t *sized = OICArenaAcquireSized(pool, 1024);
+    ASSERT_TRUE(NULL != sized);
+    uint8_t *first = (uint8_t *)OICArenaMalloc(sized, 1000);
+    ASSERT_TRUE(NULL != first);
+    memset(first, 0x5A, 1000);
+    OICArenaRelease(sized);
+
+    // Small requests still get the cached arena.
+    OICArena_t *arena = OICArenaAcquireSized(pool, 100);
+    ASSERT_TRUE(NULL != arena);
+    void *ptr = OICArenaMalloc(arena, 32);
+    OICArenaRelease(arena);
+    OICArena_t *reused = OICArenaAcquireSized(pool, 0);
+    ASSERT_TRUE(NULL != reused);
+    EXPECT_EQ(ptr, OICArenaMalloc(reused, 32));
+    OICArenaRelease(reused);
+
+    OICArenaPoolDestroy(pool);
+}
+
+TEST(OICArenaTests, ArenaOutlivesDestroyedPool)
+{
+    OICArenaPool_t *pool = OICArenaPoolCreate(0, 4);
+    ASSERT_TRUE(NULL != pool);
+
+    OICArena_t *arena = OICArenaAcquire(pool);
+    ASSERT_TRUE(NULL != arena);
+    OICArenaPoolDestroy(pool);
+
+    // The arena is still usable, and releasing it frees the pool.
+    EXPECT_TRUE(NULL != OICArenaMalloc(arena, 128));
+    OICArenaRelease(arena);
+}
+
+TEST(OICArenaTests, ThreadArenaGoesBackToPoolOnExit)
+{
+    OICArenaPool_t *pool = OICArenaPoolCreate(0, 1);
+    ASSERT_TRUE(NULL != pool);
+
+    OICArena_t *released = NULL;
+    std::thread worker([pool, &released]()
+    {
+        released = OICArenaAcquire(pool);
+        OICArenaRelease(released);
+    });
+    worker.join();
+
+    // The arena the worker kept for itself is cached by the pool now.
+    ASSERT_TRUE(NULL != released);
+    OICArena_t *arena = OICArenaAcquire(pool);
+    EXPECT_EQ(released, arena);
+    OICArenaRelease(arena);
+
+    OICArenaPoolDestroy(pool);
+}
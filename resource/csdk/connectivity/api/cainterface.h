@@ -231,6 +231,24 @@ CATransportAdapter_t CAGetSelectedNetwork();
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Maximum number of receive workers, see CASetReceiveWorkerCount().
+ */
+#define CA_MAX_RECEIVE_WORKERS 16
+
+/**
+ * Set the number of worker threads that pass received data to the registered
+ * handlers. Data is sharded on the remote endpoint, so data from one peer is
+ * handled in order while different peers are handled concurrently. With no
+ * workers (the default) received data is handled in CAHandleRequestResponse().
+ * Must be called before CAInitialize().
+ * @param[in]   workerCount   number of workers, up to ::CA_MAX_RECEIVE_WORKERS.
+ *
+ * @return  ::CA_STATUS_OK, ::CA_STATUS_INVALID_PARAM, ::CA_STATUS_FAILED if
+ *          already initialized or ::CA_NOT_SUPPORTED on single threaded builds.
+ */
+CAResult_t CASetReceiveWorkerCount(uint8_t workerCount);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
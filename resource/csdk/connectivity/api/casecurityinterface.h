@@ -42,6 +42,17 @@ extern "C"
  * It does not make much sense in bringing in all definitions from dtls.h into here.
  * Therefore, redefining them here.
  */
+/**
+ * Counters of the (D)TLS session resumption cache.
+ */
+typedef struct
+{
+    uint32_t hits;          /**< Handshakes that resumed a cached session or ticket. */
+    uint32_t misses;        /**< Handshakes that needed a full key exchange. */
+    uint32_t evictions;     /**< Sessions evicted to keep the cache bounded. */
+    uint32_t entries;       /**< Sessions currently cached. */
+} CASslSessionCacheStats_t;
+
 typedef enum
 {
     CA_DTLS_PSK_HINT,
@@ -233,7 +244,8 @@ CAResult_t CAGenerateOwnerPSK(const CAEndpoint_t *endpoint,
 CAResult_t CAInitiateHandshake(const CAEndpoint_t *endpoint);
 
 /**
- * Close the DTLS session.
+ * Close the DTLS session. Sessions cached for resumption with the peer are dropped too,
+ * so the next connection authenticates with the current credentials.
  *
  * @param[in] endpoint  information of network address.
  *
@@ -242,6 +254,26 @@ CAResult_t CAInitiateHandshake(const CAEndpoint_t *endpoint);
  */
 CAResult_t CAcloseSslSession(const CAEndpoint_t *endpoint);
 
+/**
+ * Notify the (D)TLS layer that the credential resources have changed. Parsed certificates,
+ * keys and ciphersuite lists are cached between handshakes until this is called.
+ *
+ * @retval  ::CA_STATUS_OK    Successful.
+ * @retval  ::CA_STATUS_FAILED Operation failed.
+ */
+CAResult_t CAInvalidateSslCredentials(void);
+
+/**
+ * Get the counters of the (D)TLS session resumption cache.
+ *
+ * @param[out] stats  session cache counters.
+ *
+ * @retval  ::CA_STATUS_OK    Successful.
+ * @retval  ::CA_STATUS_INVALID_PARAM Invalid input argument.
+ * @retval  ::CA_STATUS_FAILED Operation failed.
+ */
+CAResult_t CAGetSslSessionCacheStats(CASslSessionCacheStats_t *stats);
+
 /**
  * Initiate TLS handshake with selected cipher suite.
  *
@@ -0,0 +1,89 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the APIs for a bounded multi-producer, single-consumer
+ * queue. Producers never take a lock and the queue does not allocate per
+ * message, so it suits the CA hand-off between network and message threads.
+ */
+
+#ifndef U_MPSC_QUEUE_H_
+#define U_MPSC_QUEUE_H_
+
+#include <stdbool.h>
+#include "uqueue.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/**
+ * Bounded multi-producer, single-consumer queue.
+ */
+typedef struct u_mpsc_queue_t u_mpsc_queue_t;
+
+/**
+ * API to create the queue.
+ * @param capacity number of messages the queue holds, rounded up to a power of two.
+ * @return  u_mpsc_queue_t pointer if Success, NULL otherwise.
+ */
+u_mpsc_queue_t *u_mpsc_queue_create(uint32_t capacity);
+
+/**
+ * Deletes the queue. Messages still in the queue are not freed.
+ * @param queue pointer to queue.
+ */
+void u_mpsc_queue_delete(u_mpsc_queue_t *queue);
+
+/**
+ * Adds message at the end of the queue. Safe to call from any thread.
+ * @param queue pointer to queue.
+ * @param msg pointer to message.
+ * @param size message size.
+ * @return true if the message was added, false if the queue is full.
+ */
+bool u_mpsc_queue_add_element(u_mpsc_queue_t *queue, void *msg, uint32_t size);
+
+/**
+ * Removes up to count messages from the head of the queue.
+ * Must only be called from the consumer thread.
+ * @param queue pointer to queue.
+ * @param messages array receiving the messages.
+ * @param count number of entries in messages.
+ * @return number of messages removed.
+ */
+uint32_t u_mpsc_queue_get_elements(u_mpsc_queue_t *queue, u_queue_message_t *messages,
+                                   uint32_t count);
+
+/**
+ * Must only be called from the consumer thread.
+ * @param queue pointer to queue.
+ * @return true if no message is ready at the head of the queue.
+ */
+bool u_mpsc_queue_is_empty(u_mpsc_queue_t *queue);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* U_MPSC_QUEUE_H_ */
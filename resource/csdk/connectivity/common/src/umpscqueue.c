@@ -0,0 +1,204 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "umpscqueue.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "ocatomic.h"
+#include "logger.h"
+#include "oic_malloc.h"
+
+/**
+ * @def TAG
+ * @brief Logging tag for module name
+ */
+#define TAG "OIC_UMPSCQUEUE"
+
+/**
+ * Each slot carries a sequence number. A slot at position pos is free for
+ * the producer that claims pos when its sequence equals pos, and holds a
+ * message for the consumer when its sequence equals pos + 1. Positions and
+ * sequences wrap around, so they are always compared as a signed distance.
+ */
+typedef struct
+{
+    /** slot state, see above. */
+    volatile int32_t sequence;
+    /** Pointer to message. */
+    void *msg;
+    /** message size. */
+    uint32_t size;
+} u_mpsc_slot_t;
+
+struct u_mpsc_queue_t
+{
+    /** capacity - 1. */
+    uint32_t mask;
+    /** next position claimed by producers. */
+    volatile int32_t tail;
+    /** next position read by the consumer. */
+    uint32_t head;
+    /** message slots. */
+    u_mpsc_slot_t *slots;
+};
+
+static int32_t u_mpsc_queue_distance(int32_t sequence, uint32_t position)
+{
+    return (int32_t) ((uint32_t) sequence - position);
+}
+
+u_mpsc_queue_t *u_mpsc_queue_create(uint32_t capacity)
+{
+    if (0 == capacity || capacity > (UINT32_MAX >> 2))
+    {
+        OIC_LOG(DEBUG, TAG, "QueueCreate FAIL, invalid capacity");
+        return NULL;
+    }
+
+    uint32_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    u_mpsc_queue_t *queuePtr = (u_mpsc_queue_t *) OICCalloc(1, sizeof(u_mpsc_queue_t));
+    if (NULL == queuePtr)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueCreate FAIL");
+        return NULL;
+    }
+
+    queuePtr->slots = (u_mpsc_slot_t *) OICCalloc(size, sizeof(u_mpsc_slot_t));
+    if (NULL == queuePtr->slots)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueCreate FAIL");
+        OICFree(queuePtr);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        queuePtr->slots[i].sequence = (int32_t) i;
+    }
+    queuePtr->mask = size - 1;
+
+    return queuePtr;
+}
+
+void u_mpsc_queue_delete(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        return;
+    }
+
+    OICFree(queue->slots);
+    OICFree(queue);
+}
+
+bool u_mpsc_queue_add_element(u_mpsc_queue_t *queue, void *msg, uint32_t size)
+{
+    if (NULL == queue)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueAddElement FAIL, Invalid Queue");
+        return false;
+    }
+
+    uint32_t position = (uint32_t) oc_atomic_load(&queue->tail);
+    u_mpsc_slot_t *slot = NULL;
+
+    for (;;)
+    {
+        slot = &queue->slots[position & queue->mask];
+        int32_t distance = u_mpsc_queue_distance(oc_atomic_load(&slot->sequence), position);
+
+        if (0 == distance)
+        {
+            // slot is free, try to claim the position.
+            uint32_t current = (uint32_t) oc_atomic_cmpxchg(&queue->tail, (int32_t) position,
+                                                            (int32_t) (position + 1));
+            if (current == position)
+            {
+                break;
+            }
+            position = current;
+        }
+        else if (distance < 0)
+        {
+            // the consumer has not released this slot yet, queue is full.
+            return false;
+        }
+        else
+        {
+            // another producer claimed the position first.
+            position = (uint32_t) oc_atomic_load(&queue->tail);
+        }
+    }
+
+    slot->msg = msg;
+    slot->size = size;
+
+    // publish the message to the consumer.
+    oc_atomic_store(&slot->sequence, (int32_t) (position + 1));
+    return true;
+}
+
+uint32_t u_mpsc_queue_get_elements(u_mpsc_queue_t *queue, u_queue_message_t *messages,
+                                   uint32_t count)
+{
+    if (NULL == queue || NULL == messages)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueGetElements FAIL, Invalid Queue");
+        return 0;
+    }
+
+    uint32_t received = 0;
+    while (received < count)
+    {
+        u_mpsc_slot_t *slot = &queue->slots[queue->head & queue->mask];
+        if (u_mpsc_queue_distance(oc_atomic_load(&slot->sequence), queue->head + 1) < 0)
+        {
+            // empty, or the producer of this slot has not published yet.
+            break;
+        }
+
+        messages[received].msg = slot->msg;
+        messages[received].size = slot->size;
+        received++;
+
+        // release the slot for the producer one lap ahead.
+        oc_atomic_store(&slot->sequence, (int32_t) (queue->head + queue->mask + 1));
+        queue->head++;
+    }
+
+    return received;
+}
+
+bool u_mpsc_queue_is_empty(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        return true;
+    }
+
+    u_mpsc_slot_t *slot = &queue->slots[queue->head & queue->mask];
+    return u_mpsc_queue_distance(oc_atomic_load(&slot->sequence), queue->head + 1) < 0;
+}
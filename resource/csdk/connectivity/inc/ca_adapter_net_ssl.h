@@ -89,6 +89,31 @@ void CAsetSslCredentialsCallback(CAgetPskCredentialsHandler credCallback);
  */
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint);
 
+/**
+ * Mark the parsed credentials as stale. The next handshake reads the credential types,
+ * the PSK identity and the certificates from the security resources again.
+ */
+void CAinvalidateSslCredentials(void);
+
+/**
+ * Close the TLS session with a peer and forget the sessions cached for resumption with it,
+ * so the next connection performs a full handshake with the current credentials.
+ *
+ * @param[in] endpoint  information of network address
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAendSslSession(const CAEndpoint_t *endpoint);
+
+/**
+ * Get the counters of the session resumption cache.
+ *
+ * @param[out] stats  session cache counters
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAgetSslSessionCacheStats(CASslSessionCacheStats_t *stats);
+
 /**
  * initialize mbedTLS library and other necessary initialization.
  *
@@ -29,6 +29,7 @@
 #include <stdint.h>
 
 #include <coap/coap.h>
+#include <coap/uthash.h>
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uarraylist.h"
@@ -64,8 +65,8 @@ typedef struct
     /** callback function for received message. **/
     CAReceiveThreadFunc receivedThreadFunc;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** hash table of block data sets keyed by ::CABlockDataID_t. **/
+    struct CABlockData *sessions;
 
     /** data list mutex for synchronization. **/
     oc_mutex blockDataListMutex;
@@ -83,10 +84,23 @@ typedef struct
     size_t idLength;                   /**< length of blockData ID. */
 } CABlockDataID_t;
 
+/**
+ * Received block payload kept as is until the full payload is gathered.
+ */
+typedef struct CABlockSegment
+{
+    struct CABlockSegment *next;        /**< next segment in receive order. */
+    size_t length;                      /**< length of data. */
+    uint8_t data[1];                    /**< block payload, allocated with the segment. */
+} CABlockSegment_t;
+
 /**
  * Block Data Set.
+ * The received payload is payload followed by the segments. Blocks are copied into
+ * payload while it has room, e.g. once the total size is known from a size option,
+ * and are appended as segments otherwise.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -94,8 +108,12 @@ typedef struct
     CABlockDataID_t* blockDataId;        /**< ID set of CABlockData. */
     CAData_t *sentData;                 /**< sent request or response data information. */
     CAPayload_t payload;                /**< payload buffer. */
+    size_t payloadCapacity;             /**< allocated size of payload. */
+    CABlockSegment_t *segments;         /**< blocks received after payload was full. */
+    CABlockSegment_t *lastSegment;      /**< tail of segments. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
+    UT_hash_handle hh;                  /**< handle of the sessions hash table. */
 } CABlockData_t;
 
 /**
@@ -527,6 +545,18 @@ CAResult_t CACheckBlockDataValidation(const CAData_t *sendData, CABlockData_t **
  */
 CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID);
 
+/**
+ * Check whether a block-wise transfer exists for a token and remote address.
+ * Unlike ::CACreateBlockDatablockId this does not allocate.
+ * @param[in]   token       token of the message.
+ * @param[in]   tokenLength length of the token.
+ * @param[in]   addr        remote address.
+ * @param[in]   portNumber  remote port.
+ * @return true if block data exists for the message.
+ */
+bool CAHasBlockData(const CAToken_t token, uint8_t tokenLength,
+                    const char *addr, uint16_t portNumber);
+
 /**
  * Get the block option from block-wise transfer list.
  * @param[in]   blockID     ID set of CABlockData.
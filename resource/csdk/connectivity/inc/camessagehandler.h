@@ -97,6 +97,14 @@ void CAHandleRequestResponseCallbacks();
  */
 void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler);
 
+/**
+ * Set the number of receive workers used by the next CAInitializeMessageHandler().
+ * @param[in] workerCount    number of workers, 0 to handle received data in
+ *                           CAHandleRequestResponseCallbacks().
+ * @return ::CA_STATUS_OK or ::CA_STATUS_INVALID_PARAM.
+ */
+CAResult_t CASetReceiveWorkers(uint8_t workerCount);
+
 #ifdef WITH_BWT
 /**
  * Add the data to the send queue thread.
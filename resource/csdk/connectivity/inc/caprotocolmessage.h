@@ -52,6 +52,46 @@ typedef uint32_t code_t;
 
 static const uint8_t PAYLOAD_MARKER = 1;
 
+/**
+ * A CoAP option as it appears in an encoded message.
+ * The value points into the message; it is not copied.
+ */
+typedef struct
+{
+    uint16_t key;                   /**< option number. */
+    uint16_t length;                /**< length of the option value. */
+    const uint8_t *value;           /**< option value, inside the message. */
+} CAOptionView_t;
+
+/**
+ * A parsed CoAP over UDP message. Token, options and payload point into the
+ * parsed buffer, so the view is only valid as long as that buffer is.
+ */
+typedef struct
+{
+    CAMessageType_t type;           /**< message type. */
+    uint32_t code;                  /**< method or response code (CA_GET, CA_CONTENT, ...). */
+    uint16_t messageId;             /**< message ID, as stored in ::CAInfo_t::messageId. */
+    const uint8_t *token;           /**< token, or NULL. */
+    uint8_t tokenLength;            /**< length of the token. */
+    const uint8_t *options;         /**< first encoded option. */
+    size_t optionsLength;           /**< length of the encoded options. */
+    uint32_t numOptions;            /**< number of options. */
+    const uint8_t *payload;         /**< payload, or NULL. */
+    size_t payloadSize;             /**< length of the payload. */
+} CAPDUView_t;
+
+/**
+ * Iterator over the options of a ::CAPDUView_t.
+ * Initialize it with ::CAInitOptionIterator.
+ */
+typedef struct
+{
+    const uint8_t *next;            /**< next encoded option. */
+    const uint8_t *end;             /**< end of the encoded options. */
+    uint16_t key;                   /**< number of the previous option. */
+} CAOptionIterator_t;
+
 /**
  * generates pdu structure from the given information.
  * @param[in]   code                 code of the pdu packet.
@@ -209,6 +249,46 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
 coap_pdu_t *CAParsePDU(const char *data, size_t length, uint32_t *outCode,
                        const CAEndpoint_t *endpoint);
 
+/**
+ * encodes a CoAP over UDP message into a caller supplied buffer.
+ * Unlike ::CAGeneratePDU this does not allocate: URI and header options are
+ * collected on the stack and written in option number order. Messages which
+ * do not fit into @p buffer, or which need more options than the builder
+ * handles, fail so that the caller can fall back to ::CAGeneratePDU.
+ * @param[in]   code                request or response code.
+ * @param[in]   info                information of the request/response.
+ * @param[out]  buffer              buffer receiving the encoded message.
+ * @param[in]   bufferSize          size of @p buffer.
+ * @param[out]  outLength           length of the encoded message.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAGeneratePDUToBuffer(uint32_t code, const CAInfo_t *info,
+                                 uint8_t *buffer, size_t bufferSize, size_t *outLength);
+
+/**
+ * parses a CoAP over UDP message in place, without copying or allocating.
+ * @param[in]   data                received data.
+ * @param[in]   length              length of the data received.
+ * @param[out]  outView             view on the message.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAParsePDUView(const uint8_t *data, size_t length, CAPDUView_t *outView);
+
+/**
+ * initializes an iterator over the options of a parsed message.
+ * @param[in]   view                parsed message.
+ * @param[out]  iter                iterator to initialize.
+ */
+void CAInitOptionIterator(const CAPDUView_t *view, CAOptionIterator_t *iter);
+
+/**
+ * gets the next option of a parsed message.
+ * @param[in,out] iter              iterator initialized by ::CAInitOptionIterator.
+ * @param[out]  outOption           next option.
+ * @return  true if an option was returned, false at the end of the options.
+ */
+bool CAGetNextOption(CAOptionIterator_t *iter, CAOptionView_t *outOption);
+
 /**
  * get Token from received data(pdu).
  * @param[in]    pdu_hdr             header of received pdu.
@@ -32,7 +32,9 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uqueue.h"
+#include "umpscqueue.h"
 #include "cacommon.h"
+#include "ocmetrics.h"
 #ifdef __cplusplus
 extern "C"
 {
@@ -60,6 +62,14 @@ typedef struct
     bool isStop;
     /** Que on which the thread is operating. **/
     u_queue_t *dataQueue;
+    /** Lock-free que filled ahead of dataQueue, NULL if not used. **/
+    u_mpsc_queue_t *ringQueue;
+    /** Number of data put on dataQueue because ringQueue was full. **/
+    volatile int32_t overflowCount;
+    /** Set while the thread waits for data, producers signal only then. **/
+    volatile int32_t isIdle;
+    /** Gauge counting the queued data, OC_METRIC_COUNT if not counted. **/
+    OCMetricId depthMetric;
 } CAQueueingThread_t;
 
 /**
@@ -73,6 +83,23 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Initializes the queuing thread with a bounded lock-free que in front of the
+ * locked one. Adding data then takes no lock unless the thread is idle or the
+ * lock-free que is full, and the thread takes data in batches.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   handle       thread pool handle created.
+ * @param[in]   task         function to be called for each data.
+ * @param[in]   destroy      function to data destroy.
+ * @param[in]   capacity     number of data the lock-free que holds.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadInitializeLockFree(CAQueueingThread_t *thread,
+                                              ca_thread_pool_t handle,
+                                              CAThreadTask task,
+                                              CADataDestroyFunction destroy,
+                                              uint32_t capacity);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
@@ -89,6 +116,15 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Take the oldest queuing thread data, for a queue that is drained by the
+ * caller instead of a started thread. Only one caller may take data at a time.
+ * @param[in]   thread       thread data for each thread.
+ * @param[out]  message      data and its length, owned by the caller.
+ * @return  true if data was taken, false if the queue is empty.
+ */
+bool CAQueueingThreadGetData(CAQueueingThread_t *thread, u_queue_message_t *message);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
@@ -68,6 +68,9 @@ typedef struct
 
 } CARetransmissionConfig_t;
 
+/** pending retransmission data, ordered by deadline and indexed by message ID. **/
+typedef struct CARetransmissionQueue CARetransmissionQueue_t;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -91,8 +94,11 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** pending data on which the thread is operating. **/
+    CARetransmissionQueue_t *queue;
+
+    /** number of pending retransmission data. **/
+    size_t pendingCount;
 
 } CARetransmission_t;
 
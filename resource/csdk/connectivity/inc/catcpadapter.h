@@ -30,6 +30,7 @@
 #include "cathreadpool.h"
 #include "cainterface.h"
 #include <coap/pdu.h>
+#include <coap/uthash.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -54,6 +55,15 @@ typedef enum
     DISCONNECTED
 } CATCPConnectionState_t;
 
+/**
+ * Key of the TCP session endpoint index. Zero-filled before use so it can be hashed bytewise.
+ */
+typedef struct
+{
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< remote address */
+    uint16_t port;                      /**< remote port */
+} CATCPSessionKey_t;
+
 /**
  * TCP Session Information for IPv4/IPv6 TCP transport
  */
@@ -70,6 +80,11 @@ typedef struct CATCPSessionInfo_t
     CATCPConnectionState_t state;       /**< current tcp session state */
     bool isClient;                      /**< Host Mode of Operation. */
     struct CATCPSessionInfo_t *next;    /**< Linked list; for multiple session list. */
+    struct CATCPSessionInfo_t *prev;    /**< Linked list; for multiple session list. */
+    CATCPSessionKey_t key;              /**< remote address and port, endpoint index key */
+    UT_hash_handle hhFd;                /**< session index by file descriptor */
+    UT_hash_handle hhEndpoint;          /**< session index by remote address and port */
+    struct CATCPSessionInfo_t *nextSameKey; /**< next session with the same endpoint index key */
 } CATCPSessionInfo_t;
 
 /**
@@ -29,9 +29,14 @@
 #include "cacommon.h"
 #include "caipinterface.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "ocrandom.h"
 #include "byte_array.h"
 #include "octhread.h"
+#include "ocatomic.h"
+#include "oic_time.h"
+#include "ocmetrics.h"
+#include "oic_hash.h"
 #include "timer.h"
 
 // headers required for mbed TLS
@@ -46,6 +51,12 @@
 #include "mbedtls/timing.h"
 #include "mbedtls/ssl_cookie.h"
 #endif
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+#include "mbedtls/ssl_ticket.h"
+#define SSL_SESSION_TICKETS
+#endif
+#include <coap/utlist.h>
+#include <coap/uthash.h>
 
 #if !defined(NDEBUG) || defined(TB_LOG)
 #include "mbedtls/debug.h"
@@ -119,6 +130,22 @@
  * @brief Identity max length
  */
 #define UUID_LENGTH (128/8)
+/**
+ * @def SSL_SESSION_CACHE_SIZE
+ * @brief Maximum number of sessions kept for resumption, separately for the client and
+ * the server role. The least recently used session is evicted first.
+ */
+#define SSL_SESSION_CACHE_SIZE (32)
+/**
+ * @def SSL_SESSION_LIFETIME
+ * @brief Lifetime in seconds of a cached session or a session ticket
+ */
+#define SSL_SESSION_LIFETIME (3600)
+/**
+ * @def SSL_PEER_SHARD_COUNT
+ * @brief Number of independently locked buckets of the peer table
+ */
+#define SSL_PEER_SHARD_COUNT (16)
 /**
  * @def MASTER_SECRET_LEN
  * @brief TLS master secret length
@@ -276,6 +303,14 @@ mbedtls_ecp_group_id curve[ADAPTER_CURVE_MAX][2] =
 
 static PkiInfo_t g_pkiInfo = {{NULL, 0}, {NULL, 0}, {NULL, 0}, {NULL, 0}};
 
+/**
+ * @var g_credVersion
+ *
+ * @brief Version of the credentials, bumped whenever the security resources or the
+ * credential callbacks change. Parsed credentials tagged with an older version are stale.
+ */
+static volatile int32_t g_credVersion = 1;
+
 typedef struct  {
     int code;
     int alert;
@@ -362,15 +397,58 @@ typedef struct TlsCallBacks
     CAPacketSendCallback sendCallback;      /**< Callback used to send data to socket layer. */
 } SslCallbacks_t;
 
+/**
+ * Session kept for resumption. Client sessions are looked up by the peer endpoint,
+ * server sessions by the session id the client presents.
+ */
+typedef struct SslSessionCacheEntry
+{
+    mbedtls_ssl_session session;        /**< Deep copy of the negotiated session. */
+    CAEndpoint_t endpoint;              /**< Peer the session was negotiated with. */
+    CARemoteId_t identity;              /**< Peer identity, restored on resumption. */
+    CARemoteId_t userId;                /**< Peer user id, restored on resumption. */
+    uint64_t created;                   /**< Creation time in seconds. */
+    struct SslSessionCacheEntry *prev;
+    struct SslSessionCacheEntry *next;
+} SslSessionCacheEntry_t;
+
+/**
+ * Bounded LRU list of sessions, most recently used first.
+ */
+typedef struct SslSessionCache
+{
+    SslSessionCacheEntry_t *head;
+    size_t count;
+} SslSessionCache_t;
+
+/**
+ * One bucket of the peer table.
+ *
+ * Locking rules for peers:
+ *  - adding or removing a peer takes g_sslContextMutex and then the shard mutex, so code
+ *    holding g_sslContextMutex may use peers found in the table without a reference;
+ *  - lookups without g_sslContextMutex take the shard mutex and a peer reference;
+ *  - the peer mutex guards the mbedTLS session. It is taken after g_sslContextMutex and
+ *    before the shard mutex, never the other way round.
+ * Established sessions are encrypted and decrypted holding only their peer mutex, so
+ * different peers are processed in parallel. Handshakes still run under g_sslContextMutex.
+ */
+typedef struct SslPeerShard
+{
+    oc_mutex mutex;
+    struct SslEndPoint *peers;       /**< peers hashed by adapter, address and port */
+} SslPeerShard_t;
+
 /**
  * Data structure for holding the mbedTLS interface related info.
  */
 typedef struct SslContext
 {
-    u_arraylist_t *peerList;         /**< peer list which holds the mapping between
-                                              peer id, it's n/w address and mbedTLS context. */
+    SslPeerShard_t peerShards[SSL_PEER_SHARD_COUNT]; /**< peer table which holds the mapping
+                                              between n/w address and mbedTLS context. */
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
+    oc_mutex rndMutex;                  /**< Serializes rnd, see SslRandom(). */
     mbedtls_x509_crt ca;
     mbedtls_x509_crt crt;
     mbedtls_pk_context pkey;
@@ -386,11 +464,22 @@ typedef struct SslContext
     bool cipherFlag[2];
     int selectedCipher;
 
+    int32_t cipherFlagVersion;          /**< Credential version cipherFlag was read for. */
+    int32_t pkixVersion;                /**< Credential version ca/crt/pkey/crl were parsed for. */
+    int32_t confVersion[4];             /**< Credential version each config was set up for. */
+
 #ifdef __WITH_DTLS__
     mbedtls_ssl_cookie_ctx cookieCtx;
     int timerId;
 #endif
 
+    SslSessionCache_t clientSessions;
+    SslSessionCache_t serverSessions;
+    CASslSessionCacheStats_t sessionStats;
+#ifdef SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_context ticketCtx;
+#endif
+
 } SslContext_t;
 
 /**
@@ -428,6 +517,94 @@ static oc_mutex g_sslContextMutex = NULL;
  */
 static CAErrorCallback g_sslCallback = NULL;
 
+/**
+ * @var g_sslFastPathEnabled
+ *
+ * @brief Non-zero while established sessions may be used without g_sslContextMutex
+ */
+static volatile int32_t g_sslFastPathEnabled = 0;
+
+/**
+ * @var g_sslFastPathUsers
+ *
+ * @brief Number of threads using a session without g_sslContextMutex. The context is
+ * not freed before they have left.
+ */
+static volatile int32_t g_sslFastPathUsers = 0;
+
+/**
+ * @var g_sslFastPathMutex
+ * @var g_sslFastPathCond
+ *
+ * @brief Signalled when the last thread leaves the fast path while it is disabled.
+ * Created once and kept, since a thread may leave after CAdeinitSslAdapter().
+ */
+static oc_mutex g_sslFastPathMutex = NULL;
+static oc_cond g_sslFastPathCond = NULL;
+
+/**
+ * Leaves the path entered by EnterSslFastPath().
+ */
+static void LeaveSslFastPath()
+{
+    if (0 == oc_atomic_decrement(&g_sslFastPathUsers) &&
+        0 == oc_atomic_load(&g_sslFastPathEnabled))
+    {
+        oc_mutex_lock(g_sslFastPathMutex);
+        oc_cond_broadcast(g_sslFastPathCond);
+        oc_mutex_unlock(g_sslFastPathMutex);
+    }
+}
+
+/**
+ * Enters the path that uses established sessions without g_sslContextMutex.
+ *
+ * @return  true if entered, false if the adapter is not initialized or shutting down
+ */
+static bool EnterSslFastPath()
+{
+    oc_atomic_increment(&g_sslFastPathUsers);
+    if (0 == oc_atomic_load(&g_sslFastPathEnabled))
+    {
+        LeaveSslFastPath();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Stops new threads from entering the fast path and waits for the current ones.
+ * Must not be called holding g_sslContextMutex, which they may need to leave.
+ */
+static void DisableSslFastPath()
+{
+    oc_atomic_store(&g_sslFastPathEnabled, 0);
+    oc_mutex_lock(g_sslFastPathMutex);
+    while (0 != oc_atomic_load(&g_sslFastPathUsers))
+    {
+        oc_cond_wait(g_sslFastPathCond, g_sslFastPathMutex);
+    }
+    oc_mutex_unlock(g_sslFastPathMutex);
+}
+
+/**
+ * mbedTLS random callback. Established sessions encrypt in parallel on the fast path,
+ * and mbedTLS is built without MBEDTLS_THREADING_C, so the shared CTR_DRBG is locked.
+ *
+ * @param[in]  ctx     the CTR_DRBG of g_caSslContext
+ * @param[out] output  buffer to fill
+ * @param[in]  len     length of the buffer
+ *
+ * @return 0 on success, or an mbedTLS error code
+ */
+static int SslRandom(void *ctx, unsigned char *output, size_t len)
+{
+    oc_mutex_lock(g_caSslContext->rndMutex);
+    int ret = mbedtls_ctr_drbg_random(ctx, output, len);
+    oc_mutex_unlock(g_caSslContext->rndMutex);
+    return ret;
+}
+
 /**
  * Data structure for holding the data to be received.
  */
@@ -437,6 +614,16 @@ typedef struct SslRecBuf
     size_t len;
     size_t loaded;
 } SslRecBuf_t;
+/**
+ * Peer table key. Zero filled before use since it is hashed as raw bytes.
+ */
+typedef struct SslPeerKey
+{
+    CATransportAdapter_t adapter;
+    uint16_t port;                      /**< 0 for BLE, where the port is not significant */
+    char addr[MAX_ADDR_STR_SIZE_CA];
+} SslPeerKey_t;
+
 /**
  * Data structure for holding the data related to endpoint
  * and TLS session.
@@ -445,20 +632,401 @@ typedef struct SslEndPoint
 {
     mbedtls_ssl_context ssl;
     CASecureEndpoint_t sep;
+    SslPeerKey_t key;                   /**< peer table key */
+    UT_hash_handle hh;                  /**< peer table link */
+    oc_mutex mutex;                     /**< guards the session, recursive */
+    volatile int32_t refCount;          /**< one for the table plus one per user */
     u_arraylist_t * cacheList;
     SslRecBuf_t recBuf;
     uint8_t master[MASTER_SECRET_LEN];
     uint8_t random[2*RANDOM_LEN];
+    bool resumed;
 #ifdef __WITH_DTLS__
     mbedtls_timing_delay_context timer;
 #endif // __WITH_DTLS__
 } SslEndPoint_t;
 
+/**
+ * Checks whether a session may be kept for resumption.
+ *
+ * Anonymous and PSK sessions are used for ownership transfer (Just Works and random PIN),
+ * their credentials are temporary and must not outlive the transfer.
+ *
+ * @param[in] ciphersuite  negotiated ciphersuite
+ *
+ * @return true if the session may be cached
+ */
+static bool IsSessionCacheable(int ciphersuite)
+{
+    return MBEDTLS_TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 != ciphersuite &&
+           MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != ciphersuite;
+}
+
+/**
+ * Makes a deep copy of a session, including the peer certificate and the ticket.
+ *
+ * @param[out] dst  destination, freed before copying
+ * @param[in]  src  source session
+ *
+ * @return 0 on success or -1 on error
+ */
+static int SslSessionCopy(mbedtls_ssl_session *dst, const mbedtls_ssl_session *src)
+{
+    mbedtls_ssl_session_free(dst);
+    memcpy(dst, src, sizeof(mbedtls_ssl_session));
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    dst->peer_cert = NULL;
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    dst->ticket = NULL;
+    dst->ticket_len = 0;
+#endif
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if (NULL != src->peer_cert)
+    {
+        dst->peer_cert = (mbedtls_x509_crt *)mbedtls_calloc(1, sizeof(mbedtls_x509_crt));
+        if (NULL == dst->peer_cert)
+        {
+            return -1;
+        }
+        mbedtls_x509_crt_init(dst->peer_cert);
+        if (0 != mbedtls_x509_crt_parse_der(dst->peer_cert, src->peer_cert->raw.p,
+                                            src->peer_cert->raw.len))
+        {
+            mbedtls_x509_crt_free(dst->peer_cert);
+            mbedtls_free(dst->peer_cert);
+            dst->peer_cert = NULL;
+            return -1;
+        }
+    }
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if (NULL != src->ticket)
+    {
+        dst->ticket = (unsigned char *)mbedtls_calloc(1, src->ticket_len);
+        if (NULL == dst->ticket)
+        {
+            return -1;
+        }
+        memcpy(dst->ticket, src->ticket, src->ticket_len);
+        dst->ticket_len = src->ticket_len;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Removes a session from the cache and frees it.
+ *
+ * @param[in] cache  session cache
+ * @param[in] entry  cached session
+ */
+static void SslSessionCacheRemove(SslSessionCache_t *cache, SslSessionCacheEntry_t *entry)
+{
+    DL_DELETE(cache->head, entry);
+    mbedtls_ssl_session_free(&entry->session);
+    OICFree(entry);
+    cache->count--;
+}
+
+/**
+ * Removes all sessions from the cache.
+ *
+ * @param[in] cache  session cache
+ */
+static void SslSessionCacheClear(SslSessionCache_t *cache)
+{
+    SslSessionCacheEntry_t *entry = NULL;
+    SslSessionCacheEntry_t *tmp = NULL;
+    DL_FOREACH_SAFE(cache->head, entry, tmp)
+    {
+        SslSessionCacheRemove(cache, entry);
+    }
+}
+
+/**
+ * Adds an empty session to the front of the cache, evicting the least recently used
+ * session when the cache is full.
+ *
+ * @param[in] cache  session cache
+ *
+ * @return new cache entry or NULL
+ */
+static SslSessionCacheEntry_t *SslSessionCacheInsert(SslSessionCache_t *cache)
+{
+    if (SSL_SESSION_CACHE_SIZE <= cache->count && NULL != cache->head)
+    {
+        // The list is doubly linked with head->prev pointing at the tail.
+        SslSessionCacheRemove(cache, cache->head->prev);
+        g_caSslContext->sessionStats.evictions++;
+    }
+
+    SslSessionCacheEntry_t *entry =
+        (SslSessionCacheEntry_t *)OICCalloc(1, sizeof(SslSessionCacheEntry_t));
+    if (NULL == entry)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session cache entry allocation failed");
+        return NULL;
+    }
+    mbedtls_ssl_session_init(&entry->session);
+    entry->created = OICGetCurrentTime(TIME_IN_MS) / 1000;
+    DL_PREPEND(cache->head, entry);
+    cache->count++;
+    return entry;
+}
+
+/**
+ * Moves a session to the front of the cache, or drops it if it has expired.
+ *
+ * @param[in] cache  session cache
+ * @param[in] entry  cached session
+ *
+ * @return entry, or NULL if it has expired
+ */
+static SslSessionCacheEntry_t *SslSessionCacheTouch(SslSessionCache_t *cache,
+                                                    SslSessionCacheEntry_t *entry)
+{
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS) / 1000;
+    if (now - entry->created > SSL_SESSION_LIFETIME)
+    {
+        SslSessionCacheRemove(cache, entry);
+        return NULL;
+    }
+    if (entry != cache->head)
+    {
+        DL_DELETE(cache->head, entry);
+        DL_PREPEND(cache->head, entry);
+    }
+    return entry;
+}
+
+/**
+ * Finds the client session negotiated with an endpoint.
+ *
+ * @param[in] endpoint  remote address
+ *
+ * @return cached session or NULL
+ */
+static SslSessionCacheEntry_t *GetClientSession(const CAEndpoint_t *endpoint)
+{
+    SslSessionCacheEntry_t *entry = NULL;
+    DL_FOREACH(g_caSslContext->clientSessions.head, entry)
+    {
+        if (entry->endpoint.port == endpoint->port &&
+            entry->endpoint.adapter == endpoint->adapter &&
+            0 == strncmp(entry->endpoint.addr, endpoint->addr, MAX_ADDR_STR_SIZE_CA))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Finds the server session with a given session id.
+ *
+ * @param[in] id     session id
+ * @param[in] idLen  session id length
+ *
+ * @return cached session or NULL
+ */
+static SslSessionCacheEntry_t *GetServerSession(const unsigned char *id, size_t idLen)
+{
+    SslSessionCacheEntry_t *entry = NULL;
+    if (0 == idLen)
+    {
+        return NULL;
+    }
+    DL_FOREACH(g_caSslContext->serverSessions.head, entry)
+    {
+        if (entry->session.id_len == idLen && 0 == memcmp(entry->session.id, id, idLen))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * mbedTLS server session cache lookup callback.
+ *
+ * @param[in]     data     session cache
+ * @param[in,out] session  session with the id and ciphersuite to resume, completed on success
+ *
+ * @return 0 if the session was found and may be resumed
+ */
+static int SslSessionCacheGet(void *data, mbedtls_ssl_session *session)
+{
+    SslSessionCache_t *cache = (SslSessionCache_t *)data;
+    SslSessionCacheEntry_t *entry = GetServerSession(session->id, session->id_len);
+    if (NULL == entry || NULL == SslSessionCacheTouch(cache, entry))
+    {
+        return 1;
+    }
+    if (entry->session.ciphersuite != session->ciphersuite ||
+        entry->session.compression != session->compression)
+    {
+        return 1;
+    }
+
+    memcpy(session->master, entry->session.master, sizeof(session->master));
+    session->verify_result = entry->session.verify_result;
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if (NULL != entry->session.peer_cert)
+    {
+        if (NULL != session->peer_cert)
+        {
+            mbedtls_x509_crt_free(session->peer_cert);
+            mbedtls_free(session->peer_cert);
+        }
+        session->peer_cert = (mbedtls_x509_crt *)mbedtls_calloc(1, sizeof(mbedtls_x509_crt));
+        if (NULL == session->peer_cert)
+        {
+            return 1;
+        }
+        mbedtls_x509_crt_init(session->peer_cert);
+        if (0 != mbedtls_x509_crt_parse_der(session->peer_cert, entry->session.peer_cert->raw.p,
+                                            entry->session.peer_cert->raw.len))
+        {
+            mbedtls_x509_crt_free(session->peer_cert);
+            mbedtls_free(session->peer_cert);
+            session->peer_cert = NULL;
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+/**
+ * mbedTLS server session cache store callback.
+ *
+ * @param[in] data     session cache
+ * @param[in] session  session negotiated by a full handshake
+ *
+ * @return 0 if the session was cached
+ */
+static int SslSessionCacheSet(void *data, const mbedtls_ssl_session *session)
+{
+    SslSessionCache_t *cache = (SslSessionCache_t *)data;
+    if (!IsSessionCacheable(session->ciphersuite))
+    {
+        return 1;
+    }
+
+    SslSessionCacheEntry_t *entry = GetServerSession(session->id, session->id_len);
+    if (NULL == entry)
+    {
+        entry = SslSessionCacheInsert(cache);
+        if (NULL == entry)
+        {
+            return 1;
+        }
+    }
+    if (0 != SslSessionCopy(&entry->session, session))
+    {
+        SslSessionCacheRemove(cache, entry);
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef SSL_SESSION_TICKETS
+/**
+ * mbedTLS ticket write callback refusing sessions that must not be resumed.
+ */
+static int SslTicketWrite(void *ticket, const mbedtls_ssl_session *session,
+                          unsigned char *start, const unsigned char *end,
+                          size_t *tlen, uint32_t *lifetime)
+{
+    if (!IsSessionCacheable(session->ciphersuite))
+    {
+        // mbedTLS sends an empty ticket, the client falls back to a full handshake.
+        return -1;
+    }
+    return mbedtls_ssl_ticket_write(ticket, session, start, end, tlen, lifetime);
+}
+#endif
+
+/**
+ * Updates the session cache after a completed handshake. A full client handshake stores
+ * the new session, a full handshake in either role remembers the peer identity, and a
+ * resumed handshake restores it since no credential callback ran.
+ *
+ * @param[in] peer  remote peer with a completed handshake
+ */
+static void UpdateSessionCache(SslEndPoint_t *peer)
+{
+    CASslSessionCacheStats_t *stats = &g_caSslContext->sessionStats;
+    if (peer->resumed)
+    {
+        stats->hits++;
+    }
+    else
+    {
+        stats->misses++;
+    }
+
+    if (NULL == peer->ssl.session || !IsSessionCacheable(peer->ssl.session->ciphersuite))
+    {
+        return;
+    }
+
+    SslSessionCacheEntry_t *entry = NULL;
+    if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
+    {
+        entry = GetClientSession(&peer->sep.endpoint);
+        if (!peer->resumed)
+        {
+            if (NULL == entry)
+            {
+                entry = SslSessionCacheInsert(&g_caSslContext->clientSessions);
+            }
+            if (NULL != entry && 0 != SslSessionCopy(&entry->session, peer->ssl.session))
+            {
+                SslSessionCacheRemove(&g_caSslContext->clientSessions, entry);
+                entry = NULL;
+            }
+        }
+    }
+    else
+    {
+        // Sessions resumed from a ticket have no entry, their identity comes from the
+        // certificate.
+        entry = GetServerSession(peer->ssl.session->id, peer->ssl.session->id_len);
+    }
+
+    if (NULL == entry)
+    {
+        return;
+    }
+    if (peer->resumed)
+    {
+        if (0 == peer->sep.identity.id_length)
+        {
+            peer->sep.identity = entry->identity;
+        }
+        if (0 == peer->sep.userId.id_length)
+        {
+            peer->sep.userId = entry->userId;
+        }
+    }
+    else
+    {
+        entry->endpoint = peer->sep.endpoint;
+        entry->identity = peer->sep.identity;
+        entry->userId = peer->sep.userId;
+    }
+}
+
 void CAsetPskCredentialsCallback(CAgetPskCredentialsHandler credCallback)
 {
     // TODO Does this method needs protection of tlsContextMutex?
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     g_getCredentialsCallback = credCallback;
+    oc_atomic_increment(&g_credVersion);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
@@ -466,12 +1034,42 @@ void CAsetPkixInfoCallback(CAgetPkixInfoHandler infoCallback)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     g_getPkixInfoCallback = infoCallback;
+    oc_atomic_increment(&g_credVersion);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 void CAsetCredentialTypesCallback(CAgetCredentialTypesHandler credTypesCallback)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     g_getCredentialTypesCallback = credTypesCallback;
+    oc_atomic_increment(&g_credVersion);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
+void CAinvalidateSslCredentials(void)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    oc_atomic_increment(&g_credVersion);
+
+    // Cached sessions were authenticated with the old credentials.
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL != g_caSslContext)
+    {
+        SslSessionCacheClear(&g_caSslContext->clientSessions);
+        SslSessionCacheClear(&g_caSslContext->serverSessions);
+#ifdef SSL_SESSION_TICKETS
+        // Tickets already issued can only be refused by changing the ticket key.
+        mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+        mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+        if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, SslRandom,
+                                          &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                          SSL_SESSION_LIFETIME))
+        {
+            OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+        }
+#endif
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
@@ -677,8 +1275,26 @@ exit:
     return -1;
 }
 
+/**
+ * Drops the own certificates configured so far. mbedtls_ssl_conf_own_cert() appends to
+ * the list, so it has to be emptied before the reparsed certificate is configured again.
+ *
+ * @param[in,out]  conf  client/server config
+ */
+static void ResetOwnCert(mbedtls_ssl_config * conf)
+{
+    mbedtls_ssl_key_cert *cur = conf->key_cert;
+    while (NULL != cur)
+    {
+        mbedtls_ssl_key_cert *next = cur->next;
+        mbedtls_free(cur);
+        cur = next;
+    }
+    conf->key_cert = NULL;
+}
+
 //Loads PKIX related information from SRM
-static int InitPKIX(CATransportAdapter_t adapter)
+static int InitPKIX(void)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
@@ -690,6 +1306,22 @@ static int InitPKIX(CATransportAdapter_t adapter)
 
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
 
+    mbedtls_ssl_config * confs[] = {
+#ifdef __WITH_TLS__
+        &g_caSslContext->clientTlsConf,
+        &g_caSslContext->serverTlsConf,
+#endif
+#ifdef __WITH_DTLS__
+        &g_caSslContext->clientDtlsConf,
+        &g_caSslContext->serverDtlsConf,
+#endif
+    };
+    const size_t confCount = sizeof(confs) / sizeof(confs[0]);
+    for (size_t i = 0; i < confCount; i++)
+    {
+        ResetOwnCert(confs[i]);
+    }
+
     mbedtls_x509_crt_free(&g_caSslContext->ca);
     mbedtls_x509_crt_free(&g_caSslContext->crt);
     mbedtls_pk_free(&g_caSslContext->pkey);
@@ -700,12 +1332,6 @@ static int InitPKIX(CATransportAdapter_t adapter)
     mbedtls_pk_init(&g_caSslContext->pkey);
     mbedtls_x509_crl_init(&g_caSslContext->crl);
 
-    mbedtls_ssl_config * serverConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
-    mbedtls_ssl_config * clientConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->clientDtlsConf : &g_caSslContext->clientTlsConf);
     // optional
     int ret;
     int errNum;
@@ -728,17 +1354,14 @@ static int InitPKIX(CATransportAdapter_t adapter)
         goto required;
     }
 
-    ret = mbedtls_ssl_conf_own_cert(serverConf, &g_caSslContext->crt, &g_caSslContext->pkey);
-    if (0 != ret)
-    {
-        OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate parsing error");
-        goto required;
-    }
-    ret = mbedtls_ssl_conf_own_cert(clientConf, &g_caSslContext->crt, &g_caSslContext->pkey);
-    if(0 != ret)
+    for (size_t i = 0; i < confCount; i++)
     {
-        OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate configuration error");
-        goto required;
+        ret = mbedtls_ssl_conf_own_cert(confs[i], &g_caSslContext->crt, &g_caSslContext->pkey);
+        if (0 != ret)
+        {
+            OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate configuration error");
+            goto required;
+        }
     }
 
     required:
@@ -755,15 +1378,14 @@ static int InitPKIX(CATransportAdapter_t adapter)
     }
 
     ret = mbedtls_x509_crl_parse_der(&g_caSslContext->crl, g_pkiInfo.crl.data, g_pkiInfo.crl.len);
-    if(0 != ret)
+    for (size_t i = 0; i < confCount; i++)
     {
-        OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca, NULL);
+        mbedtls_ssl_conf_ca_chain(confs[i], &g_caSslContext->ca,
+                                  0 == ret ? &g_caSslContext->crl : NULL);
     }
-    else
+    if(0 != ret)
     {
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain,
-                 &g_caSslContext->ca, &g_caSslContext->crl);
+        OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
     }
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
@@ -808,6 +1430,141 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
     OIC_LOG_V(WARNING, NET_SSL_TAG, "Out %s", __func__);
     return -1;
 }
+
+static void DeleteSslEndPoint(SslEndPoint_t * tep);
+
+/**
+ * Drops a reference to a peer, deleting it with the last one.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void DropSslPeerRef(SslEndPoint_t * tep)
+{
+    if (0 == oc_atomic_decrement(&tep->refCount))
+    {
+        DeleteSslEndPoint(tep);
+    }
+}
+
+/**
+ * Takes a reference to a peer and locks its session. The peer stays valid until
+ * UnlockSslPeer(), even if it is removed from the table meanwhile.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void LockSslPeer(SslEndPoint_t * tep)
+{
+    oc_atomic_increment(&tep->refCount);
+    oc_mutex_lock(tep->mutex);
+}
+
+/**
+ * Unlocks the session of a peer and drops the reference taken by LockSslPeer() or
+ * AcquireSslPeer().
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void UnlockSslPeer(SslEndPoint_t * tep)
+{
+    oc_mutex_unlock(tep->mutex);
+    DropSslPeerRef(tep);
+}
+
+/**
+ * Builds the peer table key of an endpoint.
+ *
+ * @param[out] key         peer table key
+ * @param[in]  endpoint    remote address
+ */
+static void InitSslPeerKey(SslPeerKey_t * key, const CAEndpoint_t * endpoint)
+{
+    memset(key, 0, sizeof(*key));
+    key->adapter = endpoint->adapter;
+    key->port = (CA_ADAPTER_GATT_BTLE == endpoint->adapter) ? 0 : endpoint->port;
+    OICStrcpy(key->addr, sizeof(key->addr), endpoint->addr);
+}
+
+/**
+ * Gets the peer table shard of a key (FNV-1a over the key bytes).
+ *
+ * @param[in]  key    peer table key
+ *
+ * @return  shard holding the key
+ */
+static SslPeerShard_t * GetSslPeerShard(const SslPeerKey_t * key)
+{
+    uint32_t hash = OICHashBytes(OIC_HASH_INIT, key, sizeof(*key));
+    return &g_caSslContext->peerShards[hash % SSL_PEER_SHARD_COUNT];
+}
+
+/**
+ * Creates the peer table.
+ *
+ * @return  true on success
+ */
+static bool InitPeerTable()
+{
+    for (size_t i = 0; i < SSL_PEER_SHARD_COUNT; i++)
+    {
+        g_caSslContext->peerShards[i].peers = NULL;
+        g_caSslContext->peerShards[i].mutex = oc_mutex_new();
+        if (NULL == g_caSslContext->peerShards[i].mutex)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                oc_mutex_free(g_caSslContext->peerShards[j].mutex);
+                g_caSslContext->peerShards[j].mutex = NULL;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Adds a peer to the table, which takes over the initial reference.
+ * The caller holds g_sslContextMutex.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void AddSslPeer(SslEndPoint_t * tep)
+{
+    SslPeerShard_t *shard = GetSslPeerShard(&tep->key);
+    oc_mutex_lock(shard->mutex);
+    HASH_ADD(hh, shard->peers, key, sizeof(tep->key), tep);
+    oc_mutex_unlock(shard->mutex);
+}
+
+/**
+ * Finds a peer without holding g_sslContextMutex. On success the peer is referenced
+ * and locked, release it with UnlockSslPeer().
+ *
+ * @param[in]  endpoint    remote address
+ *
+ * @return  locked TLS session or NULL
+ */
+static SslEndPoint_t * AcquireSslPeer(const CAEndpoint_t * endpoint)
+{
+    SslPeerKey_t key;
+    SslEndPoint_t *tep = NULL;
+    InitSslPeerKey(&key, endpoint);
+
+    SslPeerShard_t *shard = GetSslPeerShard(&key);
+    oc_mutex_lock(shard->mutex);
+    HASH_FIND(hh, shard->peers, &key, sizeof(key), tep);
+    if (NULL != tep)
+    {
+        oc_atomic_increment(&tep->refCount);
+    }
+    oc_mutex_unlock(shard->mutex);
+
+    if (NULL != tep)
+    {
+        oc_mutex_lock(tep->mutex);
+    }
+    return tep;
+}
+
 /**
  * Gets session corresponding for endpoint.
  *
@@ -817,37 +1574,26 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(peer, NET_SSL_TAG, "TLS peer is NULL", NULL);
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
 
+    // The caller holds g_sslContextMutex, so the peer cannot be removed meanwhile.
+    SslPeerKey_t key;
     SslEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
-    {
-        tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
+    InitSslPeerKey(&key, peer);
 
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Compare [%s:%d] and [%s:%d] for %d adapter",
-                  peer->addr, peer->port, tep->sep.endpoint.addr, tep->sep.endpoint.port,
-                  peer->adapter);
+    SslPeerShard_t *shard = GetSslPeerShard(&key);
+    oc_mutex_lock(shard->mutex);
+    HASH_FIND(hh, shard->peers, &key, sizeof(key), tep);
+    oc_mutex_unlock(shard->mutex);
 
-        if((peer->adapter == tep->sep.endpoint.adapter)
-                && (0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port || CA_ADAPTER_GATT_BTLE == peer->adapter))
-        {
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            return tep;
-        }
+    if (NULL == tep)
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
     }
-    OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return NULL;
+    return tep;
 }
 
 #ifdef MULTIPLE_OWNER
@@ -1024,9 +1770,11 @@ static void DeleteSslEndPoint(SslEndPoint_t * tep)
 
     mbedtls_ssl_free(&tep->ssl);
     DeleteCacheList(tep->cacheList);
+    oc_mutex_free(tep->mutex);
     OICFree(tep);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
+
 /**
  * Removes endpoint session from list.
  *
@@ -1036,24 +1784,43 @@ static void RemovePeerFromList(CAEndpoint_t * endpoint)
 {
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
     VERIFY_NON_NULL_VOID(endpoint, NET_SSL_TAG, "endpoint");
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+
+    SslPeerKey_t key;
+    SslEndPoint_t *tep = NULL;
+    InitSslPeerKey(&key, endpoint);
+
+    SslPeerShard_t *shard = GetSslPeerShard(&key);
+    oc_mutex_lock(shard->mutex);
+    HASH_FIND(hh, shard->peers, &key, sizeof(key), tep);
+    if (NULL != tep)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-        if(0 == strncmp(endpoint->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA)
-                && (endpoint->port == tep->sep.endpoint.port))
-        {
-            u_arraylist_remove(g_caSslContext->peerList, listIndex);
-            DeleteSslEndPoint(tep);
-            return;
-        }
+        HASH_DELETE(hh, shard->peers, tep);
+    }
+    oc_mutex_unlock(shard->mutex);
+
+    if (NULL != tep)
+    {
+        // Peers still in use by another thread are deleted when it lets them go.
+        DropSslPeerRef(tep);
     }
 }
 
+/**
+ * Removes a peer from the table unless it has been replaced meanwhile. Used by threads
+ * that do not hold g_sslContextMutex; the caller holds a reference, not the peer mutex.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void RemoveSslPeer(SslEndPoint_t * tep)
+{
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL != g_caSslContext && tep == GetSslPeer(&tep->sep.endpoint))
+    {
+        RemovePeerFromList(&tep->sep.endpoint);
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+}
+
  /**
   * Checks handshake result. Removes peer from list and sends alert
   * if handshake failed.
@@ -1118,31 +1885,69 @@ static void DeletePeerList()
 {
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    for (size_t i = 0; i < SSL_PEER_SHARD_COUNT; i++)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
+        SslPeerShard_t *shard = &g_caSslContext->peerShards[i];
+        SslEndPoint_t *tep = NULL;
+        SslEndPoint_t *tmp = NULL;
+        HASH_ITER(hh, shard->peers, tep, tmp)
         {
-            continue;
+            LockSslPeer(tep);
+            if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+            {
+                int ret = 0;
+                do
+                {
+                    ret = mbedtls_ssl_close_notify(&tep->ssl);
+                }
+                while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
+            }
+            oc_mutex_lock(shard->mutex);
+            HASH_DELETE(hh, shard->peers, tep);
+            oc_mutex_unlock(shard->mutex);
+            DropSslPeerRef(tep);
+            UnlockSslPeer(tep);
         }
-        if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+        oc_mutex_free(shard->mutex);
+        shard->mutex = NULL;
+    }
+}
+
+/**
+ * Removes the client and server sessions cached for a peer.
+ * Must be called with g_sslContextMutex held.
+ *
+ * @param[in] endpoint  remote address
+ */
+static void RemoveCachedSessions(const CAEndpoint_t *endpoint)
+{
+    SslSessionCache_t *caches[] = { &g_caSslContext->clientSessions,
+                                    &g_caSslContext->serverSessions };
+    for (size_t i = 0; i < sizeof(caches) / sizeof(caches[0]); i++)
+    {
+        SslSessionCacheEntry_t *entry = NULL;
+        SslSessionCacheEntry_t *tmp = NULL;
+        DL_FOREACH_SAFE(caches[i]->head, entry, tmp)
         {
-            int ret = 0;
-            do
+            if (entry->endpoint.port == endpoint->port &&
+                0 == strncmp(entry->endpoint.addr, endpoint->addr, MAX_ADDR_STR_SIZE_CA))
             {
-                ret = mbedtls_ssl_close_notify(&tep->ssl);
+                SslSessionCacheRemove(caches[i], entry);
             }
-            while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
         }
-        DeleteSslEndPoint(tep);
     }
-    u_arraylist_free(&g_caSslContext->peerList);
 }
 
-CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
+/**
+ * Closes the connection with a peer.
+ *
+ * @param[in] endpoint  remote address
+ * @param[in] removeCachedSessions  true to also forget the sessions cached for resumption
+ *
+ * @return  ::CA_STATUS_OK or Appropriate error code
+ */
+static CAResult_t CloseSslConnection(const CAEndpoint_t *endpoint, bool removeCachedSessions)
 {
-    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(endpoint, NET_SSL_TAG, "Param endpoint is NULL" , CA_STATUS_INVALID_PARAM);
 
     oc_mutex_lock(g_sslContextMutex);
@@ -1161,67 +1966,114 @@ CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
     }
     /* No error checking, the connection might be closed already */
     int ret = 0;
+    LockSslPeer(tep);
     do
     {
         ret = mbedtls_ssl_close_notify(&tep->ssl);
     }
     while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
 
+    if (removeCachedSessions)
+    {
+        RemoveCachedSessions(&tep->sep.endpoint);
+    }
     RemovePeerFromList(&tep->sep.endpoint);
+    UnlockSslPeer(tep);
+    oc_mutex_unlock(g_sslContextMutex);
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+
+    // Transports close the connection on disconnect; the cached sessions are kept so the
+    // next connection with the peer is resumed.
+    CAResult_t res = CloseSslConnection(endpoint, false);
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return res;
+}
+
+CAResult_t CAendSslSession(const CAEndpoint_t *endpoint)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+
+    // An ended session is not resumed, the next connection authenticates again.
+    CAResult_t res = CloseSslConnection(endpoint, true);
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return res;
+}
+
+void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL == g_caSslContext)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Context is NULL");
+        oc_mutex_unlock(g_sslContextMutex);
+        return;
+    }
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Required transport [%d]", transportType);
+    for (size_t i = 0; i < SSL_PEER_SHARD_COUNT; i++)
+    {
+        SslPeerShard_t *shard = &g_caSslContext->peerShards[i];
+        SslEndPoint_t *tep = NULL;
+        SslEndPoint_t *tmp = NULL;
+        HASH_ITER(hh, shard->peers, tep, tmp)
+        {
+            OIC_LOG_V(DEBUG, NET_SSL_TAG, "SSL Connection [%s:%d], Transport [%d]",
+                      tep->sep.endpoint.addr, tep->sep.endpoint.port, tep->sep.endpoint.adapter);
+
+            // check transport matching
+            if (0 == (tep->sep.endpoint.adapter & transportType))
+            {
+                OIC_LOG(DEBUG, NET_SSL_TAG, "Skip the un-matched transport session");
+                continue;
+            }
+
+            // TODO: need to check below code after socket close is ensured.
+            /*int ret = 0;
+            do
+            {
+                ret = mbedtls_ssl_close_notify(&tep->ssl);
+            }
+            while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);*/
+
+            // delete from table
+            oc_mutex_lock(shard->mutex);
+            HASH_DELETE(hh, shard->peers, tep);
+            oc_mutex_unlock(shard->mutex);
+            DropSslPeerRef(tep);
+        }
+    }
     oc_mutex_unlock(g_sslContextMutex);
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return CA_STATUS_OK;
+    return;
 }
 
-void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
+CAResult_t CAgetSslSessionCacheStats(CASslSessionCacheStats_t *stats)
 {
-    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(stats, NET_SSL_TAG, "Param stats is NULL", CA_STATUS_INVALID_PARAM);
+
     oc_mutex_lock(g_sslContextMutex);
     if (NULL == g_caSslContext)
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "Context is NULL");
         oc_mutex_unlock(g_sslContextMutex);
-        return;
-    }
-
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    OIC_LOG_V(DEBUG, NET_SSL_TAG,
-            "Required transport [%d], peer count [%" PRIuPTR "]", transportType, listLength);
-    for (size_t i = listLength; i > 0; i--)
-    {
-        SslEndPoint_t *tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, i - 1);
-        if (NULL == tep)
-        {
-            continue;
-        }
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "SSL Connection [%s:%d], Transport [%d]",
-                  tep->sep.endpoint.addr, tep->sep.endpoint.port, tep->sep.endpoint.adapter);
-
-        // check transport matching
-        if (0 == (tep->sep.endpoint.adapter & transportType))
-        {
-            OIC_LOG(DEBUG, NET_SSL_TAG, "Skip the un-matched transport session");
-            continue;
-        }
-
-        // TODO: need to check below code after socket close is ensured.
-        /*int ret = 0;
-        do
-        {
-            ret = mbedtls_ssl_close_notify(&tep->ssl);
-        }
-        while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);*/
-
-        // delete from list
-        u_arraylist_remove(g_caSslContext->peerList, i - 1);
-        DeleteSslEndPoint(tep);
+        return CA_STATUS_FAILED;
     }
+    *stats = g_caSslContext->sessionStats;
+    stats->entries = (uint32_t)(g_caSslContext->clientSessions.count +
+                                g_caSslContext->serverSessions.count);
     oc_mutex_unlock(g_sslContextMutex);
-
-    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return;
+    return CA_STATUS_OK;
 }
+
 /**
  * Creates session for endpoint.
  *
@@ -1247,10 +2099,22 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
 
     tep->sep.endpoint = *endpoint;
     tep->sep.endpoint.flags = (CATransportFlags_t)(tep->sep.endpoint.flags | CA_SECURE);
+    InitSslPeerKey(&tep->key, endpoint);
+    tep->refCount = 1;
+
+    // Recursive, checkSslOperation() may remove a peer whose session is locked.
+    tep->mutex = oc_mutex_new_recursive();
+    if (NULL == tep->mutex)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Mutex creation failed!");
+        OICFree(tep);
+        return NULL;
+    }
 
     if(0 != mbedtls_ssl_setup(&tep->ssl, config))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "Setup failed");
+        oc_mutex_free(tep->mutex);
         OICFree(tep);
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
         return NULL;
@@ -1268,6 +2132,7 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
             {
                 OIC_LOG(ERROR, NET_SSL_TAG, "Transport id setup failed!");
                 mbedtls_ssl_free(&tep->ssl);
+                oc_mutex_free(tep->mutex);
                 OICFree(tep);
                 OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
                 return NULL;
@@ -1279,6 +2144,7 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "cacheList initialization failed!");
         mbedtls_ssl_free(&tep->ssl);
+        oc_mutex_free(tep->mutex);
         OICFree(tep);
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
         return NULL;
@@ -1317,7 +2183,30 @@ static int InitPskIdentity(mbedtls_ssl_config * config)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return 0;
 }
-static void SetupCipher(mbedtls_ssl_config * config, CATransportAdapter_t adapter)
+/**
+ * Gets the credential version a config was last set up for.
+ *
+ * @param[in]  config  client/server config
+ *
+ * @return  pointer to the version or NULL for an unknown config
+ */
+static int32_t * GetConfigVersion(const mbedtls_ssl_config * config)
+{
+    const mbedtls_ssl_config * confs[] = { &g_caSslContext->clientTlsConf,
+                                           &g_caSslContext->serverTlsConf,
+                                           &g_caSslContext->clientDtlsConf,
+                                           &g_caSslContext->serverDtlsConf };
+    for (size_t i = 0; i < sizeof(confs) / sizeof(confs[0]); i++)
+    {
+        if (confs[i] == config)
+        {
+            return &g_caSslContext->confVersion[i];
+        }
+    }
+    return NULL;
+}
+
+static void SetupCipher(mbedtls_ssl_config * config)
 {
     int index = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
@@ -1326,17 +2215,27 @@ static void SetupCipher(mbedtls_ssl_config * config, CATransportAdapter_t adapte
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
     VERIFY_NON_NULL_VOID(g_getCredentialTypesCallback, NET_SSL_TAG, "Param callback is null");
 
-    //Resetting cipherFlag
-    g_caSslContext->cipherFlag[0] = false;
-    g_caSslContext->cipherFlag[1] = false;
-
-    if (NULL == g_getCredentialTypesCallback)
+    // Credentials parsed for the current version are reused, so a handshake only walks
+    // the credential store after the security resources have changed.
+    int32_t credVersion = oc_atomic_load(&g_credVersion);
+    int32_t *confVersion = GetConfigVersion(config);
+    if (NULL != confVersion && credVersion == *confVersion)
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "Param callback is null");
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Config is up to date");
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
         return;
     }
 
-    g_getCredentialTypesCallback(g_caSslContext->cipherFlag);
+    if (credVersion != g_caSslContext->cipherFlagVersion)
+    {
+        //Resetting cipherFlag
+        g_caSslContext->cipherFlag[0] = false;
+        g_caSslContext->cipherFlag[1] = false;
+
+        g_getCredentialTypesCallback(g_caSslContext->cipherFlag);
+        g_caSslContext->cipherFlagVersion = credVersion;
+    }
+
     // Retrieve the PSK credential from SRM
     if (0 != InitPskIdentity(config))
     {
@@ -1344,13 +2243,15 @@ static void SetupCipher(mbedtls_ssl_config * config, CATransportAdapter_t adapte
     }
 
     // Retrieve the Cert credential from SRM
-    if (true == g_caSslContext->cipherFlag[1])
+    if (true == g_caSslContext->cipherFlag[1] && credVersion != g_caSslContext->pkixVersion)
     {
-        int ret = InitPKIX(adapter);
+        int ret = InitPKIX();
         if (0 != ret)
         {
             OIC_LOG(ERROR, NET_SSL_TAG, "Failed to init X.509");
         }
+        // Parsing again gives the same result until the credentials change.
+        g_caSslContext->pkixVersion = credVersion;
     }
 
     memset(g_cipherSuitesList, 0, sizeof(g_cipherSuitesList));
@@ -1393,6 +2294,10 @@ static void SetupCipher(mbedtls_ssl_config * config, CATransportAdapter_t adapte
     }
 
     mbedtls_ssl_conf_ciphersuites(config, g_cipherSuitesList);
+    if (NULL != confVersion)
+    {
+        *confVersion = credVersion;
+    }
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
@@ -1423,16 +2328,25 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
     }
 
     //Load allowed SVR suites from SVR DB
-    SetupCipher(config, endpoint->adapter);
+    SetupCipher(config);
 
-    ret = u_arraylist_add(g_caSslContext->peerList, (void *) tep);
-    if (!ret)
+    // Offer the last session negotiated with this peer, the server falls back to a full
+    // handshake if it no longer knows it.
+    SslSessionCacheEntry_t *cached = GetClientSession(endpoint);
+    if (NULL != cached &&
+        NULL != SslSessionCacheTouch(&g_caSslContext->clientSessions, cached))
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
-        DeleteSslEndPoint(tep);
-        return NULL;
+        ret = mbedtls_ssl_set_session(&tep->ssl, &cached->session);
+        if (0 != ret)
+        {
+            OIC_LOG_V(WARNING, NET_SSL_TAG, "Failed to set cached session: -0x%x", -ret);
+        }
     }
 
+    AddSslPeer(tep);
+    LockSslPeer(tep);
+    OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_STARTED, 1);
+
     while (MBEDTLS_SSL_HANDSHAKE_OVER > tep->ssl.state)
     {
         ret = mbedtls_ssl_handshake_step(&tep->ssl);
@@ -1443,7 +2357,9 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
         else if (-1 == ret)
         {
             OIC_LOG(ERROR, NET_SSL_TAG, "Handshake failed due to socket error");
+            OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_FAILED, 1);
             RemovePeerFromList(&tep->sep.endpoint);
+            UnlockSslPeer(tep);
             return NULL;
         }
         if (!checkSslOperation(tep,
@@ -1452,10 +2368,12 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
                                MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE))
         {
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            DeleteSslEndPoint(tep);
+            OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_FAILED, 1);
+            UnlockSslPeer(tep);
             return NULL;
         }
     }
+    UnlockSslPeer(tep);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return tep;
 }
@@ -1479,11 +2397,19 @@ void CAdeinitSslAdapter()
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "context is NULL");
     VERIFY_NON_NULL_VOID(g_sslContextMutex, NET_SSL_TAG, "context mutex is NULL");
 
+    // Wait for the threads using sessions without the context mutex
+    DisableSslFastPath();
+
     //Lock tlsContext mutex
     oc_mutex_lock(g_sslContextMutex);
 
     // Clear all lists
     DeletePeerList();
+    SslSessionCacheClear(&g_caSslContext->clientSessions);
+    SslSessionCacheClear(&g_caSslContext->serverSessions);
+#ifdef SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+#endif
 
     // De-initialize mbedTLS
     mbedtls_x509_crt_free(&g_caSslContext->crt);
@@ -1499,6 +2425,10 @@ void CAdeinitSslAdapter()
 #endif // __WITH_DTLS__
     mbedtls_ctr_drbg_free(&g_caSslContext->rnd);
     mbedtls_entropy_free(&g_caSslContext->entropy);
+    if (g_caSslContext->rndMutex)
+    {
+        oc_mutex_free(g_caSslContext->rndMutex);
+    }
 #ifdef __WITH_DTLS__
     StopRetransmit();
 #endif
@@ -1531,7 +2461,7 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
      * time, see extlibs/mbedtls/config-iotivity.h
      */
     mbedtls_ssl_conf_psk_cb(conf, GetPskCredentialsCallback, NULL);
-    mbedtls_ssl_conf_rng(conf, mbedtls_ctr_drbg_random, &g_caSslContext->rnd);
+    mbedtls_ssl_conf_rng(conf, SslRandom, &g_caSslContext->rnd);
     mbedtls_ssl_conf_curves(conf, curve[ADAPTER_CURVE_SECP256R1]);
     mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
 
@@ -1544,6 +2474,16 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
     }
 #endif // __WITH_DTLS__
 
+    if (MBEDTLS_SSL_IS_SERVER == mode)
+    {
+        mbedtls_ssl_conf_session_cache(conf, &g_caSslContext->serverSessions,
+                                       SslSessionCacheGet, SslSessionCacheSet);
+#ifdef SSL_SESSION_TICKETS
+        mbedtls_ssl_conf_session_tickets_cb(conf, SslTicketWrite, mbedtls_ssl_ticket_parse,
+                                            &g_caSslContext->ticketCtx);
+#endif
+    }
+
     /* Set TLS 1.2 as the minimum allowed version. */
     mbedtls_ssl_conf_min_version(conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
 
@@ -1562,8 +2502,6 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
  */
 static void StartRetransmit()
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     SslEndPoint_t *tep = NULL;
 
     oc_mutex_lock(g_sslContextMutex);
@@ -1579,31 +2517,36 @@ static void StartRetransmit()
         //clear previous timer
         unregisterTimer(g_caSslContext->timerId);
 
-        listLength = u_arraylist_length(g_caSslContext->peerList);
-        for (listIndex = 0; listIndex < listLength; listIndex++)
+        for (size_t i = 0; i < SSL_PEER_SHARD_COUNT; i++)
         {
-            tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-            if (NULL == tep
-                || (tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
-                || MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+            SslEndPoint_t *tmp = NULL;
+            HASH_ITER(hh, g_caSslContext->peerShards[i].peers, tep, tmp)
             {
-                continue;
-            }
-            int ret = mbedtls_ssl_handshake_step(&tep->ssl);
+                LockSslPeer(tep);
+                if ((tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
+                    || MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+                {
+                    UnlockSslPeer(tep);
+                    continue;
+                }
+                int ret = mbedtls_ssl_handshake_step(&tep->ssl);
 
-            if (MBEDTLS_ERR_SSL_CONN_EOF != ret)
-            {
-                //start new timer
-                registerTimer(RETRANSMISSION_TIME, &g_caSslContext->timerId, StartRetransmit);
-                //unlock & return
-                if (!checkSslOperation(tep,
-                                       ret,
-                                       "Retransmission",
-                                       MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE))
+                if (MBEDTLS_ERR_SSL_CONN_EOF != ret)
                 {
-                    oc_mutex_unlock(g_sslContextMutex);
-                    return;
+                    //start new timer
+                    registerTimer(RETRANSMISSION_TIME, &g_caSslContext->timerId, StartRetransmit);
+                    //unlock & return
+                    if (!checkSslOperation(tep,
+                                           ret,
+                                           "Retransmission",
+                                           MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE))
+                    {
+                        UnlockSslPeer(tep);
+                        oc_mutex_unlock(g_sslContextMutex);
+                        return;
+                    }
                 }
+                UnlockSslPeer(tep);
             }
         }
     }
@@ -1627,6 +2570,28 @@ CAResult_t CAinitSslAdapter()
         OIC_LOG(INFO, NET_SSL_TAG, "Done already!");
         return CA_STATUS_OK;
     }
+    if (NULL == g_sslFastPathMutex)
+    {
+        g_sslFastPathMutex = oc_mutex_new();
+        g_sslFastPathCond = oc_cond_new();
+        if (NULL == g_sslFastPathMutex || NULL == g_sslFastPathCond)
+        {
+            OIC_LOG(ERROR, NET_SSL_TAG, "Fast path mutex allocation failed");
+            if (g_sslFastPathMutex)
+            {
+                oc_mutex_free(g_sslFastPathMutex);
+                g_sslFastPathMutex = NULL;
+            }
+            if (g_sslFastPathCond)
+            {
+                oc_cond_free(g_sslFastPathCond);
+                g_sslFastPathCond = NULL;
+            }
+            oc_mutex_free(g_sslContextMutex);
+            g_sslContextMutex = NULL;
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+    }
 
     // Lock tlsContext mutex and create tlsContext
     oc_mutex_lock(g_sslContextMutex);
@@ -1641,12 +2606,10 @@ CAResult_t CAinitSslAdapter()
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // Create peer list
-    g_caSslContext->peerList = u_arraylist_create();
-
-    if(NULL == g_caSslContext->peerList)
+    // Create peer table
+    if (!InitPeerTable())
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "peerList initialization failed!");
+        OIC_LOG(ERROR, NET_SSL_TAG, "peer table initialization failed!");
         OICFree(g_caSslContext);
         g_caSslContext = NULL;
         oc_mutex_unlock(g_sslContextMutex);
@@ -1671,6 +2634,14 @@ CAResult_t CAinitSslAdapter()
      */
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
+    g_caSslContext->rndMutex = oc_mutex_new();
+    if (NULL == g_caSslContext->rndMutex)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Random generator mutex allocation failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
     if(0 != mbedtls_ctr_drbg_seed(&g_caSslContext->rnd, mbedtls_entropy_func,
                                   &g_caSslContext->entropy,
@@ -1683,6 +2654,19 @@ CAResult_t CAinitSslAdapter()
     }
     mbedtls_ctr_drbg_set_prediction_resistance(&g_caSslContext->rnd, MBEDTLS_CTR_DRBG_PR_ON);
 
+#ifdef SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, SslRandom,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      SSL_SESSION_LIFETIME))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        return CA_STATUS_FAILED;
+    }
+#endif
+
 #ifdef __WITH_TLS__
     if (0 != InitConfig(&g_caSslContext->clientTlsConf,
                         MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_IS_CLIENT))
@@ -1706,7 +2690,7 @@ CAResult_t CAinitSslAdapter()
 #endif // __WITH_TLS__
 #ifdef __WITH_DTLS__
     mbedtls_ssl_cookie_init(&g_caSslContext->cookieCtx);
-    if (0 != mbedtls_ssl_cookie_setup(&g_caSslContext->cookieCtx, mbedtls_ctr_drbg_random,
+    if (0 != mbedtls_ssl_cookie_setup(&g_caSslContext->cookieCtx, SslRandom,
                                       &g_caSslContext->rnd))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "Cookie setup failed!");
@@ -1750,6 +2734,7 @@ CAResult_t CAinitSslAdapter()
     g_caSslContext->timerId = -1;
 #endif
 
+    oc_atomic_store(&g_sslFastPathEnabled, 1);
    oc_mutex_unlock(g_sslContextMutex);
 #ifdef __WITH_DTLS__
     StartRetransmit();
@@ -1791,13 +2776,46 @@ SslCacheMessage_t *  NewCacheMessage(uint8_t * data, size_t dataLen)
     return message;
 }
 
+/**
+ * Writes application data to an established session. The caller holds the peer mutex.
+ *
+ * @param[in]  tep        remote peer
+ * @param[in]  data       data to be sent
+ * @param[in]  dataLen    data length
+ *
+ * @return  ::CA_STATUS_OK, or ::CA_STATUS_FAILED if the session is broken
+ */
+static CAResult_t WriteSsl(SslEndPoint_t * tep, const void *data, size_t dataLen)
+{
+    const unsigned char *dataBuf = (const unsigned char *)data;
+    size_t written = 0;
+
+    do
+    {
+        int ret = mbedtls_ssl_write(&tep->ssl, dataBuf, dataLen - written);
+        if (ret < 0)
+        {
+            if (MBEDTLS_ERR_SSL_WANT_WRITE != ret)
+            {
+                OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedTLS write failed! returned 0x%x", -ret);
+                return CA_STATUS_FAILED;
+            }
+            continue;
+        }
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "mbedTLS write returned with sent bytes[%d]", ret);
+
+        dataBuf += ret;
+        written += ret;
+    } while (dataLen > written);
+
+    return CA_STATUS_OK;
+}
+
 /* Send data via TLS connection.
  */
 CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
                         void *data, size_t dataLen)
 {
-    int ret = 0;
-
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s ", __func__);
 
     VERIFY_NON_NULL_RET(endpoint, NET_SSL_TAG,"Remote address is NULL", CA_STATUS_INVALID_PARAM);
@@ -1812,6 +2830,30 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Data to be encrypted dataLen [%" PRIuPTR "]", dataLen);
 
+    // Established sessions are encrypted holding only the peer mutex.
+    if (EnterSslFastPath())
+    {
+        SslEndPoint_t * tep = AcquireSslPeer(endpoint);
+        if (NULL != tep && MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+        {
+            CAResult_t res = WriteSsl(tep, data, dataLen);
+            oc_mutex_unlock(tep->mutex);
+            if (CA_STATUS_OK != res)
+            {
+                RemoveSslPeer(tep);
+            }
+            DropSslPeerRef(tep);
+            LeaveSslFastPath();
+            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+            return res;
+        }
+        if (NULL != tep)
+        {
+            UnlockSslPeer(tep);
+        }
+        LeaveSslFastPath();
+    }
+
     oc_mutex_lock(g_sslContextMutex);
     if(NULL == g_caSslContext)
     {
@@ -1832,31 +2874,15 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
         return CA_STATUS_FAILED;
     }
 
+    CAResult_t res = CA_STATUS_OK;
+    LockSslPeer(tep);
     if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
     {
-        unsigned char *dataBuf = (unsigned char *)data;
-        size_t written = 0;
-
-        do
+        res = WriteSsl(tep, data, dataLen);
+        if (CA_STATUS_OK != res)
         {
-            ret = mbedtls_ssl_write(&tep->ssl, dataBuf, dataLen - written);
-            if (ret < 0)
-            {
-                if (MBEDTLS_ERR_SSL_WANT_WRITE != ret)
-                {
-                    OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedTLS write failed! returned 0x%x", -ret);
-                    RemovePeerFromList(&tep->sep.endpoint);
-                    oc_mutex_unlock(g_sslContextMutex);
-                    return CA_STATUS_FAILED;
-                }
-                continue;
-            }
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "mbedTLS write returned with sent bytes[%d]", ret);
-
-            dataBuf += ret;
-            written += ret;
-        } while (dataLen > written);
-
+            RemovePeerFromList(&tep->sep.endpoint);
+        }
     }
     else
     {
@@ -1864,15 +2890,15 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
         if (NULL == msg || !u_arraylist_add(tep->cacheList, (void *) msg))
         {
             OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
-            oc_mutex_unlock(g_sslContextMutex);
-            return CA_STATUS_FAILED;
+            res = CA_STATUS_FAILED;
         }
     }
+    UnlockSslPeer(tep);
 
     oc_mutex_unlock(g_sslContextMutex);
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return CA_STATUS_OK;
+    return res;
 }
 /**
  * Sends cached messages via TLS connection.
@@ -1942,50 +2968,75 @@ void CAsetSslHandshakeCallback(CAErrorCallback tlsHandshakeCallback)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s(%p)", __func__, tlsHandshakeCallback);
 }
 
-/* Read data from TLS connection
+/**
+ * Reads application data from an established session and passes it to the adapter.
+ * The caller holds the peer mutex.
+ *
+ * @param[in]  peer      remote peer with the received record loaded
+ * @param[out] closed    set if the session has ended and the peer has to be removed
+ *
+ * @return  ::CA_STATUS_OK or ::CA_STATUS_FAILED
  */
-CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dataLen)
+static CAResult_t ReadSslApplicationData(SslEndPoint_t *peer, bool *closed)
 {
     int ret = 0;
-    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
-    VERIFY_NON_NULL_RET(sep, NET_SSL_TAG, "endpoint is NULL" , CA_STATUS_INVALID_PARAM);
-    VERIFY_NON_NULL_RET(data, NET_SSL_TAG, "Param data is NULL" , CA_STATUS_INVALID_PARAM);
+    uint8_t decryptBuffer[TLS_MSG_BUF_LEN] = {0};
+    *closed = false;
+    do
+    {
+        ret = mbedtls_ssl_read(&peer->ssl, decryptBuffer, TLS_MSG_BUF_LEN);
+    } while (MBEDTLS_ERR_SSL_WANT_READ == ret);
 
-    oc_mutex_lock(g_sslContextMutex);
-    if (NULL == g_caSslContext)
+    if (MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY == ret ||
+        // TinyDTLS sends fatal close_notify alert
+        (MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == ret &&
+         MBEDTLS_SSL_ALERT_LEVEL_FATAL == peer->ssl.in_msg[0] &&
+         MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY == peer->ssl.in_msg[1]))
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "Context is NULL");
-        oc_mutex_unlock(g_sslContextMutex);
-        return CA_STATUS_FAILED;
+        OIC_LOG(INFO, NET_SSL_TAG, "Connection was closed gracefully");
+        *closed = true;
+        return CA_STATUS_OK;
     }
 
-
-    SslEndPoint_t * peer = GetSslPeer(&sep->endpoint);
-    if (NULL == peer)
+    if (0 > ret)
     {
-        mbedtls_ssl_config * config = (sep->endpoint.adapter == CA_ADAPTER_IP ||
-                                   sep->endpoint.adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
-        peer = NewSslEndPoint(&sep->endpoint, config);
-        if (NULL == peer)
+        OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedtls_ssl_read returned -0x%x", -ret);
+        //SSL_RES(peer, CA_STATUS_FAILED);
+        *closed = true;
+        return CA_STATUS_FAILED;
+    }
+    else if (0 < ret)
+    {
+        int adapterIndex = GetAdapterIndex(peer->sep.endpoint.adapter);
+        if (0 <= adapterIndex && MAX_SUPPORTED_ADAPTERS > adapterIndex)
         {
-            OIC_LOG(ERROR, NET_SSL_TAG, "Malloc failed!");
-            oc_mutex_unlock(g_sslContextMutex);
-            return CA_STATUS_FAILED;
+            g_caSslContext->adapterCallbacks[adapterIndex].recvCallback(&peer->sep, decryptBuffer, ret);
         }
-        //Load allowed TLS suites from SVR DB
-        SetupCipher(config, sep->endpoint.adapter);
-
-        ret = u_arraylist_add(g_caSslContext->peerList, (void *) peer);
-        if (!ret)
+        else
         {
-            OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
-            DeleteSslEndPoint(peer);
-            oc_mutex_unlock(g_sslContextMutex);
+            OIC_LOG(ERROR, NET_SSL_TAG, "Unsuported adapter");
+            *closed = true;
             return CA_STATUS_FAILED;
         }
     }
+    return CA_STATUS_OK;
+}
 
+/**
+ * Runs the handshake with a peer or reads application data from it.
+ * The caller holds g_sslContextMutex and the peer mutex.
+ *
+ * @param[in]  peer      remote peer
+ * @param[in]  sep       remote address
+ * @param[in]  data      received record
+ * @param[in]  dataLen   record length
+ *
+ * @return  ::CA_STATUS_OK or ::CA_STATUS_FAILED
+ */
+static CAResult_t DecryptSslLocked(SslEndPoint_t *peer, const CASecureEndpoint_t *sep,
+                                   uint8_t *data, size_t dataLen)
+{
+    int ret = 0;
     peer->recBuf.buff = data;
     peer->recBuf.len = dataLen;
     peer->recBuf.loaded = 0;
@@ -2016,8 +3067,8 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                    "Cert verification failed",
                                    GetAlertCode(flags)))
             {
-                oc_mutex_unlock(g_sslContextMutex);
                 OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+                OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_FAILED, 1);
                 return CA_STATUS_FAILED;
             }
         }
@@ -2026,14 +3077,20 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                "Handshake error",
                                MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE))
         {
-            oc_mutex_unlock(g_sslContextMutex);
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+            OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_FAILED, 1);
             return CA_STATUS_FAILED;
         }
         if (MBEDTLS_SSL_CLIENT_CHANGE_CIPHER_SPEC == peer->ssl.state)
         {
             memcpy(peer->master, peer->ssl.session_negotiate->master, sizeof(peer->master));
             g_caSslContext->selectedCipher = peer->ssl.session_negotiate->ciphersuite;
+            peer->resumed = (NULL != peer->ssl.handshake && peer->ssl.handshake->resume);
+            if (peer->resumed)
+            {
+                // An abbreviated handshake has no key exchange step to capture this in.
+                memcpy(peer->random, peer->ssl.handshake->randbytes, sizeof(peer->random));
+            }
         }
         if (MBEDTLS_SSL_CLIENT_KEY_EXCHANGE == peer->ssl.state)
         {
@@ -2043,6 +3100,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
         if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
         {
             SSL_RES(peer, CA_STATUS_OK);
+            OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_COMPLETED, 1);
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
                 SendCacheMessages(peer);
@@ -2063,7 +3121,6 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                        "Failed to retrieve cert",
                                        MBEDTLS_SSL_ALERT_MSG_NO_CERT))
                 {
-                    oc_mutex_unlock(g_sslContextMutex);
                     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
                     return CA_STATUS_FAILED;
                 }
@@ -2080,7 +3137,6 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                            "Failed to convert subject",
                                            MBEDTLS_SSL_ALERT_MSG_UNSUPPORTED_CERT))
                     {
-                        oc_mutex_unlock(g_sslContextMutex);
                         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
                         return CA_STATUS_FAILED;
                     }
@@ -2101,7 +3157,6 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                            "Failed to convert subject alt name",
                                            MBEDTLS_SSL_ALERT_MSG_UNSUPPORTED_CERT))
                     {
-                        oc_mutex_unlock(g_sslContextMutex);
                         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
                         return CA_STATUS_FAILED;
                     }
@@ -2112,7 +3167,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                 }
             }
 
-            oc_mutex_unlock(g_sslContextMutex);
+            UpdateSessionCache(peer);
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
             return CA_STATUS_OK;
         }
@@ -2120,52 +3175,91 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
     if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
     {
-        uint8_t decryptBuffer[TLS_MSG_BUF_LEN] = {0};
-        do
+        bool closed = false;
+        CAResult_t res = ReadSslApplicationData(peer, &closed);
+        if (closed)
         {
-            ret = mbedtls_ssl_read(&peer->ssl, decryptBuffer, TLS_MSG_BUF_LEN);
-        } while (MBEDTLS_ERR_SSL_WANT_READ == ret);
+            RemovePeerFromList(&peer->sep.endpoint);
+        }
+        return res;
+    }
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return CA_STATUS_OK;
+}
+
+/* Read data from TLS connection
+ */
+CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dataLen)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(sep, NET_SSL_TAG, "endpoint is NULL" , CA_STATUS_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(data, NET_SSL_TAG, "Param data is NULL" , CA_STATUS_INVALID_PARAM);
 
-        if (MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY == ret ||
-            // TinyDTLS sends fatal close_notify alert
-            (MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == ret &&
-             MBEDTLS_SSL_ALERT_LEVEL_FATAL == peer->ssl.in_msg[0] &&
-             MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY == peer->ssl.in_msg[1]))
+    // Records of established sessions are decrypted holding only the peer mutex.
+    if (EnterSslFastPath())
+    {
+        SslEndPoint_t *peer = AcquireSslPeer(&sep->endpoint);
+        if (NULL != peer && MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
         {
-            OIC_LOG(INFO, NET_SSL_TAG, "Connection was closed gracefully");
-            RemovePeerFromList(&peer->sep.endpoint);
-            oc_mutex_unlock(g_sslContextMutex);
-            return CA_STATUS_OK;
+            bool closed = false;
+            peer->recBuf.buff = data;
+            peer->recBuf.len = dataLen;
+            peer->recBuf.loaded = 0;
+            CAResult_t res = ReadSslApplicationData(peer, &closed);
+            oc_mutex_unlock(peer->mutex);
+            if (closed)
+            {
+                RemoveSslPeer(peer);
+            }
+            DropSslPeerRef(peer);
+            LeaveSslFastPath();
+            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+            return res;
+        }
+        if (NULL != peer)
+        {
+            UnlockSslPeer(peer);
         }
+        LeaveSslFastPath();
+    }
 
-        if (0 > ret)
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL == g_caSslContext)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Context is NULL");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_FAILED;
+    }
+
+
+    SslEndPoint_t * peer = GetSslPeer(&sep->endpoint);
+    if (NULL == peer)
+    {
+        mbedtls_ssl_config * config = (sep->endpoint.adapter == CA_ADAPTER_IP ||
+                                   sep->endpoint.adapter == CA_ADAPTER_GATT_BTLE ?
+                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
+        peer = NewSslEndPoint(&sep->endpoint, config);
+        if (NULL == peer)
         {
-            OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedtls_ssl_read returned -0x%x", -ret);
-            //SSL_RES(peer, CA_STATUS_FAILED);
-            RemovePeerFromList(&peer->sep.endpoint);
+            OIC_LOG(ERROR, NET_SSL_TAG, "Malloc failed!");
             oc_mutex_unlock(g_sslContextMutex);
             return CA_STATUS_FAILED;
         }
-        else if (0 < ret)
-        {
-            int adapterIndex = GetAdapterIndex(peer->sep.endpoint.adapter);
-            if (0 <= adapterIndex && MAX_SUPPORTED_ADAPTERS > adapterIndex)
-            {
-                g_caSslContext->adapterCallbacks[adapterIndex].recvCallback(&peer->sep, decryptBuffer, ret);
-            }
-            else
-            {
-                OIC_LOG(ERROR, NET_SSL_TAG, "Unsuported adapter");
-                RemovePeerFromList(&peer->sep.endpoint);
-                oc_mutex_unlock(g_sslContextMutex);
-                return CA_STATUS_FAILED;
-            }
-        }
+        //Load allowed TLS suites from SVR DB
+        SetupCipher(config);
+
+        AddSslPeer(peer);
+        OCMetricAdd(OC_METRIC_SSL_HANDSHAKES_STARTED, 1);
     }
 
+    LockSslPeer(peer);
+    CAResult_t res = DecryptSslLocked(peer, sep, data, dataLen);
+    UnlockSslPeer(peer);
+
     oc_mutex_unlock(g_sslContextMutex);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return CA_STATUS_OK;
+    return res;
 }
 
 void CAsetSslAdapterCallbacks(CAPacketReceivedCallback recvCallback,
@@ -2291,6 +3385,8 @@ CAResult_t CAsetTlsCipherSuite(const uint32_t cipher)
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Selected cipher: 0x%x", cipher);
     }
     g_caSslContext->cipher = index;
+    // The ciphersuite lists depend on the preferred cipher, set them up again.
+    memset(g_caSslContext->confVersion, 0, sizeof(g_caSslContext->confVersion));
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return CA_STATUS_OK;
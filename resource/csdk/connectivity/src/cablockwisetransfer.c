@@ -58,7 +58,96 @@
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
-                                          .dataList = NULL };
+                                          .sessions = NULL };
+
+/**
+ * Find a block data set. blockDataListMutex has to be held.
+ */
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID || !blockID->id)
+    {
+        return NULL;
+    }
+
+    CABlockData_t *data = NULL;
+    HASH_FIND(hh, g_context.sessions, blockID->id, blockID->idLength, data);
+    return data;
+}
+
+/**
+ * Take a block data set out of the table. blockDataListMutex has to be held.
+ */
+static CABlockData_t *CAUnlinkBlockData(const CABlockDataID_t *blockID)
+{
+    CABlockData_t *data = CAFindBlockData(blockID);
+    if (data)
+    {
+        HASH_DEL(g_context.sessions, data);
+    }
+    return data;
+}
+
+static void CAFreeBlockSegments(CABlockData_t *data)
+{
+    CABlockSegment_t *segment = data->segments;
+    while (segment)
+    {
+        CABlockSegment_t *next = segment->next;
+        OICFree(segment);
+        segment = next;
+    }
+    data->segments = NULL;
+    data->lastSegment = NULL;
+}
+
+/**
+ * Drop the received payload of a block data set.
+ */
+static void CAResetBlockPayload(CABlockData_t *data)
+{
+    CAFreeBlockSegments(data);
+    OICFree(data->payload);
+    data->payload = NULL;
+    data->payloadCapacity = 0;
+    data->receivedPayloadLen = 0;
+}
+
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    CAResetBlockPayload(data);
+    OICFree(data);
+}
+
+/**
+ * Copy the received payload of a block data set into one buffer, in receive order.
+ * @param[in]   data        block data set.
+ * @param[in]   buffer      destination, at least data->receivedPayloadLen bytes long.
+ */
+static void CAGatherBlockPayload(const CABlockData_t *data, uint8_t *buffer)
+{
+    size_t offset = 0;
+    if (data->payload)
+    {
+        // payload holds what was received before the first segment.
+        offset = data->receivedPayloadLen;
+        for (const CABlockSegment_t *segment = data->segments; segment; segment = segment->next)
+        {
+            offset -= segment->length;
+        }
+        memcpy(buffer, data->payload, offset);
+    }
+    for (const CABlockSegment_t *segment = data->segments; segment; segment = segment->next)
+    {
+        memcpy(buffer + offset, segment->data, segment->length);
+        offset += segment->length;
+    }
+}
 
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
@@ -93,16 +182,9 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.receivedThreadFunc = receivedThreadFunc;
     }
 
-    if (!g_context.dataList)
-    {
-        g_context.dataList = u_arraylist_create();
-    }
-
     CAResult_t res = CAInitBlockWiseMutexVariables();
     if (CA_STATUS_OK != res)
     {
-        u_arraylist_free(&g_context.dataList);
-        g_context.dataList = NULL;
         OIC_LOG(ERROR, TAG, "init has failed");
     }
 
@@ -113,10 +195,9 @@ CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "CATerminateBlockWiseTransfer");
 
-    if (g_context.dataList)
+    if (g_context.blockDataListMutex)
     {
         CARemoveAllBlockDataFromList();
-        u_arraylist_free(&g_context.dataList);
     }
 
     CATerminateBlockWiseMutexVariables();
@@ -778,10 +859,8 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     // if error code is 4.08, remove the stored payload and initialize block number
     if (CA_BLOCK_INCOMPLETE == status)
     {
-        OICFree(data->payload);
-        data->payload = NULL;
+        CAResetBlockPayload(data);
         data->payloadLength = 0;
-        data->receivedPayloadLen = 0;
         data->block1.num = 0;
         data->block2.num = 0;
     }
@@ -802,19 +881,36 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // update payload
-    size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
-    if (fullPayload)
+    // update payload. The blocks are gathered straight into the payload handed up,
+    // the block data set keeps its copy in case the last block is received again.
+    CAInfo_t *info = NULL;
+    if (CA_REQUEST_DATA == cloneData->dataType && cloneData->requestInfo)
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
-        if (CA_STATUS_OK != res)
+        info = &cloneData->requestInfo->info;
+    }
+    else if (CA_RESPONSE_DATA == cloneData->dataType && cloneData->responseInfo)
+    {
+        info = &cloneData->responseInfo->info;
+    }
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+    CABlockData_t *data = CAFindBlockData(blockID);
+    if (info && data && (data->payload || data->segments) && data->receivedPayloadLen)
+    {
+        CAPayload_t fullPayload = (CAPayload_t) OICMalloc(data->receivedPayloadLen);
+        if (!fullPayload)
         {
-            OIC_LOG(ERROR, TAG, "update has failed");
+            oc_mutex_unlock(g_context.blockDataListMutex);
+            OIC_LOG(ERROR, TAG, "out of memory");
             CADestroyDataSet(cloneData);
-            return res;
+            return CA_MEMORY_ALLOC_FAILED;
         }
+        CAGatherBlockPayload(data, fullPayload);
+        OICFree(info->payload);
+        info->payload = fullPayload;
+        info->payloadSize = data->receivedPayloadLen;
     }
+    oc_mutex_unlock(g_context.blockDataListMutex);
 
     if (g_context.receivedThreadFunc)
     {
@@ -1987,48 +2083,58 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
     }
 
-    // memory allocation for the received block payload
-    size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        size_t prePayloadLen = currData->receivedPayloadLen;
+
+        // in case the block message has the size option, allocate the memory for the
+        // total payload once and gather what was received so far into it.
+        if (isSizeOption && currData->payloadLength > currData->payloadCapacity &&
+            currData->payloadLength >= prePayloadLen)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
+            OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
+            CAPayload_t newPayload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
+            if (NULL == newPayload)
             {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
+                OIC_LOG(ERROR, TAG, "out of memory");
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            CAGatherBlockPayload(currData, newPayload);
+            CAFreeBlockSegments(currData);
+            OICFree(currData->payload);
+            currData->payload = newPayload;
+            currData->payloadCapacity = currData->payloadLength;
+        }
 
+        if (!currData->segments && prePayloadLen + blockPayloadLen <= currData->payloadCapacity)
+        {
             // update the total payload
             memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
         }
         else
         {
+            // the total size is unknown, keep the block as a segment instead of
+            // growing and copying the payload received so far.
             OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
-
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
+            CABlockSegment_t *segment = (CABlockSegment_t *) OICMalloc(
+                    sizeof(CABlockSegment_t) - 1 + blockPayloadLen);
+            if (NULL == segment)
             {
                 OIC_LOG(ERROR, TAG, "out of memory");
                 return CA_MEMORY_ALLOC_FAILED;
             }
-
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+            segment->next = NULL;
+            segment->length = blockPayloadLen;
+            memcpy(segment->data, blockPayload, blockPayloadLen);
+            if (currData->lastSegment)
+            {
+                currData->lastSegment->next = segment;
+            }
+            else
+            {
+                currData->segments = segment;
+            }
+            currData->lastSegment = segment;
         }
 
         // update received payload length
@@ -2287,22 +2393,15 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID, uint16_t bloc
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-    return CA_STATUS_FAILED;
+    return currData ? CA_STATUS_OK : CA_STATUS_FAILED;
 }
 
 uint16_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
@@ -2312,21 +2411,12 @@ uint16_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    uint16_t type = currData ? currData->type : 0;
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-    return 0;
+    return type;
 }
 
 CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
@@ -2335,19 +2425,11 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    CAData_t *sentData = currData ? currData->sentData : NULL;
     oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return sentData;
 }
 
 CABlockData_t *CAUpdateDataSetFromBlockDataList(const CABlockDataID_t *blockID,
@@ -2358,21 +2440,15 @@ CABlockData_t *CAUpdateDataSetFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CADestroyDataSet(currData->sentData);
-            currData->sentData = CACloneCAData(sendData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        CADestroyDataSet(currData->sentData);
+        currData->sentData = CACloneCAData(sendData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
@@ -2385,39 +2461,35 @@ CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    // the message ID is not part of the key, so every block data set is visited.
+    CABlockData_t *currData = NULL;
+    CABlockData_t *tmp = NULL;
+    HASH_ITER(hh, g_context.sessions, currData, tmp)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (NULL == currData)
+        if (NULL == currData->sentData || NULL == currData->sentData->requestInfo ||
+            NULL == currData->sentData->requestInfo->info.token)
         {
             continue;
         }
 
-        if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
+        if (pdu->transport_hdr->udp.id == currData->sentData->requestInfo->info.messageId &&
+                endpoint->adapter == currData->sentData->remoteEndpoint->adapter)
         {
-            if (pdu->transport_hdr->udp.id == currData->sentData->requestInfo->info.messageId &&
-                    endpoint->adapter == currData->sentData->remoteEndpoint->adapter)
+            uint8_t length = currData->sentData->requestInfo->info.tokenLength;
+            responseInfo->info.tokenLength = length;
+            responseInfo->info.token = (char *) OICMalloc(length);
+            if (NULL == responseInfo->info.token)
             {
-                if (NULL != currData->sentData->requestInfo->info.token)
-                {
-                    uint8_t length = currData->sentData->requestInfo->info.tokenLength;
-                    responseInfo->info.tokenLength = length;
-                    responseInfo->info.token = (char *) OICMalloc(length);
-                    if (NULL == responseInfo->info.token)
-                    {
-                        OIC_LOG(ERROR, TAG, "out of memory");
-                        oc_mutex_unlock(g_context.blockDataListMutex);
-                        return CA_MEMORY_ALLOC_FAILED;
-                    }
-                    memcpy(responseInfo->info.token, currData->sentData->requestInfo->info.token,
-                           responseInfo->info.tokenLength);
-
-                    oc_mutex_unlock(g_context.blockDataListMutex);
-                    OIC_LOG(DEBUG, TAG, "OUT-CAGetTokenFromBlockDataList");
-                    return CA_STATUS_OK;
-                }
+                OIC_LOG(ERROR, TAG, "out of memory");
+                oc_mutex_unlock(g_context.blockDataListMutex);
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy(responseInfo->info.token, currData->sentData->requestInfo->info.token,
+                   responseInfo->info.tokenLength);
+
+            oc_mutex_unlock(g_context.blockDataListMutex);
+            OIC_LOG(DEBUG, TAG, "OUT-CAGetTokenFromBlockDataList");
+            return CA_STATUS_OK;
         }
     }
 
@@ -2464,20 +2536,36 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
     VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
 
     oc_mutex_lock(g_context.blockDataListMutex);
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    oc_mutex_unlock(g_context.blockDataListMutex);
+
+    return currData;
+}
+
+bool CAHasBlockData(const CAToken_t token, uint8_t tokenLength,
+                    const char *addr, uint16_t portNumber)
+{
+    VERIFY_NON_NULL_RET(addr, TAG, "addr", false);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    // same layout as CACreateBlockDatablockId, built on the stack.
+    uint8_t id[CA_MAX_TOKEN_LEN + PORT_LENGTH + MAX_ADDR_STR_SIZE_CA];
+    size_t addrLength = strlen(addr);
+    if (CA_MAX_TOKEN_LEN < tokenLength || MAX_ADDR_STR_SIZE_CA < addrLength)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        // not a valid token for a block id, don't let the caller skip blockwise transfer.
+        return true;
     }
-    oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    if (token)
+    {
+        memcpy(id, token, tokenLength);
+    }
+    id[tokenLength] = (uint8_t) ((portNumber >> 8) & 0xFF);
+    id[tokenLength + 1] = (uint8_t) (portNumber & 0xFF);
+    memcpy(id + tokenLength + PORT_LENGTH, addr, addrLength);
+
+    CABlockDataID_t blockDataID = { .id = id, .idLength = tokenLength + PORT_LENGTH + addrLength };
+    return NULL != CAGetBlockDataFromBlockDataList(&blockDataID);
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockType)
@@ -2487,28 +2575,23 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    coap_block_t *block = NULL;
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            block = &currData->block2;
+        }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            block = &currData->block1;
         }
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-    return NULL;
+    return block;
 }
 
 CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
@@ -2520,22 +2603,33 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CAPayload_t payload = NULL;
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        if (currData->segments)
+        {
+            // the caller wants one buffer, gather the segments into it once.
+            CAPayload_t newPayload = (CAPayload_t) OICMalloc(currData->receivedPayloadLen);
+            if (newPayload)
+            {
+                CAGatherBlockPayload(currData, newPayload);
+                CAFreeBlockSegments(currData);
+                OICFree(currData->payload);
+                currData->payload = newPayload;
+                currData->payloadCapacity = currData->receivedPayloadLen;
+            }
+        }
+        if (!currData->segments)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
             *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
+            payload = currData->payload;
         }
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-    return NULL;
+    return payload;
 }
 
 CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
@@ -2598,16 +2692,8 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    bool res = u_arraylist_add(g_context.dataList, (void *) data);
-    if (!res)
-    {
-        OIC_LOG(ERROR, TAG, "add has failed");
-        CADestroyBlockID(data->blockDataId);
-        CADestroyDataSet(data->sentData);
-        OICFree(data);
-        oc_mutex_unlock(g_context.blockDataListMutex);
-        return NULL;
-    }
+    HASH_ADD_KEYPTR(hh, g_context.sessions, data->blockDataId->id,
+                    data->blockDataId->idLength, data);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2621,28 +2707,11 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *removedData = CAUnlinkBlockData(blockID);
+    if (removedData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                oc_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
-
-            // destroy memory
-            CADestroyDataSet(removedData->sentData);
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
-        }
+        // destroy memory
+        CADestroyBlockData(removedData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2655,21 +2724,13 @@ CAResult_t CARemoveAllBlockDataFromList()
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = len; i > 0; i--)
+    CABlockData_t *removedData = NULL;
+    CABlockData_t *tmp = NULL;
+    HASH_ITER(hh, g_context.sessions, removedData, tmp)
     {
-        CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i - 1);
-        if (removedData)
-        {
-            // destroy memory
-            if (removedData->sentData)
-            {
-                CADestroyDataSet(removedData->sentData);
-            }
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-        }
+        HASH_DEL(g_context.sessions, removedData);
+        // destroy memory
+        CADestroyBlockData(removedData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -506,6 +506,19 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CASetReceiveWorkerCount(uint8_t workerCount)
+{
+    OIC_LOG_V(DEBUG, TAG, "CASetReceiveWorkerCount : %d", workerCount);
+
+    if (g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "already initialized");
+        return CA_STATUS_FAILED;
+    }
+
+    return CASetReceiveWorkers(workerCount);
+}
+
 CAResult_t CASelectCipherSuite(const uint16_t cipher, CATransportAdapter_t adapter)
 {
     (void)(adapter); // prevent unused-parameter warning when building release variant
@@ -617,7 +630,7 @@ CAResult_t CAcloseSslSession(const CAEndpoint_t *endpoint)
         return CA_STATUS_INVALID_PARAM;
     }
 
-    res = CAcloseSslConnection(endpoint);
+    res = CAendSslSession(endpoint);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG_V(ERROR, TAG, "Failed to CAsslClose : %d", res);
@@ -630,6 +643,35 @@ CAResult_t CAcloseSslSession(const CAEndpoint_t *endpoint)
     return res;
 }
 
+CAResult_t CAInvalidateSslCredentials(void)
+{
+    CAResult_t res = CA_STATUS_FAILED;
+#if defined (__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAinvalidateSslCredentials();
+    res = CA_STATUS_OK;
+#else
+    OIC_LOG(ERROR, TAG, "Method not supported");
+#endif
+    return res;
+}
+
+CAResult_t CAGetSslSessionCacheStats(CASslSessionCacheStats_t *stats)
+{
+    CAResult_t res = CA_STATUS_FAILED;
+#if defined (__WITH_DTLS__) || defined(__WITH_TLS__)
+    if (!stats)
+    {
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    res = CAgetSslSessionCacheStats(stats);
+#else
+    (void)(stats); // prevent unused-parameter compiler warning
+    OIC_LOG(ERROR, TAG, "Method not supported");
+#endif
+    return res;
+}
+
 #ifdef TCP_ADAPTER
 void CARegisterKeepAliveHandler(CAKeepAliveConnectionCallback ConnHandler)
 {
@@ -47,6 +47,8 @@
 #include "uqueue.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
+#include "ocmetrics.h"
+#include "oic_hash.h"
 
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
 #include "caconnectionmanager.h"
@@ -54,6 +56,9 @@
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
 
+/** Number of messages the send and receive queues take without locking. **/
+#define CA_MESSAGE_QUEUE_CAPACITY   256
+
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
 
@@ -61,6 +66,11 @@ static ca_thread_pool_t g_threadPoolHandle = NULL;
 static CAQueueingThread_t g_sendThread;
 static CAQueueingThread_t g_receiveThread;
 
+// receive workers, sharded by remote endpoint. NULL when received data is
+// handled in CAHandleRequestResponseCallbacks.
+static CAQueueingThread_t *g_receiveWorkers = NULL;
+static uint8_t g_receiveWorkerCount = 0;
+
 #else
 #define CA_MAX_RT_ARRAY_SIZE    3
 #endif  // SINGLE_THREAD
@@ -88,6 +98,8 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
 
 #ifdef SINGLE_THREAD
 static void CAProcessReceivedData(CAData_t *data);
+#else
+static void CAAddDataToReceiveQueue(CAData_t *data);
 #endif
 static void CADestroyData(void *data, uint32_t size);
 static void CALogPayloadInfo(CAInfo_t *info);
@@ -115,7 +127,7 @@ void CAAddDataToReceiveThread(CAData_t *data)
     VERIFY_NON_NULL_VOID(data, TAG, "data");
 
     // add thread
-    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(data);
 }
 #endif
 
@@ -329,7 +341,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
 #ifdef SINGLE_THREAD
     CAProcessReceivedData(cadata);
 #else
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(cadata);
 #endif
 }
 
@@ -422,8 +434,143 @@ static void CAReceiveThreadProcess(void *threadData)
     (void)threadData;
 #endif
 }
+
+/**
+ * pass received data to the registered handler.
+ * @param[in] data      received data, still owned by the caller.
+ */
+static void CADispatchReceivedData(const CAData_t *data)
+{
+    if (data->requestInfo && g_requestHandler)
+    {
+        OIC_LOG_V(DEBUG, TAG, "request callback : %d", data->requestInfo->info.numOptions);
+        g_requestHandler(data->remoteEndpoint, data->requestInfo);
+    }
+    else if (data->responseInfo && g_responseHandler)
+    {
+        OIC_LOG_V(DEBUG, TAG, "response callback : %d", data->responseInfo->info.numOptions);
+        g_responseHandler(data->remoteEndpoint, data->responseInfo);
+    }
+    else if (data->errorInfo && g_errorHandler)
+    {
+        OIC_LOG_V(DEBUG, TAG, "error callback error: %d", data->errorInfo->result);
+        g_errorHandler(data->remoteEndpoint, data->errorInfo);
+    }
+}
+
+static void CAReceiveWorkerProcess(void *threadData)
+{
+    // the queueing thread destroys the data afterwards.
+    CADispatchReceivedData((const CAData_t *) threadData);
+}
+
+/**
+ * pick the receive worker for an endpoint, so one peer always maps to the
+ * same worker and its data keeps its order.
+ */
+static CAQueueingThread_t *CAGetReceiveWorker(const CAEndpoint_t *endpoint)
+{
+    // FNV-1a over address, port and adapter.
+    uint32_t hash = OIC_HASH_INIT;
+    if (endpoint)
+    {
+        uint8_t tail[] = { (uint8_t) (endpoint->port & 0xFF), (uint8_t) (endpoint->port >> 8),
+                           (uint8_t) endpoint->adapter };
+        hash = OICHashString(hash, endpoint->addr);
+        hash = OICHashBytes(hash, tail, sizeof(tail));
+    }
+    return &g_receiveWorkers[hash % g_receiveWorkerCount];
+}
+
+static void CAAddDataToReceiveQueue(CAData_t *data)
+{
+    if (NULL != g_receiveWorkers)
+    {
+        CAQueueingThreadAddData(CAGetReceiveWorker(data->remoteEndpoint), data, sizeof(CAData_t));
+        return;
+    }
+
+    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+}
 #endif // SINGLE_THREAD
 
+/**
+ * Encode a message into a stack buffer and send it, without the coap_pdu_t and
+ * option list allocations of CAGeneratePDU. Only CoAP over UDP messages which
+ * do not belong to a block-wise transfer take this path.
+ * @return CA_NOT_SUPPORTED if the message has to be sent through CAGeneratePDU.
+ */
+static CAResult_t CASendDataFromBuffer(const CAData_t *data, uint32_t code,
+                                       const CAInfo_t *info, bool retransmit)
+{
+#ifdef WITH_TCP
+    if (CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter))
+    {
+        return CA_NOT_SUPPORTED;
+    }
+#endif
+#ifdef WITH_BWT
+    if (CAIsSupportedBlockwiseTransfer(data->remoteEndpoint->adapter))
+    {
+        uint8_t tokenLength = (info->token && CA_EMPTY != code) ? info->tokenLength : 0;
+        if (CA_REQUEST_ENTITY_INCOMPLETE == code
+            || CAHasBlockData(info->token, tokenLength,
+                              data->remoteEndpoint->addr, data->remoteEndpoint->port))
+        {
+            return CA_NOT_SUPPORTED;
+        }
+    }
+#endif
+
+    uint8_t buffer[COAP_MAX_PDU_SIZE];
+    size_t length = 0;
+    if (CA_STATUS_OK != CAGeneratePDUToBuffer(code, info, buffer, sizeof(buffer), &length))
+    {
+        return CA_NOT_SUPPORTED;
+    }
+
+    coap_pdu_t pdu = { .max_size = sizeof(buffer),
+                       .transport_hdr = (coap_hdr_transport_t *) buffer,
+                       .length = (unsigned int) length };
+    if (info->payload && 0 < info->payloadSize)
+    {
+        pdu.data = buffer + length - info->payloadSize;
+    }
+    CALogPDUInfo(data, &pdu);
+
+    CAResult_t res = CA_STATUS_OK;
+    if (SEND_TYPE_MULTICAST == data->type)
+    {
+        res = CASendMulticastData(data->remoteEndpoint, buffer, length, data->dataType);
+    }
+    else
+    {
+        OIC_LOG_V(INFO, TAG, "CASendUnicastData type : %d", data->dataType);
+        res = CASendUnicastData(data->remoteEndpoint, buffer, length, data->dataType);
+    }
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
+        CAErrorHandler(data->remoteEndpoint, buffer, length, res);
+        return res;
+    }
+    OCMetricAdd(OC_METRIC_CA_MESSAGES_SENT, 1);
+
+    if (retransmit)
+    {
+        // for retransmission
+        res = CARetransmissionSentData(&g_retransmissionContext, data->remoteEndpoint,
+                                       data->dataType, buffer, length);
+        if ((CA_STATUS_OK != res) && (CA_NOT_SUPPORTED != res))
+        {
+            //when retransmission not supported this will return CA_NOT_SUPPORTED, ignore
+            OIC_LOG_V(INFO, TAG, "retransmission is not enabled due to error, res : %d", res);
+            return res;
+        }
+    }
+    return CA_STATUS_OK;
+}
+
 static CAResult_t CAProcessMulticastData(const CAData_t *data)
 {
     VERIFY_NON_NULL(data, TAG, "data");
@@ -441,21 +588,29 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
         return res;
     }
 
+    uint32_t code = CA_GET;
     if (data->requestInfo)
     {
         OIC_LOG(DEBUG, TAG, "requestInfo is available..");
 
         info = &data->requestInfo->info;
-        pdu = CAGeneratePDU(CA_GET, info, data->remoteEndpoint, &options, &transport);
     }
     else if (data->responseInfo)
     {
         OIC_LOG(DEBUG, TAG, "responseInfo is available..");
 
         info = &data->responseInfo->info;
-        pdu = CAGeneratePDU(data->responseInfo->result, info, data->remoteEndpoint,
-                            &options, &transport);
+        code = data->responseInfo->result;
+    }
+
+    res = CASendDataFromBuffer(data, code, info, false);
+    if (CA_NOT_SUPPORTED != res)
+    {
+        return res;
     }
+    res = CA_SEND_FAILED;
+
+    pdu = CAGeneratePDU(code, info, data->remoteEndpoint, &options, &transport);
 
     if (!pdu)
     {
@@ -486,6 +641,7 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
         OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
         goto exit;
     }
+    OCMetricAdd(OC_METRIC_CA_MESSAGES_SENT, 1);
 
     coap_delete_list(options);
     coap_delete_pdu(pdu);
@@ -513,6 +669,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
     CAInfo_t *info = NULL;
     coap_list_t *options = NULL;
     coap_transport_t transport = COAP_UDP;
+    uint32_t code = CA_EMPTY;
 
     if (SEND_TYPE_UNICAST == type)
     {
@@ -534,8 +691,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
 #ifdef ROUTING_GATEWAY
             skipRetransmission = data->requestInfo->info.skipRetransmission;
 #endif
-            pdu = CAGeneratePDU(data->requestInfo->method, info, data->remoteEndpoint,
-                                &options, &transport);
+            code = data->requestInfo->method;
         }
         else if (NULL != data->responseInfo)
         {
@@ -545,8 +701,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
 #ifdef ROUTING_GATEWAY
             skipRetransmission = data->responseInfo->info.skipRetransmission;
 #endif
-            pdu = CAGeneratePDU(data->responseInfo->result, info, data->remoteEndpoint,
-                                &options, &transport);
+            code = data->responseInfo->result;
         }
         else
         {
@@ -555,6 +710,19 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
             return CA_STATUS_INVALID_PARAM;
         }
 
+#ifdef ROUTING_GATEWAY
+        res = CASendDataFromBuffer(data, code, info, !skipRetransmission);
+#else
+        res = CASendDataFromBuffer(data, code, info, true);
+#endif
+        if (CA_NOT_SUPPORTED != res)
+        {
+            OIC_TRACE_END();
+            return res;
+        }
+
+        pdu = CAGeneratePDU(code, info, data->remoteEndpoint, &options, &transport);
+
         // interface controller function call.
         if (NULL != pdu)
         {
@@ -592,6 +760,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                 OIC_TRACE_END();
                 return res;
             }
+            OCMetricAdd(OC_METRIC_CA_MESSAGES_SENT, 1);
 
 #ifdef WITH_TCP
             if (CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter))
@@ -753,6 +922,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         OIC_TRACE_END();
         return;
     }
+    OCMetricAdd(OC_METRIC_CA_MESSAGES_RECEIVED, 1);
 
     uint32_t code = CA_NOT_FOUND;
     CAData_t *cadata = NULL;
@@ -833,7 +1003,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         if (CA_NOT_SUPPORTED == res || CA_REQUEST_TIMEOUT == res)
         {
             OIC_LOG(DEBUG, TAG, "this message does not have block option");
-            CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+            CAAddDataToReceiveQueue(cadata);
         }
         else
         {
@@ -843,7 +1013,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+        CAAddDataToReceiveQueue(cadata);
     }
 #endif // SINGLE_THREAD
 
@@ -867,38 +1037,15 @@ void CAHandleRequestResponseCallbacks()
     // #1 parse the data
     // #2 get endpoint
 
-    oc_mutex_lock(g_receiveThread.threadMutex);
-
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
-
-    oc_mutex_unlock(g_receiveThread.threadMutex);
-
-    if (NULL == item || NULL == item->msg)
+    u_queue_message_t item;
+    if (!CAQueueingThreadGetData(&g_receiveThread, &item) || NULL == item.msg)
     {
         return;
     }
 
-    // get endpoint
-    CAData_t *td = (CAData_t *) item->msg;
-
-    if (td->requestInfo && g_requestHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
-        g_requestHandler(td->remoteEndpoint, td->requestInfo);
-    }
-    else if (td->responseInfo && g_responseHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
-        g_responseHandler(td->remoteEndpoint, td->responseInfo);
-    }
-    else if (td->errorInfo && g_errorHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
-        g_errorHandler(td->remoteEndpoint, td->errorInfo);
-    }
+    CADispatchReceivedData((const CAData_t *) item.msg);
 
-    CADestroyData(item->msg, sizeof(CAData_t));
-    OICFree(item);
+    CADestroyData(item.msg, sizeof(CAData_t));
 
 #endif // SINGLE_HANDLE
 #endif // SINGLE_THREAD
@@ -990,7 +1137,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
 
 #ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    if (CA_MAX_RT_ARRAY_SIZE == g_retransmissionContext.pendingCount)
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
@@ -1030,7 +1177,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     {
         OIC_LOG(DEBUG, TAG,
                 "This is a loopback message. Transfer it to the receive queue directly");
-        CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+        CAAddDataToReceiveQueue(data);
         return CA_STATUS_OK;
     }
 #ifdef WITH_BWT
@@ -1073,6 +1220,91 @@ void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler)
     g_nwMonitorHandler = nwMonitorHandler;
 }
 
+CAResult_t CASetReceiveWorkers(uint8_t workerCount)
+{
+#ifndef SINGLE_THREAD
+    if (CA_MAX_RECEIVE_WORKERS < workerCount)
+    {
+        OIC_LOG_V(ERROR, TAG, "too many receive workers : %d", workerCount);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    g_receiveWorkerCount = workerCount;
+    return CA_STATUS_OK;
+#else
+    return (0 == workerCount) ? CA_STATUS_OK : CA_NOT_SUPPORTED;
+#endif
+}
+
+#ifndef SINGLE_THREAD
+static CAResult_t CAInitializeReceiveWorkers()
+{
+    if (0 == g_receiveWorkerCount)
+    {
+        return CA_STATUS_OK;
+    }
+
+    CAQueueingThread_t *workers = (CAQueueingThread_t *) OICCalloc(g_receiveWorkerCount,
+                                                                   sizeof(CAQueueingThread_t));
+    if (NULL == workers)
+    {
+        OIC_LOG(ERROR, TAG, "memory allocation failed");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    for (uint8_t i = 0; i < g_receiveWorkerCount; i++)
+    {
+        CAResult_t res = CAQueueingThreadInitializeLockFree(&workers[i], g_threadPoolHandle,
+                                                            CAReceiveWorkerProcess,
+                                                            CADestroyData,
+                                                            CA_MESSAGE_QUEUE_CAPACITY);
+        if (CA_STATUS_OK == res)
+        {
+            workers[i].depthMetric = OC_METRIC_CA_RECEIVE_QUEUE_DEPTH;
+            res = CAQueueingThreadStart(&workers[i]);
+            if (CA_STATUS_OK != res)
+            {
+                CAQueueingThreadDestroy(&workers[i]);
+            }
+        }
+
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "receive worker %d start error", i);
+            while (0 < i--)
+            {
+                CAQueueingThreadStop(&workers[i]);
+                CAQueueingThreadDestroy(&workers[i]);
+            }
+            OICFree(workers);
+            return res;
+        }
+    }
+
+    g_receiveWorkers = workers;
+    OIC_LOG_V(INFO, TAG, "%d receive workers started", g_receiveWorkerCount);
+    return CA_STATUS_OK;
+}
+
+static void CAStopReceiveWorkers()
+{
+    for (uint8_t i = 0; g_receiveWorkers && i < g_receiveWorkerCount; i++)
+    {
+        CAQueueingThreadStop(&g_receiveWorkers[i]);
+    }
+}
+
+static void CADestroyReceiveWorkers()
+{
+    for (uint8_t i = 0; g_receiveWorkers && i < g_receiveWorkerCount; i++)
+    {
+        CAQueueingThreadDestroy(&g_receiveWorkers[i]);
+    }
+    OICFree(g_receiveWorkers);
+    g_receiveWorkers = NULL;
+}
+#endif // SINGLE_THREAD
+
 CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
 {
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
@@ -1088,13 +1320,15 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     }
 
     // send thread initialize
-    res = CAQueueingThreadInitialize(&g_sendThread, g_threadPoolHandle,
-                                     CASendThreadProcess, CADestroyData);
+    res = CAQueueingThreadInitializeLockFree(&g_sendThread, g_threadPoolHandle,
+                                             CASendThreadProcess, CADestroyData,
+                                             CA_MESSAGE_QUEUE_CAPACITY);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize send queue thread");
         return res;
     }
+    g_sendThread.depthMetric = OC_METRIC_CA_SEND_QUEUE_DEPTH;
 
     // start send thread
     res = CAQueueingThreadStart(&g_sendThread);
@@ -1105,13 +1339,15 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     }
 
     // receive thread initialize
-    res = CAQueueingThreadInitialize(&g_receiveThread, g_threadPoolHandle,
-                                     CAReceiveThreadProcess, CADestroyData);
+    res = CAQueueingThreadInitializeLockFree(&g_receiveThread, g_threadPoolHandle,
+                                             CAReceiveThreadProcess, CADestroyData,
+                                             CA_MESSAGE_QUEUE_CAPACITY);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize receive queue thread");
         return res;
     }
+    g_receiveThread.depthMetric = OC_METRIC_CA_RECEIVE_QUEUE_DEPTH;
 
 #ifndef SINGLE_HANDLE // This will be enabled when RI supports multi threading
     // start receive thread
@@ -1123,6 +1359,13 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     }
 #endif // SINGLE_HANDLE
 
+    res = CAInitializeReceiveWorkers();
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "thread start error(receive workers).");
+        return res;
+    }
+
     // retransmission initialize
     res = CARetransmissionInitialize(&g_retransmissionContext, g_threadPoolHandle,
                                      CASendUnicastData, CATimeoutCallback, NULL);
@@ -1209,6 +1452,7 @@ void CATerminateMessageHandler()
         CAQueueingThreadStop(&g_receiveThread);
 #endif
     }
+    CAStopReceiveWorkers();
 
     // destroy thread pool
     if (NULL != g_threadPoolHandle)
@@ -1223,6 +1467,7 @@ void CATerminateMessageHandler()
     CARetransmissionDestroy(&g_retransmissionContext);
     CAQueueingThreadDestroy(&g_sendThread);
     CAQueueingThreadDestroy(&g_receiveThread);
+    CADestroyReceiveWorkers();
 
     // terminate interface adapters by controller
     CATerminateAdapters();
@@ -1305,7 +1550,7 @@ void CAErrorHandler(const CAEndpoint_t *endpoint,
 
     cadata->errorInfo->result = result;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(cadata);
     coap_delete_pdu(pdu);
 #else
     (void)result;
@@ -1358,7 +1603,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     cadata->errorInfo = errorInfo;
     cadata->dataType = CA_ERROR_DATA;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(cadata);
 #endif
     OIC_LOG(DEBUG, TAG, "CASendErrorInfo OUT");
 }
@@ -48,6 +48,7 @@
 
 #define CA_PDU_MIN_SIZE (4)
 #define CA_ENCODE_BUFFER_SIZE (4)
+#define CA_PDU_MAX_OPTIONS (32)
 
 static const char COAP_URI_HEADER[] = "coap://[::]/";
 
@@ -252,6 +253,418 @@ exit:
     return NULL;
 }
 
+/**
+ * An option collected by CAGeneratePDUToBuffer before it is encoded.
+ * Unsigned and short-lived values are kept in @p inlineData, everything
+ * else refers to the caller's data.
+ */
+typedef struct
+{
+    uint16_t key;
+    uint16_t length;
+    const uint8_t *value;
+    uint8_t inlineData[CA_ENCODE_BUFFER_SIZE];
+} CAPendingOption_t;
+
+typedef struct
+{
+    CAPendingOption_t options[CA_PDU_MAX_OPTIONS];
+    size_t count;
+} CAPendingOptionList_t;
+
+static bool CAAddPendingOption(CAPendingOptionList_t *list, uint16_t key,
+                               const uint8_t *data, size_t length, bool copyValue)
+{
+    if (CA_PDU_MAX_OPTIONS <= list->count || UINT16_MAX < length)
+    {
+        OIC_LOG(DEBUG, TAG, "too many options for the pdu buffer");
+        return false;
+    }
+
+    CAPendingOption_t *option = &list->options[list->count];
+    option->key = key;
+
+    // same shrinking as CACreateNewOptionNode.
+    coap_option_def_t *def = coap_opt_def(key);
+    if (NULL != def && coap_is_var_bytes(def))
+    {
+        if (length > def->max)
+        {
+            data = &(data[length - def->max]);
+            length = def->max;
+        }
+        option->length = (uint16_t) coap_encode_var_bytes(option->inlineData,
+                coap_decode_var_bytes((unsigned char *) data, (unsigned int) length));
+        option->value = option->inlineData;
+    }
+    else if (copyValue)
+    {
+        if (sizeof(option->inlineData) < length)
+        {
+            return false;
+        }
+        memcpy(option->inlineData, data, length);
+        option->length = (uint16_t) length;
+        option->value = option->inlineData;
+    }
+    else
+    {
+        option->length = (uint16_t) length;
+        option->value = data;
+    }
+
+    list->count++;
+    return true;
+}
+
+static bool CAAddPendingUriOptions(CAPendingOptionList_t *list, const unsigned char *str,
+                                   size_t length, uint16_t target,
+                                   unsigned char *buf, size_t bufLength)
+{
+    int res = (COAP_OPTION_URI_PATH == target) ? coap_split_path(str, length, buf, &bufLength) :
+                                                 coap_split_query(str, length, buf, &bufLength);
+    if (0 >= res)
+    {
+        OIC_LOG_V(ERROR, TAG, "Problem parsing URI : %d for %d", res, target);
+        return false;
+    }
+
+    size_t prevIdx = 0;
+    while (res--)
+    {
+        if (!CAAddPendingOption(list, target, COAP_OPT_VALUE(buf), COAP_OPT_LENGTH(buf), false))
+        {
+            return false;
+        }
+
+        size_t optSize = COAP_OPT_SIZE(buf);
+        if ((prevIdx + optSize) < bufLength)
+        {
+            buf += optSize;
+            prevIdx += optSize;
+        }
+    }
+    return true;
+}
+
+static bool CAAddPendingFormatOptions(CAPendingOptionList_t *list, CAPayloadFormat_t format,
+                                      uint16_t formatOption, uint16_t versionOption,
+                                      uint16_t version)
+{
+    uint8_t buf[CA_ENCODE_BUFFER_SIZE] = { 0 };
+
+    switch (format)
+    {
+        case CA_FORMAT_APPLICATION_CBOR:
+            return CAAddPendingOption(list, formatOption, buf,
+                    coap_encode_var_bytes(buf, (unsigned short) COAP_MEDIATYPE_APPLICATION_CBOR),
+                    true);
+        case CA_FORMAT_APPLICATION_VND_OCF_CBOR:
+            if (!CAAddPendingOption(list, formatOption, buf,
+                    coap_encode_var_bytes(buf,
+                            (unsigned short) COAP_MEDIATYPE_APPLICATION_VND_OCF_CBOR), true))
+            {
+                return false;
+            }
+            return CAAddPendingOption(list, versionOption, buf,
+                                      coap_encode_var_bytes(buf, version), true);
+        default:
+            OIC_LOG_V(ERROR, TAG, "Format option:[%d] not supported", format);
+            return false;
+    }
+}
+
+static bool CACollectPendingOptions(const CAInfo_t *info, CAPendingOptionList_t *list,
+                                    unsigned char *pathBuf, unsigned char *queryBuf)
+{
+    if (info->resourceUri)
+    {
+        size_t length = strlen(info->resourceUri);
+        if (CA_MAX_URI_LENGTH < length)
+        {
+            OIC_LOG(ERROR, TAG, "URI len err");
+            return false;
+        }
+
+        char coapUri[sizeof(COAP_URI_HEADER) + CA_MAX_URI_LENGTH];
+        memcpy(coapUri, COAP_URI_HEADER, sizeof(COAP_URI_HEADER) - 1);
+        memcpy(coapUri + sizeof(COAP_URI_HEADER) - 1, info->resourceUri, length + 1);
+
+        coap_uri_t uri;
+        coap_split_uri((unsigned char *) coapUri, strlen(coapUri), &uri);
+
+        if (uri.port != COAP_DEFAULT_PORT)
+        {
+            unsigned char portbuf[CA_ENCODE_BUFFER_SIZE] = { 0 };
+            if (!CAAddPendingOption(list, COAP_OPTION_URI_PORT, portbuf,
+                                    coap_encode_var_bytes(portbuf, uri.port), true))
+            {
+                return false;
+            }
+        }
+
+        if (uri.path.s && uri.path.length
+            && !CAAddPendingUriOptions(list, uri.path.s, uri.path.length,
+                                       COAP_OPTION_URI_PATH, pathBuf, CA_MAX_URI_LENGTH))
+        {
+            return false;
+        }
+
+        if (uri.query.s && uri.query.length
+            && !CAAddPendingUriOptions(list, uri.query.s, uri.query.length,
+                                       COAP_OPTION_URI_QUERY, queryBuf, CA_MAX_URI_LENGTH))
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < info->numOptions; i++)
+    {
+        const CAHeaderOption_t *option = info->options + i;
+        if (COAP_OPTION_URI_PATH == option->optionID || COAP_OPTION_URI_QUERY == option->optionID)
+        {
+            continue;
+        }
+        if (sizeof(option->optionData) < option->optionLength
+            || !CAAddPendingOption(list, option->optionID,
+                                   (const uint8_t *) option->optionData, option->optionLength,
+                                   false))
+        {
+            return false;
+        }
+    }
+
+    if (CA_FORMAT_UNDEFINED != info->payloadFormat
+        && !CAAddPendingFormatOptions(list, info->payloadFormat, COAP_OPTION_CONTENT_FORMAT,
+                                      COAP_OPTION_CONTENT_VERSION, info->payloadVersion))
+    {
+        return false;
+    }
+
+    if (CA_FORMAT_UNDEFINED != info->acceptFormat
+        && !CAAddPendingFormatOptions(list, info->acceptFormat, COAP_OPTION_ACCEPT,
+                                      COAP_OPTION_ACCEPT_VERSION, info->acceptVersion))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+CAResult_t CAGeneratePDUToBuffer(uint32_t code, const CAInfo_t *info,
+                                 uint8_t *buffer, size_t bufferSize, size_t *outLength)
+{
+    VERIFY_NON_NULL(info, TAG, "info");
+    VERIFY_NON_NULL(buffer, TAG, "buffer");
+    VERIFY_NON_NULL(outLength, TAG, "outLength");
+
+    CAPendingOptionList_t list;
+    list.count = 0;
+    unsigned char pathBuf[CA_MAX_URI_LENGTH];
+    unsigned char queryBuf[CA_MAX_URI_LENGTH];
+
+    // RESET have to use only 4byte (empty message)
+    // and ACKNOWLEDGE can use empty message when code is empty.
+    if (CA_MSG_RESET == info->type || (CA_EMPTY == code && CA_MSG_ACKNOWLEDGE == info->type))
+    {
+        if (CA_EMPTY != code)
+        {
+            OIC_LOG(ERROR, TAG, "reset is not empty message");
+            return CA_STATUS_INVALID_PARAM;
+        }
+
+        if (info->payloadSize > 0 || info->payload || info->token || info->tokenLength > 0)
+        {
+            OIC_LOG(ERROR, TAG, "Empty message has unnecessary data after messageID");
+            return CA_STATUS_INVALID_PARAM;
+        }
+    }
+    else if (!CACollectPendingOptions(info, &list, pathBuf, queryBuf))
+    {
+        return CA_STATUS_FAILED;
+    }
+
+    uint8_t tokenLength = (info->token && CA_EMPTY != code) ? info->tokenLength : 0;
+    if (CA_MAX_TOKEN_LEN < tokenLength || bufferSize < CA_PDU_MIN_SIZE + (size_t) tokenLength)
+    {
+        return CA_STATUS_FAILED;
+    }
+
+    uint16_t messageId = info->messageId;
+    if (0 == messageId)
+    {
+        /* initialize message id */
+        prng((uint8_t *) &messageId, sizeof(messageId));
+    }
+
+    buffer[0] = (uint8_t) ((COAP_DEFAULT_VERSION << 6) | ((info->type & 0x03) << 4) | tokenLength);
+    buffer[1] = (uint8_t) COAP_RESPONSE_CODE(code);
+    // the message id is kept in the same byte order as coap_hdr_udp_t::id.
+    memcpy(buffer + 2, &messageId, sizeof(messageId));
+    if (tokenLength)
+    {
+        memcpy(buffer + CA_PDU_MIN_SIZE, info->token, tokenLength);
+    }
+    size_t length = CA_PDU_MIN_SIZE + tokenLength;
+
+    // stable insertion sort by option number, the order coap_insert gives the option list.
+    uint8_t order[CA_PDU_MAX_OPTIONS];
+    for (size_t i = 0; i < list.count; i++)
+    {
+        size_t j = i;
+        while (j > 0 && list.options[order[j - 1]].key > list.options[i].key)
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t) i;
+    }
+
+    uint16_t prevKey = 0;
+    for (size_t i = 0; i < list.count; i++)
+    {
+        const CAPendingOption_t *option = &list.options[order[i]];
+        size_t optSize = coap_opt_encode(buffer + length, bufferSize - length,
+                                         option->key - prevKey, option->value, option->length);
+        if (0 == optSize)
+        {
+            OIC_LOG(DEBUG, TAG, "options do not fit into the pdu buffer");
+            return CA_STATUS_FAILED;
+        }
+        length += optSize;
+        prevKey = option->key;
+    }
+
+    if (info->payload && 0 < info->payloadSize)
+    {
+        if (bufferSize - length < info->payloadSize + PAYLOAD_MARKER)
+        {
+            OIC_LOG(DEBUG, TAG, "payload does not fit into the pdu buffer");
+            return CA_STATUS_FAILED;
+        }
+        buffer[length++] = COAP_PAYLOAD_START;
+        memcpy(buffer + length, info->payload, info->payloadSize);
+        length += info->payloadSize;
+    }
+
+    *outLength = length;
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAParsePDUView(const uint8_t *data, size_t length, CAPDUView_t *outView)
+{
+    VERIFY_NON_NULL(data, TAG, "data");
+    VERIFY_NON_NULL(outView, TAG, "outView");
+
+    if (CA_PDU_MIN_SIZE > length)
+    {
+        OIC_LOG(ERROR, TAG, "pdu is too short");
+        return CA_STATUS_FAILED;
+    }
+
+    uint8_t version = data[0] >> 6;
+    uint8_t tokenLength = data[0] & 0x0F;
+    if (COAP_DEFAULT_VERSION != version)
+    {
+        OIC_LOG_V(ERROR, TAG, "coap version is not available : %d", version);
+        return CA_STATUS_FAILED;
+    }
+    if (CA_MAX_TOKEN_LEN < tokenLength || length < CA_PDU_MIN_SIZE + (size_t) tokenLength)
+    {
+        OIC_LOG_V(ERROR, TAG, "token length has been exceed : %d", tokenLength);
+        return CA_STATUS_FAILED;
+    }
+
+    memset(outView, 0, sizeof(*outView));
+    outView->type = (CAMessageType_t) ((data[0] >> 4) & 0x03);
+    outView->code = (uint32_t) CA_RESPONSE_CODE(data[1]);
+    memcpy(&outView->messageId, data + 2, sizeof(outView->messageId));
+    if (tokenLength)
+    {
+        outView->token = data + CA_PDU_MIN_SIZE;
+        outView->tokenLength = tokenLength;
+    }
+
+    const uint8_t *opt = data + CA_PDU_MIN_SIZE + tokenLength;
+    const uint8_t *end = data + length;
+    outView->options = opt;
+
+    uint32_t key = 0;
+    while (opt < end && COAP_PAYLOAD_START != *opt)
+    {
+        coap_option_t option;
+        size_t optSize = coap_opt_parse((const coap_opt_t *) opt, (size_t) (end - opt), &option);
+        // option is not filled in when parsing fails.
+        if (0 == optSize)
+        {
+            OIC_LOG(ERROR, TAG, "pdu has a malformed option");
+            return CA_STATUS_FAILED;
+        }
+        key += option.delta;
+        if (UINT16_MAX < key)
+        {
+            OIC_LOG(ERROR, TAG, "pdu has a malformed option");
+            return CA_STATUS_FAILED;
+        }
+        opt += optSize;
+        outView->numOptions++;
+    }
+    outView->optionsLength = (size_t) (opt - outView->options);
+
+    if (opt < end)
+    {
+        // a payload marker must be followed by a payload.
+        if (end - opt < 2)
+        {
+            OIC_LOG(ERROR, TAG, "payload marker without payload");
+            return CA_STATUS_FAILED;
+        }
+        outView->payload = opt + 1;
+        outView->payloadSize = (size_t) (end - opt - 1);
+    }
+
+    return CA_STATUS_OK;
+}
+
+void CAInitOptionIterator(const CAPDUView_t *view, CAOptionIterator_t *iter)
+{
+    VERIFY_NON_NULL_VOID(view, TAG, "view");
+    VERIFY_NON_NULL_VOID(iter, TAG, "iter");
+
+    iter->next = view->options;
+    iter->end = view->options + view->optionsLength;
+    iter->key = 0;
+}
+
+bool CAGetNextOption(CAOptionIterator_t *iter, CAOptionView_t *outOption)
+{
+    VERIFY_NON_NULL_RET(iter, TAG, "iter", false);
+    VERIFY_NON_NULL_RET(outOption, TAG, "outOption", false);
+
+    if (!iter->next || iter->next >= iter->end)
+    {
+        return false;
+    }
+
+    // the options were validated by CAParsePDUView.
+    coap_option_t option;
+    size_t optSize = coap_opt_parse((const coap_opt_t *) iter->next,
+                                    (size_t) (iter->end - iter->next), &option);
+    if (0 == optSize)
+    {
+        iter->next = iter->end;
+        return false;
+    }
+
+    iter->key = (uint16_t) (iter->key + option.delta);
+    iter->next += optSize;
+
+    outOption->key = iter->key;
+    outOption->length = (uint16_t) option.length;
+    outOption->value = option.value;
+    return true;
+}
+
 coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
                               const CAEndpoint_t *endpoint, coap_list_t *options,
                               coap_transport_t *transport)
@@ -566,7 +979,7 @@ CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **
 
     if (CA_FORMAT_UNDEFINED != info->acceptFormat)
     {
-        CAParsePayloadFormatHeadOption(info->acceptFormat, COAP_OPTION_ACCEPT, info->acceptVersion, COAP_OPTION_ACCEPT_VERSION, optlist);
+        CAParsePayloadFormatHeadOption(info->acceptFormat, COAP_OPTION_ACCEPT, COAP_OPTION_ACCEPT_VERSION, info->acceptVersion, optlist);
     }
 
     return CA_STATUS_OK;
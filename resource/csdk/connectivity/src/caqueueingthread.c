@@ -31,10 +31,83 @@
 
 #include "caqueueingthread.h"
 #include "oic_malloc.h"
+#include "ocatomic.h"
 #include "logger.h"
 
 #define TAG PCF("OIC_CA_QING")
 
+/** Number of data taken from the lock-free que at once. **/
+#define CA_QUEUEING_THREAD_BATCH_SIZE 16
+
+static void CAQueueingThreadProcessData(CAQueueingThread_t *thread, void *msg, uint32_t size)
+{
+    OCMetricAdd(thread->depthMetric, -1);
+
+    // process data
+    thread->threadTask(msg);
+
+    // free
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(msg, size);
+    }
+    else
+    {
+        OICFree(msg);
+    }
+}
+
+static void CAQueueingThreadLockFreeRoutine(CAQueueingThread_t *thread)
+{
+    u_queue_message_t messages[CA_QUEUEING_THREAD_BATCH_SIZE];
+
+    while (!thread->isStop)
+    {
+        uint32_t count = u_mpsc_queue_get_elements(thread->ringQueue, messages,
+                                                   CA_QUEUEING_THREAD_BATCH_SIZE);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            CAQueueingThreadProcessData(thread, messages[i].msg, messages[i].size);
+        }
+
+        if (0 < count)
+        {
+            continue;
+        }
+
+        // lock-free que is empty, take data that overflowed it or wait.
+        oc_mutex_lock(thread->threadMutex);
+
+        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        if (NULL == message && !thread->isStop)
+        {
+            // producers check isIdle after publishing, so either they see it
+            // set and signal under the mutex, or we see their data here.
+            oc_atomic_store(&thread->isIdle, 1);
+            if (u_mpsc_queue_is_empty(thread->ringQueue))
+            {
+                OIC_LOG(DEBUG, TAG, "wait..");
+
+                // wait
+                oc_cond_wait(thread->threadCond, thread->threadMutex);
+
+                OIC_LOG(DEBUG, TAG, "wake up..");
+            }
+            oc_atomic_store(&thread->isIdle, 0);
+        }
+
+        // mutex unlock
+        oc_mutex_unlock(thread->threadMutex);
+
+        if (NULL != message)
+        {
+            oc_atomic_decrement(&thread->overflowCount);
+            CAQueueingThreadProcessData(thread, message->msg, message->size);
+            OICFree(message);
+        }
+    }
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -47,6 +120,11 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    if (NULL != thread->ringQueue)
+    {
+        CAQueueingThreadLockFreeRoutine(thread);
+    }
+
     while (!thread->isStop)
     {
         // mutex lock
@@ -80,19 +158,7 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
             continue;
         }
 
-        // process data
-        thread->threadTask(message->msg);
-
-        // free
-        if (NULL != thread->destroy)
-        {
-            thread->destroy(message->msg, message->size);
-        }
-        else
-        {
-            OICFree(message->msg);
-        }
-
+        CAQueueingThreadProcessData(thread, message->msg, message->size);
         OICFree(message);
     }
 
@@ -128,6 +194,10 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->ringQueue = NULL;
+    thread->overflowCount = 0;
+    thread->isIdle = 0;
+    thread->depthMetric = OC_METRIC_COUNT;
     if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
@@ -154,6 +224,29 @@ ERROR_MEM_FAILURE:
     return CA_MEMORY_ALLOC_FAILED;
 }
 
+CAResult_t CAQueueingThreadInitializeLockFree(CAQueueingThread_t *thread,
+                                              ca_thread_pool_t handle,
+                                              CAThreadTask task,
+                                              CADataDestroyFunction destroy,
+                                              uint32_t capacity)
+{
+    CAResult_t res = CAQueueingThreadInitialize(thread, handle, task, destroy);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+
+    thread->ringQueue = u_mpsc_queue_create(capacity);
+    if (NULL == thread->ringQueue)
+    {
+        OIC_LOG(ERROR, TAG, "lock-free queue create error");
+        CAQueueingThreadDestroy(thread);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -209,12 +302,31 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
+    // counted before the data is visible, so the gauge never goes below zero.
+    OCMetricAdd(thread->depthMetric, 1);
+
+    // keep FIFO order: once data overflowed to dataQueue, the thread drains
+    // the lock-free que before it, so later data must follow it there.
+    if (NULL != thread->ringQueue && 0 == oc_atomic_load(&thread->overflowCount)
+        && u_mpsc_queue_add_element(thread->ringQueue, data, size))
+    {
+        if (oc_atomic_load(&thread->isIdle))
+        {
+            // notify the thread
+            oc_mutex_lock(thread->threadMutex);
+            oc_cond_signal(thread->threadCond);
+            oc_mutex_unlock(thread->threadMutex);
+        }
+        return CA_STATUS_OK;
+    }
+
     // create thread data
     u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
 
     if (NULL == message)
     {
         OIC_LOG(ERROR, TAG, "memory error!!");
+        OCMetricAdd(thread->depthMetric, -1);
         return CA_MEMORY_ALLOC_FAILED;
     }
 
@@ -226,6 +338,10 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
 
     // add thread data into list
     u_queue_add_element(thread->dataQueue, message);
+    if (NULL != thread->ringQueue)
+    {
+        oc_atomic_increment(&thread->overflowCount);
+    }
 
     // notity the thread
     oc_cond_signal(thread->threadCond);
@@ -236,6 +352,44 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
     return CA_STATUS_OK;
 }
 
+bool CAQueueingThreadGetData(CAQueueingThread_t *thread, u_queue_message_t *message)
+{
+    if (NULL == thread || NULL == message)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return false;
+    }
+
+    if (NULL != thread->ringQueue && 1 == u_mpsc_queue_get_elements(thread->ringQueue, message, 1))
+    {
+        OCMetricAdd(thread->depthMetric, -1);
+        return true;
+    }
+
+    // mutex lock
+    oc_mutex_lock(thread->threadMutex);
+
+    u_queue_message_t *item = u_queue_get_element(thread->dataQueue);
+
+    // mutex unlock
+    oc_mutex_unlock(thread->threadMutex);
+
+    if (NULL == item)
+    {
+        return false;
+    }
+
+    if (NULL != thread->ringQueue)
+    {
+        oc_atomic_decrement(&thread->overflowCount);
+    }
+
+    OCMetricAdd(thread->depthMetric, -1);
+    *message = *item;
+    OICFree(item);
+    return true;
+}
+
 CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -249,6 +403,32 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
     // mutex lock
     oc_mutex_lock(thread->threadMutex);
 
+    // remove all remained lock-free que data, it is older than the list data.
+    if (NULL != thread->ringQueue)
+    {
+        u_queue_message_t messages[CA_QUEUEING_THREAD_BATCH_SIZE];
+        uint32_t count = 0;
+        while (0 < (count = u_mpsc_queue_get_elements(thread->ringQueue, messages,
+                                                      CA_QUEUEING_THREAD_BATCH_SIZE)))
+        {
+            OCMetricAdd(thread->depthMetric, -(int64_t)count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (NULL != thread->destroy)
+                {
+                    thread->destroy(messages[i].msg, messages[i].size);
+                }
+                else
+                {
+                    OICFree(messages[i].msg);
+                }
+            }
+        }
+
+        u_mpsc_queue_delete(thread->ringQueue);
+        thread->ringQueue = NULL;
+    }
+
     // remove all remained list data.
     while (u_queue_get_size(thread->dataQueue) > 0)
     {
@@ -258,6 +438,7 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
         // free
         if (NULL != message)
         {
+            OCMetricAdd(thread->depthMetric, -1);
             if (NULL != thread->destroy)
             {
                 thread->destroy(message->msg, message->size);
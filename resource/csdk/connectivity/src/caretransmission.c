@@ -75,23 +75,67 @@
 #include "oic_time.h"
 #include "ocrandom.h"
 #include "logger.h"
+#include "ocmetrics.h"
+#include <coap/utlist.h>
+#include <coap/uthash.h>
 
 #define TAG "OIC_CA_RETRANS"
 
+/**
+ * Pending data is kept on a two level timer wheel.  Level 0 has one slot per
+ * tick, level 1 has one slot per RETRANSMISSION_WHEEL_L0_SLOTS ticks and is
+ * cascaded into level 0 as the wheel turns.  Deadlines beyond the wheel are
+ * parked in the farthest level 1 slot and re-cascaded until they fit.
+ */
+#ifndef SINGLE_THREAD
+#define RETRANSMISSION_WHEEL_TICK_USEC      (10 * 1000)
+#define RETRANSMISSION_WHEEL_L0_BITS        8
+#define RETRANSMISSION_WHEEL_L1_BITS        6
+#else
+#define RETRANSMISSION_WHEEL_TICK_USEC      (100 * 1000)
+#define RETRANSMISSION_WHEEL_L0_BITS        4
+#define RETRANSMISSION_WHEEL_L1_BITS        2
+#endif
+
+#define RETRANSMISSION_WHEEL_L0_SLOTS       (1 << RETRANSMISSION_WHEEL_L0_BITS)
+#define RETRANSMISSION_WHEEL_L1_SLOTS       (1 << RETRANSMISSION_WHEEL_L1_BITS)
+#define RETRANSMISSION_WHEEL_L0_MASK        (RETRANSMISSION_WHEEL_L0_SLOTS - 1)
+#define RETRANSMISSION_WHEEL_L1_MASK        (RETRANSMISSION_WHEEL_L1_SLOTS - 1)
+
 typedef struct
+{
+    uint16_t messageId;                 /**< coap PDU message id */
+    CATransportAdapter_t adapter;       /**< adapter the PDU was sent on */
+} CARetransmissionKey_t;
+
+typedef struct CARetransmissionData
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
+    uint64_t deadline;                  /**< next retransmission time. microseconds */
     uint8_t triedCount;                 /**< retransmission count */
     uint16_t messageId;                 /**< coap PDU message id */
     CADataType_t dataType;              /**< data Type (Request/Response) */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
+    CARetransmissionKey_t key;          /**< message ID index key */
+    struct CARetransmissionData **slot; /**< timer wheel slot holding this data */
+    struct CARetransmissionData *prev;  /**< previous data in the same slot */
+    struct CARetransmissionData *next;  /**< next data in the same slot */
+    UT_hash_handle hh;                  /**< message ID index handle */
 } CARetransmissionData_t;
 
+struct CARetransmissionQueue
+{
+    uint64_t currentTick;                                           /**< next tick to expire */
+    CARetransmissionData_t *level0[RETRANSMISSION_WHEEL_L0_SLOTS];  /**< one slot per tick */
+    CARetransmissionData_t *level1[RETRANSMISSION_WHEEL_L1_SLOTS];  /**< one slot per level 0 turn */
+    CARetransmissionData_t *index;                                  /**< data by message ID */
+};
+
 static const uint64_t USECS_PER_SEC = 1000000;
 static const uint64_t USECS_PER_MSEC = 1000;
 static const uint64_t MSECS_PER_SEC = 1000;
@@ -144,38 +188,193 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the next retransmission time
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  absolute deadline in microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetRetransmissionDeadline(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint64_t milliTimeoutValue = retData->timeout / USECS_PER_MSEC;
-    uint64_t timeout = (milliTimeoutValue << retData->triedCount) * USECS_PER_MSEC;
+    return retData->timeStamp + (milliTimeoutValue << retData->triedCount) * USECS_PER_MSEC;
+#else
+    return retData->timeStamp + (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+#endif
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static void CAFreeRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
+}
+
+/**
+ * @brief   place data on the timer wheel slot matching its deadline
+ * @param   queue           [IN]retransmission queue
+ * @param   retData         [IN]retransmission data with deadline set
+ */
+static void CAScheduleRetransmission(CARetransmissionQueue_t *queue,
+                                     CARetransmissionData_t *retData)
+{
+    uint64_t tick = (retData->deadline + RETRANSMISSION_WHEEL_TICK_USEC - 1)
+                    / RETRANSMISSION_WHEEL_TICK_USEC;
+    if (tick < queue->currentTick)
     {
-        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-        return true;
+        tick = queue->currentTick;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
 
-    if (currentTime >= retData->timeStamp + timeOut)
+    uint64_t delta = tick - queue->currentTick;
+    if (delta < RETRANSMISSION_WHEEL_L0_SLOTS)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        retData->slot = &queue->level0[tick & RETRANSMISSION_WHEEL_L0_MASK];
     }
-#endif
+    else
+    {
+        if (delta >= (uint64_t) RETRANSMISSION_WHEEL_L0_SLOTS * RETRANSMISSION_WHEEL_L1_SLOTS)
+        {
+            tick = queue->currentTick
+                   + (uint64_t) RETRANSMISSION_WHEEL_L0_SLOTS * (RETRANSMISSION_WHEEL_L1_SLOTS - 1);
+        }
+        retData->slot = &queue->level1[(tick >> RETRANSMISSION_WHEEL_L0_BITS)
+                                       & RETRANSMISSION_WHEEL_L1_MASK];
+    }
+    DL_APPEND(*retData->slot, retData);
+}
+
+static void CAUnscheduleRetransmission(CARetransmissionData_t *retData)
+{
+    DL_DELETE(*retData->slot, retData);
+    retData->slot = NULL;
+}
+
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    if (retData->slot)
+    {
+        CAUnscheduleRetransmission(retData);
+    }
+    HASH_DELETE(hh, context->queue->index, retData);
+    context->pendingCount--;
+    OCMetricAdd(OC_METRIC_CA_RETRANSMISSIONS_PENDING, -1);
+}
+
+/**
+ * @brief   earliest deadline held by a single slot
+ */
+static uint64_t CAGetSlotDeadline(const CARetransmissionData_t *head)
+{
+    uint64_t deadline = UINT64_MAX;
+    const CARetransmissionData_t *retData = NULL;
+    DL_FOREACH(head, retData)
+    {
+        if (retData->deadline < deadline)
+        {
+            deadline = retData->deadline;
+        }
+    }
+    return deadline;
+}
+
+/**
+ * @brief   find the earliest pending deadline
+ * @param   queue           [IN]retransmission queue
+ * @param   deadline        [OUT]microseconds
+ * @return  false if nothing is pending
+ */
+static bool CAGetNextRetransmissionDeadline(const CARetransmissionQueue_t *queue,
+                                            uint64_t *deadline)
+{
+    uint64_t block = queue->currentTick >> RETRANSMISSION_WHEEL_L0_BITS;
+
+    for (size_t i = 0; i < RETRANSMISSION_WHEEL_L0_SLOTS; i++)
+    {
+        const CARetransmissionData_t *head =
+            queue->level0[(queue->currentTick + i) & RETRANSMISSION_WHEEL_L0_MASK];
+        if (head)
+        {
+            // level 0 spans into the next block, whose level 1 slot may still
+            // hold earlier deadlines that were scheduled before the wheel turned.
+            uint64_t nextBlock = CAGetSlotDeadline(
+                queue->level1[(block + 1) & RETRANSMISSION_WHEEL_L1_MASK]);
+            *deadline = CAGetSlotDeadline(head);
+            if (nextBlock < *deadline)
+            {
+                *deadline = nextBlock;
+            }
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i <= RETRANSMISSION_WHEEL_L1_SLOTS; i++)
+    {
+        const CARetransmissionData_t *head =
+            queue->level1[(block + i) & RETRANSMISSION_WHEEL_L1_MASK];
+        if (head)
+        {
+            *deadline = CAGetSlotDeadline(head);
+            return true;
+        }
+    }
+
     return false;
 }
 
+/**
+ * @brief   resend data whose deadline has passed
+ * @param   context         [IN]retransmission context
+ * @param   retData         [IN]retransmission data, already off the wheel
+ * @param   currentTime     [IN]microseconds
+ */
+static void CAExpireRetransmission(CARetransmission_t *context,
+                                   CARetransmissionData_t *retData,
+                                   uint64_t currentTime)
+{
+#ifndef SINGLE_THREAD
+    OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
+              retData->deadline - retData->timeStamp, retData->triedCount);
+#else
+    OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
+              (2 << retData->triedCount), retData->triedCount);
+#endif
+
+    // #1. time's up, send the data.
+    if (NULL != context->dataSendMethod)
+    {
+        OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
+                  retData->messageId);
+        context->dataSendMethod(retData->endpoint, retData->pdu,
+                                retData->size, retData->dataType);
+        OCMetricAdd(OC_METRIC_CA_RETRANSMISSIONS, 1);
+    }
+
+    // #2. increase the retransmission count and update timestamp.
+    retData->timeStamp = currentTime;
+    retData->triedCount++;
+
+    // #3. if tried count is max, remove the retransmission data.
+    if (retData->triedCount >= context->config.tryingCount)
+    {
+        CARemoveRetransmissionData(context, retData);
+        OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
+                  "msgid=%d", retData->messageId);
+        OCMetricAdd(OC_METRIC_CA_RETRANSMISSION_TIMEOUTS, 1);
+
+        // callback for retransmit timeout
+        if (NULL != context->timeoutCallback)
+        {
+            context->timeoutCallback(retData->endpoint, retData->pdu, retData->size);
+        }
+
+        CAFreeRetransmissionData(retData);
+        return;
+    }
+
+    retData->deadline = CAGetRetransmissionDeadline(retData);
+    CAScheduleRetransmission(context->queue, retData);
+}
+
 static void CACheckRetransmissionList(CARetransmission_t *context)
 {
     if (NULL == context)
@@ -187,64 +386,50 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
+    CARetransmissionQueue_t *queue = context->queue;
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+    uint64_t currentTick = (currentTime + RETRANSMISSION_WHEEL_TICK_USEC - 1)
+                           / RETRANSMISSION_WHEEL_TICK_USEC;
 
-    for (size_t i = 0; i < len; i++)
+    while (0 < context->pendingCount && queue->currentTick <= currentTick)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        size_t slot = queue->currentTick & RETRANSMISSION_WHEEL_L0_MASK;
+        CARetransmissionData_t *retData = NULL;
+        CARetransmissionData_t *tmp = NULL;
 
-        if (NULL == retData)
+        // #1. on each turn of level 0, cascade the matching level 1 slot.
+        if (0 == slot)
         {
-            continue;
-        }
-
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
-
-        if (CACheckTimeout(currentTime, retData))
-        {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
+            CARetransmissionData_t **upper = &queue->level1[
+                (queue->currentTick >> RETRANSMISSION_WHEEL_L0_BITS)
+                & RETRANSMISSION_WHEEL_L1_MASK];
+            CARetransmissionData_t *cascade = *upper;
+            *upper = NULL;
+            DL_FOREACH_SAFE(cascade, retData, tmp)
             {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu,
-                                        retData->size, retData->dataType);
+                DL_DELETE(cascade, retData);
+                CAScheduleRetransmission(queue, retData);
             }
-
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
         }
 
-        // #4. if tried count is max, remove the retransmission data from list.
-        if (retData->triedCount >= context->config.tryingCount)
+        // #2. take the slot off the wheel before handling it, so data
+        // rescheduled below lands in a later slot.
+        CARetransmissionData_t *expired = queue->level0[slot];
+        queue->level0[slot] = NULL;
+        queue->currentTick++;
+
+        DL_FOREACH_SAFE(expired, retData, tmp)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            DL_DELETE(expired, retData);
+            retData->slot = NULL;
+            if (retData->deadline > currentTime)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
-                return;
+                CAScheduleRetransmission(queue, retData);
             }
-            OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
-
-            // callback for retransmit timeout
-            if (NULL != context->timeoutCallback)
+            else
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                CAExpireRetransmission(context, retData, currentTime);
             }
-
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
         }
     }
 
@@ -279,9 +464,10 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         oc_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        uint64_t deadline = 0;
+        if (!context->isStop && !CAGetNextRetransmissionDeadline(context->queue, &deadline))
         {
-            // if list is empty, thread will wait
+            // if nothing is pending, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
 
             // wait
@@ -291,13 +477,15 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
-
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            oc_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+            // sleep until the earliest deadline, new data wakes us up early.
+            uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+            if (deadline > currentTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
+                          deadline - currentTime);
+                oc_cond_wait_for(context->threadCond, context->threadMutex,
+                                 deadline - currentTime);
+            }
         }
         else
         {
@@ -355,6 +543,14 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
         cfg = *config;
     }
 
+    CARetransmissionQueue_t *queue = (CARetransmissionQueue_t *) OICCalloc(
+                                         1, sizeof(CARetransmissionQueue_t));
+    if (NULL == queue)
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
     // set send thread data
     context->threadPool = handle;
     context->threadMutex = oc_mutex_new();
@@ -363,7 +559,8 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
+    context->queue = queue;
+    context->pendingCount = 0;
 
     return CA_STATUS_OK;
 }
@@ -433,54 +630,53 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
 #ifndef SINGLE_THREAD
     retData->timeout = CAGetTimeoutValue();
 #endif
+    retData->deadline = CAGetRetransmissionDeadline(retData);
     retData->triedCount = 0;
     retData->messageId = messageId;
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
     retData->dataType = dataType;
-#ifndef SINGLE_THREAD
+    retData->key.messageId = messageId;
+    retData->key.adapter = endpoint->adapter;
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
-
-    // #3. add data into list
-    for (size_t i = 0; i < len; i++)
+    // #3. reject a message ID that is still pending on the same adapter
+    CARetransmissionData_t *currData = NULL;
+    HASH_FIND(hh, context->queue->index, &retData->key, sizeof(retData->key), currData);
+    if (NULL != currData)
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-        if (NULL == currData)
-        {
-            continue;
-        }
-
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
-
-            // mutex unlock
-            oc_mutex_unlock(context->threadMutex);
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
+        CAFreeRetransmissionData(retData);
+        return CA_STATUS_FAILED;
     }
 
-    u_arraylist_add(context->dataList, (void *) retData);
+    // #4. add data into the index and on the wheel. an idle wheel is moved
+    // forward to now rather than turned through the idle period.
+    if (0 == context->pendingCount)
+    {
+        context->queue->currentTick = retData->timeStamp / RETRANSMISSION_WHEEL_TICK_USEC;
+    }
+    HASH_ADD(hh, context->queue->index, key, sizeof(retData->key), retData);
+    CAScheduleRetransmission(context->queue, retData);
+    context->pendingCount++;
+    OCMetricAdd(OC_METRIC_CA_RETRANSMISSIONS_PENDING, 1);
 
+#ifndef SINGLE_THREAD
     // notify the thread
     oc_cond_signal(context->threadCond);
 
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    oc_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -520,80 +716,63 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
         return CA_STATUS_OK;
     }
 
+    CARetransmissionKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.messageId = messageId;
+    key.adapter = endpoint->adapter;
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
 
-    for (size_t i = 0; i < len; i++)
+    CARetransmissionData_t *retData = NULL;
+    HASH_FIND(hh, context->queue->index, &key, sizeof(key), retData);
+    if (NULL == retData)
     {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
-
-        if (NULL == retData)
-        {
-            continue;
-        }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
-            {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
-            }
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return CA_STATUS_OK;
+    }
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+    // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+    // if retransmission was finish..token will be unavailable.
+    if (CA_EMPTY == code)
+    {
+        OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
+        if (NULL == retData->pdu)
+        {
+            OIC_LOG(ERROR, TAG, "retData->pdu is null");
+            // mutex unlock
+            oc_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
-            }
+            return CA_STATUS_FAILED;
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // copy PDU data
+        (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+        if ((*retransmissionPdu) == NULL)
+        {
+            OIC_LOG(ERROR, TAG, "memory error");
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+            // mutex unlock
+            oc_mutex_unlock(context->threadMutex);
 
-            break;
+            return CA_MEMORY_ALLOC_FAILED;
         }
+        memcpy((*retransmissionPdu), retData->pdu, retData->size);
     }
 
+    // #2. remove data from the wheel and the index
+    CARemoveRetransmissionData(context, retData);
+
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
 
+    OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+    CAFreeRetransmissionData(retData);
+
     OIC_LOG(DEBUG, TAG, "OUT");
     return CA_STATUS_OK;
 }
@@ -636,23 +815,23 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     OIC_LOG(DEBUG, TAG, "retransmission context destroy..");
 
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
-    for (size_t i = 0; i < len; i++)
+    if (context->queue)
     {
-        CARetransmissionData_t *data = u_arraylist_get(context->dataList, i);
-        if (NULL == data)
+        CARetransmissionData_t *data = NULL;
+        CARetransmissionData_t *tmp = NULL;
+        HASH_ITER(hh, context->queue->index, data, tmp)
         {
-            continue;
+            CARemoveRetransmissionData(context, data);
+            CAFreeRetransmissionData(data);
         }
-        CAFreeEndpoint(data->endpoint);
-        OICFree(data->pdu);
+        OICFree(context->queue);
+        context->queue = NULL;
     }
     oc_mutex_unlock(context->threadMutex);
 
     oc_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     oc_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
 
     return CA_STATUS_OK;
 }
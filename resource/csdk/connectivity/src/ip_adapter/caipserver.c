@@ -60,6 +60,9 @@
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #endif
+#ifdef WITH_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include <coap/pdu.h>
 #include "caipinterface.h"
@@ -71,6 +74,7 @@
 #include "octhread.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "trace.h"
 
 #define USE_IP_MREQN
 #if defined(_WIN32)
@@ -84,6 +88,11 @@
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#ifdef WITH_EPOLL
+#define EPOLL_MAX_EVENTS 16  // sockets reported per epoll_wait()
+#define RECV_BATCH_SIZE  16  // datagrams read per recvmmsg()
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -145,11 +154,29 @@ static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 static void CAFindReadyMessage();
 #if !defined(WSA_WAIT_EVENT_0)
 static void CASelectReturned(fd_set *readFds, int ret);
+static void CAProcessInterfaceChanges();
 #else
 static void CAEventReturned(CASocketFd_t socket);
 #endif
 
 static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags);
+static CAResult_t CAHandleReceivedPacket(CATransportFlags_t flags,
+                                         const struct sockaddr_storage *srcAddr, int namelen,
+                                         unsigned char *pktinfo,
+                                         char *data, size_t dataLen);
+
+#ifdef WITH_EPOLL
+/**
+ * epoll instance watching the IP sockets, the netlink socket and the shutdown pipe.
+ * -1 if epoll is unavailable, in which case the receive thread falls back to select().
+ */
+static int g_epollFd = -1;
+
+static void CAInitializeEpoll();
+static void CADeInitializeEpoll();
+static void CAEpollFindReadyMessage();
+static CAResult_t CAReceiveMessageBatch(CASocketFd_t fd, CATransportFlags_t flags);
+#endif
 
 static void CAReceiveHandler(void *data)
 {
@@ -186,6 +213,13 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
+#ifdef WITH_EPOLL
+    if (-1 != g_epollFd)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
     fd_set readFds;
     struct timeval timeout;
 
@@ -253,21 +287,7 @@ static void CASelectReturned(fd_set *readFds, int ret)
         else ISSET(m4s, readFds, CA_MULTICAST | CA_IPV4 | CA_SECURE)
         else if ((caglobals.ip.netlinkFd != OC_INVALID_SOCKET) && FD_ISSET(caglobals.ip.netlinkFd, readFds))
         {
-            OIC_LOG_V(DEBUG, TAG, "Netlink event detacted");
-            u_arraylist_t *iflist = CAFindInterfaceChange();
-            if (iflist)
-            {
-                size_t listLength = u_arraylist_length(iflist);
-                for (size_t i = 0; i < listLength; i++)
-                {
-                    CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-                    if (ifitem)
-                    {
-                        CAProcessNewInterface(ifitem);
-                    }
-                }
-                u_arraylist_destroy(iflist);
-            }
+            CAProcessInterfaceChanges();
             break;
         }
         else if (FD_ISSET(caglobals.ip.shutdownFds[0], readFds))
@@ -289,6 +309,135 @@ static void CASelectReturned(fd_set *readFds, int ret)
     }
 }
 
+static void CAProcessInterfaceChanges()
+{
+    OIC_LOG_V(DEBUG, TAG, "Netlink event detacted");
+    u_arraylist_t *iflist = CAFindInterfaceChange();
+    if (iflist)
+    {
+        size_t listLength = u_arraylist_length(iflist);
+        for (size_t i = 0; i < listLength; i++)
+        {
+            CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+            if (ifitem)
+            {
+                CAProcessNewInterface(ifitem);
+            }
+        }
+        u_arraylist_destroy(iflist);
+    }
+}
+
+#ifdef WITH_EPOLL
+
+/*
+ * The transport flags of a socket are kept next to its fd in the epoll user data,
+ * so a wakeup needs no lookup to know how to read the socket.
+ */
+#define EPOLL_DATA(FD, FLAGS) (((uint64_t)(uint32_t)(FLAGS) << 32) | (uint32_t)(FD))
+#define EPOLL_DATA_FD(DATA) ((int)(uint32_t)(DATA))
+#define EPOLL_DATA_FLAGS(DATA) ((CATransportFlags_t)(uint32_t)((DATA) >> 32))
+
+#define EPOLL_ADD(TYPE, FLAGS) \
+    if (caglobals.ip.TYPE.fd != OC_INVALID_SOCKET) \
+    { \
+        CAEpollAdd(caglobals.ip.TYPE.fd, FLAGS); \
+    }
+
+static bool CAEpollAdd(int fd, CATransportFlags_t flags)
+{
+    struct epoll_event event = { .events = EPOLLIN, .data.u64 = EPOLL_DATA(fd, flags) };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed for fd %d: %s", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void CAInitializeEpoll()
+{
+    CADeInitializeEpoll();
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    EPOLL_ADD(u6,  CA_IPV6)
+    EPOLL_ADD(u6s, CA_IPV6 | CA_SECURE)
+    EPOLL_ADD(u4,  CA_IPV4)
+    EPOLL_ADD(u4s, CA_IPV4 | CA_SECURE)
+    EPOLL_ADD(m6,  CA_MULTICAST | CA_IPV6)
+    EPOLL_ADD(m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE)
+    EPOLL_ADD(m4,  CA_MULTICAST | CA_IPV4)
+    EPOLL_ADD(m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE)
+
+    if (caglobals.ip.shutdownFds[0] != -1)
+    {
+        CAEpollAdd(caglobals.ip.shutdownFds[0], CA_DEFAULT_FLAGS);
+    }
+    if (caglobals.ip.netlinkFd != OC_INVALID_SOCKET)
+    {
+        CAEpollAdd(caglobals.ip.netlinkFd, CA_DEFAULT_FLAGS);
+    }
+}
+
+static void CADeInitializeEpoll()
+{
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.ip.terminate; i++)
+    {
+        int fd = EPOLL_DATA_FD(events[i].data.u64);
+
+        if (fd == caglobals.ip.netlinkFd)
+        {
+            CAProcessInterfaceChanges();
+        }
+        else if (fd == caglobals.ip.shutdownFds[0])
+        {
+            char buf[10] = {0};
+            (void)read(caglobals.ip.shutdownFds[0], buf, sizeof (buf));
+        }
+        else
+        {
+            (void)CAReceiveMessageBatch(fd, EPOLL_DATA_FLAGS(events[i].data.u64));
+        }
+    }
+}
+
+#endif // WITH_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 #define PUSH_HANDLE(HANDLE, ARRAY, INDEX) \
@@ -522,6 +671,9 @@ void CAUnregisterForAddressChanges()
 
 void CADeInitializeIPGlobals()
 {
+#ifdef WITH_EPOLL
+    CADeInitializeEpoll();
+#endif
     CLOSE_SOCKET(u6);
     CLOSE_SOCKET(u6s);
     CLOSE_SOCKET(u4);
@@ -635,6 +787,91 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         }
     }
 #endif // !defined(WSA_CMSG_DATA)
+    return CAHandleReceivedPacket(flags, &srcAddr, namelen, pktinfo, recvBuffer, recvLen);
+}
+
+#if defined(WITH_EPOLL)
+/*
+ * Read up to RECV_BATCH_SIZE datagrams from a ready socket with a single recvmmsg() call.
+ * Datagrams still queued after the batch keep the socket ready for the next epoll_wait().
+ */
+static CAResult_t CAReceiveMessageBatch(CASocketFd_t fd, CATransportFlags_t flags)
+{
+    char recvBuffers[RECV_BATCH_SIZE][COAP_MAX_PDU_SIZE];
+    struct sockaddr_storage srcAddrs[RECV_BATCH_SIZE];
+    struct iovec iovs[RECV_BATCH_SIZE];
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+    union control
+    {
+        struct cmsghdr cmsg;
+        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } cmsgs[RECV_BATCH_SIZE];
+
+    int namelen = 0;
+    int level = 0;
+    int type = 0;
+
+    if (flags & CA_IPV6)
+    {
+        namelen = sizeof (struct sockaddr_in6);
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
+    }
+    else
+    {
+        namelen = sizeof (struct sockaddr_in);
+        level = IPPROTO_IP;
+        type = IP_PKTINFO;
+    }
+
+    for (int i = 0; i < RECV_BATCH_SIZE; i++)
+    {
+        iovs[i].iov_base = recvBuffers[i];
+        iovs[i].iov_len = sizeof (recvBuffers[i]);
+        msgs[i].msg_hdr = (struct msghdr) { .msg_name = &srcAddrs[i],
+                                            .msg_namelen = namelen,
+                                            .msg_iov = &iovs[i],
+                                            .msg_iovlen = 1,
+                                            .msg_control = &cmsgs[i],
+                                            .msg_controllen = sizeof (cmsgs[i]) };
+        msgs[i].msg_len = 0;
+    }
+
+    int count = recvmmsg(fd, msgs, RECV_BATCH_SIZE, MSG_DONTWAIT, NULL);
+    if (0 > count)
+    {
+        if (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno)
+        {
+            return CA_STATUS_OK;
+        }
+        OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+        return CA_STATUS_FAILED;
+    }
+
+    for (int i = 0; i < count && !caglobals.ip.terminate; i++)
+    {
+        unsigned char *pktinfo = NULL;
+        for (struct cmsghdr *cmp = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmp != NULL;
+             cmp = CMSG_NXTHDR(&msgs[i].msg_hdr, cmp))
+        {
+            if (cmp->cmsg_level == level && cmp->cmsg_type == type)
+            {
+                pktinfo = CMSG_DATA(cmp);
+            }
+        }
+        (void)CAHandleReceivedPacket(flags, &srcAddrs[i], namelen, pktinfo,
+                                     recvBuffers[i], msgs[i].msg_len);
+    }
+
+    return CA_STATUS_OK;
+}
+#endif // WITH_EPOLL
+
+static CAResult_t CAHandleReceivedPacket(CATransportFlags_t flags,
+                                         const struct sockaddr_storage *srcAddr, int namelen,
+                                         unsigned char *pktinfo,
+                                         char *data, size_t dataLen)
+{
     if (!pktinfo)
     {
         OIC_LOG(ERROR, TAG, "pktinfo is null");
@@ -673,12 +910,13 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         }
     }
 
-    CAConvertAddrToName(&srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
+    CAConvertAddrToName(srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
 
+    OIC_TRACE_BEGIN(%s:CAHandleReceivedPacket, TAG);
     if (flags & CA_SECURE)
     {
 #ifdef __WITH_DTLS__
-        int ret = CAdecryptSsl(&sep, (uint8_t *)recvBuffer, recvLen);
+        int ret = CAdecryptSsl(&sep, (uint8_t *)data, dataLen);
         OIC_LOG_V(DEBUG, TAG, "CAdecryptSsl returns [%d]", ret);
 #else
         OIC_LOG(ERROR, TAG, "Encrypted message but no DTLS");
@@ -688,9 +926,10 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
     {
         if (g_packetReceivedCallback)
         {
-            g_packetReceivedCallback(&sep, recvBuffer, recvLen);
+            g_packetReceivedCallback(&sep, data, dataLen);
         }
     }
+    OIC_TRACE_END();
 
     return CA_STATUS_OK;
 }
@@ -989,6 +1228,10 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     // create source of network address change notifications
     CARegisterForAddressChanges();
 
+#ifdef WITH_EPOLL
+    CAInitializeEpoll();
+#endif
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
@@ -1471,6 +1714,7 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
 
     bool isSecure = (endpoint->flags & CA_SECURE) != 0;
 
+    OIC_TRACE_BEGIN(%s:CAIPSendData, TAG);
     if (isMulticast)
     {
         endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
@@ -1479,6 +1723,7 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
         if (!iflist)
         {
             OIC_LOG_V(ERROR, TAG, "get interface info failed: %s", strerror(errno));
+            OIC_TRACE_END();
             return;
         }
 
@@ -1518,6 +1763,7 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
             sendData(fd, endpoint, data, datalen, "unicast", "ipv4");
         }
     }
+    OIC_TRACE_END();
 }
 
 CAResult_t CAGetIPInterfaceInformation(CAEndpoint_t **info, size_t *size)
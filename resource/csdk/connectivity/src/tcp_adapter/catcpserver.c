@@ -63,9 +63,15 @@
 #include "octhread.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "trace.h"
 
 #include <coap/pdu.h>
 #include <coap/utlist.h>
+#include <coap/uthash.h>
+
+#ifdef WITH_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #ifdef __WITH_TLS__
 #include "ca_adapter_net_ssl.h"
@@ -87,6 +93,13 @@
  */
 #define TLS_HEADER_SIZE 5
 
+#ifdef WITH_EPOLL
+/**
+ * Maximum number of ready sockets handled per epoll_wait() call.
+ */
+#define EPOLL_MAX_EVENTS 64
+#endif
+
 /**
  * Mutex to synchronize device object list.
  */
@@ -117,6 +130,23 @@ static CATCPConnectionHandleCallback g_connectionCallback = NULL;
  */
 static CATCPSessionInfo_t *g_sessionList = NULL;
 
+/**
+ * Connected TCP sessions indexed by socket file descriptor.
+ */
+static CATCPSessionInfo_t *g_sessionFdIndex = NULL;
+
+/**
+ * TCP sessions indexed by remote address and port.
+ */
+static CATCPSessionInfo_t *g_sessionEndpointIndex = NULL;
+
+#ifdef WITH_EPOLL
+/**
+ * epoll instance of the receive thread, -1 when the select() loop is used.
+ */
+static int g_epollFd = -1;
+#endif
+
 static CAResult_t CATCPCreateMutex();
 static void CATCPDestroyMutex();
 static CAResult_t CATCPCreateCond();
@@ -129,9 +159,19 @@ static void CASelectReturned(fd_set *readFds);
 #else
 static void CASocketEventReturned(CASocketFd_t socket, long networkEvents);
 #endif
-static void CAReceiveMessage(CASocketFd_t fd);
+static bool CAReceiveMessage(CASocketFd_t fd);
 static void CAReceiveHandler(void *data);
 static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem);
+static void CAAddSession(CATCPSessionInfo_t *session);
+static void CAIndexSessionFd(CATCPSessionInfo_t *session);
+static void CARemoveSession(CATCPSessionInfo_t *session);
+static CATCPSessionInfo_t *CAFindSessionByEndpoint(const CAEndpoint_t *endpoint);
+#ifdef WITH_EPOLL
+static void CAInitializeEpoll();
+static void CADeInitializeEpoll();
+static void CAEpollAdd(CASocketFd_t fd, uint32_t events);
+static void CAEpollFindReadyMessage();
+#endif
 
 #if defined(WSA_WAIT_EVENT_0)
 #define CHECKFD(FD)
@@ -227,6 +267,13 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
+#ifdef WITH_EPOLL
+    if (-1 != g_epollFd)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
     fd_set readFds;
     struct timeval timeout = { .tv_sec = caglobals.tcp.selectTimeout };
 
@@ -246,7 +293,7 @@ static void CAFindReadyMessage()
     }
 
     CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    DL_FOREACH(g_sessionList, session)
     {
         if (session && session->fd != OC_INVALID_SOCKET && session->state == CONNECTED)
         {
@@ -318,7 +365,7 @@ static void CASelectReturned(fd_set *readFds)
     else
     {
         CATCPSessionInfo_t *session = NULL;
-        LL_FOREACH(g_sessionList, session)
+        DL_FOREACH(g_sessionList, session)
         {
             if (session && session->fd != OC_INVALID_SOCKET)
             {
@@ -331,6 +378,120 @@ static void CASelectReturned(fd_set *readFds)
     }
 }
 
+#ifdef WITH_EPOLL
+static void CAInitializeEpoll()
+{
+    CADeInitializeEpoll();
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    // accept sockets and pipes are level-triggered, one event is handled per wakeup.
+    CAEpollAdd(caglobals.tcp.ipv4.fd, EPOLLIN);
+    CAEpollAdd(caglobals.tcp.ipv4s.fd, EPOLLIN);
+    CAEpollAdd(caglobals.tcp.ipv6.fd, EPOLLIN);
+    CAEpollAdd(caglobals.tcp.ipv6s.fd, EPOLLIN);
+    CAEpollAdd(caglobals.tcp.shutdownFds[0], EPOLLIN);
+    CAEpollAdd(caglobals.tcp.connectionFds[0], EPOLLIN);
+
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *session = NULL;
+    DL_FOREACH(g_sessionList, session)
+    {
+        if (session->fd != OC_INVALID_SOCKET && session->state == CONNECTED)
+        {
+            CAEpollAdd(session->fd, EPOLLIN | EPOLLRDHUP | EPOLLET);
+        }
+    }
+    oc_mutex_unlock(g_mutexObjectList);
+}
+
+static void CADeInitializeEpoll()
+{
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+}
+
+static void CAEpollAdd(CASocketFd_t fd, uint32_t events)
+{
+    if (-1 == g_epollFd || OC_INVALID_SOCKET == fd)
+    {
+        return;
+    }
+
+    struct epoll_event event = { .events = events, .data.fd = fd };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed for fd %d: %s", fd, strerror(errno));
+    }
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = (-1 == caglobals.tcp.selectTimeout) ? -1 : caglobals.tcp.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.tcp.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.tcp.terminate; i++)
+    {
+        CASocketFd_t fd = events[i].data.fd;
+
+        if (fd == caglobals.tcp.ipv4.fd)
+        {
+            CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
+        }
+        else if (fd == caglobals.tcp.ipv4s.fd)
+        {
+            CAAcceptConnection(CA_IPV4 | CA_SECURE, &caglobals.tcp.ipv4s);
+        }
+        else if (fd == caglobals.tcp.ipv6.fd)
+        {
+            CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
+        }
+        else if (fd == caglobals.tcp.ipv6s.fd)
+        {
+            CAAcceptConnection(CA_IPV6 | CA_SECURE, &caglobals.tcp.ipv6s);
+        }
+        else if (fd == caglobals.tcp.connectionFds[0] || fd == caglobals.tcp.shutdownFds[0])
+        {
+            // the new socket has already been added to the epoll set, just drain the pipe.
+            char buf[MAX_ADDR_STR_SIZE_CA] = {0};
+            (void)read(fd, buf, sizeof (buf));
+        }
+        else
+        {
+            // session sockets are edge-triggered, so read until recv() would block.
+            while (!caglobals.tcp.terminate && CAReceiveMessage(fd))
+            {
+            }
+        }
+    }
+}
+#endif // WITH_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 /**
@@ -431,7 +592,7 @@ static void CAFindReadyMessage()
     while (!caglobals.tcp.terminate)
     {
         CATCPSessionInfo_t *session = NULL;
-        LL_FOREACH(g_sessionList, session);
+        DL_FOREACH(g_sessionList, session);
         {
             if (session && OC_INVALID_SOCKET != session->fd && (arraySize < EVENT_ARRAY_SIZE))
             {
@@ -553,10 +714,14 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
                             svritem->sep.endpoint.addr, &svritem->sep.endpoint.port);
 
         oc_mutex_lock(g_mutexObjectList);
-        LL_APPEND(g_sessionList, svritem);
+        CAAddSession(svritem);
+        CAIndexSessionFd(svritem);
         oc_mutex_unlock(g_mutexObjectList);
 
         CHECKFD(sockfd);
+#ifdef WITH_EPOLL
+        CAEpollAdd(sockfd, EPOLLIN | EPOLLRDHUP | EPOLLET);
+#endif
 
         // pass the connection information to CA Common Layer.
         if (g_connectionCallback)
@@ -728,7 +893,13 @@ CAResult_t CAConstructCoAP(CATCPSessionInfo_t *svritem, unsigned char **data,
     return CA_STATUS_OK;
 }
 
-static void CAReceiveMessage(CASocketFd_t fd)
+/**
+ * Read once from a session socket and pass complete messages up.
+ *
+ * @param[in] fd - session socket
+ * @return true if data was read and the session is still open, so more data may be pending
+ */
+static bool CAReceiveMessage(CASocketFd_t fd)
 {
     CAResult_t res = CA_STATUS_OK;
 
@@ -737,11 +908,17 @@ static void CAReceiveMessage(CASocketFd_t fd)
     if (!svritem)
     {
         OIC_LOG(ERROR, TAG, "there is no connection information in list");
-        return;
+        return false;
     }
 
     // read data
     int len = 0;
+#ifdef WITH_EPOLL
+    // edge-triggered sockets are drained until there is nothing left to read.
+    int recvFlags = (-1 != g_epollFd) ? MSG_DONTWAIT : 0;
+#else
+    int recvFlags = 0;
+#endif
 
     if (svritem->sep.endpoint.flags & CA_SECURE)
     {
@@ -765,13 +942,17 @@ static void CAReceiveMessage(CASocketFd_t fd)
             {
                 OIC_LOG_V(ERROR, TAG, "toal tls length is too big (buffer size : %u)",
                                     sizeof(svritem->tlsdata));
-                return;
+                return false;
             }
             nbRead = tlsLength - svritem->tlsLen;
         }
 
-        len = recv(fd, svritem->tlsdata + svritem->tlsLen, (int)nbRead, 0);
-        if (len < 0)
+        len = recv(fd, svritem->tlsdata + svritem->tlsLen, (int)nbRead, recvFlags);
+        if (len < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            return false;
+        }
+        else if (len < 0)
         {
             OIC_LOG_V(ERROR, TAG, "recv failed %s", strerror(errno));
             res = CA_RECEIVE_FAILED;
@@ -802,8 +983,12 @@ static void CAReceiveMessage(CASocketFd_t fd)
         svritem->protocol = COAP;
 
         // svritem->tlsdata can also be used as receiving buffer in case of raw tcp
-        len = recv(fd, svritem->tlsdata, sizeof(svritem->tlsdata), 0);
-        if (len < 0)
+        len = recv(fd, svritem->tlsdata, sizeof(svritem->tlsdata), recvFlags);
+        if (len < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            return false;
+        }
+        else if (len < 0)
         {
             OIC_LOG_V(ERROR, TAG, "recv failed %s", strerror(errno));
             res = CA_RECEIVE_FAILED;
@@ -819,7 +1004,9 @@ static void CAReceiveMessage(CASocketFd_t fd)
             //when successfully read data - pass them to callback.
             if (g_packetReceivedCallback)
             {
+                OIC_TRACE_BEGIN(%s:CAReceiveMessage, TAG);
                 g_packetReceivedCallback(&svritem->sep, svritem->tlsdata, len);
+                OIC_TRACE_END();
             }
         }
     }
@@ -834,8 +1021,10 @@ static void CAReceiveMessage(CASocketFd_t fd)
         }
 #endif
         CASearchAndDeleteTCPSession(&(svritem->sep.endpoint));
-        return;
+        return false;
     }
+
+    return len > 0;
 }
 
 #if !defined(WSA_WAIT_EVENT_0)
@@ -917,8 +1106,14 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
     }
 
     OIC_LOG(DEBUG, TAG, "connect socket success");
+    oc_mutex_lock(g_mutexObjectList);
     svritem->state = CONNECTED;
+    CAIndexSessionFd(svritem);
+    oc_mutex_unlock(g_mutexObjectList);
     CHECKFD(svritem->fd);
+#ifdef WITH_EPOLL
+    CAEpollAdd(svritem->fd, EPOLLIN | EPOLLRDHUP | EPOLLET);
+#endif
 #if !defined(WSA_WAIT_EVENT_0)
     ssize_t len = CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
     if (-1 == len)
@@ -1117,6 +1312,10 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.connectionFds[1]);
 #endif
 
+#ifdef WITH_EPOLL
+    CAInitializeEpoll();
+#endif
+
     caglobals.tcp.terminate = false;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
@@ -1176,6 +1375,10 @@ void CATCPStopServer()
     }
     caglobals.tcp.started = false;
 
+#ifdef WITH_EPOLL
+    CADeInitializeEpoll();
+#endif
+
     // mutex unlock
     oc_mutex_unlock(g_mutexObjectList);
 
@@ -1288,17 +1491,22 @@ ssize_t CATCPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen)
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint is NULL", -1);
     VERIFY_NON_NULL_RET(data, TAG, "data is NULL", -1);
 
+    ssize_t len = -1;
+    OIC_TRACE_BEGIN(%s:CATCPSendData, TAG);
     if (caglobals.tcp.ipv6tcpenabled && (endpoint->flags & CA_IPV6))
     {
-        return sendData(endpoint, data, datalen, "ipv6");
+        len = sendData(endpoint, data, datalen, "ipv6");
     }
-    if (caglobals.tcp.ipv4tcpenabled && (endpoint->flags & CA_IPV4))
+    else if (caglobals.tcp.ipv4tcpenabled && (endpoint->flags & CA_IPV4))
     {
-        return sendData(endpoint, data, datalen, "ipv4");
+        len = sendData(endpoint, data, datalen, "ipv4");
     }
-
-    OIC_LOG(ERROR, TAG, "Not supported transport flags");
-    return -1;
+    else
+    {
+        OIC_LOG(ERROR, TAG, "Not supported transport flags");
+    }
+    OIC_TRACE_END();
+    return len;
 }
 
 CAResult_t CAGetTCPInterfaceInformation(CAEndpoint_t **info, size_t *size)
@@ -1382,7 +1590,7 @@ CASocketFd_t CAConnectTCPSession(const CAEndpoint_t *endpoint)
 
     // #2. add TCP connection info to list
     oc_mutex_lock(g_mutexObjectList);
-    LL_APPEND(g_sessionList, svritem);
+    CAAddSession(svritem);
     oc_mutex_unlock(g_mutexObjectList);
 
     // #3. create the socket and connect to TCP server
@@ -1438,14 +1646,11 @@ void CATCPDisconnectAll()
     oc_mutex_lock(g_mutexObjectList);
     CATCPSessionInfo_t *session = NULL;
     CATCPSessionInfo_t *tmp = NULL;
-    LL_FOREACH_SAFE(g_sessionList, session, tmp);
+    DL_FOREACH_SAFE(g_sessionList, session, tmp)
     {
-        if (session)
-        {
-            LL_DELETE(g_sessionList, session);
-            // disconnect session from remote device.
-            CADisconnectTCPSession(session);
-        }
+        CARemoveSession(session);
+        // disconnect session from remote device.
+        CADisconnectTCPSession(session);
     }
 
     g_sessionList = NULL;
@@ -1465,21 +1670,15 @@ CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint
 
     // get connection info from list
     oc_mutex_lock(g_mutexObjectList);
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    CATCPSessionInfo_t *session = CAFindSessionByEndpoint(endpoint);
+    oc_mutex_unlock(g_mutexObjectList);
+
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        return session;
     }
 
-    oc_mutex_unlock(g_mutexObjectList);
     OIC_LOG(DEBUG, TAG, "Session not found");
     return NULL;
 }
@@ -1492,21 +1691,16 @@ CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
 
     // get connection info from list.
     oc_mutex_lock(g_mutexObjectList);
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    CATCPSessionInfo_t *session = CAFindSessionByEndpoint(endpoint);
+    CASocketFd_t fd = session ? session->fd : OC_INVALID_SOCKET;
+    oc_mutex_unlock(g_mutexObjectList);
+
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session->fd;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        return fd;
     }
 
-    oc_mutex_unlock(g_mutexObjectList);
     OIC_LOG(DEBUG, TAG, "Session not found");
     return OC_INVALID_SOCKET;
 }
@@ -1516,17 +1710,10 @@ CATCPSessionInfo_t *CAGetSessionInfoFromFD(CASocketFd_t fd)
     oc_mutex_lock(g_mutexObjectList);
 
     CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
-    {
-        if (session && session->fd == fd)
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            return session;
-        }
-    }
+    HASH_FIND(hhFd, g_sessionFdIndex, &fd, sizeof(fd), session);
 
     oc_mutex_unlock(g_mutexObjectList);
-    return NULL;
+    return session;
 }
 
 CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
@@ -1536,23 +1723,15 @@ CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
     // get connection info from list
-    CATCPSessionInfo_t *session = NULL;
-    CATCPSessionInfo_t *tmp = NULL;
-
     oc_mutex_lock(g_mutexObjectList);
-    LL_FOREACH_SAFE(g_sessionList, session, tmp)
+    CATCPSessionInfo_t *session = CAFindSessionByEndpoint(endpoint);
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            LL_DELETE(g_sessionList, session);
-            CADisconnectTCPSession(session);
-            oc_mutex_unlock(g_mutexObjectList);
-            return CA_STATUS_OK;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        CARemoveSession(session);
+        CADisconnectTCPSession(session);
+        oc_mutex_unlock(g_mutexObjectList);
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_mutexObjectList);
 
@@ -1560,6 +1739,112 @@ CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
     return CA_STATUS_OK;
 }
 
+static void CAInitSessionKey(CATCPSessionKey_t *key, const CAEndpoint_t *endpoint)
+{
+    memset(key, 0, sizeof (*key));
+    OICStrcpy(key->addr, sizeof (key->addr), endpoint->addr);
+    key->port = endpoint->port;
+}
+
+/**
+ * Add a session to the session list and the endpoint index.
+ * The index holds the oldest session of a key, later ones are chained to it.
+ * g_mutexObjectList must be held.
+ */
+static void CAAddSession(CATCPSessionInfo_t *session)
+{
+    CAInitSessionKey(&session->key, &session->sep.endpoint);
+    session->nextSameKey = NULL;
+    DL_APPEND(g_sessionList, session);
+
+    CATCPSessionInfo_t *head = NULL;
+    HASH_FIND(hhEndpoint, g_sessionEndpointIndex, &session->key, sizeof (session->key), head);
+    if (!head)
+    {
+        HASH_ADD(hhEndpoint, g_sessionEndpointIndex, key, sizeof (session->key), session);
+        return;
+    }
+
+    CATCPSessionInfo_t *last = head;
+    while (last->nextSameKey)
+    {
+        last = last->nextSameKey;
+    }
+    last->nextSameKey = session;
+}
+
+/**
+ * Add a connected session to the file descriptor index.
+ * g_mutexObjectList must be held.
+ */
+static void CAIndexSessionFd(CATCPSessionInfo_t *session)
+{
+    HASH_ADD(hhFd, g_sessionFdIndex, fd, sizeof (session->fd), session);
+}
+
+/**
+ * Remove a session from the session list and both indexes.
+ * g_mutexObjectList must be held.
+ */
+static void CARemoveSession(CATCPSessionInfo_t *session)
+{
+    CATCPSessionInfo_t *indexed = NULL;
+    HASH_FIND(hhFd, g_sessionFdIndex, &session->fd, sizeof (session->fd), indexed);
+    if (indexed == session)
+    {
+        HASH_DELETE(hhFd, g_sessionFdIndex, session);
+    }
+
+    CATCPSessionInfo_t *head = NULL;
+    HASH_FIND(hhEndpoint, g_sessionEndpointIndex, &session->key, sizeof (session->key), head);
+    if (head == session)
+    {
+        // The next session of the key takes the place of the removed one.
+        HASH_DELETE(hhEndpoint, g_sessionEndpointIndex, session);
+        if (session->nextSameKey)
+        {
+            HASH_ADD(hhEndpoint, g_sessionEndpointIndex, key, sizeof (session->key),
+                     session->nextSameKey);
+        }
+    }
+    else if (head)
+    {
+        for (CATCPSessionInfo_t *prev = head; prev->nextSameKey; prev = prev->nextSameKey)
+        {
+            if (prev->nextSameKey == session)
+            {
+                prev->nextSameKey = session->nextSameKey;
+                break;
+            }
+        }
+    }
+    session->nextSameKey = NULL;
+    DL_DELETE(g_sessionList, session);
+}
+
+/**
+ * Find the session connected to the address and port of an endpoint.
+ * g_mutexObjectList must be held.
+ */
+static CATCPSessionInfo_t *CAFindSessionByEndpoint(const CAEndpoint_t *endpoint)
+{
+    CATCPSessionKey_t key;
+    CAInitSessionKey(&key, endpoint);
+
+    CATCPSessionInfo_t *session = NULL;
+    HASH_FIND(hhEndpoint, g_sessionEndpointIndex, &key, sizeof (key), session);
+
+    // Sessions to the same address and port may be for other transport flags.
+    for (; session; session = session->nextSameKey)
+    {
+        if (session->sep.endpoint.flags & endpoint->flags)
+        {
+            return session;
+        }
+    }
+    return NULL;
+}
+
 size_t CAGetTotalLengthFromHeader(const unsigned char *recvBuffer)
 {
     OIC_LOG(DEBUG, TAG, "IN - CAGetTotalLengthFromHeader");
@@ -240,6 +240,71 @@ TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
     free(requestData.payload);
 }
 
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataGathersBlocksTest)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_GET, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    ASSERT_TRUE(cadata != NULL);
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(currData, CAGetBlockDataFromBlockDataList(currData->blockDataId));
+
+    // Without a size option the blocks are kept as they arrive.
+    uint8_t block[16];
+    cadata->responseInfo->info.payload = block;
+    cadata->responseInfo->info.payloadSize = sizeof(block);
+    for (int i = 0; i < 3; i++)
+    {
+        memset(block, 'a' + i, sizeof(block));
+        EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, cadata, CA_BLOCK_UNKNOWN, false,
+                                                    COAP_OPTION_BLOCK1));
+    }
+
+    // The total size moves everything into one buffer of that size.
+    currData->payloadLength = 4 * sizeof(block);
+    memset(block, 'd', sizeof(block));
+    EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, cadata, CA_BLOCK_UNKNOWN, true,
+                                                COAP_OPTION_BLOCK1));
+    cadata->responseInfo->info.payload = NULL;
+    cadata->responseInfo->info.payloadSize = 0;
+
+    size_t fullPayloadLen = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(currData->blockDataId, &fullPayloadLen);
+    ASSERT_TRUE(payload != NULL);
+    ASSERT_EQ(4 * sizeof(block), fullPayloadLen);
+    for (size_t i = 0; i < fullPayloadLen; i++)
+    {
+        EXPECT_EQ('a' + (int)(i / sizeof(block)), payload[i]);
+    }
+
+    CARemoveBlockDataFromList(currData->blockDataId);
+
+    CADestroyDataSet(cadata);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
 // request and block option1
 TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
 {
@@ -256,3 +256,134 @@ TEST(CAProtocolMessage, CAGetInfoFromPDU)
     coap_delete_list(options);
     coap_delete_pdu(pdu);
 }
+
+TEST(CAProtocolMessage, CAGeneratePDUToBuffer)
+{
+    CAEndpoint_t tempRep;
+    memset(&tempRep, 0, sizeof(CAEndpoint_t));
+    tempRep.flags = CA_DEFAULT_FLAGS;
+    tempRep.adapter = CA_ADAPTER_IP;
+    tempRep.port = 5683;
+
+    CAHeaderOption_t headerOption;
+    memset(&headerOption, 0, sizeof(CAHeaderOption_t));
+    headerOption.optionID = 2048;
+    headerOption.optionLength = 3;
+    memcpy(headerOption.optionData, "abc", 3);
+
+    CAInfo_t inData;
+    memset(&inData, 0, sizeof(CAInfo_t));
+    inData.token = (CAToken_t)"token";
+    inData.tokenLength = (uint8_t)strlen(inData.token);
+    inData.type = CA_MSG_CONFIRM;
+    inData.messageId = 0x1234;
+    inData.resourceUri = (CAURI_t)"/oic/res?rt=core.light&if=oic.if.baseline";
+    inData.options = &headerOption;
+    inData.numOptions = 1;
+    inData.payload = (CAPayload_t) "requestPayload";
+    inData.payloadSize = strlen((const char *) inData.payload);
+    inData.payloadFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    inData.acceptFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    inData.payloadVersion = 2048;
+    inData.acceptVersion = 2048;
+
+    uint8_t buffer[COAP_MAX_PDU_SIZE];
+    size_t length = 0;
+    ASSERT_EQ(CA_STATUS_OK, CAGeneratePDUToBuffer(CA_POST, &inData, buffer, sizeof(buffer),
+                                                  &length));
+
+    CAPDUView_t view;
+    ASSERT_EQ(CA_STATUS_OK, CAParsePDUView(buffer, length, &view));
+    EXPECT_EQ(CA_MSG_CONFIRM, view.type);
+    EXPECT_EQ((uint32_t) CA_POST, view.code);
+    EXPECT_EQ(0x1234, view.messageId);
+    ASSERT_EQ(inData.tokenLength, view.tokenLength);
+    EXPECT_EQ(0, memcmp(inData.token, view.token, view.tokenLength));
+    ASSERT_EQ(inData.payloadSize, view.payloadSize);
+    EXPECT_EQ(0, memcmp(inData.payload, view.payload, view.payloadSize));
+
+    // the options have to match the ones CAGeneratePDU collects.
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+    coap_pdu_t *pdu = CAGeneratePDU(CA_POST, &inData, &tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+
+    CAOptionIterator_t iter;
+    CAInitOptionIterator(&view, &iter);
+    CAOptionView_t option;
+    uint32_t count = 0;
+    for (coap_list_t *opt = options; opt; opt = opt->next, count++)
+    {
+        coap_option *expected = (coap_option *) opt->data;
+        ASSERT_TRUE(CAGetNextOption(&iter, &option));
+        EXPECT_EQ(COAP_OPTION_KEY(*expected), option.key);
+        ASSERT_EQ(COAP_OPTION_LENGTH(*expected), option.length);
+        EXPECT_EQ(0, memcmp(COAP_OPTION_DATA(*expected), option.value, option.length));
+    }
+    EXPECT_FALSE(CAGetNextOption(&iter, &option));
+    EXPECT_EQ(count, view.numOptions);
+
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    // a buffer which can't hold the message is rejected, not overrun.
+    EXPECT_NE(CA_STATUS_OK, CAGeneratePDUToBuffer(CA_POST, &inData, buffer, length - 1,
+                                                  &length));
+}
+
+TEST(CAProtocolMessage, CAGeneratePDUToBufferEmptyMessage)
+{
+    CAInfo_t inData;
+    memset(&inData, 0, sizeof(CAInfo_t));
+    inData.type = CA_MSG_RESET;
+    inData.messageId = 0x4321;
+
+    uint8_t buffer[COAP_MAX_PDU_SIZE];
+    size_t length = 0;
+    ASSERT_EQ(CA_STATUS_OK, CAGeneratePDUToBuffer(CA_EMPTY, &inData, buffer, sizeof(buffer),
+                                                  &length));
+    EXPECT_EQ(4u, length);
+
+    CAPDUView_t view;
+    ASSERT_EQ(CA_STATUS_OK, CAParsePDUView(buffer, length, &view));
+    EXPECT_EQ(CA_MSG_RESET, view.type);
+    EXPECT_EQ(0x4321, view.messageId);
+    EXPECT_EQ(0u, view.numOptions);
+    EXPECT_TRUE(view.payload == NULL);
+
+    // reset messages can't carry a token.
+    inData.token = (CAToken_t)"token";
+    inData.tokenLength = (uint8_t)strlen(inData.token);
+    EXPECT_NE(CA_STATUS_OK, CAGeneratePDUToBuffer(CA_EMPTY, &inData, buffer, sizeof(buffer),
+                                                  &length));
+}
+
+TEST(CAProtocolMessage, CAParsePDUViewMalformed)
+{
+    CAPDUView_t view;
+
+    // too short for a header.
+    const uint8_t shortPdu[] = { 0x40, 0x01, 0x00 };
+    EXPECT_NE(CA_STATUS_OK, CAParsePDUView(shortPdu, sizeof(shortPdu), &view));
+
+    // version 2.
+    const uint8_t badVersion[] = { 0x80, 0x01, 0x00, 0x01 };
+    EXPECT_NE(CA_STATUS_OK, CAParsePDUView(badVersion, sizeof(badVersion), &view));
+
+    // token length beyond the message.
+    const uint8_t badToken[] = { 0x44, 0x01, 0x00, 0x01, 0xAA };
+    EXPECT_NE(CA_STATUS_OK, CAParsePDUView(badToken, sizeof(badToken), &view));
+
+    // option length beyond the message.
+    const uint8_t badOption[] = { 0x40, 0x01, 0x00, 0x01, 0xB5, 'a' };
+    EXPECT_NE(CA_STATUS_OK, CAParsePDUView(badOption, sizeof(badOption), &view));
+
+    // payload marker without payload.
+    const uint8_t emptyPayload[] = { 0x40, 0x01, 0x00, 0x01, 0xFF };
+    EXPECT_NE(CA_STATUS_OK, CAParsePDUView(emptyPayload, sizeof(emptyPayload), &view));
+
+    const uint8_t valid[] = { 0x40, 0x01, 0x00, 0x01, 0xB3, 'o', 'i', 'c', 0xFF, 'x' };
+    ASSERT_EQ(CA_STATUS_OK, CAParsePDUView(valid, sizeof(valid), &view));
+    EXPECT_EQ(1u, view.numOptions);
+    EXPECT_EQ(1u, view.payloadSize);
+}
@@ -0,0 +1,273 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include "gtest/gtest.h"
+
+#include "caretransmission.h"
+#include "cathreadpool.h"
+#include "octhread.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
+
+#include <string.h>
+#include <vector>
+
+// CoAP header bytes: version 1, no token.
+#define COAP_CON_GET    0x40, 0x01
+#define COAP_ACK_EMPTY  0x60, 0x00
+
+// A CON message is first resent between DEFAULT_ACK_TIMEOUT_SEC and 1.5 times that,
+// so messages sent further apart than the spread expire in the order they were sent.
+static const uint64_t FIRST_TIMEOUT_SPREAD_US = DEFAULT_ACK_TIMEOUT_SEC * 500 * 1000;
+static const uint64_t WAIT_LIMIT_US = 20 * 1000 * 1000;
+
+static oc_mutex g_eventMutex = NULL;
+static oc_cond g_eventCond = NULL;
+static std::vector<uint16_t> g_resent;
+static std::vector<uint16_t> g_timedOut;
+
+static uint16_t GetMessageId(const void *pdu)
+{
+    const uint8_t *bytes = (const uint8_t *)pdu;
+    return (uint16_t)((bytes[2] << 8) | bytes[3]);
+}
+
+static CAResult_t RecordResend(const CAEndpoint_t * /*endpoint*/, const void *pdu,
+                               uint32_t /*size*/, CADataType_t /*dataType*/)
+{
+    oc_mutex_lock(g_eventMutex);
+    g_resent.push_back(GetMessageId(pdu));
+    oc_cond_signal(g_eventCond);
+    oc_mutex_unlock(g_eventMutex);
+    return CA_STATUS_OK;
+}
+
+static void RecordTimeout(const CAEndpoint_t * /*endpoint*/, const void *pdu,
+                          uint32_t /*size*/)
+{
+    oc_mutex_lock(g_eventMutex);
+    g_timedOut.push_back(GetMessageId(pdu));
+    oc_cond_signal(g_eventCond);
+    oc_mutex_unlock(g_eventMutex);
+}
+
+class CARetransmissionF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_eventMutex = oc_mutex_new();
+        g_eventCond = oc_cond_new();
+        g_resent.clear();
+        g_timedOut.clear();
+
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+
+        threadPool = NULL;
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &threadPool));
+        started = false;
+    }
+
+    virtual void TearDown()
+    {
+        if (started)
+        {
+            EXPECT_EQ(CA_STATUS_OK, CARetransmissionStop(&context));
+            EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+        }
+        ca_thread_pool_free(threadPool);
+
+        oc_cond_free(g_eventCond);
+        oc_mutex_free(g_eventMutex);
+        g_eventCond = NULL;
+        g_eventMutex = NULL;
+    }
+
+    void Start(uint8_t tryingCount)
+    {
+        CARetransmissionConfig_t config = { (CATransportAdapter_t)DEFAULT_RETRANSMISSION_TYPE,
+                                            tryingCount };
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, threadPool,
+                                                           RecordResend, RecordTimeout,
+                                                           &config));
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionStart(&context));
+        started = true;
+    }
+
+    CAResult_t SendCon(uint16_t messageId)
+    {
+        uint8_t pdu[] = { COAP_CON_GET, (uint8_t)(messageId >> 8), (uint8_t)messageId };
+        return CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                        pdu, sizeof(pdu));
+    }
+
+    void *ReceiveAck(uint16_t messageId)
+    {
+        uint8_t pdu[] = { COAP_ACK_EMPTY, (uint8_t)(messageId >> 8), (uint8_t)messageId };
+        void *retransmissionPdu = NULL;
+        EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&context, &endpoint, pdu,
+                                                             sizeof(pdu),
+                                                             &retransmissionPdu));
+        return retransmissionPdu;
+    }
+
+    void Sleep(uint64_t microseconds)
+    {
+        uint64_t end = OICGetCurrentTime(TIME_IN_US) + microseconds;
+        oc_mutex_lock(g_eventMutex);
+        for (uint64_t now = OICGetCurrentTime(TIME_IN_US); now < end;
+             now = OICGetCurrentTime(TIME_IN_US))
+        {
+            oc_cond_wait_for(g_eventCond, g_eventMutex, end - now);
+        }
+        oc_mutex_unlock(g_eventMutex);
+    }
+
+    std::vector<uint16_t> Snapshot(const std::vector<uint16_t> &events)
+    {
+        oc_mutex_lock(g_eventMutex);
+        std::vector<uint16_t> copy(events);
+        oc_mutex_unlock(g_eventMutex);
+        return copy;
+    }
+
+    // Wait until count timeouts were reported, or the wait limit passed.
+    bool WaitForTimeouts(size_t count)
+    {
+        uint64_t end = OICGetCurrentTime(TIME_IN_US) + WAIT_LIMIT_US;
+        oc_mutex_lock(g_eventMutex);
+        while (g_timedOut.size() < count)
+        {
+            uint64_t now = OICGetCurrentTime(TIME_IN_US);
+            if (now >= end)
+            {
+                break;
+            }
+            oc_cond_wait_for(g_eventCond, g_eventMutex, end - now);
+        }
+        bool done = (g_timedOut.size() >= count);
+        oc_mutex_unlock(g_eventMutex);
+        return done;
+    }
+
+    ca_thread_pool_t threadPool;
+    CARetransmission_t context;
+    CAEndpoint_t endpoint;
+    bool started;
+};
+
+TEST_F(CARetransmissionF, SentDataIgnoresNonConfirmable)
+{
+    Start(1);
+
+    uint8_t ack[] = { COAP_ACK_EMPTY, 0x12, 0x34 };
+    EXPECT_EQ(CA_NOT_SUPPORTED, CARetransmissionSentData(&context, &endpoint,
+                                                         CA_RESPONSE_DATA,
+                                                         ack, sizeof(ack)));
+    EXPECT_EQ(0u, context.pendingCount);
+}
+
+TEST_F(CARetransmissionF, SentDataRejectsDuplicateMessageId)
+{
+    Start(1);
+
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x1001));
+    EXPECT_EQ(CA_STATUS_FAILED, SendCon(0x1001));
+    EXPECT_EQ(1u, context.pendingCount);
+
+    // The same message ID on another adapter is a different message.
+    endpoint.adapter = CA_ADAPTER_GATT_BTLE;
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x1001));
+    EXPECT_EQ(2u, context.pendingCount);
+}
+
+TEST_F(CARetransmissionF, ExpiresInDeadlineOrder)
+{
+    Start(1);
+
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x2001));
+    Sleep(FIRST_TIMEOUT_SPREAD_US + 200 * 1000);
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x2002));
+
+    ASSERT_TRUE(WaitForTimeouts(2));
+
+    std::vector<uint16_t> resent = Snapshot(g_resent);
+    ASSERT_EQ(2u, resent.size());
+    EXPECT_EQ(0x2001, resent[0]);
+    EXPECT_EQ(0x2002, resent[1]);
+    std::vector<uint16_t> timedOut = Snapshot(g_timedOut);
+    ASSERT_EQ(2u, timedOut.size());
+    EXPECT_EQ(0x2001, timedOut[0]);
+    EXPECT_EQ(0x2002, timedOut[1]);
+    EXPECT_EQ(0u, context.pendingCount);
+}
+
+TEST_F(CARetransmissionF, AckCancelsRetransmission)
+{
+    Start(1);
+
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x3001));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x3002));
+    EXPECT_EQ(2u, context.pendingCount);
+
+    // An empty ACK hands back the acknowledged PDU and drops it from the wheel.
+    void *pdu = ReceiveAck(0x3001);
+    ASSERT_TRUE(NULL != pdu);
+    EXPECT_EQ(0x3001, GetMessageId(pdu));
+    OICFree(pdu);
+    EXPECT_EQ(1u, context.pendingCount);
+
+    // An ACK for an unknown message ID is ignored.
+    EXPECT_TRUE(NULL == ReceiveAck(0x3003));
+    EXPECT_EQ(1u, context.pendingCount);
+
+    ASSERT_TRUE(WaitForTimeouts(1));
+
+    std::vector<uint16_t> resent = Snapshot(g_resent);
+    ASSERT_EQ(1u, resent.size());
+    EXPECT_EQ(0x3002, resent[0]);
+    std::vector<uint16_t> timedOut = Snapshot(g_timedOut);
+    ASSERT_EQ(1u, timedOut.size());
+    EXPECT_EQ(0x3002, timedOut[0]);
+}
+
+TEST_F(CARetransmissionF, RemovedAfterMaxRetries)
+{
+    Start(2);
+
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x4001));
+    ASSERT_TRUE(WaitForTimeouts(1));
+
+    std::vector<uint16_t> resent = Snapshot(g_resent);
+    ASSERT_EQ(2u, resent.size());
+    EXPECT_EQ(0x4001, resent[0]);
+    EXPECT_EQ(0x4001, resent[1]);
+    std::vector<uint16_t> timedOut = Snapshot(g_timedOut);
+    ASSERT_EQ(1u, timedOut.size());
+    EXPECT_EQ(0x4001, timedOut[0]);
+
+    // The data is gone, so a late ACK finds nothing and the ID can be reused.
+    EXPECT_EQ(0u, context.pendingCount);
+    EXPECT_TRUE(NULL == ReceiveAck(0x4001));
+    EXPECT_EQ(CA_STATUS_OK, SendCon(0x4001));
+    EXPECT_EQ(1u, context.pendingCount);
+}
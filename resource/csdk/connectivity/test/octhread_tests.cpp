@@ -191,6 +191,51 @@ TEST(MutexTests, TC_03_THREAD_LOCKING)
     ca_thread_pool_free(mythreadpool);
 }
 
+TEST(MutexTests, TC_04_RECURSIVE_LOCKING)
+{
+    ca_thread_pool_t mythreadpool;
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init(3, &mythreadpool));
+
+    _func1_struct pData = {0, false, false};
+
+    pData.mutex = oc_mutex_new_recursive();
+
+    EXPECT_TRUE(pData.mutex != NULL);
+    if (pData.mutex != NULL)
+    {
+        // the owner may lock again without blocking.
+        oc_mutex_lock(pData.mutex);
+        oc_mutex_lock(pData.mutex);
+
+        EXPECT_EQ(CA_STATUS_OK,
+                  ca_thread_pool_add_task(mythreadpool, mutexFunc, &pData));
+
+        while (!pData.thread_up)
+        {
+            usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+        }
+        usleep(MINIMAL_EXTRA_SLEEP * USECS_PER_MSEC);
+
+        // one unlock still leaves the mutex held.
+        oc_mutex_unlock(pData.mutex);
+        usleep(MINIMAL_EXTRA_SLEEP * USECS_PER_MSEC);
+        EXPECT_FALSE(pData.finished);
+
+        oc_mutex_unlock(pData.mutex);
+        while (!pData.finished)
+        {
+            usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+        }
+
+        oc_mutex_lock(pData.mutex);
+        oc_mutex_unlock(pData.mutex);
+        oc_mutex_free(pData.mutex);
+    }
+
+    ca_thread_pool_free(mythreadpool);
+}
+
 TEST(ConditionTests, TC_01_CREATE)
 {
     oc_cond mycond = oc_cond_new();
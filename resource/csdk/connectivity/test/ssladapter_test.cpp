@@ -44,6 +44,9 @@
 #define CAsetTlsCipherSuite CAsetTlsCipherSuiteTest
 #define CAsslGenerateOwnerPsk CAsslGenerateOwnerPskTest
 #define CAcloseSslConnectionAll CAcloseSslConnectionAllTest
+#define CAinvalidateSslCredentials CAinvalidateSslCredentialsTest
+#define CAendSslSession CAendSslSessionTest
+#define CAgetSslSessionCacheStats CAgetSslSessionCacheStatsTest
 #ifdef MULTIPLE_OWNER
 #define GetCASecureEndpointData GetCASecureEndpointDataTest
 #endif
@@ -1963,7 +1966,7 @@ static int testCAsetSslAdapterCallbacks()
     g_sslContextMutex = oc_mutex_new();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    InitPeerTable();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     unsigned char * seed = (unsigned char*) SEED;
@@ -2088,7 +2091,7 @@ static void * test0CAinitiateSslHandshake(void * arg)
     g_sslContextMutex = oc_mutex_new();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    InitPeerTable();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     unsigned char * seed = (unsigned char*) SEED;
@@ -2262,7 +2265,7 @@ static void * testCAencryptSsl(void * arg)
     g_sslContextMutex = oc_mutex_new();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    InitPeerTable();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     unsigned char * seed = (unsigned char*) SEED;
@@ -2716,7 +2719,7 @@ static void * testCAdecryptSsl(void * arg)
     g_sslContextMutex = oc_mutex_new();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    InitPeerTable();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     unsigned char * seed = (unsigned char*) SEED;
@@ -2883,7 +2886,7 @@ static int testCAdeinitSslAdapter()
     g_sslContextMutex = oc_mutex_new();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    InitPeerTable();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     unsigned char * seed = (unsigned char*) SEED;
@@ -3287,7 +3290,7 @@ static void * testCAsslGenerateOwnerPsk(void * arg)
     g_sslContextMutex = oc_mutex_new();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    InitPeerTable();
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     unsigned char * seed = (unsigned char*) SEED;
@@ -3424,3 +3427,114 @@ TEST(TLSAdapter, Test_ParseChain)
 
     EXPECT_EQ(10, ret + errNum);
 }
+
+static int pkixInfoCallCount = 0;
+
+static void countingInfoCallback(PkiInfo_t * inf)
+{
+    pkixInfoCallCount++;
+    infoCallback_that_loads_x509(inf);
+}
+
+TEST(TLSAdapter, Test_SetupCipherCachesCredentials)
+{
+    g_sslContextMutex = oc_mutex_new();
+    g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
+    ASSERT_TRUE(NULL != g_caSslContext);
+    g_caSslContext->cipher = SSL_CIPHER_MAX;
+    mbedtls_x509_crt_init(&g_caSslContext->ca);
+    mbedtls_x509_crt_init(&g_caSslContext->crt);
+    mbedtls_pk_init(&g_caSslContext->pkey);
+    mbedtls_x509_crl_init(&g_caSslContext->crl);
+    mbedtls_ssl_config_init(&g_caSslContext->clientTlsConf);
+    mbedtls_ssl_config_init(&g_caSslContext->serverTlsConf);
+    mbedtls_ssl_config_init(&g_caSslContext->clientDtlsConf);
+    mbedtls_ssl_config_init(&g_caSslContext->serverDtlsConf);
+
+    CAsetPskCredentialsCallback(GetDtlsPskCredentials);
+    CAsetPkixInfoCallback(countingInfoCallback);
+    CAsetCredentialTypesCallback(clutch);
+    pkixInfoCallCount = 0;
+
+    // The first handshake parses the credentials, the following ones reuse them.
+    SetupCipher(&g_caSslContext->clientTlsConf);
+    SetupCipher(&g_caSslContext->clientTlsConf);
+    SetupCipher(&g_caSslContext->serverTlsConf);
+    EXPECT_EQ(1, pkixInfoCallCount);
+
+    // A credential change makes the next handshake parse them again.
+    CAinvalidateSslCredentials();
+    SetupCipher(&g_caSslContext->clientTlsConf);
+    SetupCipher(&g_caSslContext->clientTlsConf);
+    EXPECT_EQ(2, pkixInfoCallCount);
+
+    mbedtls_ssl_config_free(&g_caSslContext->clientTlsConf);
+    mbedtls_ssl_config_free(&g_caSslContext->serverTlsConf);
+    mbedtls_ssl_config_free(&g_caSslContext->clientDtlsConf);
+    mbedtls_ssl_config_free(&g_caSslContext->serverDtlsConf);
+    mbedtls_x509_crt_free(&g_caSslContext->ca);
+    mbedtls_x509_crt_free(&g_caSslContext->crt);
+    mbedtls_pk_free(&g_caSslContext->pkey);
+    mbedtls_x509_crl_free(&g_caSslContext->crl);
+    OICFree(g_caSslContext);
+    g_caSslContext = NULL;
+    oc_mutex_free(g_sslContextMutex);
+    g_sslContextMutex = NULL;
+}
+
+static SslEndPoint_t * newTestPeer(const CAEndpoint_t * endpoint)
+{
+    SslEndPoint_t * tep = (SslEndPoint_t *)OICCalloc(1, sizeof(SslEndPoint_t));
+    tep->sep.endpoint = *endpoint;
+    InitSslPeerKey(&tep->key, endpoint);
+    tep->mutex = oc_mutex_new_recursive();
+    tep->refCount = 1;
+    return tep;
+}
+
+TEST(TLSAdapter, Test_PeerTableLookup)
+{
+    g_sslContextMutex = oc_mutex_new();
+    g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
+    ASSERT_TRUE(NULL != g_caSslContext);
+    ASSERT_TRUE(InitPeerTable());
+
+    CAEndpoint_t endpoints[64];
+    memset(endpoints, 0, sizeof(endpoints));
+    oc_mutex_lock(g_sslContextMutex);
+    for (size_t i = 0; i < sizeof(endpoints) / sizeof(endpoints[0]); i++)
+    {
+        endpoints[i].adapter = (i % 2) ? CA_ADAPTER_TCP : CA_ADAPTER_IP;
+        endpoints[i].flags = CA_SECURE;
+        endpoints[i].port = (uint16_t)(5684 + i / 2);
+        OICStrcpy(endpoints[i].addr, sizeof(endpoints[i].addr), "192.168.0.10");
+        AddSslPeer(newTestPeer(&endpoints[i]));
+    }
+
+    for (size_t i = 0; i < sizeof(endpoints) / sizeof(endpoints[0]); i++)
+    {
+        SslEndPoint_t * tep = GetSslPeer(&endpoints[i]);
+        ASSERT_TRUE(NULL != tep);
+        EXPECT_EQ(endpoints[i].adapter, tep->sep.endpoint.adapter);
+        EXPECT_EQ(endpoints[i].port, tep->sep.endpoint.port);
+    }
+
+    // Peers are keyed by adapter, port and address only.
+    CAEndpoint_t other = endpoints[0];
+    other.ifindex = 3;
+    EXPECT_EQ(GetSslPeer(&endpoints[0]), GetSslPeer(&other));
+    other.port = 1;
+    EXPECT_TRUE(NULL == GetSslPeer(&other));
+
+    RemovePeerFromList(&endpoints[0]);
+    EXPECT_TRUE(NULL == GetSslPeer(&endpoints[0]));
+    EXPECT_TRUE(NULL != GetSslPeer(&endpoints[1]));
+
+    DeletePeerList();
+    oc_mutex_unlock(g_sslContextMutex);
+
+    OICFree(g_caSslContext);
+    g_caSslContext = NULL;
+    oc_mutex_free(g_sslContextMutex);
+    g_sslContextMutex = NULL;
+}
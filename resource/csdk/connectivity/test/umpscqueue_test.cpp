@@ -0,0 +1,181 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "umpscqueue.h"
+#include "octhread.h"
+
+#include <vector>
+
+static const uint32_t PRODUCER_COUNT = 4;
+static const uint32_t MESSAGES_PER_PRODUCER = 1000;
+
+class UMpscQueueF : public testing::Test {
+public:
+    UMpscQueueF() :
+      testing::Test(),
+      queue(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        queue = u_mpsc_queue_create(8);
+        ASSERT_TRUE(queue != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        u_mpsc_queue_delete(queue);
+    }
+
+    u_mpsc_queue_t *queue;
+};
+
+TEST(UMpscQueue, Base)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create(16);
+    ASSERT_TRUE(queue != NULL);
+    EXPECT_TRUE(u_mpsc_queue_is_empty(queue));
+
+    u_mpsc_queue_delete(queue);
+}
+
+TEST(UMpscQueue, InvalidCapacity)
+{
+    EXPECT_TRUE(u_mpsc_queue_create(0) == NULL);
+}
+
+TEST(UMpscQueue, FreeNull)
+{
+    u_mpsc_queue_delete(NULL);
+}
+
+TEST_F(UMpscQueueF, Order)
+{
+    int values[5] = { 0, 1, 2, 3, 4 };
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_TRUE(u_mpsc_queue_add_element(queue, &values[i], sizeof(int)));
+    }
+    EXPECT_FALSE(u_mpsc_queue_is_empty(queue));
+
+    u_queue_message_t messages[8];
+    ASSERT_EQ(static_cast<uint32_t>(5), u_mpsc_queue_get_elements(queue, messages, 8));
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(&values[i], messages[i].msg);
+        EXPECT_EQ(sizeof(int), messages[i].size);
+    }
+    EXPECT_TRUE(u_mpsc_queue_is_empty(queue));
+}
+
+TEST_F(UMpscQueueF, Full)
+{
+    int dummy = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_TRUE(u_mpsc_queue_add_element(queue, &dummy, sizeof(dummy)));
+    }
+    EXPECT_FALSE(u_mpsc_queue_add_element(queue, &dummy, sizeof(dummy)));
+
+    u_queue_message_t message;
+    ASSERT_EQ(static_cast<uint32_t>(1), u_mpsc_queue_get_elements(queue, &message, 1));
+    EXPECT_TRUE(u_mpsc_queue_add_element(queue, &dummy, sizeof(dummy)));
+}
+
+TEST_F(UMpscQueueF, WrapAround)
+{
+    u_queue_message_t messages[3];
+    for (uintptr_t i = 0; i < 1000; i += 3)
+    {
+        for (uintptr_t j = 0; j < 3; ++j)
+        {
+            ASSERT_TRUE(u_mpsc_queue_add_element(queue, (void *) (i + j + 1), 0));
+        }
+        ASSERT_EQ(static_cast<uint32_t>(3), u_mpsc_queue_get_elements(queue, messages, 3));
+        for (uintptr_t j = 0; j < 3; ++j)
+        {
+            EXPECT_EQ((void *) (i + j + 1), messages[j].msg);
+        }
+    }
+}
+
+typedef struct
+{
+    u_mpsc_queue_t *queue;
+    uint32_t producer;
+} ProducerContext;
+
+static void *ProducerRoutine(void *arg)
+{
+    ProducerContext *context = (ProducerContext *) arg;
+    for (uint32_t i = 0; i < MESSAGES_PER_PRODUCER; ++i)
+    {
+        // the message carries the producer in its size and the sequence in its pointer.
+        while (!u_mpsc_queue_add_element(context->queue, (void *) (uintptr_t) i,
+                                         context->producer))
+        {
+        }
+    }
+    return NULL;
+}
+
+TEST(UMpscQueue, MultipleProducers)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create(64);
+    ASSERT_TRUE(queue != NULL);
+
+    oc_thread threads[PRODUCER_COUNT];
+    ProducerContext contexts[PRODUCER_COUNT];
+    for (uint32_t p = 0; p < PRODUCER_COUNT; ++p)
+    {
+        contexts[p].queue = queue;
+        contexts[p].producer = p;
+        ASSERT_EQ(OC_THREAD_SUCCESS, oc_thread_new(&threads[p], ProducerRoutine, &contexts[p]));
+    }
+
+    // every producer's messages must arrive once and in order.
+    std::vector<uint32_t> expected(PRODUCER_COUNT, 0);
+    uint32_t total = 0;
+    u_queue_message_t messages[16];
+    while (total < PRODUCER_COUNT * MESSAGES_PER_PRODUCER)
+    {
+        uint32_t count = u_mpsc_queue_get_elements(queue, messages, 16);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t producer = messages[i].size;
+            ASSERT_LT(producer, PRODUCER_COUNT);
+            ASSERT_EQ(expected[producer], (uint32_t) (uintptr_t) messages[i].msg);
+            expected[producer]++;
+        }
+        total += count;
+    }
+    EXPECT_TRUE(u_mpsc_queue_is_empty(queue));
+
+    for (uint32_t p = 0; p < PRODUCER_COUNT; ++p)
+    {
+        oc_thread_wait(threads[p]);
+        oc_thread_free(threads[p]);
+    }
+    u_mpsc_queue_delete(queue);
+}
@@ -84,6 +84,9 @@ extern "C" {
 /** Introspection payload URI.*/
 #define OC_RSRVD_INTROSPECTION_PAYLOAD_URI    "/oic/introspection/payload"
 
+/** Metrics URI.*/
+#define OC_RSRVD_METRICS_URI                  "/oic/metrics"
+
 /** Presence */
 
 /** Presence URI through which the OIC devices advertise their presence.*/
@@ -184,6 +187,9 @@ extern "C" {
 /** To represent resource type with introspection payload.*/
 #define OC_RSRVD_RESOURCE_TYPE_INTROSPECTION_PAYLOAD "oic.wk.introspection.payload"
 
+/** To represent resource type with runtime metrics.*/
+#define OC_RSRVD_RESOURCE_TYPE_METRICS "x.org.iotivity.metrics"
+
 /** To represent interface.*/
 #define OC_RSRVD_INTERFACE              "if"
 
@@ -1013,7 +1019,12 @@ typedef enum
     /** When this bit is set, the resource is allowed to be discovered only
      *  if discovery request contains an explicit querystring.
      *  Ex: GET /oic/res?rt=oic.sec.acl */
-    OC_EXPLICIT_DISCOVERABLE   = (1 << 5)
+    OC_EXPLICIT_DISCOVERABLE   = (1 << 5),
+
+    /** When this bit is set, OCNotifyAllObservers() calls the entity handler once for
+     *  each group of observers sharing the same query and accept format, encodes the
+     *  payload once and sends a copy to every observer of the group.*/
+    OC_OBSERVE_FANOUT          = (1 << 6)
 
 #ifdef WITH_MQ
     /** When this bit is set, the resource is allowed to be published */
@@ -1203,6 +1214,14 @@ typedef struct {
     int (* unlink)(const char *path);
 } OCPersistentStorage;
 
+/**
+ * Persistent storage journal open handler, registered with
+ * OCRegisterPersistentStorageJournalHandler. Opens the journal of the database
+ * 'path', the same name as passed to the open handler of OCPersistentStorage.
+ * The journal must not be stored in the file the open handler maps the database to.
+ */
+typedef FILE* (* OCPersistentStorageJournalHandler)(const char *path, const char *mode);
+
 /**
  * Possible returned values from entity handler.
  */
@@ -1507,6 +1526,9 @@ typedef struct OCRepPayloadValue
 
 } OCRepPayloadValue;
 
+/** Lookup table over the values of a representation, private to ocpayload.c.*/
+struct OCRepPayloadValueIndex;
+
 // used for get/set/put/observe/etc representations
 typedef struct OCRepPayload
 {
@@ -1516,6 +1538,10 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+
+    /** Hash index over values, built once a representation has many properties.
+     *  It is maintained by the OCRepPayload API, so values must not be relinked by hand.*/
+    struct OCRepPayloadValueIndex* valueIndex;
 } OCRepPayload;
 
 // used inside a resource payload
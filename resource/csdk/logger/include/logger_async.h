@@ -0,0 +1,148 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef LOGGER_ASYNC_H_
+#define LOGGER_ASYNC_H_
+
+// In asynchronous mode OCLog(), OCLogv() and OCLogBuffer() do not format or
+// write anything on the calling thread. The log level, tag, format string and
+// arguments are copied into a ring buffer owned by the calling thread, and a
+// background thread formats and writes them. A full ring buffer drops the
+// message instead of blocking the caller.
+//
+// Asynchronous mode is available on Linux and Darwin; on other platforms
+// OCLogAsyncStart() fails and logging stays synchronous.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include "logger.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Default size of the ring buffer of each logging thread, in bytes. */
+#define OC_LOG_ASYNC_DEFAULT_RING_SIZE (64 * 1024)
+
+/** Default time the background thread sleeps when there is nothing to write, in ms. */
+#define OC_LOG_ASYNC_DEFAULT_DRAIN_INTERVAL_MS (10)
+
+/**
+ * Configuration of the asynchronous logging mode.
+ */
+typedef struct
+{
+    /** Size of the ring buffer of each logging thread. 0 selects the default. */
+    size_t ringSize;
+
+    /**
+     * Maximum number of DEBUG and INFO messages per tag and second. Messages above
+     * the limit are counted, and reported with the first message of the tag in a
+     * later second. 0 disables rate limiting.
+     */
+    uint32_t maxPerSecond;
+
+    /** Time the background thread sleeps when idle. 0 selects the default. */
+    uint32_t drainIntervalMs;
+
+    /**
+     * If set, messages are written to this file in the compact binary format,
+     * unformatted, instead of going to the configured logger. The file stays
+     * owned by the caller. Use OCLogDecodeBinary() to read it.
+     */
+    FILE *binaryOutput;
+} OCLogAsyncConfig;
+
+/**
+ * Switch the logger to asynchronous mode.
+ *
+ * @param config - configuration, or NULL for the defaults.
+ * @return true if asynchronous mode is active, false if it is not supported
+ *         or the background thread could not be started.
+ */
+bool OCLogAsyncStart(const OCLogAsyncConfig *config);
+
+/**
+ * Write all pending messages and switch the logger back to synchronous mode.
+ */
+void OCLogAsyncStop();
+
+/**
+ * Wait until every message logged before this call has been written.
+ */
+void OCLogAsyncFlush();
+
+/**
+ * Decode a file written in the compact binary format into text lines, in the
+ * same form the default logger prints them.
+ *
+ * @param in  - binary log file.
+ * @param out - file the text is written to.
+ * @return true on success, false if the input is not a valid binary log.
+ */
+bool OCLogDecodeBinary(FILE *in, FILE *out);
+
+//-----------------------------------------------------------------------------
+// Internal to the logger library
+//-----------------------------------------------------------------------------
+
+/**
+ * Queue a log message if asynchronous mode is active. The level is already
+ * filtered by the caller.
+ *
+ * @return true if the message was taken (queued, dropped or rate limited),
+ *         false if the caller has to write it synchronously.
+ */
+bool OCLogAsyncLogv(LogLevel level, const char *tag, const char *format, va_list args);
+
+/**
+ * Queue a log string if asynchronous mode is active.
+ *
+ * @return see OCLogAsyncLogv().
+ */
+bool OCLogAsyncLog(LogLevel level, const char *tag, const char *logStr);
+
+/**
+ * Queue a buffer to be hex dumped if asynchronous mode is active.
+ *
+ * @return see OCLogAsyncLogv().
+ */
+bool OCLogAsyncLogBuffer(LogLevel level, const char *tag,
+                         const uint8_t *buffer, size_t bufferSize);
+
+/**
+ * Write a formatted log string to the configured logger.
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param logStr - log string
+ * @param timeUs - time the message was logged, in microseconds since the epoch,
+ *                 or 0 for now.
+ */
+void OCLogWrite(LogLevel level, const char *tag, const char *logStr, uint64_t timeUs);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* LOGGER_ASYNC_H_ */
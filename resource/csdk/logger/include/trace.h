@@ -26,6 +26,9 @@
 #elif defined(__TIZEN__)
 #include <ttrace.h>
 #elif defined(ARDUINO)
+#elif defined(__linux__)
+#include <stdbool.h>
+#include <stddef.h>
 #endif
 
 #ifdef __cplusplus
@@ -51,6 +54,57 @@ extern "C"
 #define OIC_TRACE_BEGIN(MSG, ...)
 #define OIC_TRACE_END()
 
+#elif defined(__linux__)
+/*
+ * trace macro for Linux. spans are recorded in a ring buffer per thread and
+ * dumped in Chrome trace event format, which chrome://tracing and Perfetto read.
+ * Setting the OIC_TRACE_FILE environment variable starts tracing at the first
+ * trace point and dumps to that file on SIGUSR2.
+ */
+#define OIC_TRACE_BEGIN(MSG, ...) \
+        oic_trace_begin("OIC:"#MSG, ##__VA_ARGS__)
+#define OIC_TRACE_END() \
+        oic_trace_end()
+
+/** Default number of events kept per thread. */
+#define OIC_TRACE_DEFAULT_EVENTS (4096)
+
+void oic_trace_begin(const char *name, ...);
+void oic_trace_end();
+
+/**
+ * Start recording spans.
+ *
+ * @param eventsPerThread - number of events kept per thread, older ones are
+ *                          overwritten. 0 selects OIC_TRACE_DEFAULT_EVENTS.
+ * @return true if tracing is active.
+ */
+bool oic_trace_start(size_t eventsPerThread);
+
+/**
+ * Stop recording spans. Recorded spans are kept until they are overwritten.
+ */
+void oic_trace_stop();
+
+/**
+ * Write the recorded spans of all threads to a file in Chrome trace event
+ * (JSON) format.
+ *
+ * @param path - file to write.
+ * @return true on success.
+ */
+bool oic_trace_dump(const char *path);
+
+/**
+ * Dump the recorded spans to a file each time a signal is received. The dump
+ * is written by a helper thread, not in the signal handler.
+ *
+ * @param signum - signal to dump on, e.g. SIGUSR2.
+ * @param path   - file to write.
+ * @return true on success.
+ */
+bool oic_trace_dump_on_signal(int signum, const char *path);
+
 #else
 #define OIC_TRACE_BEGIN(MSG, ...)
 #define OIC_TRACE_END()
@@ -54,6 +54,9 @@
 #include "logger.h"
 #include "string.h"
 #include "logger_types.h"
+#ifndef ARDUINO
+#include "logger_async.h"
+#endif
 
 // log level
 LogLevel g_level = DEBUG;
@@ -120,6 +123,46 @@ static oc_log_level LEVEL_XTABLE[] = {OC_LOG_DEBUG, OC_LOG_INFO,
 
 #ifndef ARDUINO
 
+/**
+ * Check the runtime log level and the privacy setting.
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @return true if messages of this level are written.
+ */
+static bool IsLogLevelEnabled(LogLevel level)
+{
+    if (g_level > level && ERROR != level && WARNING != level && FATAL != level)
+    {
+        return false;
+    }
+
+    if (true == g_hidePrivateLogEntries && INFO_PRIVATE == level)
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Map the lite and private levels to the level they are written with.
+ *
+ * @param level  - log level.
+ * @return DEBUG, INFO, WARNING, ERROR or FATAL
+ */
+static LogLevel GetOutputLevel(LogLevel level)
+{
+    switch(level)
+    {
+        case DEBUG_LITE:
+            return DEBUG;
+        case INFO_LITE:
+        case INFO_PRIVATE:
+            return INFO;
+        default:
+            return level;
+    }
+}
+
 /**
  * Output the contents of the specified buffer (in hex) with the specified priority level.
  *
@@ -135,6 +178,15 @@ void OCLogBuffer(LogLevel level, const char* tag, const uint8_t* buffer, size_t
         return;
     }
 
+#ifndef __TIZEN__
+    // Asynchronous mode copies the bytes and formats them on its own thread.
+    if (IsLogLevelEnabled(level) &&
+        OCLogAsyncLogBuffer(GetOutputLevel(level), tag, buffer, bufferSize))
+    {
+        return;
+    }
+#endif
+
     // No idea why the static initialization won't work here, it seems the compiler is convinced
     // that this is a variable-sized object.
     char lineBuffer[LINE_BUFFER_SIZE];
@@ -179,6 +231,7 @@ void OCLogInit()
 
 void OCLogShutdown()
 {
+    OCLogAsyncStop();
 #if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
     if (logCtx && logCtx->destroy)
     {
@@ -201,18 +254,21 @@ void OCLogv(LogLevel level, const char * tag, const char * format, ...)
         return;
     }
 
-    if (g_level > level && ERROR != level && WARNING != level && FATAL != level)
+    if (!IsLogLevelEnabled(level))
     {
         return;
     }
 
-    if (true == g_hidePrivateLogEntries && INFO_PRIVATE == level)
+    va_list args;
+    va_start(args, format);
+    bool queued = OCLogAsyncLogv(GetOutputLevel(level), tag, format, args);
+    va_end(args);
+    if (queued)
     {
         return;
     }
 
     char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
-    va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof buffer - 1, format, args);
     va_end(args);
@@ -234,32 +290,32 @@ void OCLog(LogLevel level, const char * tag, const char * logStr)
        return;
     }
 
-    if (g_level > level && ERROR != level && WARNING != level && FATAL != level)
+    if (!IsLogLevelEnabled(level))
     {
         return;
     }
 
-    if (true == g_hidePrivateLogEntries && INFO_PRIVATE == level)
+    level = GetOutputLevel(level);
+    if (OCLogAsyncLog(level, tag, logStr))
     {
         return;
     }
+    OCLogWrite(level, tag, logStr, 0);
+}
 
-    switch(level)
-    {
-        case DEBUG_LITE:
-            level = DEBUG;
-            break;
-        case INFO_LITE:
-            level = INFO;
-            break;
-        case INFO_PRIVATE:
-            level = INFO;
-            break;
-        default:
-            break;
-    }
-
+/**
+ * Write a formatted log string to the configured logger.
+ * Used directly by OCLog() and by the asynchronous mode's background thread.
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param logStr - log string
+ * @param timeUs - time the message was logged in microseconds, or 0 for now
+ */
+void OCLogWrite(LogLevel level, const char *tag, const char *logStr, uint64_t timeUs)
+{
    #ifdef __ANDROID__
+       (void)timeUs;
 
    #ifdef ADB_SHELL
        printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
@@ -278,33 +334,43 @@ void OCLog(LogLevel level, const char * tag, const char * logStr)
            int min = 0;
            int sec = 0;
            int ms = 0;
+           if (timeUs)
+           {
+               // Written later than it was logged, print the time it was logged.
+               min = (int)((timeUs / 60000000) % 60);
+               sec = (int)((timeUs / 1000000) % 60);
+               ms = (int)((timeUs / 1000) % 1000);
+           }
+           else
+           {
    #if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-           struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
-           clockid_t clk = CLOCK_REALTIME;
+               struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
+               clockid_t clk = CLOCK_REALTIME;
    #ifdef CLOCK_REALTIME_COARSE
-           clk = CLOCK_REALTIME_COARSE;
+               clk = CLOCK_REALTIME_COARSE;
    #endif
-           if (!clock_gettime(clk, &when))
-           {
-               min = (when.tv_sec / 60) % 60;
-               sec = when.tv_sec % 60;
-               ms = when.tv_nsec / 1000000;
-           }
+               if (!clock_gettime(clk, &when))
+               {
+                   min = (when.tv_sec / 60) % 60;
+                   sec = when.tv_sec % 60;
+                   ms = when.tv_nsec / 1000000;
+               }
    #elif defined(_WIN32)
-           SYSTEMTIME systemTime = {0};
-           GetLocalTime(&systemTime);
-           min = (int)systemTime.wMinute;
-           sec = (int)systemTime.wSecond;
-           ms  = (int)systemTime.wMilliseconds;
+               SYSTEMTIME systemTime = {0};
+               GetLocalTime(&systemTime);
+               min = (int)systemTime.wMinute;
+               sec = (int)systemTime.wSecond;
+               ms  = (int)systemTime.wMilliseconds;
    #else
-           struct timeval now;
-           if (!gettimeofday(&now, NULL))
-           {
-               min = (now.tv_sec / 60) % 60;
-               sec = now.tv_sec % 60;
-               ms = now.tv_usec * 1000;
-           }
+               struct timeval now;
+               if (!gettimeofday(&now, NULL))
+               {
+                   min = (now.tv_sec / 60) % 60;
+                   sec = now.tv_sec % 60;
+                   ms = now.tv_usec * 1000;
+               }
    #endif
+           }
            printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
        }
    #endif
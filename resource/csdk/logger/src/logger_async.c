@@ -0,0 +1,1700 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Defining _POSIX_C_SOURCE macro with 200809L (or greater) as value
+// causes header files to expose definitions
+// corresponding to the POSIX.1-2008 specification
+//
+// For this specific file, see use of clock_gettime, nanosleep and strnlen.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logger_async.h"
+#include "oic_hash.h"
+
+#if (defined(__linux__) || defined(__APPLE__)) && defined(__GNUC__)
+#define OC_LOG_ASYNC_SUPPORTED
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+
+/** Longest tag kept in a record, longer tags are truncated. */
+#define OC_LOG_ASYNC_MAX_TAG (64)
+
+/** Longest format string kept in a record, longer ones are formatted right away. */
+#define OC_LOG_ASYNC_MAX_FORMAT (256)
+
+/** Space for the encoded arguments of a record. */
+#define OC_LOG_ASYNC_MAX_ARGS (512)
+
+/** Bytes of a hex dump per record, larger buffers take several records. */
+#define OC_LOG_ASYNC_MAX_BUFFER (512)
+
+/** Number of tags the rate limiter tracks. */
+#define OC_LOG_ASYNC_RATE_SLOTS (128)
+
+/** Slots probed for a tag before it is not rate limited at all. */
+#define OC_LOG_ASYNC_RATE_PROBES (8)
+
+/** Tag of the messages the asynchronous logger writes itself. */
+#define OC_LOG_ASYNC_TAG "OIC_LOG_ASYNC"
+
+/** Magic and version at the start of a binary log. */
+static const uint8_t BINARY_MAGIC[] = { 'O', 'C', 'L', 'B', 1, 0, 0, 0 };
+
+/** Record types of a binary log. */
+#define BINARY_TAG      'T'
+#define BINARY_FORMAT   'F'
+#define BINARY_LOG      'L'
+#define BINARY_BUFFER   'B'
+#define BINARY_DROPPED  'D'
+
+/** Type tags of the encoded arguments. */
+#define ARG_TAG_INT     'i'
+#define ARG_TAG_UINT    'u'
+#define ARG_TAG_DOUBLE  'd'
+#define ARG_TAG_STRING  's'
+
+static const char *LEVEL_NAMES[] = {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+
+//-----------------------------------------------------------------------------
+// Format strings and encoded arguments
+//-----------------------------------------------------------------------------
+
+/**
+ * Kind of argument a conversion specification consumes.
+ */
+typedef enum
+{
+    ARG_NONE = 0,       /**< "%%". */
+    ARG_INT,
+    ARG_UINT,
+    ARG_DOUBLE,
+    ARG_STRING,
+    ARG_POINTER,
+    ARG_COUNT           /**< "%n", the argument is skipped. */
+} OCLogArgType;
+
+/**
+ * A parsed printf conversion specification.
+ */
+typedef struct
+{
+    size_t length;      /**< length of the specification including the '%'. */
+    size_t modStart;    /**< offset of the length modifier or the conversion. */
+    int numStars;       /**< number of '*' for width and precision. */
+    int precision;      /**< precision given as digits, -1 if none or '*'. */
+    bool precisionStar; /**< precision is given as an argument. */
+    char lengthMod[3];  /**< length modifier, "" if none. */
+    OCLogArgType type;
+} OCLogSpec;
+
+static bool ParseSpec(const char *spec, OCLogSpec *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->precision = -1;
+
+    size_t i = 1;
+    if ('%' == spec[i])
+    {
+        out->length = 2;
+        out->modStart = 1;
+        out->type = ARG_NONE;
+        return true;
+    }
+
+    while (spec[i] && strchr("-+ #0'", spec[i]))
+    {
+        i++;
+    }
+    if ('*' == spec[i])
+    {
+        out->numStars++;
+        i++;
+    }
+    else
+    {
+        while (spec[i] >= '0' && spec[i] <= '9')
+        {
+            i++;
+        }
+    }
+    if ('.' == spec[i])
+    {
+        i++;
+        if ('*' == spec[i])
+        {
+            out->numStars++;
+            out->precisionStar = true;
+            i++;
+        }
+        else
+        {
+            out->precision = 0;
+            while (spec[i] >= '0' && spec[i] <= '9')
+            {
+                if (out->precision < MAX_LOG_V_BUFFER_SIZE)
+                {
+                    out->precision = out->precision * 10 + (spec[i] - '0');
+                }
+                i++;
+            }
+        }
+    }
+
+    out->modStart = i;
+    size_t modLen = 0;
+    while (spec[i] && strchr("hlLqjzt", spec[i]))
+    {
+        if (modLen < 2)
+        {
+            out->lengthMod[modLen++] = spec[i];
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    bool wide = ('l' == out->lengthMod[0] && '\0' == out->lengthMod[1]);
+    switch (spec[i])
+    {
+        case 'd':
+        case 'i':
+            out->type = ARG_INT;
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            out->type = ARG_UINT;
+            break;
+        case 'c':
+            if (wide)
+            {
+                return false;
+            }
+            out->type = ARG_INT;
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            out->type = ARG_DOUBLE;
+            break;
+        case 's':
+            if (wide)
+            {
+                return false;
+            }
+            out->type = ARG_STRING;
+            break;
+        case 'p':
+            out->type = ARG_POINTER;
+            break;
+        case 'n':
+            out->type = ARG_COUNT;
+            break;
+        default:
+            return false;
+    }
+    out->length = i + 1;
+    return true;
+}
+
+static void PutU16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void PutU32(uint8_t *p, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void PutU64(uint8_t *p, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint16_t GetU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t *p)
+{
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static uint64_t GetU64(const uint8_t *p)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static bool PutNumber(uint8_t *out, size_t outSize, size_t *len, char tag, uint64_t value)
+{
+    if (outSize - *len < 1 + sizeof(uint64_t))
+    {
+        return false;
+    }
+    out[(*len)++] = (uint8_t)tag;
+    PutU64(out + *len, value);
+    *len += sizeof(uint64_t);
+    return true;
+}
+
+static bool PutString(uint8_t *out, size_t outSize, size_t *len, const char *str, size_t maxLen)
+{
+    if (outSize - *len < 1 + sizeof(uint16_t))
+    {
+        return false;
+    }
+    size_t strLen = strnlen(str, maxLen);
+    size_t room = outSize - *len - 1 - sizeof(uint16_t);
+    if (strLen > room)
+    {
+        strLen = room;
+    }
+    out[(*len)++] = ARG_TAG_STRING;
+    PutU16(out + *len, (uint16_t)strLen);
+    *len += sizeof(uint16_t);
+    memcpy(out + *len, str, strLen);
+    *len += strLen;
+    return true;
+}
+
+static uint64_t DoubleToBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double BitsToDouble(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Copy the arguments a format string consumes into a compact, byte order
+ * independent form, so that they can be formatted later.
+ *
+ * @return false if the format uses a conversion that is not supported or the
+ *         arguments do not fit; the caller has to format the message itself.
+ */
+static bool EncodeArgs(const char *format, va_list *args, uint8_t *out, size_t outSize,
+                       size_t *outLen)
+{
+    size_t len = 0;
+    for (const char *p = format; *p; p++)
+    {
+        if ('%' != *p)
+        {
+            continue;
+        }
+
+        OCLogSpec spec;
+        if (!ParseSpec(p, &spec))
+        {
+            return false;
+        }
+        p += spec.length - 1;
+
+        int precision = spec.precision;
+        for (int i = 0; i < spec.numStars; i++)
+        {
+            int value = va_arg(*args, int);
+            if (spec.precisionStar && i == spec.numStars - 1)
+            {
+                precision = value;
+            }
+            if (!PutNumber(out, outSize, &len, ARG_TAG_INT, (uint64_t)(int64_t)value))
+            {
+                return false;
+            }
+        }
+
+        const char *mod = spec.lengthMod;
+        bool ok = true;
+        switch (spec.type)
+        {
+            case ARG_NONE:
+                break;
+            case ARG_INT:
+            {
+                int64_t value;
+                if (!strcmp(mod, "l"))
+                {
+                    value = va_arg(*args, long);
+                }
+                else if (!strcmp(mod, "ll") || !strcmp(mod, "q"))
+                {
+                    value = va_arg(*args, long long);
+                }
+                else if (!strcmp(mod, "j"))
+                {
+                    value = va_arg(*args, intmax_t);
+                }
+                else if (!strcmp(mod, "z"))
+                {
+                    value = (int64_t)va_arg(*args, size_t);
+                }
+                else if (!strcmp(mod, "t"))
+                {
+                    value = va_arg(*args, ptrdiff_t);
+                }
+                else if (!strcmp(mod, "hh"))
+                {
+                    value = (signed char)va_arg(*args, int);
+                }
+                else if (!strcmp(mod, "h"))
+                {
+                    value = (short)va_arg(*args, int);
+                }
+                else
+                {
+                    value = va_arg(*args, int);
+                }
+                ok = PutNumber(out, outSize, &len, ARG_TAG_INT, (uint64_t)value);
+                break;
+            }
+            case ARG_UINT:
+            {
+                uint64_t value;
+                if (!strcmp(mod, "l"))
+                {
+                    value = va_arg(*args, unsigned long);
+                }
+                else if (!strcmp(mod, "ll") || !strcmp(mod, "q"))
+                {
+                    value = va_arg(*args, unsigned long long);
+                }
+                else if (!strcmp(mod, "j"))
+                {
+                    value = va_arg(*args, uintmax_t);
+                }
+                else if (!strcmp(mod, "z"))
+                {
+                    value = va_arg(*args, size_t);
+                }
+                else if (!strcmp(mod, "t"))
+                {
+                    value = (uint64_t)va_arg(*args, ptrdiff_t);
+                }
+                else if (!strcmp(mod, "hh"))
+                {
+                    value = (unsigned char)va_arg(*args, unsigned int);
+                }
+                else if (!strcmp(mod, "h"))
+                {
+                    value = (unsigned short)va_arg(*args, unsigned int);
+                }
+                else
+                {
+                    value = va_arg(*args, unsigned int);
+                }
+                ok = PutNumber(out, outSize, &len, ARG_TAG_UINT, value);
+                break;
+            }
+            case ARG_DOUBLE:
+            {
+                double value;
+                if (!strcmp(mod, "L"))
+                {
+                    value = (double)va_arg(*args, long double);
+                }
+                else
+                {
+                    value = va_arg(*args, double);
+                }
+                ok = PutNumber(out, outSize, &len, ARG_TAG_DOUBLE, DoubleToBits(value));
+                break;
+            }
+            case ARG_STRING:
+            {
+                const char *value = va_arg(*args, const char *);
+                if (!value)
+                {
+                    value = "(null)";
+                }
+                // A precision bounds the read, the string need not be terminated.
+                size_t maxLen = (precision >= 0) ? (size_t)precision : MAX_LOG_V_BUFFER_SIZE;
+                if (maxLen > MAX_LOG_V_BUFFER_SIZE)
+                {
+                    maxLen = MAX_LOG_V_BUFFER_SIZE;
+                }
+                ok = PutString(out, outSize, &len, value, maxLen);
+                break;
+            }
+            case ARG_POINTER:
+                ok = PutNumber(out, outSize, &len, ARG_TAG_UINT,
+                               (uint64_t)(uintptr_t)va_arg(*args, void *));
+                break;
+            case ARG_COUNT:
+                (void)va_arg(*args, void *);
+                break;
+        }
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    *outLen = len;
+    return true;
+}
+
+/**
+ * Cursor over encoded arguments.
+ */
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+} OCLogArgReader;
+
+static bool GetNumber(OCLogArgReader *reader, char tag, uint64_t *value)
+{
+    if (reader->len - reader->pos < 1 + sizeof(uint64_t) || tag != reader->data[reader->pos])
+    {
+        return false;
+    }
+    *value = GetU64(reader->data + reader->pos + 1);
+    reader->pos += 1 + sizeof(uint64_t);
+    return true;
+}
+
+static bool GetString(OCLogArgReader *reader, char *buffer, size_t bufferSize)
+{
+    if (reader->len - reader->pos < 1 + sizeof(uint16_t) ||
+        ARG_TAG_STRING != reader->data[reader->pos])
+    {
+        return false;
+    }
+    size_t strLen = GetU16(reader->data + reader->pos + 1);
+    reader->pos += 1 + sizeof(uint16_t);
+    if (reader->len - reader->pos < strLen)
+    {
+        return false;
+    }
+    size_t copyLen = (strLen < bufferSize - 1) ? strLen : bufferSize - 1;
+    memcpy(buffer, reader->data + reader->pos, copyLen);
+    buffer[copyLen] = '\0';
+    reader->pos += strLen;
+    return true;
+}
+
+/**
+ * Format a message from its format string and encoded arguments, the same
+ * way vsnprintf() would have formatted it from the original arguments.
+ * Formatting stops at the first argument that does not match.
+ */
+static void FormatArgs(const char *format, const uint8_t *args, size_t argsLen,
+                       char *out, size_t outSize)
+{
+    OCLogArgReader reader = { .data = args, .len = argsLen, .pos = 0 };
+    size_t len = 0;
+    out[0] = '\0';
+
+    for (const char *p = format; *p && len < outSize - 1; p++)
+    {
+        if ('%' != *p)
+        {
+            out[len++] = *p;
+            out[len] = '\0';
+            continue;
+        }
+
+        OCLogSpec spec;
+        if (!ParseSpec(p, &spec))
+        {
+            return;
+        }
+
+        if (ARG_NONE == spec.type)
+        {
+            out[len++] = '%';
+            out[len] = '\0';
+            p += spec.length - 1;
+            continue;
+        }
+
+        // Rebuild the specification with '*' replaced by the recorded values
+        // and a length modifier matching the recorded type.
+        char specBuf[64];
+        size_t specLen = 0;
+        for (size_t i = 0; i < spec.modStart; i++)
+        {
+            if ('*' == p[i])
+            {
+                uint64_t value = 0;
+                if (!GetNumber(&reader, ARG_TAG_INT, &value))
+                {
+                    return;
+                }
+                int number = (int)(int64_t)value;
+                if (number < 0 && specLen > 0 && '.' == specBuf[specLen - 1])
+                {
+                    // A negative precision is taken as if it was omitted.
+                    specLen--;
+                    continue;
+                }
+                int written = snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "%d", number);
+                if (written < 0 || (size_t)written >= sizeof(specBuf) - specLen)
+                {
+                    return;
+                }
+                specLen += (size_t)written;
+            }
+            else if (specLen < sizeof(specBuf) - 4)
+            {
+                specBuf[specLen++] = p[i];
+            }
+            else
+            {
+                return;
+            }
+        }
+        if (ARG_INT == spec.type || ARG_UINT == spec.type)
+        {
+            if ('c' != p[spec.length - 1])
+            {
+                specBuf[specLen++] = 'l';
+                specBuf[specLen++] = 'l';
+            }
+        }
+        specBuf[specLen++] = p[spec.length - 1];
+        specBuf[specLen] = '\0';
+        p += spec.length - 1;
+
+        int written = 0;
+        uint64_t value = 0;
+        switch (spec.type)
+        {
+            case ARG_INT:
+                if (!GetNumber(&reader, ARG_TAG_INT, &value))
+                {
+                    return;
+                }
+                if ('c' == specBuf[specLen - 1])
+                {
+                    written = snprintf(out + len, outSize - len, specBuf, (int)(int64_t)value);
+                }
+                else
+                {
+                    written = snprintf(out + len, outSize - len, specBuf,
+                                       (long long)(int64_t)value);
+                }
+                break;
+            case ARG_UINT:
+                if (!GetNumber(&reader, ARG_TAG_UINT, &value))
+                {
+                    return;
+                }
+                written = snprintf(out + len, outSize - len, specBuf, (unsigned long long)value);
+                break;
+            case ARG_DOUBLE:
+                if (!GetNumber(&reader, ARG_TAG_DOUBLE, &value))
+                {
+                    return;
+                }
+                written = snprintf(out + len, outSize - len, specBuf, BitsToDouble(value));
+                break;
+            case ARG_STRING:
+            {
+                char str[MAX_LOG_V_BUFFER_SIZE + 1];
+                if (!GetString(&reader, str, sizeof(str)))
+                {
+                    return;
+                }
+                written = snprintf(out + len, outSize - len, specBuf, str);
+                break;
+            }
+            case ARG_POINTER:
+                if (!GetNumber(&reader, ARG_TAG_UINT, &value))
+                {
+                    return;
+                }
+                written = snprintf(out + len, outSize - len, specBuf, (void *)(uintptr_t)value);
+                break;
+            default:
+                break;
+        }
+        if (written < 0)
+        {
+            return;
+        }
+        len += (size_t)written;
+        if (len >= outSize)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Hex dump a buffer 16 bytes a line, like OCLogBuffer() does.
+ */
+static void WriteHexLines(LogLevel level, const char *tag, const uint8_t *data, size_t len,
+                          uint64_t timeUs, void (*write)(LogLevel, const char *, const char *,
+                                                         uint64_t, void *), void *ctx)
+{
+    char line[16 * 3 + 1];
+    for (size_t i = 0; i < len; i += 16)
+    {
+        size_t lineLen = 0;
+        for (size_t j = i; j < len && j < i + 16; j++)
+        {
+            snprintf(line + lineLen, sizeof(line) - lineLen, "%02X ", data[j]);
+            lineLen += 3;
+        }
+        write(level, tag, line, timeUs, ctx);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Binary log decoder
+//-----------------------------------------------------------------------------
+
+/**
+ * Strings defined in a binary log, indexed by their id.
+ */
+typedef struct
+{
+    char **strings;
+    size_t count;
+} OCLogStringTable;
+
+static bool ReadBytes(FILE *in, void *buffer, size_t len)
+{
+    return fread(buffer, 1, len, in) == len;
+}
+
+static bool DefineString(FILE *in, OCLogStringTable *table)
+{
+    uint8_t header[6];
+    if (!ReadBytes(in, header, sizeof(header)))
+    {
+        return false;
+    }
+    uint32_t id = GetU32(header);
+    uint16_t len = GetU16(header + 4);
+    if (id != table->count)
+    {
+        return false;
+    }
+
+    char **strings = (char **)realloc(table->strings, (table->count + 1) * sizeof(char *));
+    if (!strings)
+    {
+        return false;
+    }
+    table->strings = strings;
+    char *str = (char *)malloc(len + 1u);
+    if (!str || !ReadBytes(in, str, len))
+    {
+        free(str);
+        return false;
+    }
+    str[len] = '\0';
+    table->strings[table->count++] = str;
+    return true;
+}
+
+static void FreeStringTable(OCLogStringTable *table)
+{
+    for (size_t i = 0; i < table->count; i++)
+    {
+        free(table->strings[i]);
+    }
+    free(table->strings);
+}
+
+static void PrintDecodedLine(LogLevel level, const char *tag, const char *logStr,
+                             uint64_t timeUs, void *ctx)
+{
+    fprintf((FILE *)ctx, "%02d:%02d.%03d %s: %s: %s\n",
+            (int)((timeUs / 60000000) % 60), (int)((timeUs / 1000000) % 60),
+            (int)((timeUs / 1000) % 1000), LEVEL_NAMES[level], tag, logStr);
+}
+
+bool OCLogDecodeBinary(FILE *in, FILE *out)
+{
+    if (!in || !out)
+    {
+        return false;
+    }
+
+    uint8_t magic[sizeof(BINARY_MAGIC)];
+    if (!ReadBytes(in, magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)))
+    {
+        return false;
+    }
+
+    OCLogStringTable tags = { .strings = NULL, .count = 0 };
+    OCLogStringTable formats = { .strings = NULL, .count = 0 };
+    uint8_t data[OC_LOG_ASYNC_MAX_ARGS > OC_LOG_ASYNC_MAX_BUFFER ?
+                 OC_LOG_ASYNC_MAX_ARGS : OC_LOG_ASYNC_MAX_BUFFER];
+    bool ok = true;
+    int type;
+    while (ok && EOF != (type = fgetc(in)))
+    {
+        uint8_t header[19];
+        switch (type)
+        {
+            case BINARY_TAG:
+                ok = DefineString(in, &tags);
+                break;
+            case BINARY_FORMAT:
+                ok = DefineString(in, &formats);
+                break;
+            case BINARY_LOG:
+            {
+                // time, level, tag id, format id, length of the arguments
+                ok = ReadBytes(in, header, 19);
+                if (!ok)
+                {
+                    break;
+                }
+                uint8_t level = header[8];
+                uint32_t tagId = GetU32(header + 9);
+                uint32_t formatId = GetU32(header + 13);
+                uint16_t len = GetU16(header + 17);
+                ok = level <= FATAL && tagId < tags.count && formatId < formats.count &&
+                     len <= sizeof(data) && ReadBytes(in, data, len);
+                if (ok)
+                {
+                    char text[MAX_LOG_V_BUFFER_SIZE];
+                    FormatArgs(formats.strings[formatId], data, len, text, sizeof(text));
+                    PrintDecodedLine((LogLevel)level, tags.strings[tagId], text,
+                                     GetU64(header), out);
+                }
+                break;
+            }
+            case BINARY_BUFFER:
+            {
+                // time, level, tag id, length of the buffer
+                ok = ReadBytes(in, header, 15);
+                if (!ok)
+                {
+                    break;
+                }
+                uint8_t level = header[8];
+                uint32_t tagId = GetU32(header + 9);
+                uint16_t len = GetU16(header + 13);
+                ok = level <= FATAL && tagId < tags.count &&
+                     len <= sizeof(data) && ReadBytes(in, data, len);
+                if (ok)
+                {
+                    WriteHexLines((LogLevel)level, tags.strings[tagId], data, len,
+                                  GetU64(header), PrintDecodedLine, out);
+                }
+                break;
+            }
+            case BINARY_DROPPED:
+            {
+                // time, number of dropped messages
+                ok = ReadBytes(in, header, 12);
+                if (ok)
+                {
+                    char text[64];
+                    snprintf(text, sizeof(text), "%u log messages dropped",
+                             (unsigned int)GetU32(header + 8));
+                    PrintDecodedLine(WARNING, OC_LOG_ASYNC_TAG, text, GetU64(header), out);
+                }
+                break;
+            }
+            default:
+                ok = false;
+                break;
+        }
+    }
+
+    FreeStringTable(&tags);
+    FreeStringTable(&formats);
+    return ok;
+}
+
+#ifdef OC_LOG_ASYNC_SUPPORTED
+
+//-----------------------------------------------------------------------------
+// Ring buffers
+//-----------------------------------------------------------------------------
+
+/** Record types in a ring buffer. */
+#define RECORD_PAD      0
+#define RECORD_LOG      1
+#define RECORD_BUFFER   2
+
+/**
+ * Header of a record in a ring buffer. The tag, the format string and the
+ * encoded arguments (or the buffer bytes) follow it. The size and type come
+ * first, so that a padding record needs only 8 bytes.
+ */
+typedef struct
+{
+    uint32_t size;          /**< size including this header, a multiple of 8. */
+    uint8_t type;           /**< RECORD_*. */
+    uint8_t level;          /**< level the message is written with. */
+    uint16_t tagLen;        /**< length of the tag. */
+    uint16_t formatLen;     /**< length of the format string. */
+    uint16_t dataLen;       /**< length of the encoded arguments or buffer bytes. */
+    uint32_t reserved;
+    uint64_t timeUs;        /**< time the message was logged. */
+} OCLogRecord;
+
+#define RECORD_ALIGN(x) (((x) + 7) & ~(size_t)7)
+#define MAX_RECORD_SIZE RECORD_ALIGN(sizeof(OCLogRecord) + OC_LOG_ASYNC_MAX_TAG + \
+                                     OC_LOG_ASYNC_MAX_FORMAT + OC_LOG_ASYNC_MAX_ARGS)
+
+/**
+ * Ring buffer of one logging thread. The thread is the only producer and the
+ * background thread the only consumer, so head and tail need no lock.
+ */
+typedef struct OCLogRing
+{
+    struct OCLogRing *next; /**< next ring in g_rings. */
+    uint8_t *data;
+    size_t size;            /**< size of data, a power of two. */
+    uint64_t head;          /**< written by the producer. */
+    uint64_t tail;          /**< written by the consumer. */
+    uint32_t dropped;       /**< messages which did not fit. */
+    int orphaned;           /**< the thread has exited. */
+} OCLogRing;
+
+/**
+ * Rate limiter state of one tag.
+ */
+typedef struct
+{
+    uint32_t hash;          /**< hash of the tag, 0 for a free slot. */
+    uint32_t count;         /**< messages in the current second. */
+    uint32_t suppressed;    /**< messages dropped in the current second. */
+    uint64_t second;        /**< the current second. */
+} OCLogRateSlot;
+
+/**
+ * Strings interned for the binary output, mapped to their id.
+ */
+typedef struct
+{
+    uint32_t hash;
+    uint32_t id;
+    char *str;
+} OCLogInternSlot;
+
+typedef struct
+{
+    OCLogInternSlot *slots;
+    size_t capacity;
+    uint32_t count;
+} OCLogInternTable;
+
+static pthread_mutex_t g_controlLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_ringsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_ringKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_ringKey;
+static pthread_t g_drainThread;
+
+static OCLogRing *g_rings = NULL;
+static __thread OCLogRing *t_ring = NULL;
+
+/** Bumped when OCLogAsyncStop() frees the rings, t_ring is stale if it differs. */
+static uint32_t g_ringGeneration = 0;
+static __thread uint32_t t_ringGeneration = 0;
+
+static OCLogAsyncConfig g_config;
+static int g_active = 0;
+static int g_running = 0;
+static int g_producers = 0;     /**< threads between EnterProducer and LeaveProducer. */
+static uint64_t g_flushRequested = 0;
+static uint64_t g_flushCompleted = 0;
+
+static OCLogRateSlot g_rateSlots[OC_LOG_ASYNC_RATE_SLOTS];
+static OCLogInternTable g_tagIds;
+static OCLogInternTable g_formatIds;
+
+static uint64_t GetTimeUs()
+{
+    struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    clock_gettime(clk, &when);
+    return (uint64_t)when.tv_sec * 1000000 + (uint64_t)when.tv_nsec / 1000;
+}
+
+static uint32_t HashString(const char *str, size_t len)
+{
+    return OICHashBytes(OIC_HASH_INIT, str, len);
+}
+
+static void ReleaseThreadRing(void *ring)
+{
+    // The ring may already be freed by OCLogAsyncStop().
+    pthread_mutex_lock(&g_ringsLock);
+    if (t_ringGeneration == g_ringGeneration)
+    {
+        __atomic_store_n(&((OCLogRing *)ring)->orphaned, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_ringsLock);
+    t_ring = NULL;
+}
+
+static void CreateRingKey()
+{
+    pthread_key_create(&g_ringKey, ReleaseThreadRing);
+}
+
+static OCLogRing *GetThreadRing()
+{
+    if (t_ring && t_ringGeneration == __atomic_load_n(&g_ringGeneration, __ATOMIC_ACQUIRE))
+    {
+        return t_ring;
+    }
+    t_ring = NULL;
+
+    OCLogRing *ring = (OCLogRing *)calloc(1, sizeof(OCLogRing));
+    if (!ring)
+    {
+        return NULL;
+    }
+    ring->size = g_config.ringSize;
+    ring->data = (uint8_t *)malloc(ring->size);
+    if (!ring->data)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    // The ring is released when the thread exits and freed once it is drained.
+    pthread_once(&g_ringKeyOnce, CreateRingKey);
+    pthread_setspecific(g_ringKey, ring);
+
+    pthread_mutex_lock(&g_ringsLock);
+    ring->next = g_rings;
+    g_rings = ring;
+    t_ringGeneration = g_ringGeneration;
+    pthread_mutex_unlock(&g_ringsLock);
+
+    t_ring = ring;
+    return ring;
+}
+
+static bool RingWrite(OCLogRing *ring, const OCLogRecord *record)
+{
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t offset = (size_t)(head & (ring->size - 1));
+    size_t toEnd = ring->size - offset;
+    size_t needed = record->size + ((toEnd < record->size) ? toEnd : 0);
+    if (ring->size - (size_t)(head - tail) < needed)
+    {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    if (toEnd < record->size)
+    {
+        // Records are contiguous, skip the end of the ring.
+        OCLogRecord *pad = (OCLogRecord *)(ring->data + offset);
+        pad->size = (uint32_t)toEnd;
+        pad->type = RECORD_PAD;
+        head += toEnd;
+        offset = 0;
+    }
+    memcpy(ring->data + offset, record, record->size);
+    __atomic_store_n(&ring->head, head + record->size, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Build a record in a scratch buffer and queue it in the calling thread's ring.
+ */
+static void QueueRecord(uint8_t type, LogLevel level, const char *tag, const char *format,
+                        size_t formatLen, const uint8_t *data, size_t dataLen, uint64_t timeUs)
+{
+    OCLogRing *ring = GetThreadRing();
+    if (!ring)
+    {
+        return;
+    }
+
+    uint64_t scratch[MAX_RECORD_SIZE / sizeof(uint64_t)];
+    OCLogRecord *record = (OCLogRecord *)scratch;
+    uint8_t *p = (uint8_t *)(record + 1);
+
+    size_t tagLen = strnlen(tag, OC_LOG_ASYNC_MAX_TAG);
+    memcpy(p, tag, tagLen);
+    memcpy(p + tagLen, format, formatLen);
+    if (data)
+    {
+        memcpy(p + tagLen + formatLen, data, dataLen);
+    }
+
+    record->size = (uint32_t)RECORD_ALIGN(sizeof(OCLogRecord) + tagLen + formatLen + dataLen);
+    record->type = type;
+    record->level = (uint8_t)level;
+    record->tagLen = (uint16_t)tagLen;
+    record->formatLen = (uint16_t)formatLen;
+    record->dataLen = (uint16_t)dataLen;
+    record->reserved = 0;
+    record->timeUs = timeUs;
+    RingWrite(ring, record);
+}
+
+static void QueueString(LogLevel level, const char *tag, const char *str, uint64_t timeUs)
+{
+    uint8_t args[OC_LOG_ASYNC_MAX_ARGS];
+    size_t argsLen = 0;
+    PutString(args, sizeof(args), &argsLen, str, MAX_LOG_V_BUFFER_SIZE);
+    QueueRecord(RECORD_LOG, level, tag, "%s", 2, args, argsLen, timeUs);
+}
+
+/**
+ * @return true if the message exceeds the rate of its tag and has to be dropped.
+ */
+static bool IsRateLimited(LogLevel level, const char *tag, uint64_t timeUs)
+{
+    uint32_t maxPerSecond = g_config.maxPerSecond;
+    if (0 == maxPerSecond || level > INFO)
+    {
+        return false;
+    }
+
+    uint32_t hash = HashString(tag, strnlen(tag, OC_LOG_ASYNC_MAX_TAG));
+    if (0 == hash)
+    {
+        hash = 1;
+    }
+
+    OCLogRateSlot *slot = NULL;
+    for (size_t i = 0; i < OC_LOG_ASYNC_RATE_PROBES && !slot; i++)
+    {
+        OCLogRateSlot *candidate = &g_rateSlots[(hash + i) % OC_LOG_ASYNC_RATE_SLOTS];
+        uint32_t expected = 0;
+        if (hash == __atomic_load_n(&candidate->hash, __ATOMIC_ACQUIRE) ||
+            __atomic_compare_exchange_n(&candidate->hash, &expected, hash, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+            expected == hash)
+        {
+            slot = candidate;
+        }
+    }
+    if (!slot)
+    {
+        // Too many tags, this one is not limited.
+        return false;
+    }
+
+    uint64_t second = timeUs / 1000000;
+    uint64_t current = __atomic_load_n(&slot->second, __ATOMIC_ACQUIRE);
+    if (current != second &&
+        __atomic_compare_exchange_n(&slot->second, &current, second, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        __atomic_store_n(&slot->count, 0, __ATOMIC_RELEASE);
+        uint32_t suppressed = __atomic_exchange_n(&slot->suppressed, 0, __ATOMIC_ACQ_REL);
+        if (suppressed)
+        {
+            char text[64];
+            snprintf(text, sizeof(text), "%u messages suppressed by the rate limit",
+                     (unsigned int)suppressed);
+            QueueString(WARNING, tag, text, timeUs);
+        }
+    }
+
+    if (__atomic_add_fetch(&slot->count, 1, __ATOMIC_ACQ_REL) > maxPerSecond)
+    {
+        __atomic_fetch_add(&slot->suppressed, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Announce a thread about to queue a message. OCLogAsyncStop() waits for it
+ * to leave before the final drain, so that nothing is left in a ring.
+ *
+ * @return false if the logger is not active.
+ */
+static bool EnterProducer()
+{
+    __atomic_add_fetch(&g_producers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&g_active, __ATOMIC_SEQ_CST))
+    {
+        __atomic_sub_fetch(&g_producers, 1, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+static void LeaveProducer()
+{
+    __atomic_sub_fetch(&g_producers, 1, __ATOMIC_RELEASE);
+}
+
+bool OCLogAsyncLogv(LogLevel level, const char *tag, const char *format, va_list args)
+{
+    if (!EnterProducer())
+    {
+        return false;
+    }
+
+    uint64_t timeUs = GetTimeUs();
+    if (IsRateLimited(level, tag, timeUs))
+    {
+        LeaveProducer();
+        return true;
+    }
+
+    uint8_t encoded[OC_LOG_ASYNC_MAX_ARGS];
+    size_t encodedLen = 0;
+    size_t formatLen = strnlen(format, OC_LOG_ASYNC_MAX_FORMAT + 1);
+
+    va_list copy;
+    va_copy(copy, args);
+    bool deferred = formatLen <= OC_LOG_ASYNC_MAX_FORMAT &&
+                    EncodeArgs(format, &copy, encoded, sizeof(encoded), &encodedLen);
+    va_end(copy);
+
+    if (deferred)
+    {
+        QueueRecord(RECORD_LOG, level, tag, format, formatLen, encoded, encodedLen, timeUs);
+    }
+    else
+    {
+        // Not something the encoder knows, format it right away.
+        char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
+        vsnprintf(buffer, sizeof buffer - 1, format, args);
+        QueueString(level, tag, buffer, timeUs);
+    }
+    LeaveProducer();
+    return true;
+}
+
+bool OCLogAsyncLog(LogLevel level, const char *tag, const char *logStr)
+{
+    if (!EnterProducer())
+    {
+        return false;
+    }
+
+    uint64_t timeUs = GetTimeUs();
+    if (!IsRateLimited(level, tag, timeUs))
+    {
+        QueueString(level, tag, logStr, timeUs);
+    }
+    LeaveProducer();
+    return true;
+}
+
+bool OCLogAsyncLogBuffer(LogLevel level, const char *tag,
+                         const uint8_t *buffer, size_t bufferSize)
+{
+    if (!EnterProducer())
+    {
+        return false;
+    }
+
+    uint64_t timeUs = GetTimeUs();
+    if (IsRateLimited(level, tag, timeUs))
+    {
+        LeaveProducer();
+        return true;
+    }
+
+    for (size_t offset = 0; offset < bufferSize; offset += OC_LOG_ASYNC_MAX_BUFFER)
+    {
+        size_t len = bufferSize - offset;
+        if (len > OC_LOG_ASYNC_MAX_BUFFER)
+        {
+            len = OC_LOG_ASYNC_MAX_BUFFER;
+        }
+        QueueRecord(RECORD_BUFFER, level, tag, "", 0, buffer + offset, len, timeUs);
+    }
+    LeaveProducer();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Background thread
+//-----------------------------------------------------------------------------
+
+static void WriteText(LogLevel level, const char *tag, const char *logStr, uint64_t timeUs,
+                      void *ctx)
+{
+    (void)ctx;
+    OCLogWrite(level, tag, logStr, timeUs);
+}
+
+static void FreeInternTable(OCLogInternTable *table)
+{
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        free(table->slots[i].str);
+    }
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+/**
+ * Get the id of a string in the binary output, defining it first if needed.
+ *
+ * @return false if the string could not be interned.
+ */
+static bool InternString(OCLogInternTable *table, char recordType, const char *str,
+                         size_t len, uint32_t *id)
+{
+    if (2 * (table->count + 1) > table->capacity)
+    {
+        size_t capacity = table->capacity ? table->capacity * 2 : 64;
+        OCLogInternSlot *slots = (OCLogInternSlot *)calloc(capacity, sizeof(OCLogInternSlot));
+        if (!slots)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            OCLogInternSlot *old = &table->slots[i];
+            if (old->str)
+            {
+                size_t j = old->hash & (capacity - 1);
+                while (slots[j].str)
+                {
+                    j = (j + 1) & (capacity - 1);
+                }
+                slots[j] = *old;
+            }
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->capacity = capacity;
+    }
+
+    uint32_t hash = HashString(str, len);
+    size_t i = hash & (table->capacity - 1);
+    while (table->slots[i].str)
+    {
+        OCLogInternSlot *slot = &table->slots[i];
+        if (slot->hash == hash && !strncmp(slot->str, str, len) && '\0' == slot->str[len])
+        {
+            *id = slot->id;
+            return true;
+        }
+        i = (i + 1) & (table->capacity - 1);
+    }
+
+    char *copy = (char *)malloc(len + 1);
+    if (!copy)
+    {
+        return false;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    OCLogInternSlot *slot = &table->slots[i];
+    slot->hash = hash;
+    slot->id = table->count++;
+    slot->str = copy;
+    *id = slot->id;
+
+    uint8_t header[7];
+    header[0] = (uint8_t)recordType;
+    PutU32(header + 1, slot->id);
+    PutU16(header + 5, (uint16_t)len);
+    fwrite(header, 1, sizeof(header), g_config.binaryOutput);
+    fwrite(str, 1, len, g_config.binaryOutput);
+    return true;
+}
+
+static void WriteBinaryRecord(const OCLogRecord *record, const char *tag, const char *format,
+                              const uint8_t *data)
+{
+    FILE *out = g_config.binaryOutput;
+    uint32_t tagId = 0;
+    uint32_t formatId = 0;
+    if (!InternString(&g_tagIds, BINARY_TAG, tag, record->tagLen, &tagId))
+    {
+        return;
+    }
+
+    uint8_t header[20];
+    size_t headerLen = 0;
+    if (RECORD_LOG == record->type)
+    {
+        if (!InternString(&g_formatIds, BINARY_FORMAT, format, record->formatLen, &formatId))
+        {
+            return;
+        }
+        header[0] = BINARY_LOG;
+        PutU64(header + 1, record->timeUs);
+        header[9] = record->level;
+        PutU32(header + 10, tagId);
+        PutU32(header + 14, formatId);
+        PutU16(header + 18, record->dataLen);
+        headerLen = 20;
+    }
+    else
+    {
+        header[0] = BINARY_BUFFER;
+        PutU64(header + 1, record->timeUs);
+        header[9] = record->level;
+        PutU32(header + 10, tagId);
+        PutU16(header + 14, record->dataLen);
+        headerLen = 16;
+    }
+    fwrite(header, 1, headerLen, out);
+    fwrite(data, 1, record->dataLen, out);
+}
+
+static void WriteRecord(const OCLogRecord *record)
+{
+    const char *p = (const char *)(record + 1);
+    char tag[OC_LOG_ASYNC_MAX_TAG + 1];
+    char format[OC_LOG_ASYNC_MAX_FORMAT + 1];
+    memcpy(tag, p, record->tagLen);
+    tag[record->tagLen] = '\0';
+    memcpy(format, p + record->tagLen, record->formatLen);
+    format[record->formatLen] = '\0';
+    const uint8_t *data = (const uint8_t *)p + record->tagLen + record->formatLen;
+
+    if (g_config.binaryOutput)
+    {
+        WriteBinaryRecord(record, tag, format, data);
+    }
+    else if (RECORD_LOG == record->type)
+    {
+        char text[MAX_LOG_V_BUFFER_SIZE];
+        FormatArgs(format, data, record->dataLen, text, sizeof(text));
+        OCLogWrite((LogLevel)record->level, tag, text, record->timeUs);
+    }
+    else
+    {
+        WriteHexLines((LogLevel)record->level, tag, data, record->dataLen, record->timeUs,
+                      WriteText, NULL);
+    }
+}
+
+static void WriteDropped(uint32_t dropped)
+{
+    uint64_t timeUs = GetTimeUs();
+    if (g_config.binaryOutput)
+    {
+        uint8_t record[13];
+        record[0] = BINARY_DROPPED;
+        PutU64(record + 1, timeUs);
+        PutU32(record + 9, dropped);
+        fwrite(record, 1, sizeof(record), g_config.binaryOutput);
+    }
+    else
+    {
+        char text[64];
+        snprintf(text, sizeof(text), "%u log messages dropped", (unsigned int)dropped);
+        OCLogWrite(WARNING, OC_LOG_ASYNC_TAG, text, timeUs);
+    }
+}
+
+static size_t DrainRing(OCLogRing *ring)
+{
+    size_t count = 0;
+    uint64_t tail = ring->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while (tail != head)
+    {
+        const OCLogRecord *record =
+            (const OCLogRecord *)(ring->data + (size_t)(tail & (ring->size - 1)));
+        if (RECORD_PAD != record->type)
+        {
+            WriteRecord(record);
+            count++;
+        }
+        tail += record->size;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    return count;
+}
+
+/**
+ * Free all rings once they are drained. Threads which still hold one get a
+ * new ring when the logger is started again.
+ */
+static void FreeRings()
+{
+    pthread_mutex_lock(&g_ringsLock);
+    while (g_rings)
+    {
+        OCLogRing *ring = g_rings;
+        g_rings = ring->next;
+        free(ring->data);
+        free(ring);
+    }
+    __atomic_add_fetch(&g_ringGeneration, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_ringsLock);
+}
+
+/**
+ * Write everything queued in all rings, and free the rings of exited threads.
+ * Only one thread drains at a time.
+ *
+ * @return number of messages written.
+ */
+static size_t DrainAll()
+{
+    size_t count = 0;
+    uint32_t dropped = 0;
+
+    pthread_mutex_lock(&g_ringsLock);
+    OCLogRing **link = &g_rings;
+    while (*link)
+    {
+        OCLogRing *ring = *link;
+        // Read before draining, so that the last messages of the thread are seen.
+        bool orphaned = __atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE);
+        count += DrainRing(ring);
+        dropped += __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_ACQ_REL);
+        if (orphaned)
+        {
+            *link = ring->next;
+            free(ring->data);
+            free(ring);
+            continue;
+        }
+        link = &ring->next;
+    }
+    pthread_mutex_unlock(&g_ringsLock);
+
+    if (dropped)
+    {
+        WriteDropped(dropped);
+    }
+    if (count && g_config.binaryOutput)
+    {
+        fflush(g_config.binaryOutput);
+    }
+    return count;
+}
+
+static void SleepMs(uint32_t ms)
+{
+    struct timespec delay = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000 };
+    nanosleep(&delay, NULL);
+}
+
+static void *DrainThread(void *arg)
+{
+    (void)arg;
+    while (__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        uint64_t requested = __atomic_load_n(&g_flushRequested, __ATOMIC_ACQUIRE);
+        size_t count = DrainAll();
+
+        // Everything logged before the flush request was read has been written.
+        __atomic_store_n(&g_flushCompleted, requested, __ATOMIC_RELEASE);
+
+        if (0 == count && requested == __atomic_load_n(&g_flushRequested, __ATOMIC_ACQUIRE))
+        {
+            SleepMs(g_config.drainIntervalMs);
+        }
+    }
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Public APIs
+//-----------------------------------------------------------------------------
+
+bool OCLogAsyncStart(const OCLogAsyncConfig *config)
+{
+    pthread_mutex_lock(&g_controlLock);
+    if (g_running)
+    {
+        pthread_mutex_unlock(&g_controlLock);
+        return true;
+    }
+
+    if (config)
+    {
+        g_config = *config;
+    }
+    else
+    {
+        memset(&g_config, 0, sizeof(g_config));
+    }
+
+    // The ring size is a power of two, large enough for a few of the largest records.
+    size_t ringSize = g_config.ringSize ? g_config.ringSize : OC_LOG_ASYNC_DEFAULT_RING_SIZE;
+    g_config.ringSize = 1;
+    while ((g_config.ringSize < ringSize || g_config.ringSize < 4 * MAX_RECORD_SIZE) &&
+           g_config.ringSize <= SIZE_MAX / 2)
+    {
+        g_config.ringSize *= 2;
+    }
+    if (0 == g_config.drainIntervalMs)
+    {
+        g_config.drainIntervalMs = OC_LOG_ASYNC_DEFAULT_DRAIN_INTERVAL_MS;
+    }
+    memset(g_rateSlots, 0, sizeof(g_rateSlots));
+
+    if (g_config.binaryOutput)
+    {
+        fwrite(BINARY_MAGIC, 1, sizeof(BINARY_MAGIC), g_config.binaryOutput);
+    }
+
+    __atomic_store_n(&g_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&g_drainThread, NULL, DrainThread, NULL))
+    {
+        __atomic_store_n(&g_running, 0, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&g_controlLock);
+        return false;
+    }
+    __atomic_store_n(&g_active, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&g_controlLock);
+    return true;
+}
+
+void OCLogAsyncStop()
+{
+    pthread_mutex_lock(&g_controlLock);
+    if (!g_running)
+    {
+        pthread_mutex_unlock(&g_controlLock);
+        return;
+    }
+
+    __atomic_store_n(&g_active, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_running, 0, __ATOMIC_RELEASE);
+    pthread_join(g_drainThread, NULL);
+
+    // A thread which saw the logger active may still be queueing a message.
+    while (__atomic_load_n(&g_producers, __ATOMIC_ACQUIRE))
+    {
+        sched_yield();
+    }
+
+    // Write what was queued before the logger switched back.
+    DrainAll();
+    FreeRings();
+    if (g_config.binaryOutput)
+    {
+        fflush(g_config.binaryOutput);
+    }
+    FreeInternTable(&g_tagIds);
+    FreeInternTable(&g_formatIds);
+    __atomic_store_n(&g_flushCompleted, __atomic_load_n(&g_flushRequested, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&g_controlLock);
+}
+
+void OCLogAsyncFlush()
+{
+    uint64_t ticket = __atomic_add_fetch(&g_flushRequested, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_running, __ATOMIC_ACQUIRE) &&
+           __atomic_load_n(&g_flushCompleted, __ATOMIC_ACQUIRE) < ticket)
+    {
+        SleepMs(1);
+    }
+}
+
+#else // OC_LOG_ASYNC_SUPPORTED
+
+bool OCLogAsyncStart(const OCLogAsyncConfig *config)
+{
+    (void)config;
+    return false;
+}
+
+void OCLogAsyncStop()
+{
+}
+
+void OCLogAsyncFlush()
+{
+}
+
+bool OCLogAsyncLogv(LogLevel level, const char *tag, const char *format, va_list args)
+{
+    (void)level;
+    (void)tag;
+    (void)format;
+    (void)args;
+    return false;
+}
+
+bool OCLogAsyncLog(LogLevel level, const char *tag, const char *logStr)
+{
+    (void)level;
+    (void)tag;
+    (void)logStr;
+    return false;
+}
+
+bool OCLogAsyncLogBuffer(LogLevel level, const char *tag,
+                         const uint8_t *buffer, size_t bufferSize)
+{
+    (void)level;
+    (void)tag;
+    (void)buffer;
+    (void)bufferSize;
+    return false;
+}
+
+#endif // OC_LOG_ASYNC_SUPPORTED
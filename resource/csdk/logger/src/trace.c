@@ -30,6 +30,11 @@
 #define _POSIX_C_SOURCE 200809L
 #endif
 
+// For syscall(SYS_gettid) in the Linux trace backend.
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(__TIZEN__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "iotivity_config.h"
 
 // Pull in _POSIX_TIMERS feature test macro to check for
@@ -193,6 +198,421 @@ void oic_trace_end()
     }
 }
 
+#elif defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_MAX_NAME_LEN  48
+#define TRACE_FILE_ENV      "OIC_TRACE_FILE"
+#define TRACE_DUMP_SIGNAL   SIGUSR2
+
+/**
+ * A span begin or end event.
+ */
+typedef struct
+{
+    uint64_t timeNs;                    /**< monotonic time of the event. */
+    char phase;                         /**< 'B' or 'E'. */
+    char name[TRACE_MAX_NAME_LEN];      /**< span name, begin events only. */
+} OCTraceEvent_t;
+
+/**
+ * Events of one thread. Only the owning thread writes, so the ring needs no
+ * lock; readers detect events overwritten while they were copied.
+ */
+typedef struct OCTraceRing
+{
+    struct OCTraceRing *next;           /**< next ring in g_traceRings. */
+    OCTraceEvent_t *events;
+    uint64_t mask;                      /**< number of events - 1, a power of two. */
+    uint64_t head;                      /**< number of events written. */
+    pid_t tid;
+    int orphaned;                       /**< the thread has exited. */
+} OCTraceRing_t;
+
+static pthread_once_t g_traceInitOnce = PTHREAD_ONCE_INIT;
+static pthread_once_t g_traceKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_traceKey;
+static pthread_mutex_t g_traceLock = PTHREAD_MUTEX_INITIALIZER;
+
+static int g_traceEnabled = 0;
+static size_t g_traceEvents = OIC_TRACE_DEFAULT_EVENTS;
+static OCTraceRing_t *g_traceRings = NULL;
+static __thread OCTraceRing_t *t_traceRing = NULL;
+
+static int g_traceDumpPipe[2] = { FD_INITIAL_VALUE, FD_INITIAL_VALUE };
+static char *g_traceDumpPath = NULL;
+
+static void TraceInitOnce()
+{
+    const char *path = getenv(TRACE_FILE_ENV);
+    if (path && *path)
+    {
+        oic_trace_start(0);
+        oic_trace_dump_on_signal(TRACE_DUMP_SIGNAL, path);
+    }
+}
+
+int oic_trace_init()
+{
+    pthread_once(&g_traceInitOnce, TraceInitOnce);
+    return 0;
+}
+
+static void ReleaseTraceRing(void *ring)
+{
+    t_traceRing = NULL;
+    __atomic_store_n(&((OCTraceRing_t *)ring)->orphaned, 1, __ATOMIC_RELEASE);
+}
+
+static void CreateTraceKey()
+{
+    pthread_key_create(&g_traceKey, ReleaseTraceRing);
+}
+
+static OCTraceRing_t *GetTraceRing()
+{
+    if (t_traceRing)
+    {
+        return t_traceRing;
+    }
+
+    OCTraceRing_t *ring = NULL;
+    size_t events = g_traceEvents;
+
+    pthread_mutex_lock(&g_traceLock);
+    // Reuse the ring of an exited thread rather than growing without bound.
+    for (OCTraceRing_t **link = &g_traceRings; *link; link = &(*link)->next)
+    {
+        if (__atomic_load_n(&(*link)->orphaned, __ATOMIC_ACQUIRE) &&
+            (*link)->mask + 1 == events)
+        {
+            ring = *link;
+            *link = ring->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_traceLock);
+
+    if (!ring)
+    {
+        ring = (OCTraceRing_t *)calloc(1, sizeof(OCTraceRing_t));
+        if (!ring)
+        {
+            return NULL;
+        }
+        ring->events = (OCTraceEvent_t *)calloc(events, sizeof(OCTraceEvent_t));
+        if (!ring->events)
+        {
+            free(ring);
+            return NULL;
+        }
+        ring->mask = events - 1;
+    }
+    ring->head = 0;
+    ring->orphaned = 0;
+    ring->tid = (pid_t)syscall(SYS_gettid);
+
+    pthread_once(&g_traceKeyOnce, CreateTraceKey);
+    pthread_setspecific(g_traceKey, ring);
+
+    pthread_mutex_lock(&g_traceLock);
+    ring->next = g_traceRings;
+    g_traceRings = ring;
+    pthread_mutex_unlock(&g_traceLock);
+
+    t_traceRing = ring;
+    return ring;
+}
+
+static OCTraceEvent_t *NextTraceEvent(char phase)
+{
+    if (!__atomic_load_n(&g_traceEnabled, __ATOMIC_ACQUIRE))
+    {
+        oic_trace_init();
+        if (!__atomic_load_n(&g_traceEnabled, __ATOMIC_ACQUIRE))
+        {
+            return NULL;
+        }
+    }
+
+    OCTraceRing_t *ring = GetTraceRing();
+    if (!ring)
+    {
+        return NULL;
+    }
+
+    struct timespec now = { .tv_sec = 0, .tv_nsec = 0 };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    OCTraceEvent_t *event = &ring->events[ring->head & ring->mask];
+    event->timeNs = (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+    event->phase = phase;
+    event->name[0] = '\0';
+    return event;
+}
+
+static void CommitTraceEvent()
+{
+    __atomic_store_n(&t_traceRing->head, t_traceRing->head + 1, __ATOMIC_RELEASE);
+}
+
+void oic_trace_begin(const char *name, ...)
+{
+    OCTraceEvent_t *event = NextTraceEvent('B');
+    if (event)
+    {
+        va_list ap;
+        va_start(ap, name);
+        vsnprintf(event->name, sizeof(event->name), name, ap);
+        va_end(ap);
+        CommitTraceEvent();
+    }
+}
+
+void oic_trace_end()
+{
+    if (NextTraceEvent('E'))
+    {
+        CommitTraceEvent();
+    }
+}
+
+bool oic_trace_start(size_t eventsPerThread)
+{
+    if (0 == eventsPerThread)
+    {
+        eventsPerThread = OIC_TRACE_DEFAULT_EVENTS;
+    }
+    size_t events = 1;
+    while (events < eventsPerThread && events <= SIZE_MAX / 2 / sizeof(OCTraceEvent_t))
+    {
+        events *= 2;
+    }
+
+    // Threads which already have a ring keep its size.
+    g_traceEvents = events;
+    __atomic_store_n(&g_traceEnabled, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void oic_trace_stop()
+{
+    __atomic_store_n(&g_traceEnabled, 0, __ATOMIC_RELEASE);
+}
+
+static void WriteTraceName(FILE *out, const char *name)
+{
+    for (const char *p = name; *p; p++)
+    {
+        if ('"' == *p || '\\' == *p)
+        {
+            fprintf(out, "\\%c", *p);
+        }
+        else if ((unsigned char)*p < 0x20)
+        {
+            fprintf(out, "\\u%04x", (unsigned char)*p);
+        }
+        else
+        {
+            fputc(*p, out);
+        }
+    }
+}
+
+static void WriteTraceRing(FILE *out, const OCTraceRing_t *ring, pid_t pid, bool *first)
+{
+    uint64_t capacity = ring->mask + 1;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t start = (head > capacity) ? head - capacity : 0;
+
+    for (uint64_t i = start; i < head; i++)
+    {
+        OCTraceEvent_t event = ring->events[i & ring->mask];
+
+        // The thread keeps writing; skip the event if its slot may have been reused.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - i >= capacity)
+        {
+            continue;
+        }
+        event.name[sizeof(event.name) - 1] = '\0';
+
+        fprintf(out, "%s\n{\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03u,\"pid\":%d,\"tid\":%d",
+                *first ? "" : ",", event.phase, event.timeNs / 1000,
+                (unsigned int)(event.timeNs % 1000), (int)pid, (int)ring->tid);
+        if ('B' == event.phase)
+        {
+            fputs(",\"cat\":\"oic\",\"name\":\"", out);
+            WriteTraceName(out, event.name);
+            fputc('"', out);
+        }
+        fputc('}', out);
+        *first = false;
+    }
+}
+
+bool oic_trace_dump(const char *path)
+{
+    if (!path)
+    {
+        return false;
+    }
+
+    FILE *out = fopen(path, "w");
+    if (!out)
+    {
+        OIC_LOG_V(ERROR, TAG, "failed to open %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    pid_t pid = getpid();
+    bool first = true;
+    fputs("{\"traceEvents\":[", out);
+
+    pthread_mutex_lock(&g_traceLock);
+    OCTraceRing_t **link = &g_traceRings;
+    while (*link)
+    {
+        OCTraceRing_t *ring = *link;
+        bool orphaned = __atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE);
+        WriteTraceRing(out, ring, pid, &first);
+        if (orphaned)
+        {
+            // The events of an exited thread are dumped once.
+            *link = ring->next;
+            free(ring->events);
+            free(ring);
+            continue;
+        }
+        link = &ring->next;
+    }
+    pthread_mutex_unlock(&g_traceLock);
+
+    fputs("\n],\"displayTimeUnit\":\"ns\"}\n", out);
+    bool ok = !ferror(out);
+    if (fclose(out))
+    {
+        ok = false;
+    }
+    return ok;
+}
+
+static void TraceDumpSignalHandler(int signum)
+{
+    (void)signum;
+    int savedErrno = errno;
+    char wake = 1;
+    if (write(g_traceDumpPipe[1], &wake, 1) < 0)
+    {
+        // A dump is already pending.
+    }
+    errno = savedErrno;
+}
+
+static void *TraceDumpThread(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        char wake;
+        ssize_t len = read(g_traceDumpPipe[0], &wake, 1);
+        if (len < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (len <= 0)
+        {
+            break;
+        }
+        if (oic_trace_dump(g_traceDumpPath))
+        {
+            OIC_LOG_V(INFO, TAG, "trace dumped to %s", g_traceDumpPath);
+        }
+    }
+    return NULL;
+}
+
+bool oic_trace_dump_on_signal(int signum, const char *path)
+{
+    if (!path)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_traceLock);
+    if (FD_INITIAL_VALUE != g_traceDumpPipe[0])
+    {
+        pthread_mutex_unlock(&g_traceLock);
+        OIC_LOG(ERROR, TAG, "trace dump signal already installed");
+        return false;
+    }
+
+    // The signal handler only wakes the dump thread, writing a file is not
+    // async-signal-safe.
+    if (pipe(g_traceDumpPipe) < 0)
+    {
+        pthread_mutex_unlock(&g_traceLock);
+        OIC_LOG_V(ERROR, TAG, "pipe failed: %s", strerror(errno));
+        return false;
+    }
+    fcntl(g_traceDumpPipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(g_traceDumpPipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(g_traceDumpPipe[1], F_SETFL, O_NONBLOCK);
+
+    g_traceDumpPath = strdup(path);
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    bool ok = g_traceDumpPath && (0 == pthread_create(&thread, &attr, TraceDumpThread, NULL));
+    pthread_attr_destroy(&attr);
+
+    if (ok)
+    {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = TraceDumpSignalHandler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        ok = (0 == sigaction(signum, &action, NULL));
+        if (!ok)
+        {
+            // The dump thread exits once the pipe is closed.
+            close(g_traceDumpPipe[1]);
+            g_traceDumpPipe[1] = FD_INITIAL_VALUE;
+        }
+    }
+    else
+    {
+        close(g_traceDumpPipe[0]);
+        close(g_traceDumpPipe[1]);
+        g_traceDumpPipe[0] = FD_INITIAL_VALUE;
+        g_traceDumpPipe[1] = FD_INITIAL_VALUE;
+        free(g_traceDumpPath);
+        g_traceDumpPath = NULL;
+    }
+    pthread_mutex_unlock(&g_traceLock);
+
+    if (!ok)
+    {
+        OIC_LOG(ERROR, TAG, "failed to install the trace dump signal");
+    }
+    return ok;
+}
+
 #elif defined ARDUINO
 /* TODO: Trace api for ARDUINO and others will be implemented */
 #endif //ARDUINO
@@ -21,6 +21,8 @@
 
 extern "C" {
     #include "logger.h"
+    #include "logger_async.h"
+    #include "trace.h"
 }
 
 
@@ -36,6 +38,8 @@ extern "C" {
 
 #include <iostream>
 #include <stdint.h>
+#include <string>
+#include <vector>
 using namespace std;
 
 
@@ -364,3 +368,199 @@ TEST(LoggerTest, LogBuffer) {
         EXPECT_STREQ(stdFileMD5, testFileMD5);
     }
 }
+
+#if defined(__linux__) || defined(__APPLE__)
+//-----------------------------------------------------------------------------
+//  Asynchronous mode
+//-----------------------------------------------------------------------------
+static std::vector<std::string> g_asyncLines;
+
+static int AsyncCtxInit(oc_log_ctx_t *, void *)
+{
+    return 0;
+}
+
+static void AsyncCtxDestroy(oc_log_ctx_t *)
+{
+}
+
+static void AsyncCtxFlush(oc_log_ctx_t *)
+{
+}
+
+static size_t AsyncCtxWriteLevel(oc_log_ctx_t *, const int, const char *logStr)
+{
+    g_asyncLines.push_back(logStr);
+    return strlen(logStr);
+}
+
+class LoggerAsyncTest : public testing::Test
+{
+    protected:
+        virtual void SetUp()
+        {
+            memset(&m_ctx, 0, sizeof(m_ctx));
+            m_ctx.init = AsyncCtxInit;
+            m_ctx.destroy = AsyncCtxDestroy;
+            m_ctx.flush = AsyncCtxFlush;
+            m_ctx.write_level = AsyncCtxWriteLevel;
+            OCLogConfig(&m_ctx);
+            OCSetLogLevel(DEBUG, false);
+            g_asyncLines.clear();
+        }
+
+        virtual void TearDown()
+        {
+            OCLogAsyncStop();
+            OCLogConfig(NULL);
+        }
+
+        oc_log_ctx_t m_ctx;
+};
+
+TEST_F(LoggerAsyncTest, FormatsLikeSynchronousMode)
+{
+    ASSERT_TRUE(OCLogAsyncStart(NULL));
+
+    const char *str = "abcdef";
+    OCLogv(INFO, "Async", "%d %s %5.2f %p %lu %.*s %c %% %x %lld %zu",
+           -3, "str", 3.14159, (void *)0x1234, 42ul, 3, str, 'Z', 255u, -9ll, (size_t)7);
+    OCLog(ERROR, "Async", "fixed % string");
+    uint8_t buffer[20];
+    for (int i = 0; i < (int)(sizeof buffer); i++) {
+        buffer[i] = i;
+    }
+    OCLogBuffer(DEBUG, "Async", buffer, sizeof buffer);
+    OCLogAsyncFlush();
+
+    char expected[MAX_LOG_V_BUFFER_SIZE];
+    snprintf(expected, sizeof expected, "%d %s %5.2f %p %lu %.*s %c %% %x %lld %zu",
+             -3, "str", 3.14159, (void *)0x1234, 42ul, 3, str, 'Z', 255u, -9ll, (size_t)7);
+    ASSERT_EQ(4u, g_asyncLines.size());
+    EXPECT_EQ(expected, g_asyncLines[0]);
+    EXPECT_EQ("fixed % string", g_asyncLines[1]);
+    EXPECT_EQ("00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F ", g_asyncLines[2]);
+    EXPECT_EQ("10 11 12 13 ", g_asyncLines[3]);
+}
+
+TEST_F(LoggerAsyncTest, NarrowsShortArguments)
+{
+    ASSERT_TRUE(OCLogAsyncStart(NULL));
+    OCLogv(INFO, "Async", "%hhd %hd %hhu %hu", 0x1ff, 0x1ffff, 0x1ff, 0x1ffff);
+    OCLogAsyncFlush();
+
+    ASSERT_EQ(1u, g_asyncLines.size());
+    EXPECT_EQ("-1 -1 255 65535", g_asyncLines[0]);
+}
+
+TEST_F(LoggerAsyncTest, RestartsAfterStop)
+{
+    ASSERT_TRUE(OCLogAsyncStart(NULL));
+    OCLog(INFO, "Async", "first");
+    OCLogAsyncStop();
+    ASSERT_EQ(1u, g_asyncLines.size());
+
+    // The ring of this thread was freed by the stop, a new one is used.
+    ASSERT_TRUE(OCLogAsyncStart(NULL));
+    OCLog(INFO, "Async", "second");
+    OCLogAsyncStop();
+    ASSERT_EQ(2u, g_asyncLines.size());
+    EXPECT_EQ("second", g_asyncLines[1]);
+}
+
+TEST_F(LoggerAsyncTest, RateLimitsDebugAndInfo)
+{
+    OCLogAsyncConfig config;
+    memset(&config, 0, sizeof(config));
+    config.maxPerSecond = 5;
+    ASSERT_TRUE(OCLogAsyncStart(&config));
+
+    for (int i = 0; i < 50; i++) {
+        OCLogv(DEBUG, "Limited", "message %d", i);
+    }
+    OCLog(WARNING, "Limited", "warning");
+    OCLogAsyncFlush();
+
+    // Warnings are never limited, even when the tag is over its rate.
+    ASSERT_LE(6u, g_asyncLines.size());
+    EXPECT_GE(11u, g_asyncLines.size());
+    EXPECT_EQ("message 0", g_asyncLines[0]);
+}
+
+TEST_F(LoggerAsyncTest, BinaryOutputDecodes)
+{
+    FILE *binary = tmpfile();
+    FILE *text = tmpfile();
+    ASSERT_TRUE(binary && text);
+
+    OCLogAsyncConfig config;
+    memset(&config, 0, sizeof(config));
+    config.binaryOutput = binary;
+    ASSERT_TRUE(OCLogAsyncStart(&config));
+    OCLogv(INFO, "Binary", "x=%d y=%s", 5, "yy");
+    OCLogv(INFO, "Binary", "x=%d y=%s", 6, "zz");
+    OCLogAsyncStop();
+    EXPECT_TRUE(g_asyncLines.empty());
+
+    rewind(binary);
+    EXPECT_TRUE(OCLogDecodeBinary(binary, text));
+    rewind(text);
+
+    char line[MAX_LOG_V_BUFFER_SIZE];
+    ASSERT_TRUE(NULL != fgets(line, sizeof line, text));
+    EXPECT_STREQ("INFO: Binary: x=5 y=yy\n", strchr(line, ' ') + 1);
+    ASSERT_TRUE(NULL != fgets(line, sizeof line, text));
+    EXPECT_STREQ("INFO: Binary: x=6 y=zz\n", strchr(line, ' ') + 1);
+    EXPECT_TRUE(NULL == fgets(line, sizeof line, text));
+
+    fclose(binary);
+    fclose(text);
+}
+#endif // defined(__linux__) || defined(__APPLE__)
+
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(__TIZEN__)
+//-----------------------------------------------------------------------------
+//  Tracing
+//-----------------------------------------------------------------------------
+TEST(TraceTest, DumpsChromeTraceEvents) {
+    char traceFile[] = "tst_trace.json";
+    remove(traceFile);
+
+    ASSERT_TRUE(oic_trace_start(0));
+    OIC_TRACE_BEGIN(%s:Outer, "TraceTest");
+    OIC_TRACE_BEGIN(%s:Inner, "TraceTest");
+    OIC_TRACE_END();
+    OIC_TRACE_END();
+    oic_trace_stop();
+    OIC_TRACE_BEGIN(%s:NotRecorded, "TraceTest");
+    OIC_TRACE_END();
+
+    ASSERT_TRUE(oic_trace_dump(traceFile));
+
+    FILE *in = fopen(traceFile, "r");
+    ASSERT_TRUE(NULL != in);
+    std::string trace;
+    char chunk[256];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof chunk, in)) > 0) {
+        trace.append(chunk, len);
+    }
+    fclose(in);
+    remove(traceFile);
+
+    EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+    size_t outer = trace.find("\"name\":\"OIC:TraceTest:Outer\"");
+    size_t inner = trace.find("\"name\":\"OIC:TraceTest:Inner\"");
+    EXPECT_NE(std::string::npos, outer);
+    EXPECT_NE(std::string::npos, inner);
+    EXPECT_LT(outer, inner);
+    EXPECT_EQ(std::string::npos, trace.find("NotRecorded"));
+
+    size_t ends = 0;
+    for (size_t pos = trace.find("\"ph\":\"E\""); pos != std::string::npos;
+         pos = trace.find("\"ph\":\"E\"", pos + 1)) {
+        ends++;
+    }
+    EXPECT_EQ(2u, ends);
+}
+#endif
@@ -0,0 +1,67 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "logger_async.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2 && argc != 3)
+    {
+        printf("This program decodes a log written in the compact binary format.\n");
+        printf("1. First input is the binary log file.\n");
+        printf("2. Optional second input is the text file to write, stdout by default.\n");
+        printf("\t oclogdecode <binary_log_file> [<text_file>]\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in)
+    {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = stdout;
+    if (3 == argc)
+    {
+        out = fopen(argv[2], "w");
+        if (!out)
+        {
+            fprintf(stderr, "Cannot open %s\n", argv[2]);
+            fclose(in);
+            return EXIT_FAILURE;
+        }
+    }
+
+    bool ok = OCLogDecodeBinary(in, out);
+    if (!ok)
+    {
+        fprintf(stderr, "%s is not a valid binary log\n", argv[1]);
+    }
+
+    fclose(in);
+    if (stdout != out)
+    {
+        fclose(out);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -51,6 +51,21 @@ OCStackResult DeInitACLResource();
  */
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr);
 
+/**
+ * This method is used by PolicyEngine to walk all ACEs of the ACL, in list order.
+ *
+ * @return reference to the first @ref OicSecAce_t, or NULL if the ACL is empty.
+ */
+const OicSecAce_t* GetACLResourceAces(void);
+
+/**
+ * Get the generation number of the ACL. It changes whenever an ACE is
+ * added or removed, so data derived from the ACL can detect that it is stale.
+ *
+ * @return current generation number.
+ */
+uint32_t GetACLGeneration(void);
+
 /**
  * This function converts ACL data into CBOR format.
  *
@@ -140,6 +155,32 @@ OCStackResult AppendACL(const uint8_t* payload, const size_t size);
  */
 OCStackResult AppendACL2(const OicSecAcl_t* acl);
 
+/**
+ * This function opens an ACL batch. Until the batch is committed or aborted,
+ * changes to the ACL are applied in memory only and persisted once by
+ * @ref CommitACLBatch.
+ *
+ * @return ::OC_STACK_OK for Success, ::OC_STACK_ERROR if a batch is already open,
+ *         otherwise some error value.
+ */
+OCStackResult BeginACLBatch(void);
+
+/**
+ * This function closes the open ACL batch and writes the ACL to persistent
+ * storage if the batch changed it.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+OCStackResult CommitACLBatch(void);
+
+/**
+ * This function closes the open ACL batch and restores the ACL as it was
+ * when the batch was opened.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+OCStackResult AbortACLBatch(void);
+
 /**
  * This function updates default ACE which is required for ownership transfer.
  * This function should be invoked after OTM is complete to prevent anonymous user access.
@@ -122,6 +122,33 @@ OicSecCred_t * GenerateCredential(const OicUuid_t* subject, OicSecCredType_t cre
  */
 OCStackResult AddCredential(OicSecCred_t * cred);
 
+/**
+ * This function opens a credential batch. Until the batch is committed or
+ * aborted, changes to the credential list are applied in memory only and
+ * persisted once by @ref CommitCredBatch.
+ *
+ * @return ::OC_STACK_OK for Success, ::OC_STACK_ERROR if a batch is already open,
+ *         otherwise some error value.
+ */
+OCStackResult BeginCredBatch(void);
+
+/**
+ * This function closes the open credential batch and writes the credential
+ * list to persistent storage if the batch changed it. If the write fails, the
+ * credential list is restored as it was when the batch was opened.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+OCStackResult CommitCredBatch(void);
+
+/**
+ * This function closes the open credential batch and restores the credential
+ * list as it was when the batch was opened.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+OCStackResult AbortCredBatch(void);
+
 /**
  * Function to remove the credential from SVR DB.
  *
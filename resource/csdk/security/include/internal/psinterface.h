@@ -21,6 +21,10 @@
 #ifndef IOTVT_SRM_PSI_H
 #define IOTVT_SRM_PSI_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * Reads the database from PS
  *
@@ -40,6 +44,10 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
 /**
  * This method updates the database in PS
  *
+ * If a persistent storage journal handler is registered, the update is
+ * appended to the journal of the database, which is folded back into the
+ * database once it grows large. Reads replay the journal.
+ *
  * @param databaseName  is the name of the database to access through persistent storage.
  * @param resourceName  is the name of the resource that will be updated.
  * @param payload       is the pointer to memory where the CBOR payload is located.
@@ -103,4 +111,8 @@ OCStackResult ResetSecureResourceInPS(void);
  */
 OCStackResult CreateResetProfile(void);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif //IOTVT_SRM_PSI_H
@@ -92,6 +92,14 @@ OCStackResult SRMRegisterHandler(CARequestCallback reqHandler,
                                  CAResponseCallback respHandler,
                                  CAErrorCallback errHandler);
 
+/**
+ * Request, response and error handlers that SRMRegisterHandler registers with CA when
+ * a secure build is used.  They forward to the handlers passed to SRMRegisterHandler.
+ */
+void SRMRequestHandler(const CAEndpoint_t *endPoint, const CARequestInfo_t *requestInfo);
+void SRMResponseHandler(const CAEndpoint_t *endPoint, const CAResponseInfo_t *responseInfo);
+void SRMErrorHandler(const CAEndpoint_t *endPoint, const CAErrorInfo_t *errorInfo);
+
 /**
  * Initialize all secure resources ( /oic/sec/cred, /oic/sec/acl, /oic/sec/pstat etc).
  * @return  ::OC_STACK_OK for Success, otherwise some error value.
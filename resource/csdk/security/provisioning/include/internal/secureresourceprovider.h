@@ -53,6 +53,20 @@ OCStackResult SRPProvisionACL(void *ctx, const OCProvisionDev_t *selectedDeviceI
  */
 OCStackResult SRPSaveACL(const OicSecAcl_t *acl);
 
+/**
+ * API to send a list of credentials to resource in a single request.
+ *
+ * @param[in] ctx Application context would be returned in result callback.
+ * @param[in] selectedDeviceInfo Selected target device.
+ * @param[in] credList credentials to provision.
+ * @param[in] resultCallback callback provided by API user, callback will be called when
+ *            provisioning request recieves a response from resource server.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult SRPProvisionCredentialList(void *ctx, const OCProvisionDev_t *selectedDeviceInfo,
+                                         const OicSecCred_t *credList,
+                                         OCProvisionResultCB resultCallback);
+
 /**
  * API to request CRED information to resource.
  *
@@ -237,6 +237,44 @@ OCStackResult OCProvisionACL(void *ctx, const OCProvisionDev_t *selectedDeviceIn
  */
 OCStackResult OCSaveACL(const OicSecAcl_t* acl);
 
+/**
+ * API to send a list of credentials to a device in a single request.
+ * The device stores all of them with one update of its persistent storage.
+ *
+ * @param[in] ctx Application context would be returned in result callback.
+ * @param[in] selectedDeviceInfo Selected target device.
+ * @param[in] credList credentials to provision.
+ * @param[in] resultCallback callback provided by API user, callback will be called when provisioning
+              request recieves a response from resource server.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCProvisionCredentialList(void *ctx, const OCProvisionDev_t *selectedDeviceInfo,
+                                        const OicSecCred_t *credList,
+                                        OCProvisionResultCB resultCallback);
+
+/**
+ * API to start a batch of local ACL and credential changes, e.g. OCSaveACL()
+ * or OCSaveTrustCertChain(). Changes are applied in memory and written to
+ * persistent storage once by OCCommitSVRBatch().
+ *
+ * @return  OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCBeginSVRBatch(void);
+
+/**
+ * API to write the changes of the open batch to persistent storage.
+ *
+ * @return  OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCCommitSVRBatch(void);
+
+/**
+ * API to discard the changes of the open batch.
+ *
+ * @return  OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCAbortSVRBatch(void);
+
 /**
  * this function requests CRED information to resource.
  *
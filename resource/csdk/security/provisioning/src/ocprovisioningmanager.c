@@ -366,6 +366,67 @@ OCStackResult OCSaveACL(const OicSecAcl_t* acl)
     return SRPSaveACL(acl);
 }
 
+/**
+ * API to send a list of credentials to a device in a single request.
+ *
+ * @param[in] ctx Application context would be returned in result callback.
+ * @param[in] selectedDeviceInfo Selected target device.
+ * @param[in] credList credentials to provision.
+ * @param[in] resultCallback callback provided by API user, callback will be called when provisioning
+              request recieves a response from resource server.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCProvisionCredentialList(void *ctx, const OCProvisionDev_t *selectedDeviceInfo,
+                                        const OicSecCred_t *credList,
+                                        OCProvisionResultCB resultCallback)
+{
+    return SRPProvisionCredentialList(ctx, selectedDeviceInfo, credList, resultCallback);
+}
+
+/**
+ * API to start a batch of local ACL and credential changes.
+ *
+ * @return  OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCBeginSVRBatch(void)
+{
+    OCStackResult res = BeginACLBatch();
+    if (OC_STACK_OK != res)
+    {
+        return res;
+    }
+    res = BeginCredBatch();
+    if (OC_STACK_OK != res)
+    {
+        AbortACLBatch();
+    }
+    return res;
+}
+
+/**
+ * API to write the changes of the open batch to persistent storage.
+ *
+ * @return  OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCCommitSVRBatch(void)
+{
+    OCStackResult aclRes = CommitACLBatch();
+    OCStackResult credRes = CommitCredBatch();
+    return (OC_STACK_OK != aclRes) ? aclRes : credRes;
+}
+
+/**
+ * API to discard the changes of the open batch.
+ *
+ * @return  OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OCAbortSVRBatch(void)
+{
+    OCStackResult aclRes = AbortACLBatch();
+    OCStackResult credRes = AbortCredBatch();
+    return (OC_STACK_OK != aclRes) ? aclRes : credRes;
+}
+
 /**
  * this function requests CRED information to resource.
  *
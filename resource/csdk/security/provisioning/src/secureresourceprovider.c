@@ -85,6 +85,19 @@ struct ACLData
     int numOfResults;                           /**< Number of results in result array.**/
 };
 
+/**
+ * Structure to carry credential list provision API data to callback.
+ */
+typedef struct CredListData CredListData_t;
+struct CredListData
+{
+    void *ctx;                                  /**< Pointer to user context.**/
+    const OCProvisionDev_t *deviceInfo;         /**< Pointer to PMDevInfo_t.**/
+    OCProvisionResultCB resultCallback;         /**< Pointer to result callback.**/
+    OCProvisionResult_t *resArr;                /**< Result array.**/
+    int numOfResults;                           /**< Number of results in result array.**/
+};
+
 // Structure to carry get security resource APIs data to callback.
 typedef struct GetSecData GetSecData_t;
 struct GetSecData {
@@ -936,6 +949,135 @@ OCStackResult SRPSaveACL(const OicSecAcl_t *acl)
     return res;
 }
 
+/**
+ * Internal Function to store results in result array during credential list provisioning.
+ */
+static void registerResultForCredListProvisioning(CredListData_t *credListData,
+                                                  OCStackResult stackresult)
+{
+   OIC_LOG_V(INFO, TAG, "Inside registerResultForCredListProvisioning credListData->numOfResults is %d\n",
+                       credListData->numOfResults);
+   memcpy(credListData->resArr[(credListData->numOfResults)].deviceId.id,
+          credListData->deviceInfo->doxm->deviceID.id, UUID_LENGTH);
+   credListData->resArr[(credListData->numOfResults)].res = stackresult;
+   ++(credListData->numOfResults);
+}
+
+/**
+ * Callback handler of SRPProvisionCredentialList.
+ *
+ * @param[in] ctx             ctx value passed to callback from calling function.
+ * @param[in] UNUSED          handle to an invocation
+ * @param[in] clientResponse  Response from queries to remote servers.
+ * @return  OC_STACK_DELETE_TRANSACTION to delete the transaction
+ *          and  OC_STACK_KEEP_TRANSACTION to keep it.
+ */
+static OCStackApplicationResult SRPProvisionCredentialListCB(void *ctx, OCDoHandle UNUSED,
+                                                             OCClientResponse *clientResponse)
+{
+    OIC_LOG_V(INFO, TAG, "Inside SRPProvisionCredentialListCB.");
+    (void)UNUSED;
+    VERIFY_NOT_NULL_RETURN(TAG, ctx, ERROR, OC_STACK_DELETE_TRANSACTION);
+    CredListData_t *credListData = (CredListData_t*)ctx;
+    OCProvisionResultCB resultCallback = credListData->resultCallback;
+    bool hasError = true;
+
+    if (clientResponse && OC_STACK_RESOURCE_CHANGED == clientResponse->result)
+    {
+        registerResultForCredListProvisioning(credListData, OC_STACK_RESOURCE_CHANGED);
+        hasError = false;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "SRPProvisionCredentialListCB received an error or Null clientResponse");
+        registerResultForCredListProvisioning(credListData, OC_STACK_ERROR);
+    }
+    ((OCProvisionResultCB)(resultCallback))(credListData->ctx, credListData->numOfResults,
+                                            credListData->resArr,
+                                            hasError);
+    OICFree(credListData->resArr);
+    OICFree(credListData);
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+OCStackResult SRPProvisionCredentialList(void *ctx, const OCProvisionDev_t *selectedDeviceInfo,
+        const OicSecCred_t *credList, OCProvisionResultCB resultCallback)
+{
+    VERIFY_NOT_NULL_RETURN(TAG, selectedDeviceInfo, ERROR,  OC_STACK_INVALID_PARAM);
+    VERIFY_NOT_NULL_RETURN(TAG, credList, ERROR,  OC_STACK_INVALID_PARAM);
+    VERIFY_NOT_NULL_RETURN(TAG, resultCallback, ERROR,  OC_STACK_INVALID_CALLBACK);
+
+    // All credentials go in one payload; the device stores them with a single write.
+    OCSecurityPayload* secPayload = (OCSecurityPayload*)OICCalloc(1, sizeof(OCSecurityPayload));
+    if(!secPayload)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to memory allocation");
+        return OC_STACK_NO_MEMORY;
+    }
+    secPayload->base.type = PAYLOAD_TYPE_SECURITY;
+    int secureFlag = 0;
+    if(OC_STACK_OK != CredToCBORPayload(credList, &secPayload->securityData,
+                                        &secPayload->payloadSize, secureFlag))
+    {
+        OCPayloadDestroy((OCPayload *)secPayload);
+        OIC_LOG(ERROR, TAG, "Failed to CredToCBORPayload");
+        return OC_STACK_NO_MEMORY;
+    }
+    OIC_LOG(DEBUG, TAG, "Created payload for Cred list:");
+    OIC_LOG_BUFFER(DEBUG, TAG, secPayload->securityData, secPayload->payloadSize);
+
+    char query[MAX_URI_LENGTH + MAX_QUERY_LENGTH] = {0};
+    if(!PMGenerateQuery(true,
+                        selectedDeviceInfo->endpoint.addr,
+                        selectedDeviceInfo->securePort,
+                        selectedDeviceInfo->connType,
+                        query, sizeof(query), OIC_RSRC_CRED_URI))
+    {
+        OIC_LOG(ERROR, TAG, "SRPProvisionCredentialList : Failed to generate query");
+        OCPayloadDestroy((OCPayload *)secPayload);
+        return OC_STACK_ERROR;
+    }
+    OIC_LOG_V(DEBUG, TAG, "Query=%s", query);
+
+    OCCallbackData cbData =  {.context=NULL, .cb=NULL, .cd=NULL};
+    cbData.cb = &SRPProvisionCredentialListCB;
+    CredListData_t *credListData = (CredListData_t *) OICCalloc(1, sizeof(CredListData_t));
+    if (credListData == NULL)
+    {
+        OCPayloadDestroy((OCPayload *)secPayload);
+        OIC_LOG(ERROR, TAG, "Unable to allocate memory");
+        return OC_STACK_NO_MEMORY;
+    }
+    credListData->deviceInfo = selectedDeviceInfo;
+    credListData->resultCallback = resultCallback;
+    credListData->numOfResults = 0;
+    credListData->ctx = ctx;
+    int noOfRiCalls = 1;
+    credListData->resArr = (OCProvisionResult_t*)OICCalloc(noOfRiCalls, sizeof(OCProvisionResult_t));
+    if (credListData->resArr == NULL)
+    {
+        OICFree(credListData);
+        OCPayloadDestroy((OCPayload *)secPayload);
+        OIC_LOG(ERROR, TAG, "Unable to allocate memory");
+        return OC_STACK_NO_MEMORY;
+    }
+    cbData.context = (void *)credListData;
+    cbData.cd = NULL;
+    OCMethod method = OC_REST_POST;
+    OCDoHandle handle = NULL;
+    OIC_LOG(DEBUG, TAG, "Sending Cred list to resource server");
+    OCStackResult ret = OCDoResource(&handle, method, query,
+            &selectedDeviceInfo->endpoint, (OCPayload*)secPayload,
+            selectedDeviceInfo->connType, OC_HIGH_QOS, &cbData, NULL, 0);
+    if (ret != OC_STACK_OK)
+    {
+        OICFree(credListData->resArr);
+        OICFree(credListData);
+    }
+    VERIFY_SUCCESS_RETURN(TAG, (OC_STACK_OK == ret), ERROR, OC_STACK_ERROR);
+    return OC_STACK_OK;
+}
+
 /**
  * Internal Function to store results in result array during Direct-Pairing provisioning.
  */
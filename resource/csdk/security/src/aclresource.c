@@ -62,6 +62,14 @@ static const uint16_t CBOR_SIZE = 2048*8;
 
 static OicSecAcl_t *gAcl = NULL;
 static OCResourceHandle gAclHandle = NULL;
+// Changed on every modification of gAcl, see GetACLGeneration().
+static uint32_t gAclGeneration = 1;
+
+// ACL batch state, see BeginACLBatch().
+static bool gAclBatchActive = false;
+static bool gAclBatchDirty = false;
+static uint8_t *gAclBatchBackup = NULL;
+static size_t gAclBatchBackupSize = 0;
 
 void FreeRsrc(OicSecRsrc_t *rsrc)
 {
@@ -1367,6 +1375,43 @@ exit:
 }
 #endif //MULTIPLE_OWNER
 
+/**
+ * Closes the open ACL batch without touching gAcl.
+ */
+static void EndACLBatch(void)
+{
+    OICFree(gAclBatchBackup);
+    gAclBatchBackup = NULL;
+    gAclBatchBackupSize = 0;
+    gAclBatchActive = false;
+    gAclBatchDirty = false;
+}
+
+/**
+ * Writes gAcl to persistent storage. While an ACL batch is open the write is
+ * deferred to CommitACLBatch().
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+static OCStackResult UpdateACLInPS(void)
+{
+    if (gAclBatchActive)
+    {
+        gAclBatchDirty = true;
+        return OC_STACK_OK;
+    }
+
+    size_t size = 0;
+    uint8_t *payload = NULL;
+    OCStackResult ret = AclToCBORPayload(gAcl, &payload, &size);
+    if (OC_STACK_OK == ret)
+    {
+        ret = UpdateSecureResourceInPS(OIC_JSON_ACL_NAME, payload, size);
+        OICFree(payload);
+    }
+    return ret;
+}
+
 /**
  * This method removes ACE for the subject and resource from the ACL
  *
@@ -1441,23 +1486,15 @@ OCStackResult RemoveACE(const OicUuid_t *subject, const char *resource)
 
     if (deleteFlag)
     {
+        gAclGeneration++;
         // In case of unit test do not update persistant storage.
         if (memcmp(subject->id, &WILDCARD_SUBJECT_B64_ID, sizeof(subject->id)) == 0)
         {
             ret = OC_STACK_RESOURCE_DELETED;
         }
-        else
+        else if (OC_STACK_OK == UpdateACLInPS())
         {
-            uint8_t *payload = NULL;
-            size_t size = 0;
-            if (OC_STACK_OK == AclToCBORPayload(gAcl, &payload, &size))
-            {
-                if (OC_STACK_OK == UpdateSecureResourceInPS(OIC_JSON_ACL_NAME, payload, size))
-                {
-                    ret = OC_STACK_RESOURCE_DELETED;
-                }
-                OICFree(payload);
-            }
+            ret = OC_STACK_RESOURCE_DELETED;
         }
     }
     return ret;
@@ -1870,6 +1907,7 @@ static OCStackResult RemoveAllAce(void)
             LL_DELETE(gAcl->aces, aceItem);
             FreeACE(aceItem);
         }
+        gAclGeneration++;
 
         //Generate empty ACL payload
         ret = AclToCBORPayload(gAcl, &payload, &size);
@@ -1896,6 +1934,7 @@ static OCStackResult RemoveAllAce(void)
                 {
                     DeleteACLList(gAcl);
                     gAcl = originAcl;
+                    gAclGeneration++;
                 }
                 else
                 {
@@ -2057,6 +2096,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
                         OIC_LOG(DEBUG, TAG, "Prepending new ACE:");
                         printACE(insertAce);
                         LL_PREPEND(gAcl->aces, insertAce);
+                        gAclGeneration++;
                     }
                     else
                     {
@@ -2071,22 +2111,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
 
             if(OC_EH_OK == ehRet)
             {
-                size_t cborSize = 0;
-                uint8_t *cborPayload = NULL;
-
-                if (OC_STACK_OK == AclToCBORPayload(gAcl, &cborPayload, &cborSize))
-                {
-                    if (UpdateSecureResourceInPS(OIC_JSON_ACL_NAME, cborPayload, cborSize) == OC_STACK_OK)
-                    {
-                        ehRet = OC_EH_CHANGED;
-                    }
-                    OICFree(cborPayload);
-                }
-
-                if(OC_EH_CHANGED != ehRet)
-                {
-                    ehRet = OC_EH_ERROR;
-                }
+                ehRet = (OC_STACK_OK == UpdateACLInPS()) ? OC_EH_CHANGED : OC_EH_ERROR;
             }
         }
     }
@@ -2203,6 +2228,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    gAclGeneration++;
     return OC_STACK_OK;
 }
 
@@ -2443,6 +2469,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NOT_NULL(TAG, gAcl, FATAL);
+    gAclGeneration++;
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -2464,7 +2491,9 @@ OCStackResult DeInitACLResource()
     {
         DeleteACLList(gAcl);
         gAcl = NULL;
+        gAclGeneration++;
     }
+    EndACLBatch();
     return ret;
 }
 
@@ -2522,6 +2551,16 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
     return NULL;
 }
 
+const OicSecAce_t* GetACLResourceAces(void)
+{
+    return (NULL != gAcl) ? gAcl->aces : NULL;
+}
+
+uint32_t GetACLGeneration(void)
+{
+    return gAclGeneration;
+}
+
 OCStackResult AppendACL2(const OicSecAcl_t* acl)
 {
     OCStackResult ret = OC_STACK_ERROR;
@@ -2546,17 +2585,11 @@ OCStackResult AppendACL2(const OicSecAcl_t* acl)
     {
         gAcl->aces = acl->aces;
     }
+    gAclGeneration++;
 
     printACL(gAcl);
 
-    size_t size = 0;
-    uint8_t *payload = NULL;
-    ret = AclToCBORPayload(gAcl, &payload, &size);
-    if (OC_STACK_OK == ret)
-    {
-        ret = UpdateSecureResourceInPS(OIC_JSON_ACL_NAME, payload, size);
-        OICFree(payload);
-    }
+    ret = UpdateACLInPS();
 
     return ret;
 }
@@ -2641,6 +2674,79 @@ OCStackResult InstallACL(const OicSecAcl_t* acl)
     return ret;
 }
 
+OCStackResult BeginACLBatch(void)
+{
+    if (NULL == gAcl)
+    {
+        return OC_STACK_NO_RESOURCE;
+    }
+    if (gAclBatchActive)
+    {
+        OIC_LOG(ERROR, TAG, "An ACL batch is already open");
+        return OC_STACK_ERROR;
+    }
+
+    // Keep the current ACL so that AbortACLBatch() can restore it.
+    OCStackResult ret = AclToCBORPayload(gAcl, &gAclBatchBackup, &gAclBatchBackupSize);
+    if (OC_STACK_OK != ret)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to back up ACL : %d", ret);
+        return ret;
+    }
+    gAclBatchActive = true;
+    gAclBatchDirty = false;
+    return OC_STACK_OK;
+}
+
+OCStackResult CommitACLBatch(void)
+{
+    if (!gAclBatchActive)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    bool dirty = gAclBatchDirty;
+    EndACLBatch();
+
+    OCStackResult ret = OC_STACK_OK;
+    if (dirty)
+    {
+        ret = UpdateACLInPS();
+        if (OC_STACK_OK != ret)
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed to commit ACL batch : %d", ret);
+        }
+    }
+    return ret;
+}
+
+OCStackResult AbortACLBatch(void)
+{
+    if (!gAclBatchActive)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    OCStackResult ret = OC_STACK_OK;
+    if (gAclBatchDirty)
+    {
+        OicSecAcl_t *originAcl = CBORPayloadToAcl(gAclBatchBackup, gAclBatchBackupSize);
+        if (originAcl)
+        {
+            DeleteACLList(gAcl);
+            gAcl = originAcl;
+            gAclGeneration++;
+        }
+        else
+        {
+            OIC_LOG(ERROR, TAG, "Failed to restore ACL, keeping the batched changes");
+            ret = OC_STACK_ERROR;
+        }
+    }
+    EndACLBatch();
+    return ret;
+}
+
 /**
  * This function generates default ACE for security resource in case of owned status.
  *
@@ -2789,6 +2895,8 @@ OCStackResult UpdateDefaultSecProvACE()
 
         if(isRemoved)
         {
+            gAclGeneration++;
+
             /*
              * Generate new security resource ACE as follows :
              *      subject : "*"
@@ -2800,15 +2908,9 @@ OCStackResult UpdateDefaultSecProvACE()
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
 
-                size_t size = 0;
-                uint8_t *payload = NULL;
-                if (OC_STACK_OK == AclToCBORPayload(gAcl, &payload, &size))
+                if (OC_STACK_OK != UpdateACLInPS())
                 {
-                    if (UpdateSecureResourceInPS(OIC_JSON_ACL_NAME, payload, size) == OC_STACK_OK)
-                    {
-                        ret = OC_STACK_OK;
-                    }
-                    OICFree(payload);
+                    OIC_LOG(ERROR, TAG, "Failed to update ACL in persistent storage");
                 }
             }
         }
@@ -2820,8 +2922,6 @@ OCStackResult UpdateDefaultSecProvACE()
 OCStackResult SetAclRownerId(const OicUuid_t* newROwner)
 {
     OCStackResult ret = OC_STACK_ERROR;
-    uint8_t *cborPayload = NULL;
-    size_t size = 0;
     OicUuid_t prevId = {.id={0}};
 
     if(NULL == newROwner)
@@ -2838,19 +2938,13 @@ OCStackResult SetAclRownerId(const OicUuid_t* newROwner)
         memcpy(prevId.id, gAcl->rownerID.id, sizeof(prevId.id));
         memcpy(gAcl->rownerID.id, newROwner->id, sizeof(newROwner->id));
 
-        ret = AclToCBORPayload(gAcl, &cborPayload, &size);
+        ret = UpdateACLInPS();
         VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
-
-        ret = UpdateSecureResourceInPS(OIC_JSON_ACL_NAME, cborPayload, size);
-        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
-
-        OICFree(cborPayload);
     }
 
     return ret;
 
 exit:
-    OICFree(cborPayload);
     memcpy(gAcl->rownerID.id, prevId.id, sizeof(prevId.id));
     return ret;
 }
@@ -87,6 +87,12 @@ static const uint8_t CRED_MAP_SIZE = 3;
 static OicSecCred_t        *gCred = NULL;
 static OCResourceHandle    gCredHandle = NULL;
 
+/** Credential batch state, see BeginCredBatch(). */
+static bool                gCredBatchActive = false;
+static bool                gCredBatchDirty = false;
+static uint8_t             *gCredBatchBackup = NULL;
+static size_t              gCredBatchBackupSize = 0;
+
 typedef enum CredCompareResult{
     CRED_CMP_EQUAL = 0,
     CRED_CMP_NOT_EQUAL = 1,
@@ -1265,6 +1271,19 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
     bool ret = false;
     OIC_LOG(DEBUG, TAG, "IN Cred UpdatePersistentStorage");
 
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    // gCred has changed, the (D)TLS layer has to parse the credentials again.
+    CAInvalidateSslCredentials();
+#endif
+
+    // Within a batch the write is deferred to CommitCredBatch().
+    if (gCredBatchActive)
+    {
+        gCredBatchDirty = true;
+        OIC_LOG(DEBUG, TAG, "OUT Cred UpdatePersistentStorage (batched)");
+        return true;
+    }
+
     // Convert Cred data into JSON for update to persistent storage
     if (cred)
     {
@@ -1620,6 +1639,169 @@ exit:
     return ret;
 }
 
+/**
+ * Closes the open credential batch without touching gCred.
+ */
+static void EndCredBatch(void)
+{
+    OICClearMemory(gCredBatchBackup, gCredBatchBackupSize);
+    OICFree(gCredBatchBackup);
+    gCredBatchBackup = NULL;
+    gCredBatchBackupSize = 0;
+    gCredBatchActive = false;
+    gCredBatchDirty = false;
+}
+
+OCStackResult BeginCredBatch(void)
+{
+    if (gCredBatchActive)
+    {
+        OIC_LOG(ERROR, TAG, "A credential batch is already open");
+        return OC_STACK_ERROR;
+    }
+
+    // Keep the current credentials so that AbortCredBatch() can restore them.
+    if (gCred)
+    {
+        int secureFlag = 0;
+        OCStackResult ret = CredToCBORPayload(gCred, &gCredBatchBackup, &gCredBatchBackupSize,
+                                              secureFlag);
+        if (OC_STACK_OK != ret)
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed to back up credentials : %d", ret);
+            EndCredBatch();
+            return ret;
+        }
+    }
+    gCredBatchActive = true;
+    gCredBatchDirty = false;
+    return OC_STACK_OK;
+}
+
+/**
+ * Restores gCred from the backup taken when the open batch began.
+ */
+static OCStackResult RestoreCredBatchBackup(void)
+{
+    OCStackResult ret = OC_STACK_OK;
+    OicSecCred_t *originCred = NULL;
+    if (gCredBatchBackup)
+    {
+        ret = CBORPayloadToCred(gCredBatchBackup, gCredBatchBackupSize, &originCred);
+    }
+    if (OC_STACK_OK != ret)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to restore credentials, keeping the batched changes");
+        return ret;
+    }
+
+    DeleteCredList(gCred);
+    gCred = originCred;
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAInvalidateSslCredentials();
+#endif
+    return OC_STACK_OK;
+}
+
+OCStackResult CommitCredBatch(void)
+{
+    if (!gCredBatchActive)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    // The backup stays until the write succeeded, a failed write is undone.
+    bool dirty = gCredBatchDirty;
+    gCredBatchActive = false;
+    if (dirty && !UpdatePersistentStorage(gCred))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to commit credential batch, rolling back");
+        RestoreCredBatchBackup();
+        EndCredBatch();
+        return OC_STACK_ERROR;
+    }
+    EndCredBatch();
+    return OC_STACK_OK;
+}
+
+OCStackResult AbortCredBatch(void)
+{
+    if (!gCredBatchActive)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    OCStackResult ret = OC_STACK_OK;
+    if (gCredBatchDirty)
+    {
+        ret = RestoreCredBatchBackup();
+    }
+    EndCredBatch();
+    return ret;
+}
+
+/**
+ * Checks whether the credential node is part of gCred.
+ */
+static bool IsCredInList(const OicSecCred_t *cred)
+{
+    const OicSecCred_t *temp = NULL;
+    LL_FOREACH(gCred, temp)
+    {
+        if (temp == cred)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Adds every credential of a list, e.g. all credentials of one POST request,
+ * and updates persistent storage once. Takes ownership of the whole list.
+ *
+ * If a credential batch is already open the credentials join it; otherwise
+ * the changes are rolled back if any credential is rejected.
+ *
+ * @param credList list of credentials to add.
+ *
+ * @return ::OC_STACK_OK if all credentials were added, otherwise some error value.
+ */
+static OCStackResult AddCredentialList(OicSecCred_t *credList)
+{
+    OCStackResult ret = OC_STACK_OK;
+    OicSecCred_t *cred = NULL;
+    OicSecCred_t *temp = NULL;
+    bool ownBatch = (OC_STACK_OK == BeginCredBatch());
+
+    LL_FOREACH_SAFE(credList, cred, temp)
+    {
+        cred->next = NULL;
+        if (OC_STACK_OK == ret)
+        {
+            ret = AddCredential(cred);
+        }
+        // AddCredential() keeps the node only if it appended it.
+        if (!IsCredInList(cred))
+        {
+            FreeCred(cred);
+        }
+    }
+
+    if (ownBatch)
+    {
+        if (OC_STACK_OK == ret)
+        {
+            ret = CommitCredBatch();
+        }
+        else
+        {
+            AbortCredBatch();
+        }
+    }
+    return ret;
+}
+
 OCStackResult RemoveCredential(const OicUuid_t *subject)
 {
     OCStackResult ret = OC_STACK_ERROR;
@@ -2095,7 +2277,16 @@ static OCEntityHandlerResult HandlePostRequest(OCEntityHandlerRequest * ehReques
                  * to it before getting appended to the existing credential
                  * list and updating svr database.
                  */
-                ret = (OC_STACK_OK == AddCredential(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+                if (cred->next)
+                {
+                    // Several credentials in one request are stored as one batch.
+                    ret = (OC_STACK_OK == AddCredentialList(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+                    cred = NULL;
+                }
+                else
+                {
+                    ret = (OC_STACK_OK == AddCredential(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+                }
             }
         }
 #else //not __WITH_DTLS__
@@ -2105,12 +2296,21 @@ static OCEntityHandlerResult HandlePostRequest(OCEntityHandlerRequest * ehReques
          * to it before getting appended to the existing credential
          * list and updating svr database.
          */
-        ret = (OC_STACK_OK == AddCredential(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+        if (cred->next)
+        {
+            // Several credentials in one request are stored as one batch.
+            ret = (OC_STACK_OK == AddCredentialList(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+            cred = NULL;
+        }
+        else
+        {
+            ret = (OC_STACK_OK == AddCredential(cred))? OC_EH_CHANGED : OC_EH_ERROR;
+        }
         OC_UNUSED(previousMsgId);
 #endif//__WITH_DTLS__
     }
 
-    if (OC_EH_CHANGED != ret)
+    if (OC_EH_CHANGED != ret && cred)
     {
         if(OC_STACK_OK != RemoveCredential(&cred->subject))
         {
@@ -2386,6 +2586,7 @@ OCStackResult DeInitCredResource()
     OCStackResult result = OCDeleteResource(gCredHandle);
     DeleteCredList(gCred);
     gCred = NULL;
+    EndCredBatch();
     return result;
 }
 
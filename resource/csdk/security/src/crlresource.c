@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "utlist.h"
+#include "cainterface.h"
 #include "payload_logging.h"
 #include "psinterface.h"
 #include "resourcemanager.h"
@@ -494,6 +495,9 @@ OCStackResult UpdateCRLResource(OicSecCrl_t *crl)
         OIC_LOG(ERROR, TAG, "Can't update global crl");
         return OC_STACK_ERROR;
     }
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAInvalidateSslCredentials();
+#endif
 
     char currentTime[32] = {0};
     getCurrentUTCTime(currentTime, sizeof(currentTime));
@@ -678,6 +678,11 @@ static bool UpdatePersistentStorage(OicSecDoxm_t * doxm)
 {
     bool bRet = false;
 
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    // The device ID is the PSK identity used by the (D)TLS layer.
+    CAInvalidateSslCredentials();
+#endif
+
     if (NULL != doxm)
     {
         // Convert Doxm data into CBOR for update to persistent storage
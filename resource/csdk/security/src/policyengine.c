@@ -19,9 +19,13 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <coap/uthash.h>
 
 #include "utlist.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_hash.h"
 #include "policyengine.h"
 #include "resourcemanager.h"
 #include "securevirtualresourcetypes.h"
@@ -39,6 +43,67 @@
 
 #define TAG "OIC_SRM_PE"
 
+/** Number of slots in the access decision cache. */
+#define ACL_DECISION_CACHE_SIZE (32)
+
+/** Longest time a decision that depends on an ACE validity period is cached, in seconds. */
+#define ACL_DECISION_MAX_TTL (60)
+
+/**
+ * References to ACEs, in ACL order.
+ */
+typedef struct AceRefList
+{
+    const OicSecAce_t   **aces;
+    size_t              count;
+    size_t              capacity;
+} AceRefList_t;
+
+/**
+ * ACEs of one subject which list one resource href.
+ */
+typedef struct AclHrefIndex
+{
+    const char          *href;          // points into the ACL
+    AceRefList_t        aces;
+    UT_hash_handle      hh;
+} AclHrefIndex_t;
+
+/**
+ * ACEs of one subject, bucketed by resource href.
+ * ACEs listing the wildcard resource are kept in their own bucket.
+ */
+typedef struct AclSubjectIndex
+{
+    OicUuid_t           subject;
+    AclHrefIndex_t      *hrefs;
+    AceRefList_t        wildcardAces;
+    const OicSecAce_t   *lastAce;       // last ACE of the subject, decides the denial reason
+    UT_hash_handle      hh;
+} AclSubjectIndex_t;
+
+/**
+ * Cached result of ProcessAccessRequest().
+ */
+typedef struct AclDecision
+{
+    uint32_t            generation;     // ACL generation, 0 for an unused slot
+    OicUuid_t           subject;
+    uint16_t            permission;
+    char                resourceUri[MAX_URI_LENGTH + 1];
+    SRMAccessResponse_t responseVal;
+    time_t              validFrom;
+    time_t              expiry;         // 0 if the decision does not depend on time
+} AclDecision_t;
+
+/**
+ * Index of the ACL by subject and href, rebuilt when the ACL generation changes.
+ * Like the rest of the SRM it is only used from the stack's request path.
+ */
+static AclSubjectIndex_t *g_aclIndex = NULL;
+static uint32_t g_aclIndexGeneration = 0;
+static AclDecision_t g_aclDecisions[ACL_DECISION_CACHE_SIZE];
+
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
 {
     uint16_t perm = 0;
@@ -379,71 +444,384 @@ static bool IsResourceInAce(const char *resource, const OicSecAce_t *ace)
 
 
 /**
- * Find ACLs containing context->subject.
- * Search each ACL for requested resource.
- * If resource found, check for context->permission and period validity.
- * If the ACL is not found locally and AMACL for the resource is found
- * then sends the request to AMS service for the ACL.
- * Set context->retVal to result from first ACL found which contains
- * correct subject AND resource.
+ * Get the current time for decision cache expiry.
  */
-static void ProcessAccessRequest(SRMRequestContext_t *context)
+static time_t GetAclDecisionTime(void)
 {
-    if (NULL == context)
+#ifndef WITH_ARDUINO
+    return time(NULL);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Lower 'expiry' to 'limit'. An expiry of 0 means the decision never expires.
+ */
+static void LimitAclDecisionExpiry(time_t *expiry, time_t limit)
+{
+    if (0 == *expiry || limit < *expiry)
     {
-        OIC_LOG(ERROR, TAG, "ProcessAccessRequest(): context is NULL, returning.");
-        return;
+        *expiry = limit;
     }
+}
 
-    OIC_LOG_V(DEBUG, TAG, "Entering %s(%s)", __func__, context->resourceUri);
+#ifndef WITH_ARDUINO
+/**
+ * Find the next time after 'now' at which the local time of day equals
+ * the time of day of 'timeOfDay', today or tomorrow.
+ */
+static time_t GetNextTimeOfDay(const struct tm *today, time_t now, const struct tm *timeOfDay)
+{
+    for (int day = 0; day < 2; day++)
+    {
+        struct tm candidate = *today;
+        candidate.tm_mday += day;
+        candidate.tm_hour = timeOfDay->tm_hour;
+        candidate.tm_min = timeOfDay->tm_min;
+        candidate.tm_sec = timeOfDay->tm_sec;
+        candidate.tm_isdst = -1;
+        time_t next = mktime(&candidate);
+        if ((time_t)-1 != next && next > now)
+        {
+            return next;
+        }
+    }
+    return now + ACL_DECISION_MAX_TTL;
+}
+#endif
 
-    const OicSecAce_t *currentAce = NULL;
-    OicSecAce_t *aceSavePtr = NULL;
+/**
+ * Get the next time at which IsAccessWithinValidTime() may change its result for 'ace'.
+ * Validity periods recur daily, so the result can only change at the start of
+ * a period, right after its end, or at midnight when the weekday changes.
+ *
+ * @return time of the next possible change, or 0 if the result never changes.
+ */
+static time_t GetNextValidityChange(const OicSecAce_t *ace, time_t now)
+{
+#ifndef WITH_ARDUINO
+    if (NULL == ace->validities || NULL == ace->validities->recurrences)
+    {
+        return 0;
+    }
 
-    OIC_LOG_V(DEBUG, TAG, "Entering ProcessAccessRequest(%s)",
-        context->resourceUri);
+    time_t next = now + ACL_DECISION_MAX_TTL;
+    struct tm *localNow = localtime(&now);
+    if (NULL == localNow)
+    {
+        return next;
+    }
+    struct tm today = *localNow;
+    struct tm midnight = {.tm_sec = 0};
+    LimitAclDecisionExpiry(&next, GetNextTimeOfDay(&today, now, &midnight));
+
+    OicSecValidity_t *validity = NULL;
+    LL_FOREACH(ace->validities, validity)
+    {
+        IotvtICalPeriod_t period;
+        if (IOTVTICAL_SUCCESS != ParsePeriod(validity->period, &period))
+        {
+            continue;
+        }
+        // The end of a period is inclusive, access changes one second later.
+        period.endDateTime.tm_sec++;
+        LimitAclDecisionExpiry(&next, GetNextTimeOfDay(&today, now, &period.startDateTime));
+        LimitAclDecisionExpiry(&next, GetNextTimeOfDay(&today, now, &period.endDateTime));
+    }
+    return next;
+#else
+    OC_UNUSED(ace);
+    OC_UNUSED(now);
+    return 0;
+#endif
+}
 
-    // Start out assuming subject not found.
-    context->responseVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
+/**
+ * Append 'ace' to 'list', unless it is already the last entry.
+ *
+ * @return true on success, false if out of memory.
+ */
+static bool AppendAceRef(AceRefList_t *list, const OicSecAce_t *ace)
+{
+    if (0 < list->count && ace == list->aces[list->count - 1])
+    {
+        return true;
+    }
+    if (list->count == list->capacity)
+    {
+        size_t capacity = (0 == list->capacity) ? 4 : list->capacity * 2;
+        const OicSecAce_t **aces = (const OicSecAce_t **)OICRealloc((void *)list->aces,
+            capacity * sizeof(*aces));
+        if (NULL == aces)
+        {
+            return false;
+        }
+        list->aces = aces;
+        list->capacity = capacity;
+    }
+    list->aces[list->count++] = ace;
+    return true;
+}
 
-    // Loop through all ACLs with a matching Subject searching for the right
-    // ACL for this request.
-    do
+/**
+ * Free the ACL index and forget all cached decisions.
+ */
+static void FreeAclIndex(void)
+{
+    AclSubjectIndex_t *subject = NULL;
+    AclSubjectIndex_t *tmpSubject = NULL;
+    HASH_ITER(hh, g_aclIndex, subject, tmpSubject)
     {
-        currentAce = GetACLResourceData(&context->subjectUuid, &aceSavePtr);
+        AclHrefIndex_t *href = NULL;
+        AclHrefIndex_t *tmpHref = NULL;
+        HASH_ITER(hh, subject->hrefs, href, tmpHref)
+        {
+            HASH_DEL(subject->hrefs, href);
+            OICFree((void *)href->aces.aces);
+            OICFree(href);
+        }
+        HASH_DEL(g_aclIndex, subject);
+        OICFree((void *)subject->wildcardAces.aces);
+        OICFree(subject);
+    }
+    g_aclIndexGeneration = 0;
+    memset(g_aclDecisions, 0, sizeof(g_aclDecisions));
+}
 
-        if (NULL != currentAce)
+/**
+ * Add the resources of 'ace' to the index of its subject.
+ *
+ * @return true on success, false if out of memory.
+ */
+static bool AddAceToAclIndex(const OicSecAce_t *ace)
+{
+    AclSubjectIndex_t *subject = NULL;
+    HASH_FIND(hh, g_aclIndex, &ace->subjectuuid, sizeof(OicUuid_t), subject);
+    if (NULL == subject)
+    {
+        subject = (AclSubjectIndex_t *)OICCalloc(1, sizeof(AclSubjectIndex_t));
+        if (NULL == subject)
         {
-            // Found the subject, so how about resource?
-            OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
+            return false;
+        }
+        memcpy(&subject->subject, &ace->subjectuuid, sizeof(OicUuid_t));
+        HASH_ADD(hh, g_aclIndex, subject, sizeof(OicUuid_t), subject);
+    }
+    subject->lastAce = ace;
 
-            // Subject was found, so err changes to Rsrc not found for now.
-            context->responseVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
-            OIC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
-            if (IsResourceInAce(context->resourceUri, currentAce))
+    OicSecRsrc_t *rsrc = NULL;
+    LL_FOREACH(ace->resources, rsrc)
+    {
+        if (NULL == rsrc->href)
+        {
+            continue;
+        }
+        if (0 == strcmp(WILDCARD_RESOURCE_URI, rsrc->href))
+        {
+            if (!AppendAceRef(&subject->wildcardAces, ace))
             {
-                OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
-
-                // Found the resource, so it's down to valid period & permission.
-                context->responseVal = ACCESS_DENIED_INVALID_PERIOD;
-                if (IsAccessWithinValidTime(currentAce))
-                {
-                    context->responseVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
-                    if (IsPermissionAllowingRequest(currentAce->permission,
-                        context->requestedPermission))
-                    {
-                        context->responseVal = ACCESS_GRANTED;
-                    }
-                }
+                return false;
             }
+            continue;
         }
-        else
+
+        AclHrefIndex_t *href = NULL;
+        size_t hrefLen = strlen(rsrc->href);
+        HASH_FIND(hh, subject->hrefs, rsrc->href, hrefLen, href);
+        if (NULL == href)
         {
-            OIC_LOG_V(INFO, TAG, "%s:no ACE found matching subject for resource %s",
-                __func__, context->resourceUri);
+            href = (AclHrefIndex_t *)OICCalloc(1, sizeof(AclHrefIndex_t));
+            if (NULL == href)
+            {
+                return false;
+            }
+            href->href = rsrc->href;
+            HASH_ADD_KEYPTR(hh, subject->hrefs, href->href, hrefLen, href);
         }
-    } while ((NULL != currentAce)
-        && (false == IsAccessGranted(context->responseVal)));
+        if (!AppendAceRef(&href->aces, ace))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Rebuild the ACL index if the ACL changed since it was built.
+ *
+ * @return true if the index is current, false if it could not be built.
+ */
+static bool RefreshAclIndex(void)
+{
+    uint32_t generation = GetACLGeneration();
+    if (generation == g_aclIndexGeneration)
+    {
+        return true;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "%s: rebuilding ACL index for generation %u", __func__, generation);
+    FreeAclIndex();
+    for (const OicSecAce_t *ace = GetACLResourceAces(); NULL != ace; ace = ace->next)
+    {
+        if (!AddAceToAclIndex(ace))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to build ACL index");
+            FreeAclIndex();
+            return false;
+        }
+    }
+    g_aclIndexGeneration = generation;
+    return true;
+}
+
+/**
+ * Get the decision cache slot for the request in 'context'.
+ */
+static AclDecision_t *GetAclDecisionSlot(const SRMRequestContext_t *context)
+{
+    uint32_t hash = OICHashBytes(OIC_HASH_INIT, context->subjectUuid.id,
+                                 sizeof(context->subjectUuid.id));
+    hash = OICHashString(hash, context->resourceUri);
+    hash = OICHashBytes(hash, &context->requestedPermission,
+                        sizeof(context->requestedPermission));
+    return &g_aclDecisions[hash % ACL_DECISION_CACHE_SIZE];
+}
+
+/**
+ * Check whether 'decision' holds a current result for the request in 'context'.
+ */
+static bool IsAclDecisionValid(const AclDecision_t *decision,
+    const SRMRequestContext_t *context, time_t now)
+{
+    return (GetACLGeneration() == decision->generation) &&
+        (context->requestedPermission == decision->permission) &&
+        (0 == memcmp(&context->subjectUuid, &decision->subject, sizeof(OicUuid_t))) &&
+        (0 == strcmp(context->resourceUri, decision->resourceUri)) &&
+        ((0 == decision->expiry) || (decision->validFrom <= now && now < decision->expiry));
+}
+
+/**
+ * Check whether 'ace', which lists the requested resource, grants 'permission'.
+ * Lowers 'expiry' to the time the answer may change.
+ */
+static bool IsAceGrantingAccess(const OicSecAce_t *ace, uint16_t permission,
+    time_t now, time_t *expiry)
+{
+    if (!IsPermissionAllowingRequest(ace->permission, permission))
+    {
+        return false;
+    }
+    if (NULL != ace->validities)
+    {
+        LimitAclDecisionExpiry(expiry, GetNextValidityChange(ace, now));
+    }
+    return IsAccessWithinValidTime(ace);
+}
+
+/**
+ * Check the request in 'context' against the ACL index.
+ * Lowers 'expiry' to the time the result may change.
+ */
+static SRMAccessResponse_t EvaluateAclIndex(const SRMRequestContext_t *context,
+    time_t now, time_t *expiry)
+{
+    const AclSubjectIndex_t *subject = NULL;
+    HASH_FIND(hh, g_aclIndex, &context->subjectUuid, sizeof(OicUuid_t), subject);
+    if (NULL == subject)
+    {
+        OIC_LOG_V(INFO, TAG, "%s:no ACE found matching subject for resource %s",
+            __func__, context->resourceUri);
+        return ACCESS_DENIED_SUBJECT_NOT_FOUND;
+    }
+
+    const AclHrefIndex_t *href = NULL;
+    HASH_FIND(hh, subject->hrefs, context->resourceUri, strlen(context->resourceUri), href);
+    if (NULL != href)
+    {
+        for (size_t i = 0; i < href->aces.count; i++)
+        {
+            if (IsAceGrantingAccess(href->aces.aces[i], context->requestedPermission, now, expiry))
+            {
+                return ACCESS_GRANTED;
+            }
+        }
+    }
+    for (size_t i = 0; i < subject->wildcardAces.count; i++)
+    {
+        if (IsAceGrantingAccess(subject->wildcardAces.aces[i], context->requestedPermission,
+            now, expiry))
+        {
+            return ACCESS_GRANTED;
+        }
+    }
+
+    // Not granted: report why the last ACE of the subject denied access,
+    // as a walk over the whole ACL would.
+    const OicSecAce_t *lastAce = subject->lastAce;
+    if (!IsResourceInAce(context->resourceUri, lastAce))
+    {
+        return ACCESS_DENIED_RESOURCE_NOT_FOUND;
+    }
+    if (NULL != lastAce->validities)
+    {
+        LimitAclDecisionExpiry(expiry, GetNextValidityChange(lastAce, now));
+    }
+    if (!IsAccessWithinValidTime(lastAce))
+    {
+        return ACCESS_DENIED_INVALID_PERIOD;
+    }
+    return ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+}
+
+/**
+ * Find ACEs containing context->subject and the requested resource, and
+ * check them for context->permission and period validity.
+ * Set context->responseVal to ACCESS_GRANTED if any of them grants access,
+ * otherwise to the reason the last ACE of the subject denied it.
+ *
+ * Results are cached per (subject, resource, permission) until the ACL
+ * changes or a validity period of a consulted ACE starts or ends.
+ */
+static void ProcessAccessRequest(SRMRequestContext_t *context)
+{
+    if (NULL == context)
+    {
+        OIC_LOG(ERROR, TAG, "ProcessAccessRequest(): context is NULL, returning.");
+        return;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "Entering %s(%s)", __func__, context->resourceUri);
+
+    time_t now = GetAclDecisionTime();
+    AclDecision_t *decision = GetAclDecisionSlot(context);
+    if (IsAclDecisionValid(decision, context, now))
+    {
+        context->responseVal = decision->responseVal;
+        OIC_LOG_V(INFO, TAG, "%s:Leaving with cached responseVal = %s", __func__,
+            IsAccessGranted(context->responseVal) ? "ACCESS_GRANTED" : "ACCESS_DENIED");
+        return;
+    }
+
+    if (!RefreshAclIndex())
+    {
+        context->responseVal = ACCESS_DENIED_POLICY_ENGINE_ERROR;
+        return;
+    }
+
+    time_t expiry = 0;
+    context->responseVal = EvaluateAclIndex(context, now, &expiry);
+
+    if (strlen(context->resourceUri) < sizeof(decision->resourceUri))
+    {
+        decision->generation = g_aclIndexGeneration;
+        memcpy(&decision->subject, &context->subjectUuid, sizeof(OicUuid_t));
+        decision->permission = context->requestedPermission;
+        OICStrcpy(decision->resourceUri, sizeof(decision->resourceUri), context->resourceUri);
+        decision->responseVal = context->responseVal;
+        decision->validFrom = now;
+        decision->expiry = expiry;
+    }
 
     OIC_LOG_V(INFO, TAG, "%s:Leaving with responseVal = %s", __func__,
         IsAccessGranted(context->responseVal) ? "ACCESS_GRANTED" : "ACCESS_DENIED");
@@ -537,3 +915,8 @@ void CheckPermission(SRMRequestContext_t *context)
 
     return;
 }
+
+void DeInitPolicyEngine(void)
+{
+    FreeAclIndex();
+}
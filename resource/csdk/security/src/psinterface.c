@@ -32,6 +32,8 @@
 #include "ocpayloadcbor.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
+#include "ocrandom.h"
 #include "payload_logging.h"
 #include "resourcemanager.h"
 #include "secureresourcemanager.h"
@@ -58,56 +60,161 @@
 const size_t DB_FILE_SIZE_BLOCK = 1023;
 #endif
 
-typedef enum _PSDatabase
+/**
+ * Journal file magic, including the format version.
+ */
+#define PS_JOURNAL_MAGIC "OCJ1"
+
+/**
+ * Length of the random journal ID stored in the journal header.
+ */
+#define PS_JOURNAL_ID_SIZE 8
+
+/**
+ * Journal header: magic, journal ID, size and CRC-32 of the database file
+ * the journal applies to, CRC-32 of the preceding header bytes.
+ */
+#define PS_JOURNAL_HEADER_SIZE (4 + PS_JOURNAL_ID_SIZE + 4 + 4 + 4)
+
+/**
+ * Journal record framing: type, name length, value length, and trailing CRC-32.
+ */
+#define PS_JOURNAL_RECORD_OVERHEAD (1 + 2 + 4 + 4)
+
+/**
+ * Journals are compacted once they grow past this size, or past twice the
+ * size of their database file if that is larger.
+ */
+#define PS_JOURNAL_COMPACT_SIZE (16 * 1024)
+
+/**
+ * Per entry CBOR overhead of a text string name and a byte string value.
+ */
+#define PS_ENTRY_CBOR_OVERHEAD 18
+
+typedef enum _PSJournalRecordType
 {
-    PS_DATABASE_SECURITY = 0,
-    PS_DATABASE_DEVICEPROPERTIES
-} PSDatabase;
+    PS_JOURNAL_RECORD_SET = 1,      /**< Sets one resource, an empty value removes it. */
+    PS_JOURNAL_RECORD_CHECKPOINT    /**< Holds the complete database. */
+} PSJournalRecordType;
 
 /**
- * Writes CBOR payload to the specified database in persistent storage.
- *
- * @param databaseName is the name of the database to access through persistent storage.
- * @param payload      is the CBOR payload to write to the database in persistent storage.
- * @param size         is the size of payload.
- *
- * @return ::OC_STACK_OK for Success, otherwise some error value
+ * One resource of a database: a CBOR byte string stored under a text name.
  */
-static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload, size_t size)
+typedef struct PSEntry
 {
-    if (!databaseName || !payload || (size <= 0))
+    char            *name;
+    uint8_t         *value;
+    size_t          valueSize;
+    struct PSEntry  *next;
+} PSEntry_t;
+
+/**
+ * Journal that updates of a database can be appended to.
+ */
+typedef struct PSJournal
+{
+    const OCPersistentStorage   *ps;                        // handler the journal was opened with
+    char                        *databaseName;
+    uint8_t                     id[PS_JOURNAL_ID_SIZE];     // ID in the journal header
+    size_t                      journalSize;                // bytes in the journal file
+    size_t                      databaseSize;               // bytes in the database file
+    struct PSJournal            *next;
+} PSJournal_t;
+
+/**
+ * Journals known to be consistent with their database file.
+ */
+static PSJournal_t *g_psJournals = NULL;
+
+/**
+ * Updates a CRC-32 (IEEE 802.3) with 'size' bytes of 'data'.
+ */
+static uint32_t UpdatePSCrc(uint32_t crc, const uint8_t *data, size_t size)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
     {
-        OC_STACK_INVALID_PARAM;
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
     }
+    return ~crc;
+}
 
-    OCStackResult result = OC_STACK_ERROR;
+static void PutPSUint16(uint8_t *out, uint16_t value)
+{
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)(value >> 8);
+}
 
-    OIC_LOG_V(DEBUG, TAG, "Writing in the file: %" PRIuPTR, size);
+static void PutPSUint32(uint8_t *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (uint8_t)((value >> (8 * i)) & 0xFF);
+    }
+}
 
-    OCPersistentStorage* ps = OCGetPersistentStorageHandler();
-    if (ps)
+static uint16_t GetPSUint16(const uint8_t *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t GetPSUint32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/**
+ * Opens a database file, or the journal of a database through the optional
+ * journal handler. The handler decides where the journal is stored.
+ */
+static FILE *OpenPSFile(const OCPersistentStorage *ps, const char *databaseName, bool journal,
+                        const char *mode)
+{
+    if (journal)
+    {
+        OCPersistentStorageJournalHandler openJournal = OCGetPersistentStorageJournalHandler();
+        return openJournal ? openJournal(databaseName, mode) : NULL;
+    }
+    return ps->open(databaseName, mode);
+}
+
+/**
+ * Writes 'size' bytes to a database file, or to its journal, in persistent storage.
+ *
+ * @param mode is "wb" to replace the file or "ab" to append to it.
+ */
+static OCStackResult WriteFileToPS(const OCPersistentStorage *ps, const char *databaseName,
+                                   bool journal, const char *mode,
+                                   const uint8_t *data, size_t size)
+{
+    OCStackResult result = OC_STACK_ERROR;
+    const char *kind = journal ? "journal of " : "";
+    FILE *fp = OpenPSFile(ps, databaseName, journal, mode);
+    if (fp)
     {
-        FILE *fp = ps->open(databaseName, "wb");
-        if (fp)
+        size_t numberItems = size ? ps->write(data, 1, size, fp) : 0;
+        // A failed close can mean the data never reached the storage.
+        if (0 == ps->close(fp) && size == numberItems)
         {
-            size_t numberItems = ps->write(payload, 1, size, fp);
-            if (size == numberItems)
-            {
-                OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, databaseName);
-                result = OC_STACK_OK;
-            }
-            else
-            {
-                OIC_LOG_V(ERROR, TAG, "Failed writing %" PRIuPTR " in %s", numberItems, databaseName);
-            }
-            ps->close(fp);
+            OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s%s", size, kind, databaseName);
+            result = OC_STACK_OK;
         }
         else
         {
-            OIC_LOG(ERROR, TAG, "File open failed.");
+            OIC_LOG_V(ERROR, TAG, "Failed writing %" PRIuPTR " in %s%s", numberItems, kind,
+                      databaseName);
         }
     }
-
+    else
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to open %s%s", kind, databaseName);
+    }
     return result;
 }
 
@@ -116,10 +223,12 @@ static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload
  *
  * @param ps            is a pointer to OCPersistentStorage for the Virtual Resource(s).
  * @param databaseName  is the name of the database to access through persistent storage.
+ * @param journal       is true to get the size of the journal of the database.
  *
  * @return size_t - total size of the database
  */
-static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databaseName)
+static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databaseName,
+                              bool journal)
 {
     if (!ps)
     {
@@ -128,7 +237,7 @@ static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databas
     size_t size = 0;
     char buffer[DB_FILE_SIZE_BLOCK];  // can not initialize with declaration
                                       // but maybe not needed to initialize
-    FILE *fp = ps->open(databaseName, "rb");
+    FILE *fp = OpenPSFile(ps, databaseName, journal, "rb");
     if (fp)
     {
         size_t bytesRead = 0;
@@ -142,6 +251,653 @@ static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databas
     return size;
 }
 
+/**
+ * Reads a whole database file, or its journal, from persistent storage.
+ * A missing file reads as empty.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by the data argument.
+ */
+static OCStackResult ReadFileFromPS(const OCPersistentStorage *ps, const char *databaseName,
+                                    bool journal, uint8_t **data, size_t *size)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    FILE *fp = NULL;
+
+    *data = NULL;
+    *size = GetDatabaseSize(ps, databaseName, journal);
+    OIC_LOG_V(DEBUG, TAG, "File Read Size: %" PRIuPTR, *size);
+    if (0 == *size)
+    {
+        return OC_STACK_OK;
+    }
+
+    *data = (uint8_t *)OICCalloc(1, *size);
+    VERIFY_NOT_NULL(TAG, *data, ERROR);
+    fp = OpenPSFile(ps, databaseName, journal, "rb");
+    VERIFY_NOT_NULL(TAG, fp, ERROR);
+    VERIFY_SUCCESS(TAG, ps->read(*data, 1, *size, fp) == *size, ERROR);
+    ret = OC_STACK_OK;
+
+exit:
+    if (fp)
+    {
+        ps->close(fp);
+    }
+    if (OC_STACK_OK != ret)
+    {
+        OICFree(*data);
+        *data = NULL;
+        *size = 0;
+    }
+    return ret;
+}
+
+static void FreePSEntries(PSEntry_t *entries)
+{
+    while (entries)
+    {
+        PSEntry_t *next = entries->next;
+        OICFree(entries->name);
+        OICFree(entries->value);
+        OICFree(entries);
+        entries = next;
+    }
+}
+
+/**
+ * Sets the value of the entry 'name', adding it if needed.
+ * An empty value removes the entry.
+ */
+static OCStackResult SetPSEntry(PSEntry_t **entries, const char *name, size_t nameLen,
+                                const uint8_t *value, size_t valueSize)
+{
+    PSEntry_t **link = entries;
+    while (*link && (strlen((*link)->name) != nameLen || 0 != memcmp((*link)->name, name, nameLen)))
+    {
+        link = &(*link)->next;
+    }
+
+    if (!value || 0 == valueSize)
+    {
+        if (*link)
+        {
+            PSEntry_t *entry = *link;
+            *link = entry->next;
+            entry->next = NULL;
+            FreePSEntries(entry);
+        }
+        return OC_STACK_OK;
+    }
+
+    uint8_t *copy = (uint8_t *)OICMalloc(valueSize);
+    VERIFY_NOT_NULL_RETURN(TAG, copy, ERROR, OC_STACK_NO_MEMORY);
+    memcpy(copy, value, valueSize);
+
+    if (!*link)
+    {
+        PSEntry_t *entry = (PSEntry_t *)OICCalloc(1, sizeof(PSEntry_t));
+        char *entryName = (char *)OICMalloc(nameLen + 1);
+        if (!entry || !entryName)
+        {
+            OICFree(entry);
+            OICFree(entryName);
+            OICFree(copy);
+            return OC_STACK_NO_MEMORY;
+        }
+        memcpy(entryName, name, nameLen);
+        entryName[nameLen] = '\0';
+        entry->name = entryName;
+        *link = entry;
+    }
+    OICFree((*link)->value);
+    (*link)->value = copy;
+    (*link)->valueSize = valueSize;
+    return OC_STACK_OK;
+}
+
+/**
+ * Parses a database image, a CBOR map of resource names to CBOR byte strings.
+ * Values of other types are skipped.
+ */
+static OCStackResult ParsePSImage(const uint8_t *data, size_t size, PSEntry_t **entries)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    char *name = NULL;
+    uint8_t *value = NULL;
+    PSEntry_t *parsed = NULL;
+
+    *entries = NULL;
+    if (!data || 0 == size)
+    {
+        return OC_STACK_OK;
+    }
+
+    CborParser parser;  // will be initialized in |cbor_parser_init|
+    CborValue cbor;     // will be initialized in |cbor_parser_init|
+    CborValue map;      // will be initialized in |cbor_value_enter_container|
+    CborError cborFindResult = cbor_parser_init(data, size, 0, &parser, &cbor);
+    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Init Parser.");
+    VERIFY_SUCCESS(TAG, cbor_value_is_map(&cbor), ERROR);
+    cborFindResult = cbor_value_enter_container(&cbor, &map);
+    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Entering Database Map.");
+
+    while (!cbor_value_at_end(&map))
+    {
+        size_t nameLen = 0;
+        size_t valueSize = 0;
+        VERIFY_SUCCESS(TAG, cbor_value_is_text_string(&map), ERROR);
+        cborFindResult = cbor_value_dup_text_string(&map, &name, &nameLen, NULL);
+        VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+        cborFindResult = cbor_value_advance(&map);
+        VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Advancing Map.");
+
+        if (cbor_value_is_byte_string(&map))
+        {
+            cborFindResult = cbor_value_dup_byte_string(&map, &value, &valueSize, NULL);
+            VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+            VERIFY_SUCCESS(TAG, OC_STACK_OK == SetPSEntry(&parsed, name, nameLen, value, valueSize), ERROR);
+            OICFree(value);
+            value = NULL;
+        }
+        OICFree(name);
+        name = NULL;
+        cborFindResult = cbor_value_advance(&map);
+        VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Advancing Map.");
+    }
+
+    *entries = parsed;
+    parsed = NULL;
+    ret = OC_STACK_OK;
+
+exit:
+    OICFree(name);
+    OICFree(value);
+    FreePSEntries(parsed);
+    return ret;
+}
+
+/**
+ * Encodes database entries into a database image.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by the data argument.
+ */
+static OCStackResult EncodePSImage(const PSEntry_t *entries, uint8_t **data, size_t *size)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    int64_t cborEncoderResult = CborNoError;
+    size_t allocSize = CBOR_ENCODING_SIZE_ADDITION;
+    uint8_t *outPayload = NULL;
+
+    for (const PSEntry_t *entry = entries; entry; entry = entry->next)
+    {
+        allocSize += strlen(entry->name) + entry->valueSize + PS_ENTRY_CBOR_OVERHEAD;
+    }
+
+    outPayload = (uint8_t *)OICCalloc(1, allocSize);
+    VERIFY_NOT_NULL(TAG, outPayload, ERROR);
+    CborEncoder encoder;  // will be initialized in |cbor_parser_init|
+    cbor_encoder_init(&encoder, outPayload, allocSize, 0);
+    CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
+    cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
+
+    for (const PSEntry_t *entry = entries; entry; entry = entry->next)
+    {
+        cborEncoderResult |= cbor_encode_text_string(&resource, entry->name, strlen(entry->name));
+        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
+        cborEncoderResult |= cbor_encode_byte_string(&resource, entry->value, entry->valueSize);
+        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
+    }
+
+    cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
+    *size = cbor_encoder_get_buffer_size(&encoder, outPayload);
+    *data = outPayload;
+    outPayload = NULL;
+    ret = OC_STACK_OK;
+
+exit:
+    OICFree(outPayload);
+    return ret;
+}
+
+static PSJournal_t *FindPSJournal(const OCPersistentStorage *ps, const char *databaseName)
+{
+    if (!OCGetPersistentStorageJournalHandler())
+    {
+        return NULL;
+    }
+    for (PSJournal_t *journal = g_psJournals; journal; journal = journal->next)
+    {
+        if (ps == journal->ps && 0 == strcmp(databaseName, journal->databaseName))
+        {
+            return journal;
+        }
+    }
+    return NULL;
+}
+
+static void ForgetPSJournal(const OCPersistentStorage *ps, const char *databaseName)
+{
+    for (PSJournal_t **link = &g_psJournals; *link; link = &(*link)->next)
+    {
+        PSJournal_t *journal = *link;
+        if (ps == journal->ps && 0 == strcmp(databaseName, journal->databaseName))
+        {
+            *link = journal->next;
+            OICFree(journal->databaseName);
+            OICFree(journal);
+            return;
+        }
+    }
+}
+
+/**
+ * Remembers that the journal of a database can be appended to.
+ */
+static void RememberPSJournal(const OCPersistentStorage *ps, const char *databaseName,
+                              const uint8_t *id, size_t journalSize, size_t databaseSize)
+{
+    PSJournal_t *journal = FindPSJournal(ps, databaseName);
+    if (!journal)
+    {
+        journal = (PSJournal_t *)OICCalloc(1, sizeof(PSJournal_t));
+        char *name = OICStrdup(databaseName);
+        if (!journal || !name)
+        {
+            OICFree(journal);
+            OICFree(name);
+            return;
+        }
+        journal->ps = ps;
+        journal->databaseName = name;
+        journal->next = g_psJournals;
+        g_psJournals = journal;
+    }
+    memcpy(journal->id, id, PS_JOURNAL_ID_SIZE);
+    journal->journalSize = journalSize;
+    journal->databaseSize = databaseSize;
+}
+
+/**
+ * Checks the header of a journal.
+ *
+ * @return true if the header is intact.
+ */
+static bool ParsePSJournalHeader(const uint8_t *data, size_t size, const uint8_t **id,
+                                 uint32_t *baseSize, uint32_t *baseCrc)
+{
+    if (size < PS_JOURNAL_HEADER_SIZE ||
+        0 != memcmp(data, PS_JOURNAL_MAGIC, 4) ||
+        GetPSUint32(data + PS_JOURNAL_HEADER_SIZE - 4) !=
+            UpdatePSCrc(0, data, PS_JOURNAL_HEADER_SIZE - 4))
+    {
+        return false;
+    }
+    *id = data + 4;
+    *baseSize = GetPSUint32(data + 4 + PS_JOURNAL_ID_SIZE);
+    *baseCrc = GetPSUint32(data + 8 + PS_JOURNAL_ID_SIZE);
+    return true;
+}
+
+/**
+ * Checks the journal record at 'offset'.
+ *
+ * @return size of the record, or 0 if it is torn or corrupt.
+ */
+static size_t ParsePSJournalRecord(const uint8_t *data, size_t size, size_t offset)
+{
+    if (size - offset < PS_JOURNAL_RECORD_OVERHEAD)
+    {
+        return 0;
+    }
+    const uint8_t *record = data + offset;
+    size_t available = size - offset - PS_JOURNAL_RECORD_OVERHEAD;
+    size_t nameLen = GetPSUint16(record + 1);
+    size_t valueSize = GetPSUint32(record + 3);
+    if (nameLen > available || valueSize > available - nameLen)
+    {
+        return 0;
+    }
+    size_t bodySize = PS_JOURNAL_RECORD_OVERHEAD - 4 + nameLen + valueSize;
+    if (GetPSUint32(record + bodySize) != UpdatePSCrc(0, record, bodySize))
+    {
+        return 0;
+    }
+    return bodySize + 4;
+}
+
+/**
+ * Applies the journal record at 'record' to 'entries'.
+ */
+static OCStackResult ApplyPSJournalRecord(const uint8_t *record, PSEntry_t **entries)
+{
+    uint16_t nameLen = GetPSUint16(record + 1);
+    uint32_t valueSize = GetPSUint32(record + 3);
+    const uint8_t *name = record + PS_JOURNAL_RECORD_OVERHEAD - 4;
+    const uint8_t *value = name + nameLen;
+
+    if (PS_JOURNAL_RECORD_CHECKPOINT == record[0])
+    {
+        PSEntry_t *checkpoint = NULL;
+        OCStackResult ret = ParsePSImage(value, valueSize, &checkpoint);
+        if (OC_STACK_OK == ret)
+        {
+            FreePSEntries(*entries);
+            *entries = checkpoint;
+        }
+        return ret;
+    }
+    return SetPSEntry(entries, (const char *)name, nameLen, value, valueSize);
+}
+
+/**
+ * Loads a database: the database file, brought up to date by its journal.
+ *
+ * The journal applies if its header names the current database file. If it
+ * does not, the database file was either replaced by someone else, or was
+ * torn while a checkpoint was being written back; in the latter case the
+ * journal is replayed from its last checkpoint. Replay stops at the first
+ * torn record, which is where a crash interrupted an append.
+ *
+ * If the journal can be appended to, it is remembered for UpdateResourceInPS().
+ * Without a journal handler only the database file is read.
+ *
+ * @param entries      is set to the resources of the database.
+ * @param journalUsed  is set to true if the journal changed the database file contents.
+ */
+static OCStackResult LoadPSDatabase(const OCPersistentStorage *ps, const char *databaseName,
+                                    uint8_t **dbData, size_t *dbSize,
+                                    PSEntry_t **entries, bool *journalUsed)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    uint8_t *journalData = NULL;
+    size_t journalSize = 0;
+
+    *entries = NULL;
+    *journalUsed = false;
+
+    ret = ReadFileFromPS(ps, databaseName, false, dbData, dbSize);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+    if (!OCGetPersistentStorageJournalHandler())
+    {
+        // The handler does not keep journals.
+        ret = ParsePSImage(*dbData, *dbSize, entries);
+        goto exit;
+    }
+    ret = ReadFileFromPS(ps, databaseName, true, &journalData, &journalSize);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+
+    const uint8_t *id = NULL;
+    uint32_t baseSize = 0;
+    uint32_t baseCrc = 0;
+    bool validJournal = ParsePSJournalHeader(journalData, journalSize, &id, &baseSize, &baseCrc);
+    bool baseMatches = validJournal && (baseSize == *dbSize) &&
+                       (baseCrc == UpdatePSCrc(0, *dbData, *dbSize));
+
+    // Find the intact records, and the last checkpoint among them.
+    size_t replayFrom = PS_JOURNAL_HEADER_SIZE;
+    size_t replayTo = PS_JOURNAL_HEADER_SIZE;
+    bool hasCheckpoint = false;
+    while (validJournal)
+    {
+        size_t recordSize = ParsePSJournalRecord(journalData, journalSize, replayTo);
+        if (0 == recordSize)
+        {
+            break;
+        }
+        if (PS_JOURNAL_RECORD_CHECKPOINT == journalData[replayTo])
+        {
+            replayFrom = replayTo;
+            hasCheckpoint = true;
+        }
+        replayTo += recordSize;
+    }
+
+    if (!baseMatches && !hasCheckpoint)
+    {
+        // Stale journal, or none: the database file is all there is.
+        if (validJournal)
+        {
+            OIC_LOG_V(INFO, TAG, "Ignoring stale journal of %s", databaseName);
+        }
+        ForgetPSJournal(ps, databaseName);
+        ret = ParsePSImage(*dbData, *dbSize, entries);
+        goto exit;
+    }
+
+    if (baseMatches)
+    {
+        replayFrom = PS_JOURNAL_HEADER_SIZE;
+        ret = ParsePSImage(*dbData, *dbSize, entries);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+    }
+    else
+    {
+        OIC_LOG_V(INFO, TAG, "Recovering %s from its journal", databaseName);
+    }
+
+    for (size_t offset = replayFrom; offset < replayTo;
+         offset += ParsePSJournalRecord(journalData, journalSize, offset))
+    {
+        ret = ApplyPSJournalRecord(journalData + offset, entries);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        *journalUsed = true;
+    }
+
+    if (baseMatches && replayTo == journalSize)
+    {
+        RememberPSJournal(ps, databaseName, id, journalSize, *dbSize);
+    }
+    else
+    {
+        ForgetPSJournal(ps, databaseName);
+    }
+    ret = OC_STACK_OK;
+
+exit:
+    if (OC_STACK_OK != ret)
+    {
+        FreePSEntries(*entries);
+        *entries = NULL;
+    }
+    OICFree(journalData);
+    return ret;
+}
+
+/**
+ * Builds a journal record.
+ *
+ * @note Caller of this method MUST use OICFree() method to release the returned record.
+ */
+static uint8_t *CreatePSJournalRecord(PSJournalRecordType type, const char *name,
+                                      const uint8_t *value, size_t valueSize, size_t *recordSize)
+{
+    size_t nameLen = name ? strlen(name) : 0;
+    if (nameLen > UINT16_MAX || valueSize > UINT32_MAX)
+    {
+        return NULL;
+    }
+
+    size_t bodySize = PS_JOURNAL_RECORD_OVERHEAD - 4 + nameLen + valueSize;
+    uint8_t *record = (uint8_t *)OICMalloc(bodySize + 4);
+    if (record)
+    {
+        record[0] = (uint8_t)type;
+        PutPSUint16(record + 1, (uint16_t)nameLen);
+        PutPSUint32(record + 3, (uint32_t)valueSize);
+        if (nameLen)
+        {
+            memcpy(record + PS_JOURNAL_RECORD_OVERHEAD - 4, name, nameLen);
+        }
+        if (valueSize)
+        {
+            memcpy(record + PS_JOURNAL_RECORD_OVERHEAD - 4 + nameLen, value, valueSize);
+        }
+        PutPSUint32(record + bodySize, UpdatePSCrc(0, record, bodySize));
+        *recordSize = bodySize + 4;
+    }
+    return record;
+}
+
+/**
+ * Starts a new journal for the database file 'data', holding 'records'.
+ * A crash while the journal is written leaves a journal without the
+ * torn records, or one that does not apply to the database file.
+ */
+static OCStackResult StartPSJournal(const OCPersistentStorage *ps, const char *databaseName,
+                                    const uint8_t *data, size_t size,
+                                    const uint8_t *records, size_t recordsSize)
+{
+    uint8_t *journal = (uint8_t *)OICMalloc(PS_JOURNAL_HEADER_SIZE + recordsSize);
+    VERIFY_NOT_NULL_RETURN(TAG, journal, ERROR, OC_STACK_NO_MEMORY);
+
+    memcpy(journal, PS_JOURNAL_MAGIC, 4);
+    if (!OCGetRandomBytes(journal + 4, PS_JOURNAL_ID_SIZE))
+    {
+        OICFree(journal);
+        return OC_STACK_ERROR;
+    }
+    PutPSUint32(journal + 4 + PS_JOURNAL_ID_SIZE, (uint32_t)size);
+    PutPSUint32(journal + 8 + PS_JOURNAL_ID_SIZE, UpdatePSCrc(0, data, size));
+    PutPSUint32(journal + PS_JOURNAL_HEADER_SIZE - 4,
+                UpdatePSCrc(0, journal, PS_JOURNAL_HEADER_SIZE - 4));
+    if (recordsSize)
+    {
+        memcpy(journal + PS_JOURNAL_HEADER_SIZE, records, recordsSize);
+    }
+
+    OCStackResult ret = WriteFileToPS(ps, databaseName, true, "wb", journal,
+                                      PS_JOURNAL_HEADER_SIZE + recordsSize);
+    if (OC_STACK_OK == ret)
+    {
+        RememberPSJournal(ps, databaseName, journal + 4,
+                          PS_JOURNAL_HEADER_SIZE + recordsSize, size);
+    }
+    OICFree(journal);
+    return ret;
+}
+
+/**
+ * Checks that the remembered journal of a database is still the one on storage.
+ */
+static bool IsPSJournalCurrent(const OCPersistentStorage *ps, const char *databaseName,
+                               const PSJournal_t *journal)
+{
+    uint8_t header[PS_JOURNAL_HEADER_SIZE];
+    const uint8_t *id = NULL;
+    uint32_t baseSize = 0;
+    uint32_t baseCrc = 0;
+    bool current = false;
+
+    FILE *fp = OpenPSFile(ps, databaseName, true, "rb");
+    if (fp)
+    {
+        current = (sizeof(header) == ps->read(header, 1, sizeof(header), fp)) &&
+                  ParsePSJournalHeader(header, sizeof(header), &id, &baseSize, &baseCrc) &&
+                  (0 == memcmp(id, journal->id, PS_JOURNAL_ID_SIZE));
+        ps->close(fp);
+    }
+    return current;
+}
+
+/**
+ * Writes a complete database image to persistent storage.
+ *
+ * The image is first appended to the journal as a checkpoint, then written
+ * to the database file, and finally the journal is restarted. A crash at any
+ * point leaves either the old or the new contents recoverable.
+ */
+static OCStackResult CommitPSImage(const OCPersistentStorage *ps, const char *databaseName,
+                                   const uint8_t *image, size_t imageSize)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    uint8_t *record = NULL;
+    size_t recordSize = 0;
+    uint8_t *dbData = NULL;
+    size_t dbSize = 0;
+    PSEntry_t *entries = NULL;
+    bool journalUsed = false;
+
+    if (!OCGetPersistentStorageJournalHandler())
+    {
+        return WriteFileToPS(ps, databaseName, false, "wb", image, imageSize);
+    }
+
+    record = CreatePSJournalRecord(PS_JOURNAL_RECORD_CHECKPOINT, NULL, image, imageSize, &recordSize);
+    VERIFY_NOT_NULL(TAG, record, ERROR);
+
+    PSJournal_t *journal = FindPSJournal(ps, databaseName);
+    if (!journal)
+    {
+        // Loading the database validates its journal for appending.
+        ret = LoadPSDatabase(ps, databaseName, &dbData, &dbSize, &entries, &journalUsed);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        journal = FindPSJournal(ps, databaseName);
+    }
+
+    if (journal && IsPSJournalCurrent(ps, databaseName, journal))
+    {
+        ret = WriteFileToPS(ps, databaseName, true, "ab", record, recordSize);
+    }
+    else
+    {
+        // No journal to append to: start one for the current database file.
+        ForgetPSJournal(ps, databaseName);
+        if (!dbData)
+        {
+            ret = ReadFileFromPS(ps, databaseName, false, &dbData, &dbSize);
+            VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        }
+        ret = StartPSJournal(ps, databaseName, dbData, dbSize, record, recordSize);
+    }
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+
+    // The checkpoint is durable, so the database file can be rewritten.
+    ret = WriteFileToPS(ps, databaseName, false, "wb", image, imageSize);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+    ret = StartPSJournal(ps, databaseName, image, imageSize, NULL, 0);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+
+exit:
+    if (OC_STACK_OK != ret)
+    {
+        ForgetPSJournal(ps, databaseName);
+    }
+    OICFree(record);
+    OICFree(dbData);
+    FreePSEntries(entries);
+    return ret;
+}
+
+/**
+ * Writes CBOR payload to the specified database in persistent storage.
+ *
+ * @param databaseName is the name of the database to access through persistent storage.
+ * @param payload      is the CBOR payload to write to the database in persistent storage.
+ * @param size         is the size of payload.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload, size_t size)
+{
+    if (!databaseName || !payload || (size <= 0))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "Writing in the file: %" PRIuPTR, size);
+
+    OCPersistentStorage* ps = OCGetPersistentStorageHandler();
+    if (!ps)
+    {
+        return OC_STACK_ERROR;
+    }
+    return CommitPSImage(ps, databaseName, payload, size);
+}
+
 /**
  * Reads the database from PS
  * 
@@ -165,65 +921,63 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
         return OC_STACK_INVALID_PARAM;
     }
 
-    FILE *fp = NULL;
-    uint8_t *fsData = NULL;
-    size_t fileSize = 0;
+    uint8_t *dbData = NULL;
+    size_t dbSize = 0;
+    PSEntry_t *entries = NULL;
+    bool journalUsed = false;
     OCStackResult ret = OC_STACK_ERROR;
 
     OCPersistentStorage *ps = OCGetPersistentStorageHandler();
     VERIFY_NOT_NULL(TAG, ps, ERROR);
 
-    fileSize = GetDatabaseSize(ps, databaseName);
-    OIC_LOG_V(DEBUG, TAG, "File Read Size: %zu", fileSize);
-    if (fileSize)
-    {
-        fsData = (uint8_t *) OICCalloc(1, fileSize);
-        VERIFY_NOT_NULL(TAG, fsData, ERROR);
+    ret = LoadPSDatabase(ps, databaseName, &dbData, &dbSize, &entries, &journalUsed);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+    ret = OC_STACK_ERROR;
 
-        fp = ps->open(databaseName, "rb");
-        VERIFY_NOT_NULL(TAG, fp, ERROR);
-        if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+    if (resourceName)
+    {
+        for (const PSEntry_t *entry = entries; entry; entry = entry->next)
         {
-            if (resourceName)
-            {
-                CborParser parser;  // will be initialized in |cbor_parser_init|
-                CborValue cbor;     // will be initialized in |cbor_parser_init|
-                cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
-                CborValue cborValue = {0};
-                CborError cborFindResult = cbor_value_map_find_value(&cbor, resourceName, &cborValue);
-                if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
-                    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
-                    ret = OC_STACK_OK;
-                }
-                // in case of |else (...)|, svr_data not found
-            }
-            // return everything in case resourceName is NULL
-            else
+            if (0 == strcmp(resourceName, entry->name))
             {
-                *size = fileSize;
-                *data = (uint8_t *) OICCalloc(1, fileSize);
+                *data = (uint8_t *)OICMalloc(entry->valueSize);
                 VERIFY_NOT_NULL(TAG, *data, ERROR);
-                memcpy(*data, fsData, fileSize);
+                memcpy(*data, entry->value, entry->valueSize);
+                *size = entry->valueSize;
                 ret = OC_STACK_OK;
+                break;
             }
         }
+        // in case no entry matched, svr_data not found
+    }
+    // return everything in case resourceName is NULL
+    else if (journalUsed)
+    {
+        ret = EncodePSImage(entries, data, size);
+    }
+    else if (dbSize)
+    {
+        *data = dbData;
+        *size = dbSize;
+        dbData = NULL;
+        ret = OC_STACK_OK;
     }
     OIC_LOG(DEBUG, TAG, "ReadDatabaseFromPS OUT");
 
 exit:
-    if (fp)
-    {
-        ps->close(fp);
-    }
-    OICFree(fsData);
+    OICFree(dbData);
+    FreePSEntries(entries);
     return ret;
 }
 
 /**
  * This method updates the database in PS
  *
+ * If the persistent storage handler keeps journals, the update is appended to
+ * the journal of the database, so only the changed resource is written. Once
+ * the journal has grown large enough it is folded back into the database file.
+ * Otherwise the database file is rewritten.
+ *
  * @param databaseName  is the name of the database to access through persistent storage.
  * @param resourceName  is the name of the resource that will be updated.
  * @param payload       is the pointer to memory where the CBOR payload is located.
@@ -239,271 +993,81 @@ OCStackResult UpdateResourceInPS(const char *databaseName, const char *resourceN
         return OC_STACK_INVALID_PARAM;
     }
 
-    size_t dbSize = 0;
-    size_t outSize = 0;
+    OCStackResult ret = OC_STACK_ERROR;
+    uint8_t *record = NULL;
+    size_t recordSize = 0;
     uint8_t *dbData = NULL;
+    size_t dbSize = 0;
+    PSEntry_t *entries = NULL;
+    bool loaded = false;
+    bool journalUsed = false;
     uint8_t *outPayload = NULL;
+    size_t outSize = 0;
 
-    uint8_t *aclCbor = NULL;
-    uint8_t *pstatCbor = NULL;
-    uint8_t *doxmCbor = NULL;
-    uint8_t *amaclCbor = NULL;
-    uint8_t *credCbor = NULL;
-    uint8_t *pconfCbor = NULL;
-    uint8_t *resetPfCbor = NULL;
-    uint8_t *crlCbor = NULL;
-    uint8_t *dpCbor = NULL;
-
-    int64_t cborEncoderResult = CborNoError;
-    OCStackResult ret = ReadDatabaseFromPS(databaseName, NULL, &dbData, &dbSize);
-    if (dbData && dbSize)
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    VERIFY_NOT_NULL(TAG, ps, ERROR);
+    if (OCGetPersistentStorageJournalHandler())
     {
-        PSDatabase database = PS_DATABASE_SECURITY;
-        size_t allocSize = 0;
-        size_t aclCborLen = 0;
-        size_t pstatCborLen = 0;
-        size_t doxmCborLen = 0;
-        size_t amaclCborLen = 0;
-        size_t credCborLen = 0;
-        size_t pconfCborLen = 0;
-        size_t resetPfCborLen = 0;
-        size_t crlCborLen = 0;
-        size_t dpCborLen = 0;
-
-        // Determine which database we are working with so we can scope our operations
-        if (0 == strcmp(OC_DEVICE_PROPS_FILE_NAME, databaseName))
-        {
-            database = PS_DATABASE_DEVICEPROPERTIES;
-        }
-
-        // Gets each secure virtual resource from persistent storage
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            CborParser parser;  // will be initialized in |cbor_parser_init|
-            CborValue cbor;     // will be initialized in |cbor_parser_init|
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
+        record = CreatePSJournalRecord(PS_JOURNAL_RECORD_SET, resourceName,
+                                       payload, payload ? size : 0, &recordSize);
+        VERIFY_NOT_NULL(TAG, record, ERROR);
+    }
 
-            // Only search for and copy resources owned by the target database
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &aclCbor, &aclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding ACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PSTAT_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pstatCbor, &pstatCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PSTAT Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_DOXM_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &doxmCbor, &doxmCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding DOXM Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_AMACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &amaclCbor, &amaclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding AMACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRED_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &credCbor, &credCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding CRED Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PCONF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pconfCbor, &pconfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PCONF Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &resetPfCbor, &resetPfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Reset Profile Name Value.");
-                }
-                int64_t cborFindCrlResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRL_NAME, &curVal);
-                if ((CborNoError == cborFindCrlResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindCrlResult = cbor_value_dup_byte_string(&curVal, &crlCbor, &crlCborLen, NULL);
-                    if ((CborNoError != cborFindCrlResult) && (CborErrorOutOfMemory != cborFindCrlResult))
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed Finding optional CRL Name Value.");
-                    }
-                    else
-                    {
-                        OIC_LOG(INFO, TAG, "Successfully Finding optional CRL Name Value.");
-                    }
-                }
-            }
-            else
-            {
-                // Device Properties database
-                cborFindResult = cbor_value_map_find_value(&cbor, OC_JSON_DEVICE_PROPS_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &dpCbor, &dpCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Device Properties Name Value.");
-                }
-            }
-        }
+    PSJournal_t *journal = FindPSJournal(ps, databaseName);
+    if (!journal)
+    {
+        // Loading the database validates its journal for appending.
+        ret = LoadPSDatabase(ps, databaseName, &dbData, &dbSize, &entries, &journalUsed);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        loaded = true;
+        journal = FindPSJournal(ps, databaseName);
+    }
 
-        // Updates the added |payload| with the existing secure virtual resource(s)
-        // this local scoping intended, for destroying large cbor instances after use
+    if (journal)
+    {
+        size_t compactSize = (2 * journal->databaseSize > PS_JOURNAL_COMPACT_SIZE) ?
+                             2 * journal->databaseSize : PS_JOURNAL_COMPACT_SIZE;
+        if (journal->journalSize + recordSize <= compactSize &&
+            IsPSJournalCurrent(ps, databaseName, journal))
         {
-            if (PS_DATABASE_SECURITY == database)
+            ret = WriteFileToPS(ps, databaseName, true, "ab", record, recordSize);
+            if (OC_STACK_OK == ret)
             {
-                allocSize = aclCborLen + pstatCborLen + doxmCborLen + amaclCborLen
-                          + credCborLen + pconfCborLen + resetPfCborLen + crlCborLen
-                          + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-            else
-            {
-                allocSize = dpCborLen + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-
-
-            outPayload = (uint8_t *)OICCalloc(1, allocSize);
-            VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-            CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-            cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-            CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-            cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-            if (payload && size)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-                cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-            }
-
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                if (strcmp(OIC_JSON_ACL_NAME, resourceName) && aclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_ACL_NAME, strlen(OIC_JSON_ACL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, aclCbor, aclCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Value.");
-                }
-                else if (strcmp(OIC_JSON_PSTAT_NAME, resourceName) && pstatCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PSTAT_NAME, strlen(OIC_JSON_PSTAT_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pstatCbor, pstatCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Value.");
-                }
-                else if (strcmp(OIC_JSON_DOXM_NAME, resourceName) && doxmCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_DOXM_NAME, strlen(OIC_JSON_DOXM_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, doxmCbor, doxmCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Value.");
-                }
-                else if (strcmp(OIC_JSON_AMACL_NAME, resourceName) && amaclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_AMACL_NAME, strlen(OIC_JSON_AMACL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, amaclCbor, amaclCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Value.");
-                }
-                else if (strcmp(OIC_JSON_CRED_NAME, resourceName) && credCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRED_NAME, strlen(OIC_JSON_CRED_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, credCbor, credCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Value.");
-                }
-                else if (strcmp(OIC_JSON_PCONF_NAME, resourceName) && pconfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PCONF_NAME, strlen(OIC_JSON_PCONF_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pconfCbor, pconfCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Value.");
-                }
-                else if (strcmp(OIC_JSON_RESET_PF_NAME, resourceName) && resetPfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_RESET_PF_NAME, strlen(OIC_JSON_RESET_PF_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, resetPfCbor, resetPfCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Value.");
-                }
-                else if (strcmp(OIC_JSON_CRL_NAME, resourceName) && crlCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRL_NAME, strlen(OIC_JSON_CRL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, crlCbor, crlCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Value.");
-                }
-            }
-            else
-            {
-                // Device Properties database
-                if (strcmp(OC_JSON_DEVICE_PROPS_NAME, resourceName) && dpCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OC_JSON_DEVICE_PROPS_NAME, strlen(OC_JSON_DEVICE_PROPS_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Device Properties Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, dpCbor, dpCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Device Properties Value.");
-                }
+                journal->journalSize += recordSize;
+                OIC_LOG(DEBUG, TAG, "UpdateResourceInPS OUT");
+                goto exit;
             }
-
-            cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-            outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+            // A partial append must not be followed by further records.
+            OIC_LOG(WARNING, TAG, "Journal append failed, compacting");
+            ForgetPSJournal(ps, databaseName);
+            FreePSEntries(entries);
+            entries = NULL;
+            loaded = false;
         }
     }
-    else if (payload && size)
-    {
-        size_t allocSize = size + CBOR_ENCODING_SIZE_ADDITION;
 
-        outPayload = (uint8_t *)OICCalloc(1, allocSize);
-        VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-        CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-        cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-        CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-        cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-        cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-        cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-
-        cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-        outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+    // Compact: fold the journal and this update into the database file.
+    if (!loaded)
+    {
+        OICFree(dbData);
+        dbData = NULL;
+        ret = LoadPSDatabase(ps, databaseName, &dbData, &dbSize, &entries, &journalUsed);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
     }
-
-    ret = WritePayloadToPS(databaseName, outPayload, outSize);
-    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+    ret = SetPSEntry(&entries, resourceName, strlen(resourceName), payload, payload ? size : 0);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+    ret = EncodePSImage(entries, &outPayload, &outSize);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+    ret = CommitPSImage(ps, databaseName, outPayload, outSize);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
 
     OIC_LOG(DEBUG, TAG, "UpdateResourceInPS OUT");
 
 exit:
+    OICFree(record);
     OICFree(dbData);
+    FreePSEntries(entries);
     OICFree(outPayload);
-    OICFree(aclCbor);
-    OICFree(pstatCbor);
-    OICFree(doxmCbor);
-    OICFree(amaclCbor);
-    OICFree(credCbor);
-    OICFree(pconfCbor);
-    OICFree(resetPfCbor);
-    OICFree(crlCbor);
-    OICFree(dpCbor);
     return ret;
 }
 
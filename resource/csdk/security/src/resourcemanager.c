@@ -22,6 +22,7 @@
 #include "resourcemanager.h"
 #include "securevirtualresourcetypes.h"
 #include "aclresource.h"
+#include "policyengine.h"
 #include "pstatresource.h"
 #include "doxmresource.h"
 #include "credresource.h"
@@ -126,6 +127,7 @@ OCStackResult InitSecureResources( )
 OCStackResult DestroySecureResources( )
 {
     DeInitACLResource();
+    DeInitPolicyEngine();
     DeInitCredResource();
     DeInitDoxmResource();
     DeInitPstatResource();
@@ -457,6 +457,129 @@ TEST(ACLResourceTest, ACLDeleteWithSingleResourceTest)
     OICFree(payload);
 }
 
+TEST(ACLResourceTest, ACLGenerationTest)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicSecAcl_t *defaultAcl = NULL;
+    EXPECT_EQ(OC_STACK_OK, GetDefaultACL(&defaultAcl));
+    ASSERT_TRUE(defaultAcl != NULL);
+    uint32_t generation = GetACLGeneration();
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(defaultAcl));
+    EXPECT_NE(generation, GetACLGeneration());
+    EXPECT_EQ(defaultAcl->aces, GetACLResourceAces());
+
+    //Populate ACL
+    OicSecAcl_t acl = OicSecAcl_t();
+    EXPECT_EQ(OC_STACK_OK, populateAcl(&acl, 1));
+
+    size_t size = 0;
+    uint8_t *payload = NULL;
+    EXPECT_EQ(OC_STACK_OK, AclToCBORPayload(&acl, &payload, &size));
+    ASSERT_TRUE(NULL != payload);
+    OCSecurityPayload *securityPayload = OCSecurityPayloadCreate(payload, size);
+    ASSERT_TRUE(NULL != securityPayload);
+
+    // Adding an ACE changes the generation
+    generation = GetACLGeneration();
+    OCEntityHandlerRequest ehReq = OCEntityHandlerRequest();
+    ehReq.payload = (OCPayload *) securityPayload;
+    ehReq.method = OC_REST_POST;
+    ACLEntityHandler(OC_REQUEST_FLAG, &ehReq, NULL);
+    EXPECT_NE(generation, GetACLGeneration());
+
+    // Posting the same ACE again does not
+    generation = GetACLGeneration();
+    ACLEntityHandler(OC_REQUEST_FLAG, &ehReq, NULL);
+    EXPECT_EQ(generation, GetACLGeneration());
+
+    // Deleting it does
+    ehReq.method = OC_REST_DELETE;
+    char query[] = "subjectuuid=32323232-3232-3232-3232-323232323232;resources=/a/led";
+    ehReq.query = (char *)OICMalloc(strlen(query)+1);
+    ASSERT_TRUE(NULL !=  ehReq.query);
+    OICStrcpy(ehReq.query, strlen(query)+1, query);
+    ACLEntityHandler(OC_REQUEST_FLAG, &ehReq, NULL);
+    EXPECT_NE(generation, GetACLGeneration());
+
+    // Perform cleanup
+    DeInitACLResource();
+    OICFree(ehReq.query);
+    OCPayloadDestroy((OCPayload *)securityPayload);
+    OICFree(payload);
+}
+
+TEST(ACLResourceTest, ACLBatchTest)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicSecAcl_t *defaultAcl = NULL;
+    EXPECT_EQ(OC_STACK_OK, GetDefaultACL(&defaultAcl));
+    ASSERT_TRUE(defaultAcl != NULL);
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(defaultAcl));
+
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+    EXPECT_EQ(OC_STACK_OK, populateAcl(acl, 1));
+
+    uint8_t *before = NULL;
+    size_t beforeSize = 0;
+    OCStackResult beforeRes = GetSecureVirtualDatabaseFromPS(OIC_JSON_ACL_NAME, &before, &beforeSize);
+
+    // Aborted batch: nothing is persisted and the ACL is restored
+    EXPECT_EQ(OC_STACK_OK, BeginACLBatch());
+    EXPECT_EQ(OC_STACK_ERROR, BeginACLBatch());
+    EXPECT_EQ(OC_STACK_OK, InstallACL(acl));
+    OicSecAce_t *savePtr = NULL;
+    EXPECT_TRUE(NULL != GetACLResourceData(&acl->aces->subjectuuid, &savePtr));
+
+    uint8_t *during = NULL;
+    size_t duringSize = 0;
+    EXPECT_EQ(beforeRes, GetSecureVirtualDatabaseFromPS(OIC_JSON_ACL_NAME, &during, &duringSize));
+    ASSERT_EQ(beforeSize, duringSize);
+    if (0 < beforeSize)
+    {
+        EXPECT_EQ(0, memcmp(before, during, beforeSize));
+    }
+    OICFree(during);
+
+    EXPECT_EQ(OC_STACK_OK, AbortACLBatch());
+    savePtr = NULL;
+    EXPECT_TRUE(NULL == GetACLResourceData(&acl->aces->subjectuuid, &savePtr));
+
+    // Committed batch: the ACL is persisted once
+    EXPECT_EQ(OC_STACK_OK, BeginACLBatch());
+    EXPECT_EQ(OC_STACK_OK, InstallACL(acl));
+    EXPECT_EQ(OC_STACK_OK, CommitACLBatch());
+    EXPECT_EQ(OC_STACK_ERROR, CommitACLBatch());
+
+    uint8_t *after = NULL;
+    size_t afterSize = 0;
+    EXPECT_EQ(OC_STACK_OK, GetSecureVirtualDatabaseFromPS(OIC_JSON_ACL_NAME, &after, &afterSize));
+    OicSecAcl_t *storedAcl = CBORPayloadToAcl(after, afterSize);
+    ASSERT_TRUE(NULL != storedAcl);
+    bool found = false;
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(storedAcl->aces, ace)
+    {
+        if (0 == memcmp(&ace->subjectuuid, &acl->aces->subjectuuid, sizeof(OicUuid_t)))
+        {
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+
+    // Perform cleanup
+    RemoveACE(&acl->aces->subjectuuid, "/a/led");
+    DeleteACLList(storedAcl);
+    OICFree(after);
+    OICFree(before);
+    DeleteACLList(acl);
+    DeInitACLResource();
+}
+
 TEST(ACLResourceTest, ACLDeleteWithMultiResourceTest)
 {
     static OCPersistentStorage ps = OCPersistentStorage();
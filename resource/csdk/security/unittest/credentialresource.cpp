@@ -29,6 +29,7 @@
 #include "srmtestcommon.h"
 #include "srmutility.h"
 #include "psinterface.h"
+#include "srmresourcestrings.h"
 #include "security_internals.h"
 #include "logger.h"
 
@@ -385,6 +386,143 @@ TEST(CredResourceTest, GenerateAndAddCredentialValidInput)
     DeleteCredList(headCred);
 }
 
+TEST(CredResourceTest, CredBatchTest)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicUuid_t rownerID = {{0}};
+    OICStrcpy((char *)rownerID.id, sizeof(rownerID.id), "ownersId44");
+
+    OicUuid_t subject = {{0}};
+    OICStrcpy((char *)subject.id, sizeof(subject.id), "subject44");
+
+    uint8_t privateKey[] = "My private Key44";
+    OicSecKey_t key = {privateKey, sizeof(privateKey)};
+
+    // Aborted batch: the credential is dropped again
+    EXPECT_EQ(OC_STACK_OK, BeginCredBatch());
+    EXPECT_EQ(OC_STACK_ERROR, BeginCredBatch());
+    OicSecCred_t *cred = GenerateCredential(&subject, SYMMETRIC_PAIR_WISE_KEY, NULL,
+                                            &key, &rownerID, NULL);
+    ASSERT_TRUE(NULL != cred);
+    EXPECT_EQ(OC_STACK_OK, AddCredential(cred));
+    EXPECT_TRUE(NULL != GetCredResourceData(&subject));
+    EXPECT_EQ(OC_STACK_OK, AbortCredBatch());
+    EXPECT_TRUE(NULL == GetCredResourceData(&subject));
+
+    // Committed batch: the credential is persisted
+    EXPECT_EQ(OC_STACK_OK, BeginCredBatch());
+    cred = GenerateCredential(&subject, SYMMETRIC_PAIR_WISE_KEY, NULL,
+                              &key, &rownerID, NULL);
+    ASSERT_TRUE(NULL != cred);
+    EXPECT_EQ(OC_STACK_OK, AddCredential(cred));
+    EXPECT_EQ(OC_STACK_OK, CommitCredBatch());
+    EXPECT_EQ(OC_STACK_ERROR, CommitCredBatch());
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_EQ(OC_STACK_OK, GetSecureVirtualDatabaseFromPS(OIC_JSON_CRED_NAME, &data, &size));
+    OicSecCred_t *storedCred = NULL;
+    EXPECT_EQ(OC_STACK_OK, CBORPayloadToCred(data, size, &storedCred));
+    bool found = false;
+    for (const OicSecCred_t *temp = storedCred; temp; temp = temp->next)
+    {
+        if (0 == memcmp(&temp->subject, &subject, sizeof(subject)))
+        {
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+
+    // Perform cleanup
+    RemoveCredential(&subject);
+    DeleteCredList(storedCred);
+    OICFree(data);
+}
+
+// Opens the database for reading only, so that every write fails.
+static FILE *OpenReadOnly(const char *path, const char *mode)
+{
+    return (strchr(mode, 'w') || strchr(mode, 'a')) ? NULL : fopen(path, mode);
+}
+
+static bool IsCredStored(const OicUuid_t *subject)
+{
+    uint8_t *data = NULL;
+    size_t size = 0;
+    OicSecCred_t *storedCred = NULL;
+    if (OC_STACK_OK != GetSecureVirtualDatabaseFromPS(OIC_JSON_CRED_NAME, &data, &size) ||
+        OC_STACK_OK != CBORPayloadToCred(data, size, &storedCred))
+    {
+        OICFree(data);
+        return false;
+    }
+
+    bool found = false;
+    for (const OicSecCred_t *temp = storedCred; temp; temp = temp->next)
+    {
+        if (0 == memcmp(&temp->subject, subject, sizeof(*subject)))
+        {
+            found = true;
+        }
+    }
+    DeleteCredList(storedCred);
+    OICFree(data);
+    return found;
+}
+
+//Cred POST request with several credentials
+TEST(CredResourceTest, CredEntityHandlerMultiEntryPostTest)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicSecCred_t *cred = getCredList();
+    ASSERT_TRUE(NULL != cred);
+    ASSERT_TRUE(NULL != cred->next);
+    OicUuid_t subject1 = cred->subject;
+    OicUuid_t subject2 = cred->next->subject;
+    uint8_t *payload = NULL;
+    size_t size = 0;
+    int secureFlag = 0;
+    EXPECT_EQ(OC_STACK_OK, CredToCBORPayload(cred, &payload, &size, secureFlag));
+    DeleteCredList(cred);
+    ASSERT_TRUE(NULL != payload);
+
+    OCEntityHandlerRequest ehReq = OCEntityHandlerRequest();
+    ehReq.method = OC_REST_POST;
+    ehReq.payload = (OCPayload *)OCSecurityPayloadCreate(payload, size);
+    OICFree(payload);
+    ASSERT_TRUE(NULL != ehReq.payload);
+
+    // Both credentials are added and persisted. The result only tells whether
+    // the response could be sent.
+    CredEntityHandler(OC_REQUEST_FLAG, &ehReq, NULL);
+    EXPECT_TRUE(NULL != GetCredResourceData(&subject1));
+    EXPECT_TRUE(NULL != GetCredResourceData(&subject2));
+    EXPECT_TRUE(IsCredStored(&subject1));
+    EXPECT_TRUE(IsCredStored(&subject2));
+
+    RemoveCredential(&subject1);
+    RemoveCredential(&subject2);
+    EXPECT_TRUE(NULL == GetCredResourceData(&subject1));
+    EXPECT_TRUE(NULL == GetCredResourceData(&subject2));
+
+    // If the batch can't be written, neither credential is kept in memory.
+    ps.open = OpenReadOnly;
+    EXPECT_EQ(OC_STACK_OK, OCRegisterPersistentStorageHandler(&ps));
+    CredEntityHandler(OC_REQUEST_FLAG, &ehReq, NULL);
+    EXPECT_TRUE(NULL == GetCredResourceData(&subject1));
+    EXPECT_TRUE(NULL == GetCredResourceData(&subject2));
+
+    // Perform cleanup
+    SetPersistentHandler(&ps, true);
+    EXPECT_FALSE(IsCredStored(&subject1));
+    EXPECT_FALSE(IsCredStored(&subject2));
+    OCPayloadDestroy((OCPayload *)ehReq.payload);
+}
+
 #if 0
 TEST(CredGetResourceDataTest, GetCredResourceDataValidSubject)
 {
@@ -0,0 +1,184 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string>
+#include "ocstack.h"
+#include "oic_malloc.h"
+#include "psinterface.h"
+#include "srmtestcommon.h"
+
+#define TEST_DB_FILE_NAME "psinterface_test.dat"
+#define TEST_DB_JOURNAL_NAME TEST_DB_FILE_NAME ".journal"
+#define OTHER_DB_FILE_NAME "psinterface_test_other.dat"
+#define OTHER_DB_JOURNAL_NAME OTHER_DB_FILE_NAME ".journal"
+
+static long GetFileSize(const char *fileName)
+{
+    long size = -1;
+    FILE *fp = fopen(fileName, "rb");
+    if (fp)
+    {
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fclose(fp);
+    }
+    return size;
+}
+
+static void RemoveTestFiles()
+{
+    remove(TEST_DB_FILE_NAME);
+    remove(TEST_DB_JOURNAL_NAME);
+    remove(OTHER_DB_FILE_NAME);
+    remove(OTHER_DB_JOURNAL_NAME);
+}
+
+static FILE *JournalFopen(const char *path, const char *mode)
+{
+    std::string journalName(path);
+    journalName += ".journal";
+    return fopen(journalName.c_str(), mode);
+}
+
+static bool ResourceEquals(const char *databaseName, const char *resourceName,
+                           const uint8_t *expected, size_t expectedSize)
+{
+    uint8_t *data = NULL;
+    size_t size = 0;
+    bool equals = (OC_STACK_OK == ReadDatabaseFromPS(databaseName, resourceName, &data, &size)) &&
+                  (expectedSize == size) && (0 == memcmp(expected, data, size));
+    OICFree(data);
+    return equals;
+}
+
+class PSInterfaceTest : public testing::Test
+{
+    protected:
+        virtual void SetUp()
+        {
+            RemoveTestFiles();
+            SetPersistentHandler(&m_ps, true);
+            EXPECT_EQ(OC_STACK_OK, OCRegisterPersistentStorageJournalHandler(JournalFopen));
+        }
+
+        virtual void TearDown()
+        {
+            EXPECT_EQ(OC_STACK_OK, OCRegisterPersistentStorageJournalHandler(NULL));
+            RemoveTestFiles();
+        }
+
+        OCPersistentStorage m_ps;
+};
+
+static const uint8_t g_valueA1[] = {0x01, 0x02, 0x03};
+static const uint8_t g_valueA2[] = {0x04, 0x05, 0x06, 0x07};
+static const uint8_t g_valueB[] = {0x08};
+
+TEST_F(PSInterfaceTest, UpdateAndRead)
+{
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA2, sizeof(g_valueA2)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "a", g_valueA2, sizeof(g_valueA2)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+
+    // An empty payload removes the resource
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "b", NULL, 0));
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_NE(OC_STACK_OK, ReadDatabaseFromPS(TEST_DB_FILE_NAME, "b", &data, &size));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "a", g_valueA2, sizeof(g_valueA2)));
+
+    // The whole database reads back as one image
+    EXPECT_EQ(OC_STACK_OK, ReadDatabaseFromPS(TEST_DB_FILE_NAME, NULL, &data, &size));
+    EXPECT_TRUE(NULL != data);
+    OICFree(data);
+}
+
+TEST_F(PSInterfaceTest, UpdateAppendsToJournal)
+{
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    long dbSize = GetFileSize(TEST_DB_FILE_NAME);
+    long journalSize = GetFileSize(TEST_DB_JOURNAL_NAME);
+    EXPECT_LT(0, dbSize);
+    EXPECT_LT(0, journalSize);
+
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+    EXPECT_EQ(dbSize, GetFileSize(TEST_DB_FILE_NAME));
+    EXPECT_LT(journalSize, GetFileSize(TEST_DB_JOURNAL_NAME));
+}
+
+TEST_F(PSInterfaceTest, UpdateRewritesDatabaseWithoutJournalHandler)
+{
+    EXPECT_EQ(OC_STACK_OK, OCRegisterPersistentStorageJournalHandler(NULL));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+    EXPECT_EQ(-1, GetFileSize(TEST_DB_JOURNAL_NAME));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+}
+
+TEST_F(PSInterfaceTest, TornJournalRecordIsIgnored)
+{
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+
+    // Simulate a crash in the middle of appending a record
+    FILE *fp = fopen(TEST_DB_JOURNAL_NAME, "ab");
+    ASSERT_TRUE(NULL != fp);
+    const uint8_t torn[] = {0x01, 0x01, 0x00, 0x10, 0x00, 0x00, 0x00, 'a'};
+    EXPECT_EQ(sizeof(torn), fwrite(torn, 1, sizeof(torn), fp));
+    fclose(fp);
+
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+
+    // Updates after the torn record are not lost
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA2, sizeof(g_valueA2)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "a", g_valueA2, sizeof(g_valueA2)));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+}
+
+TEST_F(PSInterfaceTest, ReplacedDatabaseIgnoresStaleJournal)
+{
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA1, sizeof(g_valueA1)));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(TEST_DB_FILE_NAME, "a", g_valueA2, sizeof(g_valueA2)));
+
+    // Replace the database file, as provisioning a fresh SVR database does
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(OTHER_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+    uint8_t *image = NULL;
+    size_t imageSize = 0;
+    ASSERT_EQ(OC_STACK_OK, ReadDatabaseFromPS(OTHER_DB_FILE_NAME, NULL, &image, &imageSize));
+    FILE *fp = fopen(TEST_DB_FILE_NAME, "wb");
+    ASSERT_TRUE(NULL != fp);
+    EXPECT_EQ(imageSize, fwrite(image, 1, imageSize, fp));
+    fclose(fp);
+    OICFree(image);
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_NE(OC_STACK_OK, ReadDatabaseFromPS(TEST_DB_FILE_NAME, "a", &data, &size));
+    EXPECT_TRUE(ResourceEquals(TEST_DB_FILE_NAME, "b", g_valueB, sizeof(g_valueB)));
+}
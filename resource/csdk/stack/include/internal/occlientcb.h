@@ -35,6 +35,7 @@
 
 #include "ocresource.h"
 #include "cacommon.h"
+#include <coap/uthash.h>
 
 /**
  * Data structure For presence Discovery.
@@ -113,6 +114,25 @@ typedef struct ClientCB {
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
+
+    /** Own address, used as the key of the node index.*/
+    struct ClientCB    *self;
+
+    /** Hash handle for the token index.*/
+    UT_hash_handle hhToken;
+
+    /** Hash handle for the invocation handle index.*/
+    UT_hash_handle hhHandle;
+
+    /** Hash handle for the node index.*/
+    UT_hash_handle hhNode;
+
+    /** Neighbours in the list of callbacks ordered by TTL (only when TTL is not 0).*/
+    struct ClientCB    *ttlPrev;
+    struct ClientCB    *ttlNext;
 } ClientCB;
 
 /**
@@ -203,5 +223,22 @@ void DeleteClientCBList();
  */
 void FindAndDeleteClientCB(ClientCB * cbNode);
 
+/** @ingroup ocstack
+ *
+ * This method is used to change the TTL of a cb node. The node is moved to
+ * its new position in the list of callbacks ordered by TTL.
+ *
+ * @param[in] cbNode    Address to client callback node.
+ * @param[in] ttl       New time to live in coap_ticks, 0 disables the timeout.
+ */
+void UpdateClientCBTTL(ClientCB * cbNode, uint32_t ttl);
+
+/** @ingroup ocstack
+ *
+ * This method is used to delete every cb node whose TTL has passed.
+ * Only expired nodes are visited since the timeout list is kept ordered by TTL.
+ */
+void DeleteTimedOutClientCBs();
+
 #endif //OC_CLIENT_CB
 
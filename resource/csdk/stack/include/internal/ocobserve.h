@@ -30,6 +30,7 @@
 #define OC_OBSERVE_H
 
 #include "ocserverrequest.h"
+#include <coap/uthash.h>
 
 /** Maximum number of observers to reach */
 
@@ -90,15 +91,24 @@ typedef struct ResourceObserver
      * from remaining in the list of observers indefinitely.*/
     uint32_t TTL;
 
-    /** next node in this list.*/
+    /** next node in the list of observers of the same resource.*/
     struct ResourceObserver *next;
 
+    /** previous node in the list of observers of the same resource.*/
+    struct ResourceObserver *prev;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
     /** requested payload content version. */
     uint16_t acceptVersion;
 
+    /** Hash handle for the observation ID index.*/
+    UT_hash_handle hhId;
+
+    /** Hash handle for the token index.*/
+    UT_hash_handle hhToken;
+
 } ResourceObserver;
 
 #ifdef WITH_PRESENCE
@@ -33,6 +33,83 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
 
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
+/**
+ * Read-only view over a CBOR encoded representation. Properties are located in the
+ * encoded buffer when they are asked for, instead of decoding the whole buffer into
+ * an OCRepPayload tree like OCParsePayload() does.
+ */
+typedef struct OCRepPayloadView OCRepPayloadView;
+
+/**
+ * Create a view over a CBOR encoded representation. If the payload holds an array of
+ * representations, e.g. a batch response, the view covers the first one.
+ *
+ * @param payload       Encoded representation. It must outlive the view.
+ * @param payloadSize   Size of payload.
+ * @param buildIndex    true to index all keys up front. This pays off when many
+ *                      properties are read, each lookup then costs a hash probe.
+ *                      Otherwise every lookup scans the keys of the map.
+ * @param view          [OUT] Created view, to be freed with OCRepPayloadViewDestroy().
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_MALFORMED_RESPONSE if the payload is not
+ *         a representation, some other value upon failure.
+ */
+OCStackResult OCRepPayloadViewCreate(const uint8_t *payload, size_t payloadSize,
+                                     bool buildIndex, OCRepPayloadView **view);
+
+/**
+ * Free a view created by OCRepPayloadViewCreate(). The payload buffer is not freed.
+ */
+void OCRepPayloadViewDestroy(OCRepPayloadView *view);
+
+/**
+ * The getters below behave like their OCRepPayload counterparts. Keys are looked up
+ * as encoded, so OC_RSRVD_HREF, OC_RSRVD_RESOURCE_TYPE and OC_RSRVD_INTERFACE are
+ * visible as properties too. Arrays are only available through the eager parser.
+ */
+bool OCRepPayloadViewHasProp(const OCRepPayloadView *view, const char *name);
+bool OCRepPayloadViewIsNull(const OCRepPayloadView *view, const char *name);
+bool OCRepPayloadViewGetPropInt(const OCRepPayloadView *view, const char *name,
+                                int64_t *value);
+bool OCRepPayloadViewGetPropDouble(const OCRepPayloadView *view, const char *name,
+                                   double *value);
+bool OCRepPayloadViewGetPropBool(const OCRepPayloadView *view, const char *name,
+                                 bool *value);
+
+/** The string is copied, the caller frees it with OICFree(). */
+bool OCRepPayloadViewGetPropString(const OCRepPayloadView *view, const char *name,
+                                   char **value);
+
+/** The bytes are copied, the caller frees value->bytes with OICFree(). */
+bool OCRepPayloadViewGetPropByteString(const OCRepPayloadView *view, const char *name,
+                                       OCByteString *value);
+
+/** Only the requested object is decoded, the caller frees it with OCRepPayloadDestroy(). */
+bool OCRepPayloadViewGetPropObject(const OCRepPayloadView *view, const char *name,
+                                   OCRepPayload **value);
+
+/**
+ * Encode a payload into a buffer owned by the caller, e.g. the payload area of a PDU.
+ *
+ * @param payload   Payload to encode.
+ * @param buffer    Destination buffer.
+ * @param size      [IN] Size of buffer. [OUT] Number of bytes written on success, or the
+ *                  size needed when ::OC_STACK_NO_MEMORY is returned.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_NO_MEMORY if buffer is too small, some other
+ *         value upon failure.
+ */
+OCStackResult OCConvertPayloadToBuffer(OCPayload *payload, uint8_t *buffer, size_t *size);
+
+/**
+ * Upper bound of the encoded size of a payload, computed without encoding it.
+ *
+ * @param payload   Payload to measure.
+ *
+ * @return Number of bytes large enough to hold the encoded payload.
+ */
+size_t OCEstimatePayloadSize(const OCPayload *payload);
+
 #ifdef __cplusplus
 }
 #endif
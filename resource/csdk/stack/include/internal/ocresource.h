@@ -31,6 +31,7 @@
 
 #include "ocstackconfig.h"
 #include "occlientcb.h"
+#include <coap/uthash.h>
 
 /** Macro Definitions for observers */
 
@@ -112,6 +113,20 @@ typedef struct ocactionset
     OCAction* head;
 } OCActionSet;
 
+/**
+ * Link used to chain every resource type (or interface) of the same name into one bucket of
+ * the stack's resource type (or interface) index, so a filtered discovery only visits the
+ * resources that can match.
+ */
+typedef struct OCResourceIndexLink {
+    /** Resource the type or interface is bound to; NULL while not indexed.*/
+    struct OCResource *resource;
+
+    /** Neighbours within the bucket.*/
+    struct OCResourceIndexLink *prev;
+    struct OCResourceIndexLink *next;
+} OCResourceIndexLink;
+
 /**
  * Data structure for holding name and data types for each OIC resource.
  */
@@ -129,6 +144,9 @@ typedef struct resourcetype_t {
      * " <base URI>/types " list of available types.
     */
     char *resourcetypename;
+
+    /** Entry in the resource type index.*/
+    OCResourceIndexLink indexLink;
 } OCResourceType;
 
 /**
@@ -168,6 +186,9 @@ typedef struct resourceinterface_t {
     char *outputContentType ;
 #endif
     /** Future placeholder for access control and policy.*/
+
+    /** Entry in the resource interface index.*/
+    OCResourceIndexLink indexLink;
 } OCResourceInterface;
 
 /**
@@ -241,6 +262,15 @@ typedef struct OCResource {
 
     /** Resource endpoint type(s). */
     OCTpsSchemeFlags endpointType;
+
+    /** Points to itself; key of the handle index used to validate resource handles.*/
+    struct OCResource *self;
+
+    /** Entry in the URI index.*/
+    UT_hash_handle hhUri;
+
+    /** Entry in the handle index.*/
+    UT_hash_handle hhHandle;
 } OCResource;
 
 
@@ -152,6 +152,48 @@ OCEntityHandlerResult defaultResourceEHandler(OCEntityHandlerFlag flag,
  */
 OCResource *FindResourceByUri(const char* resourceUri);
 
+/**
+ * Find a resource by its handle.
+ * @return the resource if the handle refers to a live resource, otherwise NULL.
+ */
+OCResource *FindResourceByHandle(const OCResource *handle);
+
+/**
+ * Get the first entry of the resource type index bucket for the given type.
+ * Entries are chained through OCResourceIndexLink::next in the order they were bound.
+ * @return the first entry or NULL if no resource has that type.
+ */
+const OCResourceIndexLink *FindResourcesByType(const char *resourceTypeName);
+
+/**
+ * Get the first entry of the resource interface index bucket for the given interface.
+ * Entries are chained through OCResourceIndexLink::next in the order they were bound.
+ * @return the first entry or NULL if no resource has that interface.
+ */
+const OCResourceIndexLink *FindResourcesByInterface(const char *resourceInterfaceName);
+
+/**
+ * Add a resource to the URI and handle indexes. The resource URI must be set and
+ * must not change while the resource is indexed.
+ */
+void AddResourceToIndex(OCResource *resource);
+
+/**
+ * Add a resource type, already bound to the resource, to the resource type index.
+ */
+void AddResourceTypeToIndex(OCResource *resource, OCResourceType *resourceType);
+
+/**
+ * Add a resource interface, already bound to the resource, to the resource interface index.
+ */
+void AddResourceInterfaceToIndex(OCResource *resource, OCResourceInterface *resourceInterface);
+
+/**
+ * Remove a resource and all of its types and interfaces from the indexes.
+ * Must be called before the resource elements are freed.
+ */
+void RemoveResourceFromIndex(OCResource *resource);
+
 /**
  * This function checks whether the specified resource URI aligns with a pre-existing
  * virtual resource; returns false otherwise.
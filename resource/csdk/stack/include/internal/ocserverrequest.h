@@ -33,12 +33,31 @@
 #include "cainterface.h"
 
 #include "tree.h"
+#include "oic_arena.h"
 
 /**
  * The signature of the internal call back functions to handle responses from entity handler
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Observer receiving a copy of a notification sent in fan-out mode.
+ */
+typedef struct OCObserveFanOutTarget
+{
+    /** Remote endpoint address.*/
+    OCDevAddr devAddr;
+
+    /** Token of the observe request.*/
+    char token[CA_MAX_TOKEN_LEN];
+
+    /** Token length of the observe request.*/
+    uint8_t tokenLength;
+
+    /** Quality of service decided for this observer.*/
+    OCQualityOfService qos;
+} OCObserveFanOutTarget;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -111,6 +130,18 @@ typedef struct OCServerRequest
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Observers receiving a copy of the response, NULL unless notifying in fan-out mode.*/
+    OCObserveFanOutTarget *fanOutTargets;
+
+    /** Number of fan-out observers.*/
+    size_t numFanOutTargets;
+
+    /** Time the request was added, in microseconds.*/
+    uint64_t receivedTime;
+
+    /** Arena holding this request, its token and the data of its response.*/
+    OICArena_t *arena;
+
     /** Payload Size.*/
     size_t payloadSize;
 
@@ -269,6 +300,31 @@ OCStackResult FormOCEntityHandlerRequest(
         OCObservationId observeID,
         uint16_t messageID);
 
+/**
+ * Create the pool of request arenas.
+ *
+ * @return
+ *     ::OC_STACK_OK, or ::OC_STACK_NO_MEMORY if the pool can't be allocated.
+ */
+OCStackResult InitServerRequestArenaPool();
+
+/**
+ * Destroy the pool of request arenas. Requests still alive keep their arena.
+ */
+void TerminateServerRequestArenaPool();
+
+/**
+ * Acquire an arena for data which lives as long as one request.
+ * Release it with ::OICArenaRelease.
+ *
+ * @param requestSize  bytes the request needs in the arena, the first block
+ *                     is made large enough for them.
+ *
+ * @return
+ *     arena, or NULL if out of memory.
+ */
+OICArena_t *AcquireRequestArena(size_t requestSize);
+
 /**
  * Find a server request in the server request list and delete
  *
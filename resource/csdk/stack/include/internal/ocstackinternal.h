@@ -148,6 +148,17 @@ typedef uint8_t ServerID[16];
 //-----------------------------------------------------------------------------
 
 
+/**
+ * Acquire the stack lock.  The lock is recursive and only exists when receive workers
+ * are enabled through OCSetReceiveWorkerCount, otherwise this is a no-op.
+ */
+void OCStackLock(void);
+
+/**
+ * Release the stack lock acquired with OCStackLock.
+ */
+void OCStackUnlock(void);
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
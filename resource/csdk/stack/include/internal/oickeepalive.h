@@ -31,12 +31,43 @@
 #include "octypes.h"
 #include "ocserverrequest.h"
 #include "ocresource.h"
+#include "cacommon.h"
+#include <coap/uthash.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/**
+ * Key of the KeepAlive table, the remote address and port of a connection.
+ */
+typedef struct
+{
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< remote address. */
+    uint16_t port;                      /**< remote port. */
+} KeepAliveKey_t;
+
+/**
+ * KeepAlive table entries.
+ */
+typedef struct KeepAliveEntry
+{
+    KeepAliveKey_t key;             /**< key of the endpoint index. */
+    OCMode mode;                    /**< host Mode of Operation. */
+    CAEndpoint_t remoteAddr;        /**< destination Address. */
+    int64_t interval;              /**< time interval for KeepAlive. in seconds.*/
+    int32_t currIndex;              /**< current interval value index. */
+    size_t intervalSize;            /**< total interval counts. */
+    int64_t *intervalInfo;          /**< interval values for KeepAlive. */
+    bool sentPingMsg;               /**< if oic client already sent ping message. */
+    uint64_t timeStamp;             /**< last sent or received ping message. in microseconds. */
+    uint64_t deadline;              /**< time the entry has to be processed. in microseconds. */
+    size_t heapIndex;               /**< position in the deadline heap. */
+    UT_hash_handle hh;              /**< hash handle for the endpoint index. */
+} KeepAliveEntry_t;
+
+
 /**
  * Name of resource type.
  */
@@ -89,6 +120,41 @@ OCStackResult HandleKeepAliveRequest(OCServerRequest *request,
  */
 void HandleKeepAliveConnCB(const CAEndpoint_t *endpoint, bool isConnected, bool isClient);
 
+/**
+ * Gets keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference uri and transport type) to
+ *                          which the ping message has to be sent.
+ * @return  KeepAlive entry to send ping message.
+ */
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint);
+
+/**
+ * Add keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference uri and transport type).
+ * @param[in]   mode        Whether it is OIC Server or OIC Client.
+ * @param[in]   intervalArray   Received interval values from cloud server.
+ * @return  The KeepAlive entry added in KeepAlive Table.
+ */
+KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
+                                    int64_t *intervalArray);
+
+/**
+ * Remove keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference uri and transport type).
+ * @return  The KeepAlive entry removed in KeepAlive Table.
+ */
+OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint);
+
+/**
+ * Set the deadline of a keepalive entry and move it in the deadline heap accordingly.
+ * @param[in]   entry       The KeepAlive entry to schedule.
+ * @param[in]   deadline    Time the entry has to be processed. in microseconds.
+ */
+void SetKeepAliveDeadline(KeepAliveEntry_t *entry, uint64_t deadline);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
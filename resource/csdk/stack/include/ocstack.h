@@ -78,6 +78,22 @@ OCStackResult OCInit2(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
  */
 OCStackResult OCInit(const char *ipAddr, uint16_t port, OCMode mode);
 
+/**
+ * This function sets the number of worker threads that dispatch received requests and
+ * responses.  Messages are sharded on the remote endpoint, so messages from one peer are
+ * still processed in order.  When workers are enabled, entity handlers run on the worker
+ * threads and may execute concurrently for different peers; the rest of the stack state
+ * is serialized internally.  Applications must therefore not delete a resource while its
+ * entity handler may be running.  Must be called before the stack is initialized.
+ *
+ * @param workerCount     Number of receive workers, 0 to process received messages from
+ *                        OCProcess() (the default).
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM if workerCount is too large,
+ *         ::OC_STACK_ERROR if the stack is already initialized.
+ */
+OCStackResult OCSetReceiveWorkerCount(uint8_t workerCount);
+
 #ifdef RA_ADAPTER
 /**
  * @brief   Set Remote Access information for XMPP Client.
@@ -246,6 +262,17 @@ OCStackResult OCCancel(OCDoHandle handle,
  */
 OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistentStorageHandler);
 
+/**
+ * Register the optional persistent storage journal handler. When it is set, updates of the
+ * SVR database are appended to a journal opened through it instead of rewriting the whole
+ * database. Without it the database is rewritten on every update.
+ * @param   journalHandler  Journal open handler, or NULL to stop journaling.
+ *
+ * @return
+ *     OC_STACK_OK                    No errors; Success.
+ */
+OCStackResult OCRegisterPersistentStorageJournalHandler(OCPersistentStorageJournalHandler journalHandler);
+
 #ifdef WITH_PRESENCE
 /**
  * When operating in  OCServer or  OCClientServer mode,
@@ -479,6 +506,18 @@ OCResourceHandle OCGetResourceHandle(uint8_t index);
  */
 OCStackResult OCDeleteResource(OCResourceHandle handle);
 
+/**
+ * This function creates the diagnostic metrics resource at ::OC_RSRVD_METRICS_URI. A GET on
+ * it returns the runtime metrics of the connectivity and stack layers, see ocmetrics.h.
+ * The resource is not created unless the application calls this function.
+ *
+ * @param handle          Pointer to handle to newly created resource. Pass it to
+ *                        OCDeleteResource() to remove the resource again.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCCreateMetricsResource(OCResourceHandle *handle);
+
 /**
  * Get a string representation the server instance ID.
  * The memory is managed internal to this function, so freeing externally will result
@@ -869,6 +908,13 @@ OCStackResult OCGetPropertyValue(OCPayloadType type, const char *propName, void
 */
 OCPersistentStorage *OCGetPersistentStorageHandler();
 
+/**
+* Get the registered persistent storage journal handler.
+*
+* @return the journal open handler, or NULL if none is registered.
+*/
+OCPersistentStorageJournalHandler OCGetPersistentStorageJournalHandler();
+
 /**
 * This function return link local zone id related from ifindex.
 *
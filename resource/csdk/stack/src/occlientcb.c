@@ -40,6 +40,87 @@
 
 struct ClientCB *cbList = NULL;
 
+/**
+ * Index of cbList keyed by token.
+ */
+static ClientCB *g_cbTokenIndex = NULL;
+
+/**
+ * Index of cbList keyed by invocation handle.
+ */
+static ClientCB *g_cbHandleIndex = NULL;
+
+/**
+ * Index of cbList keyed by node address, used to verify that a node is still alive.
+ */
+static ClientCB *g_cbNodeIndex = NULL;
+
+/**
+ * Head and tail of the callbacks with a non-zero TTL, ordered by TTL.
+ */
+static ClientCB *g_cbTimeoutHead = NULL;
+static ClientCB *g_cbTimeoutTail = NULL;
+
+/*
+ * Inserts the node into the timeout list. Callbacks are mostly added with
+ * a TTL later than all the others, so the position is searched from the tail.
+ */
+static void InsertTimeoutCB(ClientCB *cbNode)
+{
+    ClientCB *prev = g_cbTimeoutTail;
+    while (prev && prev->TTL > cbNode->TTL)
+    {
+        prev = prev->ttlPrev;
+    }
+
+    cbNode->ttlPrev = prev;
+    cbNode->ttlNext = prev ? prev->ttlNext : g_cbTimeoutHead;
+    if (cbNode->ttlNext)
+    {
+        cbNode->ttlNext->ttlPrev = cbNode;
+    }
+    else
+    {
+        g_cbTimeoutTail = cbNode;
+    }
+    if (prev)
+    {
+        prev->ttlNext = cbNode;
+    }
+    else
+    {
+        g_cbTimeoutHead = cbNode;
+    }
+}
+
+static void RemoveTimeoutCB(ClientCB *cbNode)
+{
+    if (cbNode->ttlPrev)
+    {
+        cbNode->ttlPrev->ttlNext = cbNode->ttlNext;
+    }
+    else if (g_cbTimeoutHead == cbNode)
+    {
+        g_cbTimeoutHead = cbNode->ttlNext;
+    }
+    else
+    {
+        // not in the timeout list.
+        return;
+    }
+
+    if (cbNode->ttlNext)
+    {
+        cbNode->ttlNext->ttlPrev = cbNode->ttlPrev;
+    }
+    else
+    {
+        g_cbTimeoutTail = cbNode->ttlPrev;
+    }
+    cbNode->ttlPrev = NULL;
+    cbNode->ttlNext = NULL;
+}
+
 OCStackResult
 AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
              CAToken_t token, uint8_t tokenLength,
@@ -100,8 +181,22 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             }
             cbNode->requestUri = requestUri;    // I own it now
             cbNode->devAddr = devAddr;          // I own it now
+            cbNode->self = cbNode;
+            cbNode->ttlPrev = NULL;
+            cbNode->ttlNext = NULL;
             OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
-            LL_APPEND(cbList, cbNode);
+            DL_APPEND(cbList, cbNode);
+            if (cbNode->token && cbNode->tokenLength > 0)
+            {
+                HASH_ADD_KEYPTR(hhToken, g_cbTokenIndex, cbNode->token,
+                                cbNode->tokenLength, cbNode);
+            }
+            HASH_ADD(hhHandle, g_cbHandleIndex, handle, sizeof(OCDoHandle), cbNode);
+            HASH_ADD(hhNode, g_cbNodeIndex, self, sizeof(ClientCB *), cbNode);
+            if (cbNode->TTL != 0)
+            {
+                InsertTimeoutCB(cbNode);
+            }
             *clientCB = cbNode;
         }
     }
@@ -148,7 +243,14 @@ void DeleteClientCB(ClientCB * cbNode)
 {
     if (cbNode)
     {
-        LL_DELETE(cbList, cbNode);
+        DL_DELETE(cbList, cbNode);
+        if (cbNode->token && cbNode->tokenLength > 0)
+        {
+            HASH_DELETE(hhToken, g_cbTokenIndex, cbNode);
+        }
+        HASH_DELETE(hhHandle, g_cbHandleIndex, cbNode);
+        HASH_DELETE(hhNode, g_cbNodeIndex, cbNode);
+        RemoveTimeoutCB(cbNode);
         OIC_LOG (INFO, TAG, "Deleting token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         CADestroyToken (cbNode->token);
@@ -188,33 +290,6 @@ void DeleteClientCB(ClientCB * cbNode)
     }
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
-{
-    if (!cbNode)
-    {
-        return;
-    }
-    if (cbNode->TTL == 0)
-    {
-        return;
-    }
-    coap_tick_t now;
-    coap_ticks(&now);
-
-    if (cbNode->TTL < now)
-    {
-        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCB(cbNode);
-    }
-}
-
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
                       OCDoHandle handle, const char * requestUri)
 {
@@ -224,30 +299,12 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     {
         OIC_LOG (INFO, TAG,  "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        LL_FOREACH(cbList, out)
-        {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        HASH_FIND(hhToken, g_cbTokenIndex, token, tokenLength, out);
     }
     else if (handle)
     {
         OIC_LOG (INFO, TAG,  "Looking for handle");
-        LL_FOREACH(cbList, out)
-        {
-            if (out->handle == handle)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        HASH_FIND(hhHandle, g_cbHandleIndex, &handle, sizeof(OCDoHandle), out);
     }
     else if (requestUri)
     {
@@ -258,16 +315,56 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
             //OIC_LOG_V(INFO, TAG, "%s", out->requestUri);
             if (out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
             {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
+                break;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
+
+    if (out)
+    {
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return out;
+    }
     OIC_LOG(INFO, TAG, "Callback Not found !!");
     return NULL;
 }
 
+void UpdateClientCBTTL(ClientCB * cbNode, uint32_t ttl)
+{
+    if (!cbNode)
+    {
+        return;
+    }
+
+    RemoveTimeoutCB(cbNode);
+    cbNode->TTL = ttl;
+    if (cbNode->TTL != 0)
+    {
+        InsertTimeoutCB(cbNode);
+    }
+}
+
+/*
+ * Presence and observe callbacks have a TTL of 0 and are never part of the
+ * timeout list, presence nodes have their own mechanisms for timeouts.
+ */
+void DeleteTimedOutClientCBs()
+{
+    if (!g_cbTimeoutHead)
+    {
+        return;
+    }
+
+    coap_tick_t now;
+    coap_ticks(&now);
+
+    while (g_cbTimeoutHead && g_cbTimeoutHead->TTL < now)
+    {
+        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
+        DeleteClientCB(g_cbTimeoutHead);
+    }
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult InsertResourceTypeFilter(ClientCB * cbNode, char * resourceTypeName)
 {
@@ -304,16 +401,13 @@ void DeleteClientCBList()
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
+    ClientCB* tmp = NULL;
     if (cbNode)
     {
-        LL_FOREACH(cbList, tmp)
+        HASH_FIND(hhNode, g_cbNodeIndex, &cbNode, sizeof(ClientCB *), tmp);
+        if (tmp)
         {
-            if (cbNode == tmp)
-            {
-                DeleteClientCB(tmp);
-                break;
-            }
+            DeleteClientCB(tmp);
         }
     }
 }
@@ -0,0 +1,165 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ocstack.h"
+#include "ocpayload.h"
+#include "ocmetrics.h"
+#include "oic_string.h"
+#include "logger.h"
+
+#define TAG "OIC_RI_METRICS"
+
+/** Property holding the time a snapshot was taken, in milliseconds.*/
+#define METRICS_TIME        "time"
+/** Properties of a histogram.*/
+#define METRICS_COUNT       "count"
+#define METRICS_SUM         "sum"
+#define METRICS_BUCKETS     "buckets"
+
+static OCRepPayload *CreateHistogramPayload(const OCMetricValue *value)
+{
+    OCRepPayload *histogram = OCRepPayloadCreate();
+    if (!histogram)
+    {
+        return NULL;
+    }
+
+    int64_t buckets[OC_METRIC_HISTOGRAM_BUCKETS];
+    for (size_t i = 0; i < OC_METRIC_HISTOGRAM_BUCKETS; i++)
+    {
+        buckets[i] = (int64_t)value->buckets[i];
+    }
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {OC_METRIC_HISTOGRAM_BUCKETS, 0, 0};
+
+    if (!OCRepPayloadSetPropInt(histogram, METRICS_COUNT, value->value) ||
+        !OCRepPayloadSetPropInt(histogram, METRICS_SUM, (int64_t)value->sum) ||
+        !OCRepPayloadSetIntArray(histogram, METRICS_BUCKETS, buckets, dimensions))
+    {
+        OCRepPayloadDestroy(histogram);
+        return NULL;
+    }
+    return histogram;
+}
+
+static OCRepPayload *CreateMetricsPayload()
+{
+    OCMetricsSnapshot snapshot;
+    OCMetricsGetSnapshot(&snapshot);
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    if (!OCRepPayloadSetPropInt(payload, METRICS_TIME, (int64_t)snapshot.timeMs))
+    {
+        goto exit;
+    }
+
+    for (int i = 0; i < OC_METRIC_COUNT; i++)
+    {
+        OCMetricId id = (OCMetricId)i;
+        if (OC_METRIC_HISTOGRAM == OCMetricGetKind(id))
+        {
+            OCRepPayload *histogram = CreateHistogramPayload(&snapshot.values[id]);
+            if (!histogram)
+            {
+                goto exit;
+            }
+            if (!OCRepPayloadSetPropObjectAsOwner(payload, OCMetricGetName(id), histogram))
+            {
+                OCRepPayloadDestroy(histogram);
+                goto exit;
+            }
+        }
+        else if (!OCRepPayloadSetPropInt(payload, OCMetricGetName(id), snapshot.values[id].value))
+        {
+            goto exit;
+        }
+    }
+    return payload;
+
+exit:
+    OCRepPayloadDestroy(payload);
+    return NULL;
+}
+
+static OCEntityHandlerResult MetricsEntityHandler(OCEntityHandlerFlag flag,
+                                                  OCEntityHandlerRequest *entityHandlerRequest,
+                                                  void *callbackParam)
+{
+    OC_UNUSED(callbackParam);
+
+    if (!(flag & OC_REQUEST_FLAG) || !entityHandlerRequest)
+    {
+        return OC_EH_ERROR;
+    }
+
+    if (OC_REST_GET != entityHandlerRequest->method)
+    {
+        OIC_LOG_V(INFO, TAG, "Method %d not allowed on metrics resource",
+                  entityHandlerRequest->method);
+        return OC_EH_METHOD_NOT_ALLOWED;
+    }
+
+    OCRepPayload *payload = CreateMetricsPayload();
+    if (!payload)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create metrics payload");
+        return OC_EH_ERROR;
+    }
+
+    OCEntityHandlerResponse ehResponse = { .ehResult = OC_EH_OK,
+                                           .payload = (OCPayload *) payload,
+                                           .requestHandle = entityHandlerRequest->requestHandle,
+                                           .resourceHandle = entityHandlerRequest->resource };
+    OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri), OC_RSRVD_METRICS_URI);
+
+    OCStackResult result = OCDoResponse(&ehResponse);
+    OCRepPayloadDestroy(payload);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Sending metrics response failed[%d]", result);
+        return OC_EH_ERROR;
+    }
+    return OC_EH_OK;
+}
+
+OCStackResult OCCreateMetricsResource(OCResourceHandle *handle)
+{
+    if (!handle)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCStackResult result = OCCreateResource(handle,
+                                            OC_RSRVD_RESOURCE_TYPE_METRICS,
+                                            OC_RSRVD_INTERFACE_READ,
+                                            OC_RSRVD_METRICS_URI,
+                                            MetricsEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Create resource for metrics failed[%d]", result);
+    }
+    return result;
+}
@@ -29,6 +29,7 @@
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "ocserverrequest.h"
+#include "ocmetrics.h"
 #include "logger.h"
 
 #include <coap/utlist.h>
@@ -42,7 +43,112 @@
 
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
-static struct ResourceObserver * g_serverObsList = NULL;
+/**
+ * Observers of one resource.
+ */
+typedef struct ResourceObserverList
+{
+    /** Observed resource, key of the list index.*/
+    OCResource *resource;
+
+    /** Observers of the resource.*/
+    ResourceObserver *head;
+
+    /** Hash handle for the list index.*/
+    UT_hash_handle hh;
+} ResourceObserverList;
+
+/**
+ * Observer lists keyed by resource.
+ */
+static ResourceObserverList *g_serverObsLists = NULL;
+
+/**
+ * Observers keyed by observation ID.
+ */
+static ResourceObserver *g_serverObsIdIndex = NULL;
+
+/**
+ * Observers keyed by token.
+ */
+static ResourceObserver *g_serverObsTokenIndex = NULL;
+
+static ResourceObserverList *GetObserverList(const OCResource *resource)
+{
+    ResourceObserverList *out = NULL;
+    HASH_FIND(hh, g_serverObsLists, &resource, sizeof(OCResource *), out);
+    return out;
+}
+
+static OCStackResult InsertObserver(ResourceObserver *observer)
+{
+    ResourceObserverList *obsList = GetObserverList(observer->resource);
+    if (!obsList)
+    {
+        obsList = (ResourceObserverList *) OICCalloc(1, sizeof(ResourceObserverList));
+        if (!obsList)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        obsList->resource = observer->resource;
+        HASH_ADD(hh, g_serverObsLists, resource, sizeof(OCResource *), obsList);
+    }
+
+    DL_APPEND(obsList->head, observer);
+    HASH_ADD(hhId, g_serverObsIdIndex, observeId, sizeof(OCObservationId), observer);
+    if (observer->tokenLength)
+    {
+        HASH_ADD_KEYPTR(hhToken, g_serverObsTokenIndex, observer->token,
+                        observer->tokenLength, observer);
+    }
+    OCMetricAdd(OC_METRIC_OBSERVERS, 1);
+    return OC_STACK_OK;
+}
+
+static void RemoveObserver(ResourceObserver *observer)
+{
+    ResourceObserverList *obsList = GetObserverList(observer->resource);
+    if (obsList)
+    {
+        DL_DELETE(obsList->head, observer);
+        if (!obsList->head)
+        {
+            HASH_DEL(g_serverObsLists, obsList);
+            OICFree(obsList);
+        }
+    }
+
+    HASH_DELETE(hhId, g_serverObsIdIndex, observer);
+    if (observer->tokenLength)
+    {
+        HASH_DELETE(hhToken, g_serverObsTokenIndex, observer);
+    }
+    OCMetricAdd(OC_METRIC_OBSERVERS, -1);
+}
+
+static void FreeObserver(ResourceObserver *observer)
+{
+    OICFree(observer->resUri);
+    OICFree(observer->query);
+    OICFree(observer->token);
+    OICFree(observer);
+}
+
+/*
+ * Checks if the observer is past its time to live. Presence observers
+ * have a ttl of 0 and never time out.
+ */
+static bool IsObserverTimedOut(const ResourceObserver *observer)
+{
+    if (observer->TTL == 0)
+    {
+        return false;
+    }
+
+    coap_tick_t now = 0;
+    coap_ticks(&now);
+    return observer->TTL < now;
+}
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -109,6 +215,7 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
 {
     OCStackResult result = OC_STACK_ERROR;
     OCServerRequest * request = NULL;
+    OCObservationId observeId = observer->observeId;
 
     result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
                               0, observer->resource->sequenceNum, qos,
@@ -128,8 +235,13 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
             if (result == OC_STACK_OK)
             {
                 result = ProcessRequest(resHandling, resource, request);
-                // Reset Observer TTL.
-                observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                // The observer may have been removed while the entity handler ran.
+                observer = GetObserverUsingId(observeId);
+                if (observer)
+                {
+                    // Reset Observer TTL.
+                    observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                }
             }
         }
     }
@@ -137,6 +249,245 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
     return result;
 }
 
+/**
+ * Check if two observers receive the same representation, i.e. they share the
+ * query and the accepted payload format.
+ *
+ * @param a First observer.
+ * @param b Second observer.
+ * @return true if one notification payload can be sent to both observers.
+ */
+static bool IsSameNotification(const ResourceObserver *a, const ResourceObserver *b)
+{
+    if (a->acceptFormat != b->acceptFormat || a->acceptVersion != b->acceptVersion)
+    {
+        return false;
+    }
+    if (strcmp(a->resUri, b->resUri) != 0)
+    {
+        return false;
+    }
+    if (!a->query || !b->query)
+    {
+        return a->query == b->query;
+    }
+    return strcmp(a->query, b->query) == 0;
+}
+
+/**
+ * Notify a group of observers sharing the same notification. The entity handler is
+ * called once for the first observer of the group and the response is sent to all of them.
+ *
+ * @param group Observers of the group.
+ * @param numObservers Number of observers in the group.
+ * @param method RESTful method.
+ * @param qos Quality of service of resource.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendFanOutNotification(ResourceObserver **group, size_t numObservers,
+                                            OCMethod method, OCQualityOfService qos)
+{
+    OCStackResult result = OC_STACK_ERROR;
+    OCServerRequest * request = NULL;
+    ResourceObserver *leader = group[0];
+
+    OCObserveFanOutTarget *targets = (OCObserveFanOutTarget *)
+            OICCalloc(numObservers, sizeof(OCObserveFanOutTarget));
+    if (!targets)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    for (size_t i = 0; i < numObservers; i++)
+    {
+        ResourceObserver *observer = group[i];
+        OCQualityOfService obsQos = qos;
+        if (IsObserverTimedOut(observer))
+        {
+            // Send confirmable notification message to observer.
+            OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
+            obsQos = OC_HIGH_QOS;
+        }
+        targets[i].qos = DetermineObserverQoS(method, observer, obsQos);
+        targets[i].devAddr = observer->devAddr;
+        memcpy(targets[i].token, observer->token, observer->tokenLength);
+        targets[i].tokenLength = observer->tokenLength;
+        // Reset Observer TTL.
+        observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+    }
+
+    result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                              0, leader->resource->sequenceNum, targets[0].qos,
+                              leader->query, NULL, NULL,
+                              leader->token, leader->tokenLength,
+                              leader->resUri, 0, leader->acceptFormat,
+                              leader->acceptVersion, &leader->devAddr);
+    if (!request)
+    {
+        OICFree(targets);
+        return result;
+    }
+
+    // The server request owns the targets now.
+    request->fanOutTargets = targets;
+    request->numFanOutTargets = numObservers;
+    request->observeResult = OC_STACK_OK;
+    if (result == OC_STACK_OK)
+    {
+        ResourceHandling resHandling = OC_RESOURCE_VIRTUAL;
+        OCResource *resource = NULL;
+        result = DetermineResourceHandling (request, &resHandling, &resource);
+        if (result == OC_STACK_OK)
+        {
+            result = ProcessRequest(resHandling, resource, request);
+        }
+    }
+    return result;
+}
+
+/**
+ * Observer of a fan-out notification. Entity handlers may remove observers, so
+ * observers are kept by observation ID and token and looked up again before use.
+ */
+typedef struct
+{
+    /** Observation ID of the observer.*/
+    OCObservationId observeId;
+
+    /** Token of the observe request.*/
+    char token[CA_MAX_TOKEN_LEN];
+
+    /** Token length of the observe request.*/
+    uint8_t tokenLength;
+
+    /** Index of the first observer of the group.*/
+    size_t group;
+} FanOutObserver;
+
+/**
+ * Look up a fan-out observer again.
+ *
+ * @param entry Observer taken from the observer list.
+ * @param resource Observed resource.
+ *
+ * @return the observer, or NULL if it was removed meanwhile.
+ */
+static ResourceObserver *GetFanOutObserver(const FanOutObserver *entry, const OCResource *resource)
+{
+    ResourceObserver *observer = GetObserverUsingId(entry->observeId);
+    if (!observer || observer->resource != resource ||
+        observer->tokenLength != entry->tokenLength ||
+        0 != memcmp(observer->token, entry->token, entry->tokenLength))
+    {
+        return NULL;
+    }
+    return observer;
+}
+
+/**
+ * Notify all observers of a resource in fan-out mode. Observers are grouped by
+ * query and accepted payload format, and each group is notified with one call to
+ * the entity handler.
+ *
+ * @param obsList Observers of the resource.
+ * @param method RESTful method.
+ * @param qos Quality of service of resource.
+ * @param numObs Number of notified observers.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendAllObserverFanOutNotification(ResourceObserverList *obsList,
+                                                       OCMethod method,
+                                                       OCQualityOfService qos,
+                                                       uint32_t *numObs)
+{
+    OCStackResult result = OC_STACK_OK;
+    const OCResource *resource = obsList->resource;
+    ResourceObserver *observer = NULL;
+    size_t count = 0;
+
+    DL_FOREACH(obsList->head, observer)
+    {
+        count++;
+    }
+
+    FanOutObserver *pending = (FanOutObserver *) OICCalloc(count, sizeof(FanOutObserver));
+    ResourceObserver **group = (ResourceObserver **)
+            OICCalloc(count, sizeof(ResourceObserver *));
+    if (!pending || !group)
+    {
+        OICFree(pending);
+        OICFree(group);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    count = 0;
+    DL_FOREACH(obsList->head, observer)
+    {
+        pending[count].observeId = observer->observeId;
+        memcpy(pending[count].token, observer->token, observer->tokenLength);
+        pending[count].tokenLength = observer->tokenLength;
+        pending[count].group = count;
+        count++;
+    }
+    *numObs = 0;
+
+    // Groups are formed before any entity handler runs, while the observer list is stable.
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pending[i].group != i)
+        {
+            continue;
+        }
+        ResourceObserver *leader = GetFanOutObserver(&pending[i], resource);
+        for (size_t j = i + 1; leader && j < count; j++)
+        {
+            ResourceObserver *member = NULL;
+            if (pending[j].group == j &&
+                (member = GetFanOutObserver(&pending[j], resource)) &&
+                IsSameNotification(leader, member))
+            {
+                pending[j].group = i;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pending[i].group != i)
+        {
+            continue;
+        }
+
+        // Observers removed by the entity handlers of earlier groups are skipped.
+        size_t groupSize = 0;
+        for (size_t j = i; j < count; j++)
+        {
+            if (pending[j].group == i &&
+                (observer = GetFanOutObserver(&pending[j], resource)))
+            {
+                group[groupSize++] = observer;
+            }
+        }
+        if (0 == groupSize)
+        {
+            continue;
+        }
+        *numObs += (uint32_t)groupSize;
+
+        OIC_LOG_V(INFO, TAG, "Notifying group of %zu observers", groupSize);
+        if (OC_STACK_OK != SendFanOutNotification(group, groupSize, method, qos))
+        {
+            result = OC_STACK_ERROR;
+        }
+    }
+
+    OICFree(pending);
+    OICFree(group);
+    return result;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -152,73 +503,124 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
-    uint8_t numObs = 0;
+    ResourceObserverList *obsList = GetObserverList(resPtr);
+    ResourceObserver * resourceObserver = NULL;
+    OCObservationId *observeIds = NULL;
+    size_t numObserveIds = 0;
+    uint32_t numObs = 0;
     OCServerRequest * request = NULL;
     bool observeErrorFlag = false;
 
-    // Find clients that are observing this resource
-    while (resourceObserver)
+    if (obsList && method != OC_REST_PRESENCE &&
+        (resPtr->resourceProperties & OC_OBSERVE_FANOUT))
+    {
+        result = SendAllObserverFanOutNotification(obsList, method, qos, &numObs);
+        if (OC_STACK_OK != result)
+        {
+            observeErrorFlag = true;
+        }
+        obsList = NULL;
+    }
+
+    // Only the clients that are observing this resource are visited. Entity handlers
+    // run without the stack lock and may remove observers, so the observation IDs are
+    // collected first and each observer is looked up again before it is notified.
+    if (obsList)
+    {
+        DL_FOREACH(obsList->head, resourceObserver)
+        {
+            numObserveIds++;
+        }
+        observeIds = (OCObservationId *) OICCalloc(numObserveIds, sizeof(OCObservationId));
+        if (numObserveIds && !observeIds)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        numObserveIds = 0;
+        DL_FOREACH(obsList->head, resourceObserver)
+        {
+            observeIds[numObserveIds++] = resourceObserver->observeId;
+        }
+    }
+
+    for (size_t i = 0; i < numObserveIds; i++)
     {
-        if (resourceObserver->resource == resPtr)
+        resourceObserver = GetObserverUsingId(observeIds[i]);
+        if (!resourceObserver || resourceObserver->resource != resPtr)
         {
-            numObs++;
+            continue;
+        }
+
+        numObs++;
 #ifdef WITH_PRESENCE
-            if (method != OC_REST_PRESENCE)
-            {
+        if (method != OC_REST_PRESENCE)
+        {
 #endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
-                result = SendObserveNotification(resourceObserver, qos);
-#ifdef WITH_PRESENCE
+            OCQualityOfService obsQos = qos;
+            if (IsObserverTimedOut(resourceObserver))
+            {
+                // Send confirmable notification message to observer.
+                OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
+                obsQos = OC_HIGH_QOS;
             }
-            else
+            obsQos = DetermineObserverQoS(method, resourceObserver, obsQos);
+            result = SendObserveNotification(resourceObserver, obsQos);
+#ifdef WITH_PRESENCE
+        }
+        else
+        {
+            OCEntityHandlerResponse ehResponse = {0};
+
+            //This is effectively the implementation for the presence entity handler.
+            OIC_LOG(DEBUG, TAG, "This notification is for Presence");
+            result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                    0, resPtr->sequenceNum, qos, resourceObserver->query,
+                    NULL, NULL,
+                    resourceObserver->token, resourceObserver->tokenLength,
+                    resourceObserver->resUri, 0, resourceObserver->acceptFormat,
+                    resourceObserver->acceptVersion, &resourceObserver->devAddr);
+
+            if (result == OC_STACK_OK)
             {
-                OCEntityHandlerResponse ehResponse = {0};
+                OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
+                        resPtr->sequenceNum, maxAge, trigger,
+                        resourceType ? resourceType->resourcetypename : NULL);
 
-                //This is effectively the implementation for the presence entity handler.
-                OIC_LOG(DEBUG, TAG, "This notification is for Presence");
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        resourceObserver->acceptVersion, &resourceObserver->devAddr);
+                if (!presenceResBuf)
+                {
+                    OICFree(observeIds);
+                    return OC_STACK_NO_MEMORY;
+                }
 
                 if (result == OC_STACK_OK)
                 {
-                    OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
-                            resPtr->sequenceNum, maxAge, trigger,
-                            resourceType ? resourceType->resourcetypename : NULL);
-
-                    if (!presenceResBuf)
-                    {
-                        return OC_STACK_NO_MEMORY;
-                    }
-
-                    if (result == OC_STACK_OK)
-                    {
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)presenceResBuf;
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        ehResponse.resourceHandle = (OCResourceHandle) resPtr;
-                        OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
-                                resourceObserver->resUri);
-                        result = OCDoResponse(&ehResponse);
-                    }
-
-                    OCPresencePayloadDestroy(presenceResBuf);
+                    ehResponse.ehResult = OC_EH_OK;
+                    ehResponse.payload = (OCPayload*)presenceResBuf;
+                    ehResponse.persistentBufferFlag = 0;
+                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    ehResponse.resourceHandle = (OCResourceHandle) resPtr;
+                    OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
+                            resourceObserver->resUri);
+                    result = OCDoResponse(&ehResponse);
                 }
+
+                OCPresencePayloadDestroy(presenceResBuf);
             }
+        }
 #endif
 
-            // Since we are in a loop, set an error flag to indicate at least one error occurred.
-            if (result != OC_STACK_OK)
-            {
-                observeErrorFlag = true;
-            }
+        // Since we are in a loop, set an error flag to indicate at least one error occurred.
+        if (result != OC_STACK_OK)
+        {
+            observeErrorFlag = true;
         }
-        resourceObserver = resourceObserver->next;
+    }
+    OICFree(observeIds);
+
+    if (0 < numObs)
+    {
+        OCMetricAdd(OC_METRIC_OBSERVE_NOTIFICATIONS, numObs);
+        OCMetricRecord(OC_METRIC_OBSERVE_FANOUT, numObs);
     }
 
     if (numObs == 0)
@@ -323,6 +725,12 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         numIds--;
     }
 
+    if (0 < numSentNotification)
+    {
+        OCMetricAdd(OC_METRIC_OBSERVE_NOTIFICATIONS, numSentNotification);
+        OCMetricRecord(OC_METRIC_OBSERVE_FANOUT, numSentNotification);
+    }
+
     if (numSentNotification == numberOfIds && !observeErrorFlag)
     {
         return OC_STACK_OK;
@@ -428,7 +836,10 @@ OCStackResult AddObserver (const char         *resUri,
             obsNode->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
         }
 
-        LL_APPEND (g_serverObsList, obsNode);
+        if (OC_STACK_OK != InsertObserver(obsNode))
+        {
+            goto exit;
+        }
 
         return OC_STACK_OK;
     }
@@ -436,51 +847,21 @@ OCStackResult AddObserver (const char         *resUri,
 exit:
     if (obsNode)
     {
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode);
+        FreeObserver(obsNode);
     }
     return OC_STACK_NO_MEMORY;
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence callback
- * with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckTimedOutObserver(ResourceObserver* observer)
-{
-    if (!observer || observer->TTL == 0)
-    {
-        return;
-    }
-
-    coap_tick_t now = 0;
-    coap_ticks(&now);
-
-    if (observer->TTL < now)
-    {
-        // Send confirmable notification message to observer.
-        OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
-        SendObserveNotification(observer, OC_HIGH_QOS);
-    }
-}
-
 ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 {
     ResourceObserver *out = NULL;
 
     if (observeId)
     {
-        LL_FOREACH (g_serverObsList, out)
+        HASH_FIND(hhId, g_serverObsIdIndex, &observeId, sizeof(OCObservationId), out);
+        if (out)
         {
-            if (out->observeId == observeId)
-            {
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            return out;
         }
     }
     OIC_LOG(INFO, TAG, "Observer node not found!!");
@@ -495,16 +876,14 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
         ResourceObserver *out = NULL;
-        LL_FOREACH (g_serverObsList, out)
+        if (tokenLength)
         {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if ((memcmp(out->token, token, tokenLength) == 0))
-            {
-                OIC_LOG(INFO, TAG, "Found in observer list");
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            HASH_FIND(hhToken, g_serverObsTokenIndex, token, tokenLength, out);
+        }
+        if (out)
+        {
+            OIC_LOG(INFO, TAG, "Found in observer list");
+            return out;
         }
     }
     else
@@ -528,11 +907,8 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
     {
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (g_serverObsList, obsNode);
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode->token);
-        OICFree(obsNode);
+        RemoveObserver(obsNode);
+        FreeObserver(obsNode);
     }
     // it is ok if we did not find the observer...
     return OC_STACK_OK;
@@ -545,11 +921,13 @@ OCStackResult DeleteObserverUsingDevAddr(const OCDevAddr *devAddr)
         return OC_STACK_INVALID_PARAM;
     }
 
-    ResourceObserver *out = NULL;
-    ResourceObserver *tmp = NULL;
-    LL_FOREACH_SAFE(g_serverObsList, out, tmp)
+    ResourceObserverList *obsList = NULL;
+    ResourceObserverList *tmpList = NULL;
+    HASH_ITER(hh, g_serverObsLists, obsList, tmpList)
     {
-        if (out)
+        ResourceObserver *out = NULL;
+        ResourceObserver *tmp = NULL;
+        DL_FOREACH_SAFE(obsList->head, out, tmp)
         {
             if ((strcmp(out->devAddr.addr, devAddr->addr) == 0)
                     && out->devAddr.port == devAddr->port)
@@ -566,16 +944,21 @@ OCStackResult DeleteObserverUsingDevAddr(const OCDevAddr *devAddr)
 
 void DeleteObserverList()
 {
-    ResourceObserver *out = NULL;
-    ResourceObserver *tmp = NULL;
-    LL_FOREACH_SAFE (g_serverObsList, out, tmp)
+    ResourceObserverList *obsList = NULL;
+    ResourceObserverList *tmpList = NULL;
+    HASH_ITER(hh, g_serverObsLists, obsList, tmpList)
     {
-        if (out)
+        ResourceObserver *out = NULL;
+        ResourceObserver *tmp = NULL;
+        DL_FOREACH_SAFE(obsList->head, out, tmp)
         {
-            DeleteObserverUsingToken ((out->token), out->tokenLength);
+            RemoveObserver(out);
+            FreeObserver(out);
         }
     }
-    g_serverObsList = NULL;
+    g_serverObsLists = NULL;
+    g_serverObsIdIndex = NULL;
+    g_serverObsTokenIndex = NULL;
 }
 
 /*
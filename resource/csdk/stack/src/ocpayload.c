@@ -28,6 +28,7 @@
 #include <string.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_hash.h"
 #include "ocstackinternal.h"
 #include "ocresource.h"
 #include "logger.h"
@@ -37,6 +38,30 @@
 #define TAG "OIC_RI_PAYLOAD"
 #define CSV_SEPARATOR ','
 
+/** Number of values after which a representation gets a hash index.*/
+#define OC_REP_INDEX_MIN_VALUES (8)
+
+/** Initial number of slots of a value index, a power of 2.*/
+#define OC_REP_INDEX_MIN_SLOTS (32)
+
+typedef struct
+{
+    uint32_t hash;
+    OCRepPayloadValue* value;
+} OCRepPayloadIndexSlot;
+
+/**
+ * Open addressed table, probed linearly, mapping value names to the nodes of
+ * the values list. The list stays the owner of the nodes and keeps their order.
+ */
+typedef struct OCRepPayloadValueIndex
+{
+    size_t numSlots;
+    size_t numValues;
+    OCRepPayloadValue* tail;
+    OCRepPayloadIndexSlot* slots;
+} OCRepPayloadValueIndex;
+
 static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
 
 void OCPayloadDestroy(OCPayload* payload)
@@ -97,6 +122,120 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
+static uint32_t OCRepPayloadHashName(const char* name)
+{
+    return OICHashString(OIC_HASH_INIT, name);
+}
+
+static OCRepPayloadIndexSlot* OCRepPayloadIndexLookup(const OCRepPayloadValueIndex* index,
+        const char* name, uint32_t hash)
+{
+    size_t mask = index->numSlots - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        OCRepPayloadIndexSlot* slot = &index->slots[i];
+        if (!slot->value ||
+            (slot->hash == hash && 0 == strcmp(slot->value->name, name)))
+        {
+            return slot;
+        }
+    }
+}
+
+static void OCRepPayloadIndexDestroy(OCRepPayloadValueIndex* index)
+{
+    if (index)
+    {
+        OICFree(index->slots);
+        OICFree(index);
+    }
+}
+
+static bool OCRepPayloadIndexResize(OCRepPayloadValueIndex* index, size_t numSlots)
+{
+    OCRepPayloadIndexSlot* slots =
+        (OCRepPayloadIndexSlot*)OICCalloc(numSlots, sizeof(OCRepPayloadIndexSlot));
+    if (!slots)
+    {
+        return false;
+    }
+
+    OCRepPayloadIndexSlot* oldSlots = index->slots;
+    size_t oldNumSlots = index->numSlots;
+    index->slots = slots;
+    index->numSlots = numSlots;
+    for (size_t i = 0; i < oldNumSlots; ++i)
+    {
+        if (oldSlots[i].value)
+        {
+            *OCRepPayloadIndexLookup(index, oldSlots[i].value->name, oldSlots[i].hash) =
+                oldSlots[i];
+        }
+    }
+    OICFree(oldSlots);
+    return true;
+}
+
+/**
+ * Adds a value which is not in the index yet. The table is kept at most half full.
+ */
+static bool OCRepPayloadIndexAdd(OCRepPayloadValueIndex* index, OCRepPayloadValue* val)
+{
+    if ((index->numValues + 1) * 2 > index->numSlots &&
+        !OCRepPayloadIndexResize(index, index->numSlots * 2))
+    {
+        return false;
+    }
+
+    uint32_t hash = OCRepPayloadHashName(val->name);
+    OCRepPayloadIndexSlot* slot = OCRepPayloadIndexLookup(index, val->name, hash);
+    slot->hash = hash;
+    slot->value = val;
+    index->numValues++;
+    return true;
+}
+
+/**
+ * Indexes all values of a payload. Without memory the payload simply keeps
+ * using linear lookups.
+ */
+static void OCRepPayloadBuildIndex(OCRepPayload* payload)
+{
+    OCRepPayloadValueIndex* index =
+        (OCRepPayloadValueIndex*)OICCalloc(1, sizeof(OCRepPayloadValueIndex));
+    if (!index)
+    {
+        return;
+    }
+
+    size_t numValues = 0;
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        numValues++;
+        index->tail = val;
+    }
+    size_t numSlots = OC_REP_INDEX_MIN_SLOTS;
+    while (numSlots < (numValues + 1) * 2)
+    {
+        numSlots *= 2;
+    }
+
+    if (!OCRepPayloadIndexResize(index, numSlots))
+    {
+        OICFree(index);
+        return;
+    }
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        if (!OCRepPayloadIndexAdd(index, val))
+        {
+            OCRepPayloadIndexDestroy(index);
+            return;
+        }
+    }
+    payload->valueIndex = index;
+}
+
 static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if (!payload || !name)
@@ -104,6 +243,12 @@ static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, con
         return NULL;
     }
 
+    if (payload->valueIndex)
+    {
+        return OCRepPayloadIndexLookup(payload->valueIndex, name,
+                                       OCRepPayloadHashName(name))->value;
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -279,17 +424,38 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
     }
 }
 
-static void OCFreeRepPayloadValue(OCRepPayloadValue* val)
+/**
+ * Allocates a value node. The name is stored right behind the node, so that
+ * both take a single allocation.
+ */
+static OCRepPayloadValue* OCRepPayloadValueCreate(const char* name)
 {
+    size_t nameSize = strlen(name) + 1;
+    OCRepPayloadValue* val =
+        (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue) + nameSize);
     if (!val)
     {
-        return;
+        return NULL;
     }
+    val->name = (char*)(val + 1);
+    memcpy(val->name, name, nameSize);
+    return val;
+}
 
-    OICFree(val->name);
-    OCFreeRepPayloadValueContents(val);
-    OCFreeRepPayloadValue(val->next);
-    OICFree(val);
+static void OCFreeRepPayloadValue(OCRepPayloadValue* val)
+{
+    // Iterative, as the list of a large representation can be long.
+    while (val)
+    {
+        OCRepPayloadValue* next = val->next;
+        if (val->name != (char*)(val + 1))
+        {
+            OICFree(val->name);
+        }
+        OCFreeRepPayloadValueContents(val);
+        OICFree(val);
+        val = next;
+    }
 }
 static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 {
@@ -299,36 +465,28 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
     }
 
     OCRepPayloadValue *sourceIter = source;
-    OCRepPayloadValue *destIter = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
-    if (!destIter)
-    {
-        return NULL;
-    }
-
-    OCRepPayloadValue *headOfClone = destIter;
-
-    // Copy payload type and non pointer types in union.
-    *destIter = *sourceIter;
-    destIter->name = OICStrdup (sourceIter->name);
-    OCCopyPropertyValue (destIter, sourceIter);
-
-    sourceIter = sourceIter->next;
+    OCRepPayloadValue *headOfClone = NULL;
+    OCRepPayloadValue **destLink = &headOfClone;
 
     while (sourceIter)
     {
-        destIter->next = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!destIter->next)
+        OCRepPayloadValue *destIter = OCRepPayloadValueCreate(sourceIter->name);
+        if (!destIter)
         {
             OCFreeRepPayloadValue (headOfClone);
             return NULL;
         }
 
-        *(destIter->next) = *sourceIter;
-        destIter->next->name = OICStrdup (sourceIter->name);
-        OCCopyPropertyValue (destIter->next, sourceIter);
+        // Copy payload type and non pointer types in union.
+        char *name = destIter->name;
+        *destIter = *sourceIter;
+        destIter->name = name;
+        destIter->next = NULL;
+        OCCopyPropertyValue (destIter, sourceIter);
 
+        *destLink = destIter;
+        destLink = &destIter->next;
         sourceIter = sourceIter->next;
-        destIter = destIter->next;
     }
     return headOfClone;
 }
@@ -341,56 +499,66 @@ static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, con
         return NULL;
     }
 
-    OCRepPayloadValue* val = payload->values;
-    if (val == NULL)
+    OCRepPayloadValue* val = NULL;
+    OCRepPayloadValue** link = &payload->values;
+    OCRepPayloadValueIndex* index = payload->valueIndex;
+    size_t numValues = 0;
+
+    if (index)
     {
-        payload->values = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!payload->values)
+        val = OCRepPayloadFindValue(payload, name);
+        if (index->tail)
         {
-            return NULL;
-        }
-        payload->values->name = OICStrdup(name);
-        if (!payload->values->name)
-        {
-            OICFree(payload->values);
-            payload->values = NULL;
-            return NULL;
+            while (index->tail->next)
+            {
+                index->tail = index->tail->next;
+            }
+            link = &index->tail->next;
         }
-        payload->values->type =type;
-        return payload->values;
     }
-
-    while(val)
+    else
     {
-        if (0 == strcmp(val->name, name))
-        {
-            OCFreeRepPayloadValueContents(val);
-            val->type = type;
-            return val;
-        }
-        else if (val->next == NULL)
+        for (val = payload->values; val; val = val->next)
         {
-            val->next = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-            if (!val->next)
+            if (0 == strcmp(val->name, name))
             {
-                return NULL;
-            }
-            val->next->name = OICStrdup(name);
-            if (!val->next->name)
-            {
-                OICFree(val->next);
-                val->next = NULL;
-                return NULL;
+                break;
             }
-            val->next->type =type;
-            return val->next;
+            link = &val->next;
+            numValues++;
         }
+    }
 
-        val = val->next;
+    if (val)
+    {
+        OCFreeRepPayloadValueContents(val);
+        val->type = type;
+        return val;
     }
 
-    OIC_LOG(ERROR, TAG, "FindAndSetValue reached point after while loop, pointer corruption?");
-    return NULL;
+    val = OCRepPayloadValueCreate(name);
+    if (!val)
+    {
+        return NULL;
+    }
+    val->type = type;
+
+    if (index)
+    {
+        if (!OCRepPayloadIndexAdd(index, val))
+        {
+            OICFree(val);
+            return NULL;
+        }
+        index->tail = val;
+    }
+    *link = val;
+
+    if (!index && numValues + 1 >= OC_REP_INDEX_MIN_VALUES)
+    {
+        OCRepPayloadBuildIndex(payload);
+    }
+    return val;
 }
 
 bool OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType)
@@ -1591,6 +1759,10 @@ OCRepPayload* OCRepPayloadClone (const OCRepPayload* payload)
     clone->types = CloneOCStringLL (payload->types);
     clone->interfaces = CloneOCStringLL (payload->interfaces);
     clone->values = OCRepPayloadValueClone (payload->values);
+    if (payload->valueIndex)
+    {
+        OCRepPayloadBuildIndex(clone);
+    }
 
     return clone;
 }
@@ -1614,6 +1786,10 @@ OCRepPayload* OCRepPayloadBatchClone(const OCRepPayload* repPayload)
     clone->types  = CloneOCStringLL(repPayload->types);
     clone->interfaces  = CloneOCStringLL(repPayload->interfaces);
     clone->values = OCRepPayloadValueClone(repPayload->values);
+    if (repPayload->valueIndex)
+    {
+        OCRepPayloadBuildIndex(clone);
+    }
     OCRepPayloadSetPropObjectAsOwner(newPayload, OC_RSRVD_REPRESENTATION, clone);
 
     return newPayload;
@@ -1630,6 +1806,7 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
     OCFreeRepPayloadValue(payload->values);
+    OCRepPayloadIndexDestroy(payload->valueIndex);
     OCRepPayloadDestroy(payload->next);
     OICFree(payload);
 }
@@ -48,6 +48,12 @@
 // Endpoint Map length, it contains "ep", "pri".
 #define EP_MAP_LEN (2)
 
+// Largest CBOR item header: initial byte followed by a 64-bit length or value.
+#define CBOR_MAX_HEADER_SIZE (9)
+
+// Start and break bytes of an indefinite-length container.
+#define CBOR_INDEFINITE_SIZE (2)
+
 // Functions all return either a CborError, or a negative version of the OC_STACK return values
 static int64_t OCConvertPayloadHelper(OCPayload *payload, uint8_t *outPayload, size_t *size);
 static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, uint8_t *outPayload,
@@ -67,6 +73,11 @@ static int64_t AddTextStringToMap(CborEncoder *map, const char *key, size_t keyl
 static int64_t ConditionalAddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
 
+static size_t OCEstimateDiscoveryPayloadSize(const OCDiscoveryPayload *payload);
+static size_t OCEstimateRepPayloadSize(const OCRepPayload *payload);
+static size_t OCEstimateRepMapSize(const OCRepPayload *payload);
+static size_t OCEstimatePresencePayloadSize(const OCPresencePayload *payload);
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
@@ -77,65 +88,135 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     #undef CborNeedsUpdating
 
     OCStackResult ret = OC_STACK_INVALID_PARAM;
-    int64_t err = CborErrorOutOfMemory;
     uint8_t *out = NULL;
-    size_t curSize = INIT_SIZE;
+    size_t allocSize = 0;
+    size_t curSize = 0;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
     VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
 
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
-    if (PAYLOAD_TYPE_SECURITY == payload->type)
-    {
-        size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
-        {
-            curSize = securityPayloadSize;
-        }
-    }
-
-    ret = OC_STACK_NO_MEMORY;
 
+    // The estimate is an upper bound, so the payload is normally encoded exactly once.
+    // The loop only repeats if the estimate was short for a payload it does not model.
+    allocSize = OCEstimatePayloadSize(payload);
     for (;;)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
+        out = (uint8_t *)OICCalloc(1, allocSize);
+        ret = OC_STACK_NO_MEMORY;
         VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
-        err = OCConvertPayloadHelper(payload, out, &curSize);
 
-        if (CborErrorOutOfMemory != err)
+        curSize = allocSize;
+        ret = OCConvertPayloadToBuffer(payload, out, &curSize);
+        if (OC_STACK_NO_MEMORY != ret || curSize <= allocSize)
         {
             break;
         }
 
+        OIC_LOG_V(DEBUG, TAG, "Payload estimate %zu too small, need %zu", allocSize, curSize);
         OICFree(out);
+        out = NULL;
+        allocSize = curSize;
+    }
+    if (OC_STACK_OK != ret)
+    {
+        goto exit;
     }
 
-    if (err == CborNoError)
+    if ((curSize < allocSize) && (curSize > 0))
     {
-        if ((curSize < INIT_SIZE) &&
-            (PAYLOAD_TYPE_SECURITY != payload->type))
+        // Shrinking keeps the same block on most allocators, so this does not copy.
+        uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
+        if (out2)
         {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
             out = out2;
         }
-
-        *size = curSize;
-        *outPayload = out;
-        OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
-        OIC_LOG_BUFFER(DEBUG, TAG, *outPayload, *size);
-        return OC_STACK_OK;
     }
 
-    //TODO: Proper conversion from CborError to OCStackResult.
-    ret = (OCStackResult)-err;
+    *size = curSize;
+    *outPayload = out;
+    OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
+    OIC_LOG_BUFFER(DEBUG, TAG, *outPayload, *size);
+    return OC_STACK_OK;
 
 exit:
     OICFree(out);
     return ret;
 }
 
+OCStackResult OCConvertPayloadToBuffer(OCPayload *payload, uint8_t *buffer, size_t *size)
+{
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "buffer parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
+
+    if (PAYLOAD_TYPE_SECURITY == payload->type &&
+        ((OCSecurityPayload *)payload)->payloadSize > *size)
+    {
+        *size = ((OCSecurityPayload *)payload)->payloadSize;
+        return OC_STACK_NO_MEMORY;
+    }
+
+    size_t bufferSize = *size;
+    int64_t err = OCConvertPayloadHelper(payload, buffer, size);
+    if (CborErrorOutOfMemory == err)
+    {
+        // checkError reports the bytes tinycbor could not write; never report less than
+        // the upper bound so a caller retrying with *size succeeds.
+        size_t estimate = OCEstimatePayloadSize(payload);
+        if (*size < estimate)
+        {
+            *size = estimate;
+        }
+        if (*size <= bufferSize)
+        {
+            *size = bufferSize + 1;
+        }
+        return OC_STACK_NO_MEMORY;
+    }
+    if (CborNoError != err)
+    {
+        //TODO: Proper conversion from CborError to OCStackResult.
+        return (OCStackResult)-err;
+    }
+    return OC_STACK_OK;
+
+exit:
+    return OC_STACK_INVALID_PARAM;
+}
+
+size_t OCEstimatePayloadSize(const OCPayload *payload)
+{
+    size_t estimate = 0;
+    if (!payload)
+    {
+        return 0;
+    }
+
+    switch (payload->type)
+    {
+        case PAYLOAD_TYPE_DISCOVERY:
+            estimate = OCEstimateDiscoveryPayloadSize((const OCDiscoveryPayload *)payload);
+            break;
+        case PAYLOAD_TYPE_REPRESENTATION:
+            estimate = OCEstimateRepPayloadSize((const OCRepPayload *)payload);
+            break;
+        case PAYLOAD_TYPE_PRESENCE:
+            estimate = OCEstimatePresencePayloadSize((const OCPresencePayload *)payload);
+            break;
+        case PAYLOAD_TYPE_SECURITY:
+            estimate = ((const OCSecurityPayload *)payload)->payloadSize;
+            break;
+        default:
+            break;
+    }
+
+    // Keep a minimum so tiny payloads need no reallocation and an empty security
+    // payload still gets a buffer.
+    return (estimate < INIT_SIZE) ? INIT_SIZE : estimate;
+}
+
 static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, size_t* size)
 {
     switch(payload->type)
@@ -154,6 +235,185 @@ static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, s
     }
 }
 
+static size_t OCEstimateTextStringSize(const char *str)
+{
+    return str ? (CBOR_MAX_HEADER_SIZE + strlen(str)) : 0;
+}
+
+static size_t OCEstimateStringLLSize(const char *key, const OCStringLL *val)
+{
+    if (!val)
+    {
+        return 0;
+    }
+
+    size_t estimate = OCEstimateTextStringSize(key) + CBOR_MAX_HEADER_SIZE;
+    for (const OCStringLL *temp = val; temp; temp = temp->next)
+    {
+        estimate += OCEstimateTextStringSize(temp->value);
+    }
+    return estimate;
+}
+
+static size_t OCEstimateDiscoveryPayloadSize(const OCDiscoveryPayload *payload)
+{
+    size_t estimate = CBOR_MAX_HEADER_SIZE;
+
+    for (; payload; payload = payload->next)
+    {
+        estimate += CBOR_INDEFINITE_SIZE;
+        estimate += OCEstimateTextStringSize(OC_RSRVD_DEVICE_NAME) +
+                    OCEstimateTextStringSize(payload->name);
+        estimate += OCEstimateTextStringSize(OC_RSRVD_DEVICE_ID) +
+                    OCEstimateTextStringSize(payload->sid);
+        estimate += OCEstimateStringLLSize(OC_RSRVD_RESOURCE_TYPE, payload->type);
+        estimate += OCEstimateStringLLSize(OC_RSRVD_INTERFACE, payload->iface);
+        estimate += OCEstimateTextStringSize(OC_RSRVD_BASE_URI) +
+                    OCEstimateTextStringSize(payload->baseURI);
+        estimate += OCEstimateTextStringSize(OC_RSRVD_LINKS) + CBOR_MAX_HEADER_SIZE;
+
+        for (const OCResourcePayload *res = payload->resources; res; res = res->next)
+        {
+            estimate += CBOR_MAX_HEADER_SIZE;
+            estimate += OCEstimateTextStringSize(OC_RSRVD_HREF) +
+                        OCEstimateTextStringSize(res->uri);
+            estimate += OCEstimateTextStringSize(OC_RSRVD_REL) +
+                        OCEstimateTextStringSize(res->rel);
+            estimate += OCEstimateStringLLSize(OC_RSRVD_RESOURCE_TYPE, res->types);
+            estimate += OCEstimateStringLLSize(OC_RSRVD_INTERFACE, res->interfaces);
+
+            // Policy map with bitmap, secure flag and the hosting, tls and tcp ports.
+            estimate += OCEstimateTextStringSize(OC_RSRVD_POLICY) + CBOR_INDEFINITE_SIZE;
+            estimate += OCEstimateTextStringSize(OC_RSRVD_BITMAP) + CBOR_MAX_HEADER_SIZE;
+            estimate += OCEstimateTextStringSize(OC_RSRVD_SECURE) + 1;
+            estimate += OCEstimateTextStringSize(OC_RSRVD_HOSTING_PORT) + CBOR_MAX_HEADER_SIZE;
+            estimate += OCEstimateTextStringSize(OC_RSRVD_TLS_PORT) + CBOR_MAX_HEADER_SIZE;
+            estimate += OCEstimateTextStringSize(OC_RSRVD_TCP_PORT) + CBOR_MAX_HEADER_SIZE;
+
+            if (res->eps)
+            {
+                estimate += OCEstimateTextStringSize(OC_RSRVD_ENDPOINTS) + CBOR_MAX_HEADER_SIZE;
+                for (const OCEndpointPayload *ep = res->eps; ep; ep = ep->next)
+                {
+                    estimate += CBOR_MAX_HEADER_SIZE;
+                    estimate += OCEstimateTextStringSize(OC_RSRVD_ENDPOINT) +
+                                CBOR_MAX_HEADER_SIZE + MAX_ADDR_STR_SIZE;
+                    estimate += OCEstimateTextStringSize(OC_RSRVD_PRIORITY) +
+                                CBOR_MAX_HEADER_SIZE;
+                }
+            }
+        }
+    }
+    return estimate;
+}
+
+static size_t OCEstimateArraySize(const OCRepPayloadValueArray *valArray)
+{
+    // One header per array at every nesting level.
+    size_t estimate = CBOR_MAX_HEADER_SIZE;
+    if (valArray->dimensions[1])
+    {
+        estimate += valArray->dimensions[0] * CBOR_MAX_HEADER_SIZE;
+        if (valArray->dimensions[2])
+        {
+            estimate += valArray->dimensions[0] * valArray->dimensions[1] *
+                        CBOR_MAX_HEADER_SIZE;
+        }
+    }
+
+    size_t count = calcDimTotal(valArray->dimensions);
+    switch (valArray->type)
+    {
+        case OCREP_PROP_INT:
+        case OCREP_PROP_DOUBLE:
+        case OCREP_PROP_BOOL:
+            estimate += count * CBOR_MAX_HEADER_SIZE;
+            break;
+        case OCREP_PROP_STRING:
+            for (size_t i = 0; valArray->strArray && i < count; ++i)
+            {
+                estimate += OCEstimateTextStringSize(valArray->strArray[i]) + 1;
+            }
+            break;
+        case OCREP_PROP_BYTE_STRING:
+            for (size_t i = 0; valArray->ocByteStrArray && i < count; ++i)
+            {
+                estimate += CBOR_MAX_HEADER_SIZE + valArray->ocByteStrArray[i].len;
+            }
+            break;
+        case OCREP_PROP_OBJECT:
+            for (size_t i = 0; valArray->objArray && i < count; ++i)
+            {
+                estimate += valArray->objArray[i] ?
+                            OCEstimateRepMapSize(valArray->objArray[i]) : 1;
+            }
+            break;
+        default:
+            break;
+    }
+    return estimate;
+}
+
+static size_t OCEstimateRepValueSize(const OCRepPayloadValue *value)
+{
+    switch (value->type)
+    {
+        case OCREP_PROP_NULL:
+        case OCREP_PROP_BOOL:
+            return 1;
+        case OCREP_PROP_INT:
+        case OCREP_PROP_DOUBLE:
+            return CBOR_MAX_HEADER_SIZE;
+        case OCREP_PROP_STRING:
+            return OCEstimateTextStringSize(value->str);
+        case OCREP_PROP_BYTE_STRING:
+            return CBOR_MAX_HEADER_SIZE + value->ocByteStr.len;
+        case OCREP_PROP_OBJECT:
+            return value->obj ? OCEstimateRepMapSize(value->obj) : 1;
+        case OCREP_PROP_ARRAY:
+            return OCEstimateArraySize(&value->arr);
+        default:
+            return 0;
+    }
+}
+
+static size_t OCEstimateRepMapSize(const OCRepPayload *payload)
+{
+    // A map is indefinite-length, an array of integer-named values has a header; budget
+    // for the larger of the two.
+    size_t estimate = CBOR_MAX_HEADER_SIZE;
+    for (const OCRepPayloadValue *value = payload->values; value; value = value->next)
+    {
+        estimate += OCEstimateTextStringSize(value->name) + OCEstimateRepValueSize(value);
+    }
+    return estimate;
+}
+
+static size_t OCEstimateRepPayloadSize(const OCRepPayload *payload)
+{
+    size_t estimate = CBOR_MAX_HEADER_SIZE;
+
+    for (; payload; payload = payload->next)
+    {
+        estimate += OCEstimateTextStringSize(OC_RSRVD_HREF) +
+                    OCEstimateTextStringSize(payload->uri);
+        estimate += OCEstimateStringLLSize(OC_RSRVD_RESOURCE_TYPE, payload->types);
+        estimate += OCEstimateStringLLSize(OC_RSRVD_INTERFACE, payload->interfaces);
+        estimate += OCEstimateRepMapSize(payload);
+    }
+    return estimate;
+}
+
+static size_t OCEstimatePresencePayloadSize(const OCPresencePayload *payload)
+{
+    return CBOR_INDEFINITE_SIZE +
+           OCEstimateTextStringSize(OC_RSRVD_NONCE) + CBOR_MAX_HEADER_SIZE +
+           OCEstimateTextStringSize(OC_RSRVD_TTL) + CBOR_MAX_HEADER_SIZE +
+           OCEstimateTextStringSize(OC_RSRVD_TRIGGER) + CBOR_MAX_HEADER_SIZE +
+           OCEstimateTextStringSize(OC_RSRVD_RESOURCE_TYPE) +
+           OCEstimateTextStringSize(payload->resourceType);
+}
+
 static int64_t checkError(int64_t err, CborEncoder* encoder, uint8_t* outPayload, size_t* size)
 {
     if (err == CborErrorOutOfMemory)
@@ -702,7 +962,9 @@ static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, s
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed adding rep root map");
     }
 
-    while (payload != NULL && (err == CborNoError))
+    // Keep going on CborErrorOutOfMemory so tinycbor accounts for every member of a
+    // collection when reporting the size needed.
+    while (payload != NULL)
     {
         CborEncoder rootMap;
         err |= cbor_encoder_create_map(((arrayCount == 1)? &encoder: &rootArray),
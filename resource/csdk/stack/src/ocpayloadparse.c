@@ -32,6 +32,7 @@
 #include "ocpayload.h"
 #include "oic_string.h"
 #include "oic_malloc.h"
+#include "oic_hash.h"
 #include "ocpayloadcbor.h"
 #include "ocstackinternal.h"
 #include "payload_logging.h"
@@ -1124,3 +1125,306 @@ exit:
     OCPresencePayloadDestroy(payload);
     return ret;
 }
+
+typedef struct
+{
+    uint32_t hash;
+    CborValue key;
+    CborValue value;
+} OCRepPayloadViewEntry;
+
+struct OCRepPayloadView
+{
+    CborParser parser;
+    CborValue map;                      /**< map of the viewed representation. */
+    size_t numEntries;
+    OCRepPayloadViewEntry *entries;     /**< keys in encoded order, NULL without index. */
+    size_t numSlots;
+    size_t *slots;                      /**< entry index + 1 per slot, 0 for an empty slot. */
+};
+
+static uint32_t OCRepPayloadViewHash(const char *str, size_t len)
+{
+    // Same hash as the property index of OCRepPayload.
+    return OICHashBytes(OIC_HASH_INIT, str, len);
+}
+
+static CborError OCRepPayloadViewHashKey(const CborValue *key, uint32_t *hash)
+{
+    // Keys are short, the copy only falls back to the heap for unusual ones.
+    char buffer[64];
+    size_t len = sizeof(buffer);
+    CborError err = cbor_value_copy_text_string(key, buffer, &len, NULL);
+    if (CborNoError == err)
+    {
+        *hash = OCRepPayloadViewHash(buffer, len);
+        return CborNoError;
+    }
+    if (CborErrorOutOfMemory != err)
+    {
+        return err;
+    }
+
+    char *name = NULL;
+    err = cbor_value_dup_text_string(key, &name, &len, NULL);
+    if (CborNoError == err)
+    {
+        *hash = OCRepPayloadViewHash(name, len);
+    }
+    free(name);  // Free *TinyCBOR allocated* string.
+    return err;
+}
+
+static CborError OCRepPayloadViewBuildIndex(OCRepPayloadView *view)
+{
+    size_t capacity = 0;
+    CborValue it;
+    CborError err = cbor_value_enter_container(&view->map, &it);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+
+    while (cbor_value_is_valid(&it))
+    {
+        if (!cbor_value_is_text_string(&it))
+        {
+            err = CborErrorIllegalType;
+            goto exit;
+        }
+        if (view->numEntries == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 16;
+            OCRepPayloadViewEntry *entries = (OCRepPayloadViewEntry *)
+                OICRealloc(view->entries, capacity * sizeof(OCRepPayloadViewEntry));
+            if (!entries)
+            {
+                err = CborErrorOutOfMemory;
+                goto exit;
+            }
+            view->entries = entries;
+        }
+
+        OCRepPayloadViewEntry *entry = &view->entries[view->numEntries];
+        entry->key = it;
+        err = OCRepPayloadViewHashKey(&it, &entry->hash);
+        if (CborNoError == err)
+        {
+            err = cbor_value_advance(&it);
+        }
+        if (CborNoError == err && !cbor_value_is_valid(&it))
+        {
+            err = CborErrorUnexpectedEOF;
+        }
+        if (CborNoError != err)
+        {
+            goto exit;
+        }
+        entry->value = it;
+        err = cbor_value_advance(&it);
+        if (CborNoError != err)
+        {
+            goto exit;
+        }
+        view->numEntries++;
+    }
+
+    view->numSlots = 16;
+    while (view->numSlots < view->numEntries * 2)
+    {
+        view->numSlots *= 2;
+    }
+    view->slots = (size_t *)OICCalloc(view->numSlots, sizeof(size_t));
+    if (!view->slots)
+    {
+        err = CborErrorOutOfMemory;
+        goto exit;
+    }
+
+    // Later duplicates of a key are ignored, like cbor_value_map_find_value() does.
+    for (size_t i = 0; i < view->numEntries; ++i)
+    {
+        size_t mask = view->numSlots - 1;
+        size_t slot = view->entries[i].hash & mask;
+        while (view->slots[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+        view->slots[slot] = i + 1;
+    }
+    return CborNoError;
+
+exit:
+    return err;
+}
+
+static bool OCRepPayloadViewFind(const OCRepPayloadView *view, const char *name,
+                                 CborValue *value)
+{
+    if (!view || !name)
+    {
+        return false;
+    }
+
+    if (!view->slots)
+    {
+        return (CborNoError == cbor_value_map_find_value(&view->map, name, value)) &&
+               cbor_value_is_valid(value);
+    }
+
+    uint32_t hash = OCRepPayloadViewHash(name, strlen(name));
+    size_t mask = view->numSlots - 1;
+    for (size_t slot = hash & mask; view->slots[slot]; slot = (slot + 1) & mask)
+    {
+        const OCRepPayloadViewEntry *entry = &view->entries[view->slots[slot] - 1];
+        bool equal = false;
+        if (entry->hash == hash &&
+            CborNoError == cbor_value_text_string_equals(&entry->key, name, &equal) && equal)
+        {
+            *value = entry->value;
+            return true;
+        }
+    }
+    return false;
+}
+
+OCStackResult OCRepPayloadViewCreate(const uint8_t *payload, size_t payloadSize,
+                                     bool buildIndex, OCRepPayloadView **view)
+{
+    OCStackResult ret = OC_STACK_INVALID_PARAM;
+    OCRepPayloadView *newView = NULL;
+    CborError err = CborNoError;
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Invalid cbor payload value");
+    VERIFY_PARAM_NON_NULL(TAG, view, "Invalid Parameter view");
+
+    ret = OC_STACK_NO_MEMORY;
+    newView = (OCRepPayloadView *)OICCalloc(1, sizeof(OCRepPayloadView));
+    VERIFY_PARAM_NON_NULL(TAG, newView, "Failed allocating view");
+
+    ret = OC_STACK_MALFORMED_RESPONSE;
+    err = cbor_parser_init(payload, payloadSize, 0, &newView->parser, &newView->map);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed initializing init value");
+
+    if (cbor_value_is_array(&newView->map))
+    {
+        CborValue first;
+        err = cbor_value_enter_container(&newView->map, &first);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering root array");
+        newView->map = first;
+    }
+    if (!cbor_value_is_map(&newView->map))
+    {
+        OIC_LOG(ERROR, TAG, "Payload is not a representation");
+        goto exit;
+    }
+
+    if (buildIndex)
+    {
+        err = OCRepPayloadViewBuildIndex(newView);
+        if (CborNoError != err)
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed indexing representation with cbor error: '%s'.",
+                      cbor_error_string(err));
+            ret = (CborErrorOutOfMemory == err) ? OC_STACK_NO_MEMORY : ret;
+            goto exit;
+        }
+    }
+
+    *view = newView;
+    return OC_STACK_OK;
+
+exit:
+    OCRepPayloadViewDestroy(newView);
+    return ret;
+}
+
+void OCRepPayloadViewDestroy(OCRepPayloadView *view)
+{
+    if (view)
+    {
+        OICFree(view->entries);
+        OICFree(view->slots);
+        OICFree(view);
+    }
+}
+
+bool OCRepPayloadViewHasProp(const OCRepPayloadView *view, const char *name)
+{
+    CborValue value;
+    return OCRepPayloadViewFind(view, name, &value);
+}
+
+bool OCRepPayloadViewIsNull(const OCRepPayloadView *view, const char *name)
+{
+    CborValue value;
+    return OCRepPayloadViewFind(view, name, &value) && cbor_value_is_null(&value);
+}
+
+bool OCRepPayloadViewGetPropInt(const OCRepPayloadView *view, const char *name,
+                                int64_t *value)
+{
+    CborValue val;
+    return value && OCRepPayloadViewFind(view, name, &val) && cbor_value_is_integer(&val) &&
+           (CborNoError == cbor_value_get_int64(&val, value));
+}
+
+bool OCRepPayloadViewGetPropDouble(const OCRepPayloadView *view, const char *name,
+                                   double *value)
+{
+    CborValue val;
+    if (!value || !OCRepPayloadViewFind(view, name, &val))
+    {
+        return false;
+    }
+
+    // Like OCRepPayloadGetPropDouble(), integers are converted.
+    if (cbor_value_is_integer(&val))
+    {
+        int64_t intValue = 0;
+        if (CborNoError != cbor_value_get_int64(&val, &intValue))
+        {
+            return false;
+        }
+        *value = (double)intValue;
+        return true;
+    }
+    return cbor_value_is_double(&val) && (CborNoError == cbor_value_get_double(&val, value));
+}
+
+bool OCRepPayloadViewGetPropBool(const OCRepPayloadView *view, const char *name,
+                                 bool *value)
+{
+    CborValue val;
+    return value && OCRepPayloadViewFind(view, name, &val) && cbor_value_is_boolean(&val) &&
+           (CborNoError == cbor_value_get_boolean(&val, value));
+}
+
+bool OCRepPayloadViewGetPropString(const OCRepPayloadView *view, const char *name,
+                                   char **value)
+{
+    CborValue val;
+    size_t len = 0;
+    return value && OCRepPayloadViewFind(view, name, &val) && cbor_value_is_text_string(&val) &&
+           (CborNoError == cbor_value_dup_text_string(&val, value, &len, NULL));
+}
+
+bool OCRepPayloadViewGetPropByteString(const OCRepPayloadView *view, const char *name,
+                                       OCByteString *value)
+{
+    CborValue val;
+    return value && OCRepPayloadViewFind(view, name, &val) && cbor_value_is_byte_string(&val) &&
+           (CborNoError == cbor_value_dup_byte_string(&val, &value->bytes, &value->len, NULL));
+}
+
+bool OCRepPayloadViewGetPropObject(const OCRepPayloadView *view, const char *name,
+                                   OCRepPayload **value)
+{
+    CborValue val;
+    if (!value || !OCRepPayloadViewFind(view, name, &val) || !cbor_value_is_map(&val))
+    {
+        return false;
+    }
+
+    *value = NULL;
+    return (CborNoError == OCParseSingleRepPayload(value, &val, false)) && *value;
+}
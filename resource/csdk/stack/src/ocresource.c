@@ -44,6 +44,7 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
+#include "trace.h"
 #include "ocpayload.h"
 #include "secureresourcemanager.h"
 #include "cacommon.h"
@@ -57,6 +58,7 @@
 #include "oickeepalive.h"
 #include "ocpayloadcbor.h"
 #include "psinterface.h"
+#include <coap/utlist.h>
 
 #ifdef ROUTING_GATEWAY
 #include "routingmanager.h"
@@ -85,6 +87,29 @@ static const uint16_t CBOR_MAX_SIZE = 4400;
 extern OCResource *headResource;
 extern bool g_multicastServerStopped;
 
+/**
+ * Bucket of the resource type or resource interface index. Holds every type (or interface)
+ * entry of one name, in the order they were bound to their resources.
+ */
+typedef struct ResourceIndexBucket
+{
+    char *name;
+    OCResourceIndexLink *head;
+    UT_hash_handle hh;
+} ResourceIndexBucket;
+
+/** Resources hashed by URI.*/
+static OCResource *g_resourceUriIndex = NULL;
+
+/** Resources hashed by handle.*/
+static OCResource *g_resourceHandleIndex = NULL;
+
+/** Resource type entries bucketed by type name.*/
+static ResourceIndexBucket *g_resourceTypeIndex = NULL;
+
+/** Resource interface entries bucketed by interface name.*/
+static ResourceIndexBucket *g_resourceInterfaceIndex = NULL;
+
 /**
  * Prepares a Payload for response.
  */
@@ -1333,17 +1358,156 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource *pointer = NULL;
+    HASH_FIND(hhUri, g_resourceUriIndex, resourceUri, strlen(resourceUri), pointer);
+    if (!pointer)
+    {
+        OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
+    }
+    return pointer;
+}
+
+OCResource *FindResourceByHandle(const OCResource *handle)
+{
+    if (!handle)
+    {
+        return NULL;
+    }
+
+    OCResource *pointer = NULL;
+    HASH_FIND(hhHandle, g_resourceHandleIndex, &handle, sizeof(handle), pointer);
+    return pointer;
+}
+
+static const OCResourceIndexLink *FindIndexBucket(ResourceIndexBucket *index, const char *name)
+{
+    if (!name)
+    {
+        return NULL;
+    }
+
+    ResourceIndexBucket *bucket = NULL;
+    HASH_FIND_STR(index, name, bucket);
+    return bucket ? bucket->head : NULL;
+}
+
+const OCResourceIndexLink *FindResourcesByType(const char *resourceTypeName)
+{
+    return FindIndexBucket(g_resourceTypeIndex, resourceTypeName);
+}
+
+const OCResourceIndexLink *FindResourcesByInterface(const char *resourceInterfaceName)
+{
+    return FindIndexBucket(g_resourceInterfaceIndex, resourceInterfaceName);
+}
+
+static void AddToIndexBucket(ResourceIndexBucket **index, const char *name,
+                             OCResource *resource, OCResourceIndexLink *link)
+{
+    ResourceIndexBucket *bucket = NULL;
+    HASH_FIND_STR(*index, name, bucket);
+    if (!bucket)
+    {
+        bucket = (ResourceIndexBucket *) OICCalloc(1, sizeof(ResourceIndexBucket));
+        if (!bucket)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to allocate index bucket");
+            return;
+        }
+        bucket->name = OICStrdup(name);
+        if (!bucket->name)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to allocate index bucket");
+            OICFree(bucket);
+            return;
+        }
+        HASH_ADD_KEYPTR(hh, *index, bucket->name, strlen(bucket->name), bucket);
+    }
+
+    link->resource = resource;
+    DL_APPEND(bucket->head, link);
+}
+
+static void RemoveFromIndexBucket(ResourceIndexBucket **index, const char *name,
+                                  OCResourceIndexLink *link)
+{
+    if (!link->resource)
+    {
+        return;
+    }
+
+    ResourceIndexBucket *bucket = NULL;
+    HASH_FIND_STR(*index, name, bucket);
+    if (bucket)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
+        DL_DELETE(bucket->head, link);
+        if (!bucket->head)
         {
-            return pointer;
+            HASH_DELETE(hh, *index, bucket);
+            OICFree(bucket->name);
+            OICFree(bucket);
         }
-        pointer = pointer->next;
     }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    link->resource = NULL;
+    link->prev = NULL;
+    link->next = NULL;
+}
+
+void AddResourceToIndex(OCResource *resource)
+{
+    if (!resource || !resource->uri || resource->self)
+    {
+        return;
+    }
+
+    resource->self = resource;
+    HASH_ADD_KEYPTR(hhUri, g_resourceUriIndex, resource->uri, strlen(resource->uri), resource);
+    HASH_ADD(hhHandle, g_resourceHandleIndex, self, sizeof(resource->self), resource);
+}
+
+void AddResourceTypeToIndex(OCResource *resource, OCResourceType *resourceType)
+{
+    if (!resource || !resourceType || !resourceType->resourcetypename)
+    {
+        return;
+    }
+    AddToIndexBucket(&g_resourceTypeIndex, resourceType->resourcetypename,
+                     resource, &resourceType->indexLink);
+}
+
+void AddResourceInterfaceToIndex(OCResource *resource, OCResourceInterface *resourceInterface)
+{
+    if (!resource || !resourceInterface || !resourceInterface->name)
+    {
+        return;
+    }
+    AddToIndexBucket(&g_resourceInterfaceIndex, resourceInterface->name,
+                     resource, &resourceInterface->indexLink);
+}
+
+void RemoveResourceFromIndex(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    for (OCResourceType *rtPtr = resource->rsrcType; rtPtr; rtPtr = rtPtr->next)
+    {
+        RemoveFromIndexBucket(&g_resourceTypeIndex, rtPtr->resourcetypename,
+                              &rtPtr->indexLink);
+    }
+    for (OCResourceInterface *ifPtr = resource->rsrcInterface; ifPtr; ifPtr = ifPtr->next)
+    {
+        RemoveFromIndexBucket(&g_resourceInterfaceIndex, ifPtr->name, &ifPtr->indexLink);
+    }
+
+    if (resource->self)
+    {
+        HASH_DELETE(hhUri, g_resourceUriIndex, resource);
+        HASH_DELETE(hhHandle, g_resourceHandleIndex, resource);
+        resource->self = NULL;
+    }
 }
 
 OCStackResult CheckRequestsEndpoint(const OCDevAddr *reqDevAddr,
@@ -1583,6 +1747,21 @@ static bool resourceMatchesIFFilter(OCResource *resource, char *interfaceFilter)
     return false;
 }
 
+/**
+ * Step to the next resource to consider for a discovery response, either along the resource
+ * list or, when indexEntry is given, along an index bucket.
+ */
+static OCResource *nextDiscoveryCandidate(OCResource *resource,
+                                          const OCResourceIndexLink **indexEntry)
+{
+    if (indexEntry)
+    {
+        *indexEntry = (*indexEntry)->next;
+        return *indexEntry ? (*indexEntry)->resource : NULL;
+    }
+    return resource->next;
+}
+
 /*
  * If the filters are null, they will be assumed to NOT be present
  * and the resource will not be matched against them.
@@ -1774,6 +1953,26 @@ static bool isUnicast(OCServerRequest *request)
            (request->devAddr.adapter != OC_ADAPTER_GATT_BTLE));
 }
 
+/**
+ * Check if a resource is served by the stack itself, i.e. it is a security resource or
+ * lives under the reserved "/oic/" prefix. Such handlers touch stack state and run
+ * with the stack lock held.
+ *
+ * @param uri Resource URI.
+ * @return true if the resource belongs to the stack.
+ */
+static bool IsStackResourceUri(const char *uri)
+{
+    static const char reservedPrefix[] = "/oic/";
+
+    if (!uri)
+    {
+        return false;
+    }
+    return SRMIsSecurityResourceURI(uri) ||
+           (0 == strncmp(uri, reservedPrefix, sizeof(reservedPrefix) - 1));
+}
+
 static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource* resource)
 {
     if (!request || !resource)
@@ -1875,7 +2074,30 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 #ifdef MQ_BROKER
         prop = (OC_MQ_BROKER_URI == virtualUriInRequest) ? OC_MQ_BROKER : prop;
 #endif
-        for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+        // A type filter, or a filter on an interface other than oic.if.ll and oic.if.baseline
+        // (which every resource implements), only has to visit the resources in the matching
+        // index bucket instead of every resource on the device.
+        const OCResourceIndexLink *indexEntry = NULL;
+        bool useIndex = false;
+        if (resourceTypeQuery && *resourceTypeQuery)
+        {
+            indexEntry = FindResourcesByType(resourceTypeQuery);
+            useIndex = true;
+        }
+        else if (interfaceQuery && *interfaceQuery
+                 && 0 != strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)
+                 && 0 != strcmp(interfaceQuery, OC_RSRVD_INTERFACE_DEFAULT))
+        {
+            indexEntry = FindResourcesByInterface(interfaceQuery);
+            useIndex = true;
+        }
+        if (useIndex)
+        {
+            resource = indexEntry ? indexEntry->resource : NULL;
+        }
+
+        for (; resource && discoveryResult == OC_STACK_OK;
+             resource = nextDiscoveryCandidate(resource, useIndex ? &indexEntry : NULL))
         {
             // This case will handle when no resource type and it is oic.if.ll.
             // Do not assume check if the query is ll
@@ -2051,9 +2273,12 @@ HandleDefaultDeviceEntityHandler(OCServerRequest *request)
     OCStackResult result = EHRequest(&ehRequest, PAYLOAD_TYPE_REPRESENTATION, request, NULL);
     VERIFY_SUCCESS(result);
 
-    // At this point we know for sure that defaultDeviceHandler exists
+    // At this point we know for sure that defaultDeviceHandler exists.
+    // It is always set by the application, so the stack lock is released while it runs.
+    OCStackUnlock();
     ehResult = defaultDeviceHandler(OC_REQUEST_FLAG, &ehRequest,
                                   (char*) request->resourceUrl, defaultDeviceHandlerCallbackParameter);
+    OCStackLock();
     if(ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
@@ -2196,7 +2421,23 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
         goto exit;
     }
 
-    ehResult = resource->entityHandler(ehFlag, &ehRequest, resource->entityHandlerCallbackParam);
+    // The stack lock is released while an application handler runs, so handlers of requests
+    // from different peers can run concurrently on the receive workers. Stack and security
+    // handlers work on stack state and keep the lock.
+    OCEntityHandler entityHandler = resource->entityHandler;
+    void *entityHandlerCallbackParam = resource->entityHandlerCallbackParam;
+    bool stackHandler = IsStackResourceUri(resource->uri);
+    if (!stackHandler)
+    {
+        OCStackUnlock();
+    }
+    OIC_TRACE_BEGIN(%s:EntityHandler %s, TAG, request->resourceUrl);
+    ehResult = entityHandler(ehFlag, &ehRequest, entityHandlerCallbackParam);
+    OIC_TRACE_END();
+    if (!stackHandler)
+    {
+        OCStackLock();
+    }
     if(ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
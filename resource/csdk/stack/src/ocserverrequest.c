@@ -25,9 +25,12 @@
 #include "ocobserve.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "ocmetrics.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 #include "logger.h"
+#include "trace.h"
 
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
 #include "routingutility.h"
@@ -62,6 +65,25 @@ RB_HEAD(ServerResponseTree, OCServerResponse) serverResponseTree =
                                                             RB_INITIALIZER(&serverResponseTree);
 RB_GENERATE(ServerResponseTree, OCServerResponse, entry, RBResponseTokenCmp)
 
+/**
+ * Room in a pooled request arena after the request itself, for the payload,
+ * the token and the response.
+ */
+#ifdef WITH_ARDUINO
+#define REQUEST_ARENA_HEADROOM (128)
+#else
+#define REQUEST_ARENA_HEADROOM (2048)
+#endif
+
+/**
+ * Pool of the arenas holding server requests. Released arenas keep their first
+ * block, so requests are served without calls to malloc once the pool is warm.
+ * A thread first reuses the arena it released last, without the pool lock.
+ * Requests with a large payload get an arena of their own size, which is not
+ * kept.
+ */
+static OICArenaPool_t *g_requestArenaPool = NULL;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
@@ -111,8 +133,9 @@ static void DeleteServerRequest(OCServerRequest * serverRequest)
     if(serverRequest)
     {
         RB_REMOVE(ServerRequestTree, &serverRequestTree, serverRequest);
-        OICFree(serverRequest->requestToken);
-        OICFree(serverRequest);
+        OICFree(serverRequest->fanOutTargets);
+        // The request, its token and its response data all live in the arena.
+        OICArenaRelease(serverRequest->arena);
         serverRequest = NULL;
         OIC_LOG(INFO, TAG, "Server Request Removed!!");
     }
@@ -158,7 +181,9 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
 
     // Do not include the accept header option
     responseInfo->info.acceptFormat = CA_FORMAT_UNDEFINED;
+    OIC_TRACE_BEGIN(%s:CASendResponse, TAG);
     CAResult_t result = CASendResponse(object, responseInfo);
+    OIC_TRACE_END();
     if(CA_STATUS_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "CASendResponse failed with CA error %u", result);
@@ -271,14 +296,19 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
     }
 
     OCServerRequest * serverRequest = NULL;
+    OICArena_t *arena = NULL;
 
+    VERIFY_NON_NULL(devAddr);
     OIC_LOG_V(INFO, TAG, "addserverrequest entry!! [%s:%u]", devAddr->addr, devAddr->port);
 
-    serverRequest = (OCServerRequest *) OICCalloc(1, sizeof(OCServerRequest) +
+    arena = AcquireRequestArena(sizeof(OCServerRequest) + reqTotalSize + tokenLength);
+    VERIFY_NON_NULL(arena);
+    serverRequest = (OCServerRequest *) OICArenaCalloc(arena, 1, sizeof(OCServerRequest) +
         (reqTotalSize ? reqTotalSize : 1) - 1);
-    VERIFY_NON_NULL(devAddr);
     VERIFY_NON_NULL(serverRequest);
 
+    serverRequest->arena = arena;
+    serverRequest->receivedTime = OICGetCurrentTime(TIME_IN_US);
     serverRequest->coapID = coapID;
     serverRequest->delayedResNeeded = delayedResNeeded;
     serverRequest->notificationFlag = notificationFlag;
@@ -318,7 +348,7 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
         // particular library implementation (it may or may not be a null pointer).
         if (tokenLength)
         {
-            serverRequest->requestToken = (CAToken_t) OICMalloc(tokenLength);
+            serverRequest->requestToken = (CAToken_t) OICArenaMalloc(arena, tokenLength);
             VERIFY_NON_NULL(serverRequest->requestToken);
             memcpy(serverRequest->requestToken, requestToken, tokenLength);
         }
@@ -336,15 +366,15 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
     *request = serverRequest;
 
     RB_INSERT(ServerRequestTree, &serverRequestTree, serverRequest);
+    if (!notificationFlag)
+    {
+        OCMetricAdd(OC_METRIC_SERVER_REQUESTS, 1);
+    }
     OIC_LOG(INFO, TAG, "Server Request Added!!");
     return OC_STACK_OK;
 
 exit:
-    if (serverRequest)
-    {
-        OICFree(serverRequest);
-        serverRequest = NULL;
-    }
+    OICArenaRelease(arena);
     *request = NULL;
     return OC_STACK_NO_MEMORY;
 }
@@ -398,6 +428,28 @@ OCStackResult FormOCEntityHandlerRequest(
     return OC_STACK_INVALID_PARAM;
 }
 
+OCStackResult InitServerRequestArenaPool()
+{
+    if (!g_requestArenaPool)
+    {
+        g_requestArenaPool = OICArenaPoolCreate(sizeof(OCServerRequest) + REQUEST_ARENA_HEADROOM,
+                                                OIC_ARENA_DEFAULT_POOL_SIZE);
+    }
+    return g_requestArenaPool ? OC_STACK_OK : OC_STACK_NO_MEMORY;
+}
+
+void TerminateServerRequestArenaPool()
+{
+    OICArenaPoolDestroy(g_requestArenaPool);
+    g_requestArenaPool = NULL;
+}
+
+OICArena_t *AcquireRequestArena(size_t requestSize)
+{
+    // Without a pool, e.g. before OCInit, the arena is simply freed on release.
+    return OICArenaAcquireSized(g_requestArenaPool, requestSize);
+}
+
 /**
  * Find a server request in the server request list and delete
  *
@@ -487,6 +539,161 @@ CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult result, OCMe
 }
 
 
+/**
+ * Send a response on the adapter of the endpoint, or on every adapter if the endpoint
+ * uses the default adapter.
+ *
+ * @param responseEndpoint - endpoint to send the response to
+ * @param responseInfo - response to send
+ *
+ * @return
+ *     OCStackResult
+ */
+static OCStackResult SendSingleResponse(CAEndpoint_t *responseEndpoint,
+                                        CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_ERROR;
+
+#ifdef WITH_PRESENCE
+    CATransportAdapter_t CAConnTypes[] = {
+                            CA_ADAPTER_IP,
+                            CA_ADAPTER_GATT_BTLE,
+                            CA_ADAPTER_RFCOMM_BTEDR,
+                            CA_ADAPTER_NFC
+#ifdef RA_ADAPTER
+                            , CA_ADAPTER_REMOTE_ACCESS
+#endif
+                            , CA_ADAPTER_TCP
+                        };
+
+    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+
+    CATransportAdapter_t adapter = responseEndpoint->adapter;
+    // Default adapter, try to send response out on all adapters.
+    if (adapter == CA_DEFAULT_ADAPTER)
+    {
+        adapter =
+            (CATransportAdapter_t)(
+                CA_ADAPTER_IP           |
+                CA_ADAPTER_GATT_BTLE    |
+                CA_ADAPTER_RFCOMM_BTEDR |
+                CA_ADAPTER_NFC
+#ifdef RA_ADAP
+                | CA_ADAPTER_REMOTE_ACCESS
+#endif
+                | CA_ADAPTER_TCP
+            );
+    }
+
+    result = OC_STACK_OK;
+    OCStackResult tempResult = OC_STACK_OK;
+
+    for(size_t i = 0; i < size; i++ )
+    {
+        responseEndpoint->adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
+        if(responseEndpoint->adapter)
+        {
+            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
+            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
+            tempResult = OCSendResponse(responseEndpoint, responseInfo);
+        }
+        if(OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+#else
+
+    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
+    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint->addr);
+    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint->adapter);
+    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo->result);
+    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo->info.resourceUri);
+
+    result = OCSendResponse(responseEndpoint, responseInfo);
+#endif
+
+    return result;
+}
+
+/**
+ * Send a copy of a notification to every fan-out observer of the server request.
+ * Only the token and the message type differ between the copies.
+ *
+ * @param serverRequest - server request carrying the fan-out observers
+ * @param responseInfo - response already holding the encoded payload
+ *
+ * @return
+ *     OCStackResult
+ */
+static OCStackResult SendFanOutResponse(const OCServerRequest *serverRequest,
+                                        CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_OK;
+
+    OIC_LOG_V(INFO, TAG, "Sending notification to %zu observers",
+              serverRequest->numFanOutTargets);
+
+    for (size_t i = 0; i < serverRequest->numFanOutTargets; i++)
+    {
+        OCObserveFanOutTarget *target = &serverRequest->fanOutTargets[i];
+        CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
+
+        CopyDevAddrToEndpoint(&target->devAddr, &responseEndpoint);
+        responseInfo->info.type = (target->qos == OC_HIGH_QOS) ? CA_MSG_CONFIRM :
+                                                                 CA_MSG_NONCONFIRM;
+        responseInfo->info.token = (CAToken_t)target->token;
+        responseInfo->info.tokenLength = target->tokenLength;
+
+        OCStackResult tempResult = SendSingleResponse(&responseEndpoint, responseInfo);
+        if (OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+    return result;
+}
+
+/**
+ * Encode a response payload into the arena of its request. If the arena cannot
+ * provide the buffer, the payload is encoded on the heap and returned in heapPayload
+ * as well, so that the caller can free it.
+ */
+static OCStackResult ConvertResponsePayload(OICArena_t *arena, OCPayload *payload,
+                                            CAPayload_t *outPayload, size_t *outSize,
+                                            uint8_t **heapPayload)
+{
+    OCStackResult result = OC_STACK_NO_MEMORY;
+    size_t size = OCEstimatePayloadSize(payload);
+    uint8_t *buffer = (uint8_t *) OICArenaMalloc(arena, size);
+
+    // The estimate is an upper bound for most payloads; the retry covers the rest.
+    for (int attempt = 0; buffer && attempt < 2; attempt++)
+    {
+        result = OCConvertPayloadToBuffer(payload, buffer, &size);
+        if (OC_STACK_NO_MEMORY != result)
+        {
+            break;
+        }
+        buffer = (uint8_t *) OICArenaMalloc(arena, size);
+    }
+
+    if (OC_STACK_OK == result)
+    {
+        *outPayload = buffer;
+        *outSize = size;
+        return OC_STACK_OK;
+    }
+    if (OC_STACK_NO_MEMORY != result)
+    {
+        return result;
+    }
+
+    result = OCConvertPayload(payload, heapPayload, outSize);
+    *outPayload = *heapPayload;
+    return result;
+}
+
 /**
  * Handler function for sending a response from a single resource
  *
@@ -501,6 +708,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
     CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
     CAHeaderOption_t* optionsPointer = NULL;
+    uint8_t *heapPayload = NULL;
 
     if(!ehResponse || !ehResponse->requestHandle)
     {
@@ -566,8 +774,10 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
 
     if(responseInfo.info.numOptions > 0)
     {
+        // The response data is released together with the request right after sending.
         responseInfo.info.options = (CAHeaderOption_t *)
-                                      OICCalloc(responseInfo.info.numOptions,
+                                      OICArenaCalloc(serverRequest->arena,
+                                              responseInfo.info.numOptions,
                                               sizeof(CAHeaderOption_t));
 
         if(!responseInfo.info.options)
@@ -633,12 +843,12 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                 // No preference set by the client, so default to CBOR then
             case OC_FORMAT_CBOR:
             case OC_FORMAT_VND_OCF_CBOR:
-                if((result = OCConvertPayload(ehResponse->payload, &responseInfo.info.payload,
-                                &responseInfo.info.payloadSize))
+                if((result = ConvertResponsePayload(serverRequest->arena, ehResponse->payload,
+                                &responseInfo.info.payload, &responseInfo.info.payloadSize,
+                                &heapPayload))
                         != OC_STACK_OK)
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
-                    OICFree(responseInfo.info.options);
                     return result;
                 }
                 // Add CONTENT_FORMAT OPT if payload exist
@@ -665,67 +875,23 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         }
     }
 
-#ifdef WITH_PRESENCE
-    CATransportAdapter_t CAConnTypes[] = {
-                            CA_ADAPTER_IP,
-                            CA_ADAPTER_GATT_BTLE,
-                            CA_ADAPTER_RFCOMM_BTEDR,
-                            CA_ADAPTER_NFC
-#ifdef RA_ADAPTER
-                            , CA_ADAPTER_REMOTE_ACCESS
-#endif
-                            , CA_ADAPTER_TCP
-                        };
-
-    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
-
-    CATransportAdapter_t adapter = responseEndpoint.adapter;
-    // Default adapter, try to send response out on all adapters.
-    if (adapter == CA_DEFAULT_ADAPTER)
+    if (serverRequest->fanOutTargets)
     {
-        adapter =
-            (CATransportAdapter_t)(
-                CA_ADAPTER_IP           |
-                CA_ADAPTER_GATT_BTLE    |
-                CA_ADAPTER_RFCOMM_BTEDR |
-                CA_ADAPTER_NFC
-#ifdef RA_ADAP
-                | CA_ADAPTER_REMOTE_ACCESS
-#endif
-                | CA_ADAPTER_TCP
-            );
+        result = SendFanOutResponse(serverRequest, &responseInfo);
     }
-
-    result = OC_STACK_OK;
-    OCStackResult tempResult = OC_STACK_OK;
-
-    for(size_t i = 0; i < size; i++ )
+    else
     {
-        responseEndpoint.adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
-        if(responseEndpoint.adapter)
-        {
-            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
-            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
-            tempResult = OCSendResponse(&responseEndpoint, &responseInfo);
-        }
-        if(OC_STACK_OK != tempResult)
-        {
-            result = tempResult;
-        }
+        result = SendSingleResponse(&responseEndpoint, &responseInfo);
     }
-#else
 
-    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
-    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint.addr);
-    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint.adapter);
-    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo.result);
-    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo.info.resourceUri);
-
-    result = OCSendResponse(&responseEndpoint, &responseInfo);
-#endif
+    if (OC_STACK_OK == result && !serverRequest->notificationFlag)
+    {
+        OCMetricAdd(OC_METRIC_SERVER_RESPONSES, 1);
+        OCMetricRecord(OC_METRIC_ENTITY_HANDLER_LATENCY_US,
+                       OICGetCurrentTime(TIME_IN_US) - serverRequest->receivedTime);
+    }
 
-    OICFree(responseInfo.info.payload);
-    OICFree(responseInfo.info.options);
+    OICFree(heapPayload);
     //Delete the request
     FindAndDeleteServerRequest(serverRequest);
     return result;
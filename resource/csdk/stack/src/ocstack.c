@@ -69,6 +69,7 @@
 #include "oicgroup.h"
 #include "ocendpoint.h"
 #include "ocatomic.h"
+#include "octhread.h"
 #include "platform_features.h"
 
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
@@ -161,6 +162,8 @@ CAAdapterStateChangedCB g_adapterHandler = NULL;
 CAConnectionStateChangedCB g_connectionHandler = NULL;
 // Persistent Storage callback handler for open/read/write/close/unlink
 static OCPersistentStorage *g_PersistentStorageHandler = NULL;
+// Optional persistent storage journal open handler
+static OCPersistentStorageJournalHandler g_PersistentStorageJournalHandler = NULL;
 // Number of users of OCStack, based on the successful calls to OCInit2 prior to OCStop
 // The variable must not be declared static because it is also referenced by the unit test
 uint32_t g_ocStackStartCount = 0;
@@ -169,6 +172,17 @@ volatile int32_t g_ocStackStartStopThreadCount = 0;
 
 bool g_multicastServerStopped = false;
 
+// Number of CA receive workers requested through OCSetReceiveWorkerCount
+static uint8_t g_receiveWorkerCount = 0;
+// Recursive lock serializing the stack state, only created when receive workers are used
+static oc_mutex g_stackMutex = NULL;
+// Set while received messages may be dispatched into the stack from the receive workers
+static bool g_receiveDispatchEnabled = false;
+// Handlers wrapped by the stack lock when receive workers are used
+static CARequestCallback g_lockedRequestHandler = NULL;
+static CAResponseCallback g_lockedResponseHandler = NULL;
+static CAErrorCallback g_lockedErrorHandler = NULL;
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -471,6 +485,13 @@ static OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFl
  */
 static OCStackResult OCDeInitializeInternal();
 
+/**
+ * Register request, response and error handlers with CA that take the stack lock before
+ * forwarding to the handlers the stack would otherwise register. Used when receive workers
+ * are enabled, so messages from different peers are dispatched into the stack safely.
+ */
+static void OCRegisterLockedHandlers();
+
 //-----------------------------------------------------------------------------
 // Internal functions
 //-----------------------------------------------------------------------------
@@ -1806,8 +1827,8 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    UpdateClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                       MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -2159,6 +2180,50 @@ OCStackResult HandleStackRequests(OCServerProtocolRequest * protocolRequest)
     return result;
 }
 
+/**
+ * Split a request URI into the resource path and the query of a server request.
+ * Both are copied straight into the fixed size fields of the request.
+ *
+ * @param uri       Request URI, with an optional query after '?'.
+ * @param request   Server request to fill in.
+ *
+ * @return true on success, false if the path is empty or either part is too long.
+ */
+static bool SplitRequestUri(const char *uri, OCServerProtocolRequest *request)
+{
+    if (!uri)
+    {
+        OIC_LOG(ERROR, TAG, "Request URI is NULL");
+        return false;
+    }
+
+    const char *delimiter = strchr(uri, '?');
+    size_t uriLen = delimiter ? (size_t)(delimiter - uri) : strlen(uri);
+    if (0 == uriLen)
+    {
+        OIC_LOG(ERROR, TAG, "Request URI has no path");
+        return false;
+    }
+    if (uriLen >= MAX_URI_LENGTH)
+    {
+        OIC_LOG(ERROR, TAG, "URI length exceeds MAX_URI_LENGTH.");
+        return false;
+    }
+    memcpy(request->resourceUrl, uri, uriLen);
+    request->resourceUrl[uriLen] = '\0';
+
+    if (delimiter)
+    {
+        if (strlen(delimiter + 1) >= MAX_QUERY_LENGTH)
+        {
+            OIC_LOG(ERROR, TAG, "Query length exceeds MAX_QUERY_LENGTH.");
+            return false;
+        }
+        OICStrcpy(request->query, sizeof(request->query), delimiter + 1);
+    }
+    return true;
+}
+
 void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* requestInfo)
 {
     OIC_LOG(DEBUG, TAG, "Enter OCHandleRequests");
@@ -2176,60 +2241,23 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     directResponseType = (directResponseType == CA_MSG_CONFIRM)
             ? CA_MSG_ACKNOWLEDGE : CA_MSG_NONCONFIRM;
 
-    char * uriWithoutQuery = NULL;
-    char * query = NULL;
-    OCStackResult requestResult = OC_STACK_ERROR;
-
-    requestResult = getQueryFromUri(requestInfo->info.resourceUri, &query, &uriWithoutQuery);
-
-    if (requestResult != OC_STACK_OK || !uriWithoutQuery)
-    {
-        OIC_LOG_V(ERROR, TAG, "getQueryFromUri() failed with OC error code %d\n", requestResult);
-        return;
-    }
-    OIC_LOG_V(INFO, TAG, "URI without query: %s", uriWithoutQuery);
-    OIC_LOG_V(INFO, TAG, "Query : %s", query);
-
     OCServerProtocolRequest serverRequest = { 0 };
-    if (strlen(uriWithoutQuery) < MAX_URI_LENGTH)
-    {
-        OICStrcpy(serverRequest.resourceUrl, sizeof(serverRequest.resourceUrl), uriWithoutQuery);
-        OICFree(uriWithoutQuery);
-    }
-    else
+    if (!SplitRequestUri(requestInfo->info.resourceUri, &serverRequest))
     {
-        OIC_LOG(ERROR, TAG, "URI length exceeds MAX_URI_LENGTH.");
-        OICFree(uriWithoutQuery);
-        OICFree(query);
         return;
     }
+    OIC_LOG_V(INFO, TAG, "URI without query: %s", serverRequest.resourceUrl);
+    OIC_LOG_V(INFO, TAG, "Query : %s", serverRequest.query);
 
-    if (query)
-    {
-        if (strlen(query) < MAX_QUERY_LENGTH)
-        {
-            OICStrcpy(serverRequest.query, sizeof(serverRequest.query), query);
-            OICFree(query);
-        }
-        else
-        {
-            OIC_LOG(ERROR, TAG, "Query length exceeds MAX_QUERY_LENGTH.");
-            OICFree(query);
-            return;
-        }
-    }
+    OCStackResult requestResult = OC_STACK_ERROR;
 
+    // The payload and the token are only read until this function returns, and
+    // AddServerRequest copies them into the arena of the request, so they are
+    // not copied here.
     if ((requestInfo->info.payload) && (0 < requestInfo->info.payloadSize))
     {
         serverRequest.reqTotalSize = requestInfo->info.payloadSize;
-        serverRequest.payload = (uint8_t *) OICMalloc(requestInfo->info.payloadSize);
-        if (!serverRequest.payload)
-        {
-            OIC_LOG(ERROR, TAG, "Allocation for payload failed.");
-            return;
-        }
-        memcpy (serverRequest.payload, requestInfo->info.payload,
-                requestInfo->info.payloadSize);
+        serverRequest.payload = requestInfo->info.payload;
     }
     else
     {
@@ -2257,7 +2285,6 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                                     requestInfo->info.options, requestInfo->info.token,
                                     requestInfo->info.tokenLength, requestInfo->info.resourceUri,
                                     CA_RESPONSE_DATA);
-            OICFree(serverRequest.payload);
             return;
     }
 
@@ -2268,20 +2295,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     if (serverRequest.tokenLength)
     {
         // Non empty token
-        serverRequest.requestToken = (CAToken_t)OICMalloc(requestInfo->info.tokenLength);
-
-        if (!serverRequest.requestToken)
-        {
-            OIC_LOG(FATAL, TAG, "Allocation for token failed.");
-            SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_INTERNAL_SERVER_ERROR,
-                                    directResponseType, requestInfo->info.numOptions,
-                                    requestInfo->info.options, requestInfo->info.token,
-                                    requestInfo->info.tokenLength, requestInfo->info.resourceUri,
-                                    CA_RESPONSE_DATA);
-            OICFree(serverRequest.payload);
-            return;
-        }
-        memcpy(serverRequest.requestToken, requestInfo->info.token, requestInfo->info.tokenLength);
+        serverRequest.requestToken = requestInfo->info.token;
     }
 
     switch (requestInfo->info.acceptFormat)
@@ -2333,8 +2347,6 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                                 requestInfo->info.options, requestInfo->info.token,
                                 requestInfo->info.tokenLength, requestInfo->info.resourceUri,
                                 CA_RESPONSE_DATA);
-        OICFree(serverRequest.payload);
-        OICFree(serverRequest.requestToken);
         return;
     }
     serverRequest.numRcvdVendorSpecificHeaderOptions = tempNum;
@@ -2374,9 +2386,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                                 CA_RESPONSE_DATA);
     }
     // requestToken is fed to HandleStackRequests, which then goes to AddServerRequest.
-    // The token is copied in there, and is thus still owned by this function.
-    OICFree(serverRequest.payload);
-    OICFree(serverRequest.requestToken);
+    // The token is copied in there, and is thus still owned by the caller.
     OIC_LOG(INFO, TAG, "Exit OCHandleRequests");
 }
 
@@ -2448,7 +2458,9 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
 #endif
     {
         // Normal handling of the packet
+        OIC_TRACE_BEGIN(%s:OCHandleRequests, TAG);
         OCHandleRequests(endPoint, requestInfo);
+        OIC_TRACE_END();
     }
     OIC_LOG(INFO, TAG, "Exit HandleCARequests");
     OIC_TRACE_END();
@@ -2516,6 +2528,104 @@ OCStackResult OCInit2(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
     return result;
 }
 
+OCStackResult OCSetReceiveWorkerCount(uint8_t workerCount)
+{
+    if (workerCount > CA_MAX_RECEIVE_WORKERS)
+    {
+        OIC_LOG_V(ERROR, TAG, "Receive worker count %u exceeds %u",
+                  workerCount, CA_MAX_RECEIVE_WORKERS);
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCEnterInitializer();
+
+    OCStackResult result = OC_STACK_OK;
+    if (stackState == OC_STACK_INITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "Receive workers must be set before the stack is initialized");
+        result = OC_STACK_ERROR;
+    }
+    else
+    {
+        g_receiveWorkerCount = workerCount;
+    }
+
+    OCLeaveInitializer();
+    return result;
+}
+
+void OCStackLock(void)
+{
+    if (g_stackMutex)
+    {
+        oc_mutex_lock(g_stackMutex);
+    }
+}
+
+void OCStackUnlock(void)
+{
+    if (g_stackMutex)
+    {
+        oc_mutex_unlock(g_stackMutex);
+    }
+}
+
+static void HandleCARequestsLocked(const CAEndpoint_t* endPoint,
+                                   const CARequestInfo_t* requestInfo)
+{
+    OCStackLock();
+    if (g_receiveDispatchEnabled)
+    {
+        g_lockedRequestHandler(endPoint, requestInfo);
+    }
+    OCStackUnlock();
+}
+
+static void HandleCAResponsesLocked(const CAEndpoint_t* endPoint,
+                                    const CAResponseInfo_t* responseInfo)
+{
+    OCStackLock();
+    if (g_receiveDispatchEnabled)
+    {
+        g_lockedResponseHandler(endPoint, responseInfo);
+    }
+    OCStackUnlock();
+}
+
+static void HandleCAErrorResponseLocked(const CAEndpoint_t* endPoint,
+                                        const CAErrorInfo_t* errorInfo)
+{
+    OCStackLock();
+    if (g_receiveDispatchEnabled)
+    {
+        g_lockedErrorHandler(endPoint, errorInfo);
+    }
+    OCStackUnlock();
+}
+
+void OCRegisterLockedHandlers()
+{
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    if (OC_CLIENT != myStackMode)
+    {
+        // SRMRegisterHandler already stored the stack handlers, keep SRM in front of them.
+        g_lockedRequestHandler = SRMRequestHandler;
+        g_lockedResponseHandler = SRMResponseHandler;
+        g_lockedErrorHandler = SRMErrorHandler;
+    }
+    else
+#endif
+    {
+        g_lockedRequestHandler = HandleCARequests;
+        g_lockedResponseHandler = HandleCAResponses;
+        g_lockedErrorHandler = HandleCAErrorResponse;
+    }
+
+    g_receiveDispatchEnabled = true;
+    CARegisterHandler(HandleCARequestsLocked, HandleCAResponsesLocked,
+                      HandleCAErrorResponseLocked);
+}
+
 OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
                                    OCTransportFlags clientFlags, OCTransportAdapter transportType)
 {
@@ -2580,6 +2690,23 @@ OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
     result = InitializeScheduleResourceList();
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
+    result = InitServerRequestArenaPool();
+    VERIFY_SUCCESS(result, OC_STACK_OK);
+
+    if (g_receiveWorkerCount > 0)
+    {
+        g_stackMutex = oc_mutex_new_recursive();
+        if (!g_stackMutex)
+        {
+            OIC_LOG(FATAL, TAG, "Failed to create the stack lock");
+            result = OC_STACK_NO_MEMORY;
+            goto exit;
+        }
+    }
+
+    result = CAResultToOCResult(CASetReceiveWorkerCount(g_receiveWorkerCount));
+    VERIFY_SUCCESS(result, OC_STACK_OK);
+
     result = CAResultToOCResult(CAInitialize((CATransportAdapter_t)transportType));
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
@@ -2614,6 +2741,11 @@ OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
     }
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
+    if (g_stackMutex)
+    {
+        OCRegisterLockedHandlers();
+    }
+
 #ifdef TCP_ADAPTER
     CARegisterKeepAliveHandler(HandleKeepAliveConnCB);
 #endif
@@ -2662,7 +2794,14 @@ exit:
         OIC_LOG(ERROR, TAG, "Stack initialization error");
         TerminateScheduleResourceList();
         deleteAllResources();
+        g_receiveDispatchEnabled = false;
         CATerminate();
+        TerminateServerRequestArenaPool();
+        if (g_stackMutex)
+        {
+            oc_mutex_free(g_stackMutex);
+            g_stackMutex = NULL;
+        }
         stackState = OC_STACK_UNINITIALIZED;
     }
     return result;
@@ -2728,6 +2867,9 @@ OCStackResult OCDeInitializeInternal()
         OIC_LOG(ERROR, TAG, "CAUnregisterNetworkMonitorHandler has failed");
     }
 
+    // Receive workers may still be dispatching, stop them from entering the stack first.
+    OCStackLock();
+    g_receiveDispatchEnabled = false;
     TerminateScheduleResourceList();
     // Remove all observers
     DeleteObserverList();
@@ -2735,8 +2877,18 @@ OCStackResult OCDeInitializeInternal()
     deleteAllResources();
     // Remove all the client callbacks
     DeleteClientCBList();
-    // Terminate connectivity-abstraction layer.
+    OCStackUnlock();
+    // Terminate connectivity-abstraction layer. The receive workers are joined here, so the
+    // stack lock must not be held.
     CATerminate();
+    // Arenas of requests still pending keep the pool alive until they are released.
+    TerminateServerRequestArenaPool();
+
+    if (g_stackMutex)
+    {
+        oc_mutex_free(g_stackMutex);
+        g_stackMutex = NULL;
+    }
 
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
     // Terminate the Connection Manager
@@ -3055,7 +3207,7 @@ OCStackResult OCDoResource(OCDoHandle *handle,
 /**
  * Discover or Perform requests on a specified resource
  */
-OCStackResult OCDoRequest(OCDoHandle *handle,
+static OCStackResult OCDoRequestInternal(OCDoHandle *handle,
                             OCMethod method,
                             const char *requestUri,
                             const OCDevAddr *destination,
@@ -3354,8 +3506,26 @@ exit:
     return result;
 }
 
-OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption * options,
-        uint8_t numOptions)
+OCStackResult OCDoRequest(OCDoHandle *handle,
+                            OCMethod method,
+                            const char *requestUri,
+                            const OCDevAddr *destination,
+                            OCPayload* payload,
+                            OCConnectivityType connectivityType,
+                            OCQualityOfService qos,
+                            OCCallbackData *cbData,
+                            OCHeaderOption *options,
+                            uint8_t numOptions)
+{
+    OCStackLock();
+    OCStackResult result = OCDoRequestInternal(handle, method, requestUri, destination, payload,
+                                               connectivityType, qos, cbData, options, numOptions);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult OCCancelInternal(OCDoHandle handle, OCQualityOfService qos,
+        OCHeaderOption * options, uint8_t numOptions)
 {
     /*
      * This ftn is implemented one of two ways in the case of observation:
@@ -3453,6 +3623,15 @@ OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption
     return ret;
 }
 
+OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption * options,
+        uint8_t numOptions)
+{
+    OCStackLock();
+    OCStackResult result = OCCancelInternal(handle, qos, options, numOptions);
+    OCStackUnlock();
+    return result;
+}
+
 /**
  * @brief   Register Persistent storage callback.
  * @param   persistentStorageHandler [IN] Pointers to open, read, write, close & unlink handlers.
@@ -3484,6 +3663,24 @@ OCPersistentStorage *OCGetPersistentStorageHandler()
     return g_PersistentStorageHandler;
 }
 
+/**
+ * @brief   Register Persistent storage journal callback.
+ * @param   journalHandler [IN] Journal open handler, or NULL.
+ * @return
+ *     OC_STACK_OK    - No errors; Success
+ */
+OCStackResult OCRegisterPersistentStorageJournalHandler(OCPersistentStorageJournalHandler journalHandler)
+{
+    OIC_LOG(INFO, TAG, "RegisterPersistentStorageJournalHandler !!");
+    g_PersistentStorageJournalHandler = journalHandler;
+    return OC_STACK_OK;
+}
+
+OCPersistentStorageJournalHandler OCGetPersistentStorageJournalHandler()
+{
+    return g_PersistentStorageJournalHandler;
+}
+
 #ifdef WITH_PRESENCE
 
 OCStackResult OCProcessPresence()
@@ -3582,7 +3779,7 @@ exit:
 }
 #endif // WITH_PRESENCE
 
-OCStackResult OCProcess()
+static OCStackResult OCProcessInternal()
 {
     if (stackState == OC_STACK_UNINITIALIZED)
     {
@@ -3593,6 +3790,7 @@ OCStackResult OCProcess()
     OCProcessPresence();
 #endif
     CAHandleRequestResponse();
+    DeleteTimedOutClientCBs();
 
 #ifdef ROUTING_GATEWAY
     RMProcess();
@@ -3604,8 +3802,16 @@ OCStackResult OCProcess()
     return OC_STACK_OK;
 }
 
+OCStackResult OCProcess()
+{
+    OCStackLock();
+    OCStackResult result = OCProcessInternal();
+    OCStackUnlock();
+    return result;
+}
+
 #ifdef WITH_PRESENCE
-OCStackResult OCStartPresence(const uint32_t ttl)
+static OCStackResult OCStartPresenceInternal(const uint32_t ttl)
 {
     OIC_LOG(INFO, TAG, "Entering OCStartPresence");
     uint8_t tokenLength = CA_MAX_TOKEN_LEN;
@@ -3658,7 +3864,15 @@ OCStackResult OCStartPresence(const uint32_t ttl)
             OC_PRESENCE_TRIGGER_CREATE);
 }
 
-OCStackResult OCStopPresence()
+OCStackResult OCStartPresence(const uint32_t ttl)
+{
+    OCStackLock();
+    OCStackResult result = OCStartPresenceInternal(ttl);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult OCStopPresenceInternal()
 {
     OIC_LOG(INFO, TAG, "Entering OCStopPresence");
     OCStackResult result = OC_STACK_ERROR;
@@ -3682,13 +3896,23 @@ OCStackResult OCStopPresence()
 
     return SendStopNotification();
 }
+
+OCStackResult OCStopPresence()
+{
+    OCStackLock();
+    OCStackResult result = OCStopPresenceInternal();
+    OCStackUnlock();
+    return result;
+}
 #endif
 
 OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandler,
                                             void* callbackParameter)
 {
+    OCStackLock();
     defaultDeviceHandler = entityHandler;
     defaultDeviceHandlerCallbackParameter = callbackParameter;
+    OCStackUnlock();
 
     return OC_STACK_OK;
 }
@@ -3714,7 +3938,7 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
                                   OC_ALL);
 }
 
-OCStackResult OCCreateResourceWithEp(OCResourceHandle *handle,
+static OCStackResult OCCreateResourceWithEpInternal(OCResourceHandle *handle,
         const char *resourceTypeName,
         const char *resourceInterfaceName,
         const char *uri, OCEntityHandler entityHandler,
@@ -3756,7 +3980,7 @@ OCStackResult OCCreateResourceWithEp(OCResourceHandle *handle,
     // Make sure resourceProperties bitmask has allowed properties specified
     if (resourceProperties
             > (OC_ACTIVE | OC_DISCOVERABLE | OC_OBSERVABLE | OC_SLOW | OC_SECURE |
-               OC_EXPLICIT_DISCOVERABLE
+               OC_EXPLICIT_DISCOVERABLE | OC_OBSERVE_FANOUT
 #ifdef MQ_PUBLISHER
                | OC_MQ_PUBLISHER
 #endif
@@ -3798,21 +4022,11 @@ OCStackResult OCCreateResourceWithEp(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (FindResourceByUri(uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
@@ -3832,6 +4046,7 @@ OCStackResult OCCreateResourceWithEp(OCResourceHandle *handle,
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
+    AddResourceToIndex(pointer);
 
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
@@ -3895,7 +4110,24 @@ exit:
     return result;
 }
 
-OCStackResult OCBindResource(
+OCStackResult OCCreateResourceWithEp(OCResourceHandle *handle,
+        const char *resourceTypeName,
+        const char *resourceInterfaceName,
+        const char *uri, OCEntityHandler entityHandler,
+        void *callbackParam,
+        uint8_t resourceProperties,
+        OCTpsSchemeFlags resourceTpsTypes)
+{
+    OCStackLock();
+    OCStackResult result = OCCreateResourceWithEpInternal(handle, resourceTypeName,
+                                                          resourceInterfaceName, uri,
+                                                          entityHandler, callbackParam,
+                                                          resourceProperties, resourceTpsTypes);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult OCBindResourceInternal(
         OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
 {
     OCResource *resource = NULL;
@@ -3966,7 +4198,15 @@ OCStackResult OCBindResource(
     return OC_STACK_OK;
 }
 
-OCStackResult OCUnBindResource(
+OCStackResult OCBindResource(OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
+{
+    OCStackLock();
+    OCStackResult result = OCBindResourceInternal(collectionHandle, resourceHandle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult OCUnBindResourceInternal(
         OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
 {
     OCResource *resource = NULL;
@@ -4060,6 +4300,14 @@ OCStackResult OCUnBindResource(
     return OC_STACK_ERROR;
 }
 
+OCStackResult OCUnBindResource(OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
+{
+    OCStackLock();
+    OCStackResult result = OCUnBindResourceInternal(collectionHandle, resourceHandle);
+    OCStackUnlock();
+    return result;
+}
+
 static bool ValidateResourceTypeInterface(const char *resourceItemName)
 {
     if (!resourceItemName)
@@ -4222,7 +4470,7 @@ OCStackResult BindTpsTypeToResource(OCResource* resource,
     return result;
 }
 
-OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
+static OCStackResult OCBindResourceTypeToResourceInternal(OCResourceHandle handle,
         const char *resourceTypeName)
 {
 
@@ -4249,7 +4497,16 @@ OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
     return result;
 }
 
-OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
+OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
+        const char *resourceTypeName)
+{
+    OCStackLock();
+    OCStackResult result = OCBindResourceTypeToResourceInternal(handle, resourceTypeName);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult OCBindResourceInterfaceToResourceInternal(OCResourceHandle handle,
         const char *resourceInterfaceName)
 {
 
@@ -4276,6 +4533,15 @@ OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
     return result;
 }
 
+OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
+        const char *resourceInterfaceName)
+{
+    OCStackLock();
+    OCStackResult result = OCBindResourceInterfaceToResourceInternal(handle, resourceInterfaceName);
+    OCStackUnlock();
+    return result;
+}
+
 OCStackResult OCGetNumberOfResources(uint8_t *numResources)
 {
     OCResource *pointer = headResource;
@@ -4301,7 +4567,7 @@ OCResourceHandle OCGetResourceHandle(uint8_t index)
     return (OCResourceHandle) pointer;
 }
 
-OCStackResult OCDeleteResource(OCResourceHandle handle)
+static OCStackResult OCDeleteResourceInternal(OCResourceHandle handle)
 {
     if (!handle)
     {
@@ -4325,6 +4591,14 @@ OCStackResult OCDeleteResource(OCResourceHandle handle)
     return OC_STACK_OK;
 }
 
+OCStackResult OCDeleteResource(OCResourceHandle handle)
+{
+    OCStackLock();
+    OCStackResult result = OCDeleteResourceInternal(handle);
+    OCStackUnlock();
+    return result;
+}
+
 const char *OCGetResourceUri(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
@@ -4478,7 +4752,7 @@ OCResourceHandle OCGetResourceHandleFromCollection(OCResourceHandle collectionHa
     return NULL;
 }
 
-OCStackResult OCBindResourceHandler(OCResourceHandle handle,
+static OCStackResult OCBindResourceHandlerInternal(OCResourceHandle handle,
         OCEntityHandler entityHandler,
         void* callbackParam)
 {
@@ -4510,6 +4784,16 @@ OCStackResult OCBindResourceHandler(OCResourceHandle handle,
     return OC_STACK_OK;
 }
 
+OCStackResult OCBindResourceHandler(OCResourceHandle handle,
+        OCEntityHandler entityHandler,
+        void* callbackParam)
+{
+    OCStackLock();
+    OCStackResult result = OCBindResourceHandlerInternal(handle, entityHandler, callbackParam);
+    OCStackUnlock();
+    return result;
+}
+
 OCEntityHandler OCGetResourceHandler(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
@@ -4582,7 +4866,7 @@ OCStackResult SendStopNotification()
 }
 
 #endif // WITH_PRESENCE
-OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService qos)
+static OCStackResult OCNotifyAllObserversInternal(OCResourceHandle handle, OCQualityOfService qos)
 {
     OCResource *resPtr = NULL;
     OCStackResult result = OC_STACK_ERROR;
@@ -4620,12 +4904,20 @@ OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService q
     }
 }
 
-OCStackResult
-OCNotifyListOfObservers (OCResourceHandle handle,
-                         OCObservationId  *obsIdList,
-                         uint8_t          numberOfIds,
-                         const OCRepPayload       *payload,
-                         OCQualityOfService qos)
+OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService qos)
+{
+    OCStackLock();
+    OCStackResult result = OCNotifyAllObserversInternal(handle, qos);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult
+OCNotifyListOfObserversInternal(OCResourceHandle handle,
+                                OCObservationId  *obsIdList,
+                                uint8_t          numberOfIds,
+                                const OCRepPayload       *payload,
+                                OCQualityOfService qos)
 {
     OIC_LOG(INFO, TAG, "Entering OCNotifyListOfObservers");
 
@@ -4650,7 +4942,21 @@ OCNotifyListOfObservers (OCResourceHandle handle,
             payload, maxAge, qos));
 }
 
-OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
+OCStackResult
+OCNotifyListOfObservers (OCResourceHandle handle,
+                         OCObservationId  *obsIdList,
+                         uint8_t          numberOfIds,
+                         const OCRepPayload       *payload,
+                         OCQualityOfService qos)
+{
+    OCStackLock();
+    OCStackResult result = OCNotifyListOfObserversInternal(handle, obsIdList, numberOfIds,
+                                                           payload, qos);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult OCDoResponseInternal(OCEntityHandlerResponse *ehResponse)
 {
     OCStackResult result = OC_STACK_ERROR;
     OCServerRequest *serverRequest = NULL;
@@ -4673,6 +4979,14 @@ OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
     return result;
 }
 
+OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
+{
+    OCStackLock();
+    OCStackResult result = OCDoResponseInternal(ehResponse);
+    OCStackUnlock();
+    return result;
+}
+
 //#ifdef DIRECT_PAIRING
 const OCDPDev_t* OCDiscoverDirectPairingDevices(unsigned short waittime)
 {
@@ -4893,17 +5207,7 @@ void insertResource(OCResource *resource)
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
-
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    return FindResourceByHandle(resource);
 }
 
 void deleteAllResources()
@@ -4996,6 +5300,7 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            RemoveResourceFromIndex(temp);
             deleteResourceElements(temp);
             OICFree(temp);
             temp = NULL;
@@ -5127,6 +5432,7 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
         }
     }
     resourceType->next = NULL;
+    AddResourceTypeToIndex(resource, resourceType);
 
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
 }
@@ -5252,6 +5558,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             previous->next = newInterface;
         }
     }
+    AddResourceInterfaceToIndex(resource, newInterface);
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
@@ -5656,18 +5963,12 @@ OCResourceHandle OCGetResourceHandleAtUri(const char *uri)
         return NULL;
     }
 
-    OCResource *pointer = headResource;
-
-    while (pointer)
+    OCResource *pointer = FindResourceByUri(uri);
+    if (pointer)
     {
-        if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-        {
-            OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
     }
-    return NULL;
+    return pointer;
 }
 
 OCStackResult OCSetHeaderOption(OCHeaderOption* ocHdrOpt, size_t* numOptions, uint16_t optionID,
@@ -26,7 +26,6 @@
 #include "oic_string.h"
 #include "oic_time.h"
 #include "ocrandom.h"
-#include "uarraylist.h"
 #include "ocstackinternal.h"
 #include "ocpayloadcbor.h"
 #include "ocpayload.h"
@@ -77,6 +76,11 @@ static const uint64_t USECS_PER_SEC = 1000000;
  */
 #define DEFAULT_INTERVAL_COUNT  6
 
+/**
+ * Initial count of the heap slots in the KeepAlive table.
+ */
+#define KEEPALIVE_TABLE_MIN_SIZE 16
+
 /**
  * KeepAlive key to parser Payload Table.
  */
@@ -99,23 +103,22 @@ static OCResourceHandle g_keepAliveHandle = NULL;
 
 /**
  * KeepAlive table which holds connection interval.
+ * Entries are found by endpoint through a hash index, and ordered by their
+ * deadline in a binary min-heap, so that only the entries which are due
+ * have to be visited.
  */
-static u_arraylist_t *g_keepAliveConnectionTable = NULL;
+typedef struct
+{
+    KeepAliveEntry_t *index;        /**< entries keyed by remote address and port. */
+    size_t numEntries;              /**< number of entries in the table. */
+    KeepAliveEntry_t **heap;        /**< entries ordered by deadline. */
+    size_t heapCapacity;            /**< number of allocated heap slots. */
+} KeepAliveTable_t;
 
 /**
- * KeepAlive table entries.
+ * KeepAlive table, heap is NULL until the table is created.
  */
-typedef struct
-{
-    OCMode mode;                    /**< host Mode of Operation. */
-    CAEndpoint_t remoteAddr;        /**< destination Address. */
-    int64_t interval;              /**< time interval for KeepAlive. in seconds.*/
-    int32_t currIndex;              /**< current interval value index. */
-    size_t intervalSize;            /**< total interval counts. */
-    int64_t *intervalInfo;          /**< interval values for KeepAlive. */
-    bool sentPingMsg;               /**< if oic client already sent ping message. */
-    uint64_t timeStamp;             /**< last sent or received ping message. in microseconds. */
-} KeepAliveEntry_t;
+static KeepAliveTable_t g_keepAliveConnectionTable = { .heap = NULL };
 
 /**
  * Send disconnect message to remove connection.
@@ -179,33 +182,11 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
                                       OCStackResult responseCode,
                                       const OCRepPayload *respPayload);
 /**
- * Gets keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference uri and transport type) to
- *                          which the ping message has to be sent.
- * @param[out]  index       index of array list.
- * @return  KeepAlive entry to send ping message.
- */
-static KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, size_t *index);
-
-/**
- * Add keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference uri and transport type).
- * @param[in]   mode        Whether it is OIC Server or OIC Client.
- * @param[in]   intervalArray   Received interval values from cloud server.
- * @return  The KeepAlive entry added in KeepAlive Table.
- */
-KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
-                                    int64_t *intervalArray);
-
-/**
- * Remove keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference uri and transport type).
- * @return  The KeepAlive entry removed in KeepAlive Table.
+ * Update the deadline of a keepalive entry from its state and move it in the
+ * deadline heap accordingly.
+ * @param[in]   entry       The KeepAlive entry which changed.
  */
-static OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint);
+static void ScheduleKeepAliveEntry(KeepAliveEntry_t *entry);
 
 /**
  * Create KeepAlive paylaod to send message.
@@ -257,13 +238,20 @@ OCStackResult InitializeKeepAlive(OCMode mode)
         }
     }
 
-    if (!g_keepAliveConnectionTable)
+    if (!g_keepAliveConnectionTable.heap)
     {
-        g_keepAliveConnectionTable = u_arraylist_create();
-        if (NULL == g_keepAliveConnectionTable)
+        g_keepAliveConnectionTable.heap = (KeepAliveEntry_t **) OICMalloc(
+                KEEPALIVE_TABLE_MIN_SIZE * sizeof(KeepAliveEntry_t *));
+        g_keepAliveConnectionTable.index = NULL;
+        g_keepAliveConnectionTable.heapCapacity = KEEPALIVE_TABLE_MIN_SIZE;
+        g_keepAliveConnectionTable.numEntries = 0;
+        if (!g_keepAliveConnectionTable.heap)
         {
             OIC_LOG(ERROR, TAG, "Creating KeepAlive Table failed");
-            TerminateKeepAlive(mode);
+            if (OC_CLIENT != mode)
+            {
+                DeleteKeepAliveResource();
+            }
             return OC_STACK_ERROR;
         }
     }
@@ -294,10 +282,20 @@ OCStackResult TerminateKeepAlive(OCMode mode)
         }
     }
 
-    if (NULL != g_keepAliveConnectionTable)
+    if (NULL != g_keepAliveConnectionTable.heap)
     {
-        u_arraylist_destroy(g_keepAliveConnectionTable);
-        g_keepAliveConnectionTable = NULL;
+        KeepAliveEntry_t *entry = NULL;
+        KeepAliveEntry_t *tmp = NULL;
+        HASH_ITER(hh, g_keepAliveConnectionTable.index, entry, tmp)
+        {
+            HASH_DEL(g_keepAliveConnectionTable.index, entry);
+            OICFree(entry->intervalInfo);
+            OICFree(entry);
+        }
+        OICFree(g_keepAliveConnectionTable.heap);
+        g_keepAliveConnectionTable.heap = NULL;
+        g_keepAliveConnectionTable.numEntries = 0;
+        g_keepAliveConnectionTable.heapCapacity = 0;
     }
 
     g_isKeepAliveInitialized = false;
@@ -405,8 +403,7 @@ OCStackResult SendKeepAliveResponse(OCServerRequest *request,
     CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
     CopyDevAddrToEndpoint(&request->devAddr, &endpoint);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint);
     int64_t interval = (entry) ? entry->interval : 0;
 
     // Create KeepAlive payload to send response message.
@@ -458,8 +455,7 @@ OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
     CAEndpoint_t endpoint = { .adapter = CA_DEFAULT_ADAPTER };
     CopyDevAddrToEndpoint(&request->devAddr, &endpoint);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint);
     if (!entry)
     {
         OIC_LOG(ERROR, TAG, "Received the first keepalive message from client");
@@ -471,18 +467,19 @@ OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
         }
     }
 
-    OCPayload *ocPayload = NULL;
-    OCParsePayload(&ocPayload, PAYLOAD_TYPE_REPRESENTATION,
-                   request->payload, request->payloadSize);
-    OCRepPayload *repPayload = (OCRepPayload *)ocPayload;
-
+    // Only the interval is needed, so it is read without decoding the whole payload.
+    OCRepPayloadView *view = NULL;
     int64_t interval = 0;
-    OCRepPayloadGetPropInt(repPayload, INTERVAL, &interval);
+    if (OC_STACK_OK == OCRepPayloadViewCreate(request->payload, request->payloadSize,
+                                              false, &view))
+    {
+        OCRepPayloadViewGetPropInt(view, INTERVAL, &interval);
+        OCRepPayloadViewDestroy(view);
+    }
     entry->interval = interval;
     OIC_LOG_V(DEBUG, TAG, "Received interval is [%" PRId64 "]", entry->interval);
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
-
-    OCPayloadDestroy(ocPayload);
+    ScheduleKeepAliveEntry(entry);
 
     return OC_EH_OK;
 }
@@ -496,8 +493,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     OIC_LOG(DEBUG, TAG, "HandleKeepAliveResponse IN");
 
     // Get entry from KeepAlive table.
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint);
     if (!entry)
     {
         // Receive response message about find /oic/ping request.
@@ -536,6 +532,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     {
         // Set sentPingMsg values with false.
         entry->sentPingMsg = false;
+        ScheduleKeepAliveEntry(entry);
 
         // Check the received interval value.
         int64_t interval = 0;
@@ -555,65 +552,49 @@ void ProcessKeepAlive()
         return;
     }
 
-    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
+    if (0 == g_keepAliveConnectionTable.numEntries)
+    {
+        return;
+    }
 
-    for (size_t i = 0; i < len; i++)
+    // Only the entries at the top of the heap can be due.
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+    while (0 < g_keepAliveConnectionTable.numEntries &&
+           g_keepAliveConnectionTable.heap[0]->deadline <= currentTime)
     {
-        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
-                                                                      i);
-        if (NULL == entry)
+        KeepAliveEntry_t *entry = g_keepAliveConnectionTable.heap[0];
+        if (OC_CLIENT == entry->mode && !entry->sentPingMsg)
         {
-            continue;
-        }
+            // Increase interval value.
+            IncreaseInterval(entry);
 
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
-        if (OC_CLIENT == entry->mode)
-        {
-            if (entry->sentPingMsg)
+            OCStackResult result = SendPingMessage(entry);
+            if (OC_STACK_OK != result)
             {
-                /*
-                 * If an OIC Client does not receive the response within 1 minutes,
-                 * terminate the connection.
-                 * In this case the timeStamp means last time sent ping message.
-                 */
-                if ((KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC) <= currentTime - entry->timeStamp)
-                {
-                    OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
+                OIC_LOG(ERROR, TAG, "Failed to send ping request");
 
-                    // Send message to disconnect session.
-                    SendDisconnectMessage(entry);
-                }
-            }
-            else
-            {
-                if ((entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC)
-                        <= currentTime - entry->timeStamp)
-                {
-                    // Increase interval value.
-                    IncreaseInterval(entry);
-
-                    OCStackResult result = SendPingMessage(entry);
-                    if (OC_STACK_OK != result)
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed to send ping request");
-                        continue;
-                    }
-                }
+                // Try again on the next call.
+                SetKeepAliveDeadline(entry, currentTime + 1);
             }
         }
-        else if (OC_SERVER == entry->mode)
+        else
         {
             /*
-             * If an OIC Server does not receive a PUT request to ping resource
-             * within the specified interval time, terminate the connection.
-             * In this case the timeStamp means last time received ping message.
+             * If an OIC Client does not receive the response within 1 minutes, or an
+             * OIC Server does not receive a PUT request to ping resource within the
+             * specified interval time, terminate the connection.
              */
-            if ((entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC)
-                    <= currentTime - entry->timeStamp)
+            if (OC_CLIENT == entry->mode)
+            {
+                OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
+            }
+            else
             {
                 OIC_LOG(DEBUG, TAG, "Server does not receive a PUT request.");
-                SendDisconnectMessage(entry);
             }
+
+            // Send message to disconnect session. This removes the entry from the table.
+            SendDisconnectMessage(entry);
         }
     }
 }
@@ -628,6 +609,7 @@ void IncreaseInterval(KeepAliveEntry_t *entry)
         entry->currIndex++;
         entry->interval = entry->intervalInfo[entry->currIndex];
         OIC_LOG_V(DEBUG, TAG, "increase interval value [%" PRId64 "]", entry->interval);
+        ScheduleKeepAliveEntry(entry);
     }
 }
 
@@ -640,14 +622,16 @@ OCStackResult SendDisconnectMessage(const KeepAliveEntry_t *entry)
      * If CA get the empty message from RI, CA will disconnect a connection.
      */
 
-    OCStackResult result = RemoveKeepAliveEntry(&entry->remoteAddr);
+    // The entry is freed when it is removed.
+    CAEndpoint_t remoteAddr = entry->remoteAddr;
+    OCStackResult result = RemoveKeepAliveEntry(&remoteAddr);
     if (result != OC_STACK_OK)
     {
         return result;
     }
 
     CARequestInfo_t requestInfo = { .method = CA_POST };
-    result = CASendRequest(&entry->remoteAddr, &requestInfo);
+    result = CASendRequest(&remoteAddr, &requestInfo);
     return CAResultToOCResult(result);
 }
 
@@ -673,6 +657,7 @@ OCStackResult SendPingMessage(KeepAliveEntry_t *entry)
     // Update timeStamp with time sent ping message for next ping message.
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
     entry->sentPingMsg = true;
+    ScheduleKeepAliveEntry(entry);
 
     OIC_LOG_V(DEBUG, TAG, "Client sent ping message, interval [%" PRId64 "]", entry->interval);
 
@@ -699,35 +684,141 @@ OCStackApplicationResult PingRequestCallback(void* ctx, OCDoHandle handle,
     return OC_STACK_DELETE_TRANSACTION;
 }
 
-KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, size_t *index)
+static void SetKeepAliveKey(KeepAliveKey_t *key, const CAEndpoint_t *endpoint)
+{
+    // The whole key is hashed, so the bytes after the address string must be zero.
+    memset(key, 0, sizeof(*key));
+    OICStrcpy(key->addr, sizeof(key->addr), endpoint->addr);
+    key->port = endpoint->port;
+}
+
+static void SetHeapSlot(size_t index, KeepAliveEntry_t *entry)
 {
-    if (!g_keepAliveConnectionTable)
+    g_keepAliveConnectionTable.heap[index] = entry;
+    entry->heapIndex = index;
+}
+
+static void SiftUp(size_t index)
+{
+    KeepAliveEntry_t **heap = g_keepAliveConnectionTable.heap;
+    KeepAliveEntry_t *entry = heap[index];
+    while (index > 0)
     {
-        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
-        return NULL;
+        size_t parent = (index - 1) / 2;
+        if (heap[parent]->deadline <= entry->deadline)
+        {
+            break;
+        }
+        SetHeapSlot(index, heap[parent]);
+        index = parent;
+    }
+    SetHeapSlot(index, entry);
+}
+
+static void SiftDown(size_t index)
+{
+    KeepAliveEntry_t **heap = g_keepAliveConnectionTable.heap;
+    size_t count = g_keepAliveConnectionTable.numEntries;
+    KeepAliveEntry_t *entry = heap[index];
+    for (;;)
+    {
+        size_t child = 2 * index + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && heap[child + 1]->deadline < heap[child]->deadline)
+        {
+            child++;
+        }
+        if (entry->deadline <= heap[child]->deadline)
+        {
+            break;
+        }
+        SetHeapSlot(index, heap[child]);
+        index = child;
     }
+    SetHeapSlot(index, entry);
+}
 
-    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
+void SetKeepAliveDeadline(KeepAliveEntry_t *entry, uint64_t deadline)
+{
+    uint64_t oldDeadline = entry->deadline;
+    entry->deadline = deadline;
+    if (deadline < oldDeadline)
+    {
+        SiftUp(entry->heapIndex);
+    }
+    else
+    {
+        SiftDown(entry->heapIndex);
+    }
+}
 
-    for (size_t i = 0; i < len; i++)
+static uint64_t GetKeepAliveDeadline(const KeepAliveEntry_t *entry)
+{
+    /*
+     * An OIC Client waits 1 minute for the response of a sent ping message,
+     * otherwise the interval runs from the last sent or received ping message.
+     */
+    uint64_t timeout = KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+    if (OC_SERVER == entry->mode || !entry->sentPingMsg)
     {
-        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
-                                                                      i);
-        if (NULL == entry)
+        // A negative interval never expires.
+        if (entry->interval < 0 || (uint64_t)entry->interval > UINT64_MAX / timeout)
         {
-            continue;
+            return UINT64_MAX;
         }
+        timeout *= (uint64_t)entry->interval;
+    }
+
+    if (UINT64_MAX - entry->timeStamp < timeout)
+    {
+        return UINT64_MAX;
+    }
+    return entry->timeStamp + timeout;
+}
+
+void ScheduleKeepAliveEntry(KeepAliveEntry_t *entry)
+{
+    SetKeepAliveDeadline(entry, GetKeepAliveDeadline(entry));
+}
 
-        if (!strncmp(entry->remoteAddr.addr, endpoint->addr, sizeof(entry->remoteAddr.addr))
-                && (entry->remoteAddr.port == endpoint->port))
+static bool GrowKeepAliveHeap()
+{
+    KeepAliveTable_t *table = &g_keepAliveConnectionTable;
+    if (table->numEntries == table->heapCapacity)
+    {
+        size_t capacity = table->heapCapacity * 2;
+        KeepAliveEntry_t **heap = (KeepAliveEntry_t **) OICRealloc(table->heap,
+                capacity * sizeof(KeepAliveEntry_t *));
+        if (!heap)
         {
-            OIC_LOG(DEBUG, TAG, "Connection Info found in KeepAlive table");
-            *index = i;
-            return entry;
+            return false;
         }
+        table->heap = heap;
+        table->heapCapacity = capacity;
+    }
+    return true;
+}
+
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint)
+{
+    if (!g_keepAliveConnectionTable.heap)
+    {
+        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
+        return NULL;
     }
 
-    return NULL;
+    KeepAliveKey_t key;
+    KeepAliveEntry_t *entry = NULL;
+    SetKeepAliveKey(&key, endpoint);
+    HASH_FIND(hh, g_keepAliveConnectionTable.index, &key, sizeof(key), entry);
+    if (entry)
+    {
+        OIC_LOG(DEBUG, TAG, "Connection Info found in KeepAlive table");
+    }
+    return entry;
 }
 
 KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
@@ -739,12 +830,18 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
         return NULL;
     }
 
-    if (!g_keepAliveConnectionTable)
+    if (!g_keepAliveConnectionTable.heap)
     {
         OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
         return NULL;
     }
 
+    if (!GrowKeepAliveHeap())
+    {
+        OIC_LOG(ERROR, TAG, "Growing KeepAlive Table failed");
+        return NULL;
+    }
+
     KeepAliveEntry_t *entry = (KeepAliveEntry_t *) OICCalloc(1, sizeof(KeepAliveEntry_t));
     if (NULL == entry)
     {
@@ -752,6 +849,7 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
         return NULL;
     }
 
+    SetKeepAliveKey(&entry->key, endpoint);
     entry->mode = mode;
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
     entry->remoteAddr.adapter = endpoint->adapter;
@@ -765,6 +863,12 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     if (!entry->intervalInfo)
     {
         entry->intervalInfo = (int64_t*) OICMalloc(entry->intervalSize * sizeof(int64_t));
+        if (!entry->intervalInfo)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to Malloc KeepAlive intervals");
+            OICFree(entry);
+            return NULL;
+        }
         for (size_t i = 0; i < entry->intervalSize; i++)
         {
             entry->intervalInfo[i] = KEEPALIVE_MIN_INTERVAL << i;
@@ -772,14 +876,12 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     }
     entry->interval = entry->intervalInfo[0];
 
-    bool result = u_arraylist_add(g_keepAliveConnectionTable, (void *)entry);
-    if (!result)
-    {
-        OIC_LOG(ERROR, TAG, "Adding node to head failed");
-        OICFree(entry->intervalInfo);
-        OICFree(entry);
-        return NULL;
-    }
+    HASH_ADD(hh, g_keepAliveConnectionTable.index, key, sizeof(entry->key), entry);
+
+    entry->deadline = GetKeepAliveDeadline(entry);
+    SetHeapSlot(g_keepAliveConnectionTable.numEntries, entry);
+    g_keepAliveConnectionTable.numEntries++;
+    SiftUp(entry->heapIndex);
 
     return entry;
 }
@@ -788,27 +890,45 @@ OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL(endpoint, FATAL, OC_STACK_INVALID_PARAM);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endpoint, &index);
-    if (!entry)
+    if (!g_keepAliveConnectionTable.heap)
     {
-        OIC_LOG(ERROR, TAG, "There is no entry in keepalive table.");
+        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
         return OC_STACK_ERROR;
     }
 
-    KeepAliveEntry_t *removedEntry = (KeepAliveEntry_t *)
-                                        u_arraylist_remove(g_keepAliveConnectionTable, index);
-    if (NULL == removedEntry)
+    KeepAliveKey_t key;
+    KeepAliveEntry_t *removedEntry = NULL;
+    SetKeepAliveKey(&key, endpoint);
+    HASH_FIND(hh, g_keepAliveConnectionTable.index, &key, sizeof(key), removedEntry);
+    if (!removedEntry)
     {
-        OIC_LOG(ERROR, TAG, "Removed Entry is NULL");
+        OIC_LOG(ERROR, TAG, "There is no entry in keepalive table.");
         return OC_STACK_ERROR;
     }
+    HASH_DEL(g_keepAliveConnectionTable.index, removedEntry);
+
+    // Fill the hole in the heap with the last entry.
+    size_t index = removedEntry->heapIndex;
+    g_keepAliveConnectionTable.numEntries--;
+    KeepAliveEntry_t *last = g_keepAliveConnectionTable.heap[g_keepAliveConnectionTable.numEntries];
+    if (last != removedEntry)
+    {
+        SetHeapSlot(index, last);
+        if (index > 0 && g_keepAliveConnectionTable.heap[(index - 1) / 2]->deadline > last->deadline)
+        {
+            SiftUp(index);
+        }
+        else
+        {
+            SiftDown(index);
+        }
+    }
 
     OIC_LOG_V(DEBUG, TAG, "Remove Connection Info from KeepAlive table, "
              "remote addr=%s port:%d", removedEntry->remoteAddr.addr,
              removedEntry->remoteAddr.port);
 
-    OICFree(entry->intervalInfo);
+    OICFree(removedEntry->intervalInfo);
     OICFree(removedEntry);
 
     return OC_STACK_OK;
@@ -306,3 +306,176 @@ TEST(CborHeterogeneousArrayTest, ConvertParseTest)
     OICFree(payload_cbor);
     OCPayloadDestroy(payload_out);
 }
+
+TEST(CborEncodeBufferTest, ConvertPayloadToBuffer)
+{
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(payload_in != NULL);
+    OCRepPayloadSetUri(payload_in, "/a/collection");
+    char name[16];
+    for (int i = 0; i < 64; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        EXPECT_TRUE(OCRepPayloadSetPropString(payload_in, name, "a value long enough to matter"));
+    }
+    OCRepPayload *child = OCRepPayloadCreate();
+    ASSERT_TRUE(child != NULL);
+    OCRepPayloadSetUri(child, "/a/child");
+    EXPECT_TRUE(OCRepPayloadSetPropInt(child, "value", 42));
+    OCRepPayloadAppend(payload_in, child);
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                                            &payload_cbor_size));
+    EXPECT_GE(OCEstimatePayloadSize((OCPayload*) payload_in), payload_cbor_size);
+
+    // Too small a buffer reports the size needed instead of writing a truncated payload.
+    uint8_t small[16];
+    size_t size = sizeof(small);
+    EXPECT_EQ(OC_STACK_NO_MEMORY, OCConvertPayloadToBuffer((OCPayload*) payload_in, small, &size));
+    EXPECT_GE(size, payload_cbor_size);
+
+    uint8_t *buffer = (uint8_t *)OICMalloc(size);
+    ASSERT_TRUE(buffer != NULL);
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload*) payload_in, buffer, &size));
+    ASSERT_EQ(payload_cbor_size, size);
+    EXPECT_EQ(0, memcmp(payload_cbor, buffer, size));
+
+    OICFree(buffer);
+    OICFree(payload_cbor);
+    OCRepPayloadDestroy(payload_in);
+}
+
+TEST(CborRepPayloadTest, ManyPropertiesKeepOrderAndValues)
+{
+    const int count = 500;
+    char name[16];
+
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(payload_in != NULL);
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        EXPECT_TRUE(OCRepPayloadSetPropInt(payload_in, name, i));
+    }
+    // Setting an existing property replaces its value in place.
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload_in, "prop7", "seven"));
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload_in, "prop400", -400));
+
+    int index = 0;
+    for (OCRepPayloadValue *value = payload_in->values; value; value = value->next, ++index)
+    {
+        snprintf(name, sizeof(name), "prop%d", index);
+        EXPECT_STREQ(name, value->name);
+    }
+    EXPECT_EQ(count, index);
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                                            &payload_cbor_size));
+    OCPayload *payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+                                          payload_cbor, payload_cbor_size));
+    ASSERT_TRUE(payload_out != NULL);
+
+    OCRepPayload *clone = OCRepPayloadClone((OCRepPayload *) payload_out);
+    ASSERT_TRUE(clone != NULL);
+
+    OCRepPayload *payloads[] = { payload_in, (OCRepPayload *) payload_out, clone };
+    for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); ++p)
+    {
+        char *str = NULL;
+        EXPECT_TRUE(OCRepPayloadGetPropString(payloads[p], "prop7", &str));
+        EXPECT_STREQ("seven", str);
+        OICFree(str);
+
+        int64_t intValue = 0;
+        EXPECT_TRUE(OCRepPayloadGetPropInt(payloads[p], "prop400", &intValue));
+        EXPECT_EQ(-400, intValue);
+        EXPECT_TRUE(OCRepPayloadGetPropInt(payloads[p], "prop499", &intValue));
+        EXPECT_EQ(499, intValue);
+        EXPECT_FALSE(OCRepPayloadGetPropInt(payloads[p], "prop500", &intValue));
+    }
+
+    OICFree(payload_cbor);
+    OCRepPayloadDestroy(clone);
+    OCPayloadDestroy(payload_out);
+    OCRepPayloadDestroy(payload_in);
+}
+
+TEST(CborRepPayloadViewTest, ReadsPropertiesWithAndWithoutIndex)
+{
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(payload_in != NULL);
+    OCRepPayloadSetUri(payload_in, "/a/light");
+    char name[16];
+    for (int i = 0; i < 40; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        EXPECT_TRUE(OCRepPayloadSetPropInt(payload_in, name, i));
+    }
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload_in, "name", "kitchen"));
+    EXPECT_TRUE(OCRepPayloadSetPropDouble(payload_in, "level", 0.5));
+    EXPECT_TRUE(OCRepPayloadSetPropBool(payload_in, "on", true));
+    EXPECT_TRUE(OCRepPayloadSetNull(payload_in, "nothing"));
+    OCRepPayload *child = OCRepPayloadCreate();
+    ASSERT_TRUE(child != NULL);
+    EXPECT_TRUE(OCRepPayloadSetPropInt(child, "value", 42));
+    EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_in, "child", child));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                                            &payload_cbor_size));
+
+    for (int buildIndex = 0; buildIndex < 2; ++buildIndex)
+    {
+        OCRepPayloadView *view = NULL;
+        ASSERT_EQ(OC_STACK_OK, OCRepPayloadViewCreate(payload_cbor, payload_cbor_size,
+                                                      buildIndex != 0, &view));
+
+        int64_t intValue = 0;
+        EXPECT_TRUE(OCRepPayloadViewGetPropInt(view, "prop39", &intValue));
+        EXPECT_EQ(39, intValue);
+        EXPECT_FALSE(OCRepPayloadViewGetPropInt(view, "prop40", &intValue));
+        EXPECT_FALSE(OCRepPayloadViewGetPropInt(view, "name", &intValue));
+
+        double doubleValue = 0;
+        EXPECT_TRUE(OCRepPayloadViewGetPropDouble(view, "level", &doubleValue));
+        EXPECT_EQ(0.5, doubleValue);
+        EXPECT_TRUE(OCRepPayloadViewGetPropDouble(view, "prop3", &doubleValue));
+        EXPECT_EQ(3.0, doubleValue);
+
+        bool boolValue = false;
+        EXPECT_TRUE(OCRepPayloadViewGetPropBool(view, "on", &boolValue));
+        EXPECT_TRUE(boolValue);
+        EXPECT_TRUE(OCRepPayloadViewIsNull(view, "nothing"));
+        EXPECT_FALSE(OCRepPayloadViewIsNull(view, "on"));
+        EXPECT_TRUE(OCRepPayloadViewHasProp(view, OC_RSRVD_HREF));
+
+        char *str = NULL;
+        EXPECT_TRUE(OCRepPayloadViewGetPropString(view, "name", &str));
+        EXPECT_STREQ("kitchen", str);
+        OICFree(str);
+
+        OCRepPayload *object = NULL;
+        EXPECT_TRUE(OCRepPayloadViewGetPropObject(view, "child", &object));
+        EXPECT_TRUE(OCRepPayloadGetPropInt(object, "value", &intValue));
+        EXPECT_EQ(42, intValue);
+        OCRepPayloadDestroy(object);
+
+        OCRepPayloadViewDestroy(view);
+    }
+
+    // Anything but a representation is refused.
+    uint8_t notAMap[] = { 0x01 };
+    OCRepPayloadView *view = NULL;
+    EXPECT_EQ(OC_STACK_MALFORMED_RESPONSE, OCRepPayloadViewCreate(notAMap, sizeof(notAMap),
+                                                                  false, &view));
+    EXPECT_TRUE(view == NULL);
+
+    OICFree(payload_cbor);
+    OCRepPayloadDestroy(payload_in);
+}
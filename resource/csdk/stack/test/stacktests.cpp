@@ -29,6 +29,10 @@ extern "C"
     #include "oic_string.h"
     #include "oic_time.h"
     #include "ocresourcehandler.h"
+    #include "ocobserve.h"
+#ifdef TCP_ADAPTER
+    #include "oickeepalive.h"
+#endif
 }
 
 #include "gtest/gtest.h"
@@ -40,6 +44,18 @@ extern "C"
 #include <unistd.h>
 #endif
 #include <stdlib.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
 
 //-----------------------------------------------------------------------------
 // Includes
@@ -49,6 +65,7 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <string>
 
 #include "gtest_helper.h"
 
@@ -194,6 +211,14 @@ OCDeviceProperties* getTestDeviceProps()
     return deviceProps;
 }
 
+// Tokens made for different indexes only differ in their last byte, and share
+// every shorter prefix.
+void SetIndexedTestToken(uint8_t *token, size_t index)
+{
+    memset(token, 0x5A, CA_MAX_TOKEN_LEN);
+    token[CA_MAX_TOKEN_LEN - 1] = (uint8_t)index;
+}
+
 class OCDiscoverTests : public testing::Test
 {
     protected:
@@ -303,6 +328,18 @@ TEST(StackStart, StackStartSuccessiveInits)
     EXPECT_EQ(0u, g_ocStackStartCount);
 }
 
+TEST(StackStart, StackStartWithReceiveWorkers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetReceiveWorkerCount(CA_MAX_RECEIVE_WORKERS + 1));
+    EXPECT_EQ(OC_STACK_OK, OCSetReceiveWorkerCount(2));
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+    EXPECT_EQ(OC_STACK_ERROR, OCSetReceiveWorkerCount(4));
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetReceiveWorkerCount(0));
+}
+
 TEST(StackStart, SetPlatformInfoValid)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -1273,6 +1310,451 @@ TEST(StackResource, ClearResourceProperties)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, CreateResourceWithObserveFanOut)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CreateResourceWithObserveFanOut test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_OBSERVABLE|OC_OBSERVE_FANOUT));
+
+    EXPECT_EQ(OC_OBSERVE_FANOUT, OCGetResourceProperties(handle) & OC_OBSERVE_FANOUT);
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyAllObservers(handle, OC_NA_QOS));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+#define TEST_OBSERVER_COUNT (32)
+
+static OCObservationId AddTestObserver(OCResourceHandle handle, const char *uri,
+                                       const char *token, uint8_t tokenLength)
+{
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+    OCObservationId obsId = 0;
+    if (OC_STACK_OK != GenerateObserverId(&obsId) ||
+        OC_STACK_OK != AddObserver(uri, NULL, obsId, (CAToken_t)token, tokenLength,
+                                   (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR, 0,
+                                   &devAddr))
+    {
+        return 0;
+    }
+    return obsId;
+}
+
+TEST(StackResource, ObserverLookupByIdAndToken)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ObserverLookupByIdAndToken test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_OBSERVABLE));
+
+    char tokens[TEST_OBSERVER_COUNT][CA_MAX_TOKEN_LEN];
+    OCObservationId obsIds[TEST_OBSERVER_COUNT];
+    for (size_t i = 0; i < TEST_OBSERVER_COUNT; i++)
+    {
+        SetIndexedTestToken((uint8_t *)tokens[i], i);
+        obsIds[i] = AddTestObserver(handle, "/a/led", tokens[i], CA_MAX_TOKEN_LEN);
+        ASSERT_NE(0, obsIds[i]);
+    }
+
+    // A token that is a prefix of all the others is a different key.
+    OCObservationId prefixId = AddTestObserver(handle, "/a/led", tokens[0],
+                                               CA_MAX_TOKEN_LEN - 1);
+    ASSERT_NE(0, prefixId);
+
+    for (size_t i = 0; i < TEST_OBSERVER_COUNT; i++)
+    {
+        ResourceObserver *observer = GetObserverUsingId(obsIds[i]);
+        ASSERT_TRUE(NULL != observer);
+        EXPECT_EQ(obsIds[i], observer->observeId);
+        EXPECT_EQ((OCResource *)handle, observer->resource);
+        EXPECT_EQ(observer, GetObserverUsingToken(tokens[i], CA_MAX_TOKEN_LEN));
+    }
+    ResourceObserver *prefixObserver = GetObserverUsingToken(tokens[0], CA_MAX_TOKEN_LEN - 1);
+    ASSERT_TRUE(NULL != prefixObserver);
+    EXPECT_EQ(prefixId, prefixObserver->observeId);
+
+    const char unknown[] = { 0x01, 0x02, 0x03, 0x04 };
+    EXPECT_TRUE(NULL == GetObserverUsingToken((CAToken_t)unknown, sizeof(unknown)));
+
+    // Remove every other observer.
+    for (size_t i = 0; i < TEST_OBSERVER_COUNT; i += 2)
+    {
+        EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(tokens[i], CA_MAX_TOKEN_LEN));
+    }
+    for (size_t i = 0; i < TEST_OBSERVER_COUNT; i++)
+    {
+        ResourceObserver *observer = GetObserverUsingToken(tokens[i], CA_MAX_TOKEN_LEN);
+        if (i % 2)
+        {
+            ASSERT_TRUE(NULL != observer);
+            EXPECT_EQ(obsIds[i], observer->observeId);
+            EXPECT_EQ(observer, GetObserverUsingId(obsIds[i]));
+        }
+        else
+        {
+            EXPECT_TRUE(NULL == observer);
+            EXPECT_TRUE(NULL == GetObserverUsingId(obsIds[i]));
+        }
+    }
+    EXPECT_EQ(prefixObserver, GetObserverUsingToken(tokens[0], CA_MAX_TOKEN_LEN - 1));
+
+    // Deleting an unknown token is not an error.
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(tokens[0], CA_MAX_TOKEN_LEN));
+
+    DeleteObserverList();
+    EXPECT_TRUE(NULL == GetObserverUsingId(obsIds[1]));
+    EXPECT_TRUE(NULL == GetObserverUsingToken(tokens[1], CA_MAX_TOKEN_LEN));
+    EXPECT_TRUE(NULL == GetObserverUsingId(prefixId));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, ObserversAreBucketedPerResource)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ObserversAreBucketedPerResource test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle led;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&led,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_OBSERVABLE));
+    OCResourceHandle fan;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&fan,
+                                            "core.fan",
+                                            "core.rw",
+                                            "/a/fan",
+                                            0,
+                                            NULL,
+                                            OC_OBSERVABLE));
+
+    const char ledToken1[] = { 0x11, 0x12, 0x13, 0x14 };
+    const char ledToken2[] = { 0x21, 0x22, 0x23, 0x24 };
+    const char fanToken[] = { 0x31, 0x32, 0x33, 0x34 };
+    OCObservationId ledId1 = AddTestObserver(led, "/a/led", ledToken1, sizeof(ledToken1));
+    OCObservationId ledId2 = AddTestObserver(led, "/a/led", ledToken2, sizeof(ledToken2));
+    OCObservationId fanId = AddTestObserver(fan, "/a/fan", fanToken, sizeof(fanToken));
+    ASSERT_NE(0, ledId1);
+    ASSERT_NE(0, ledId2);
+    ASSERT_NE(0, fanId);
+
+    EXPECT_EQ((OCResource *)led, GetObserverUsingId(ledId1)->resource);
+    EXPECT_EQ((OCResource *)led, GetObserverUsingId(ledId2)->resource);
+    EXPECT_EQ((OCResource *)fan, GetObserverUsingId(fanId)->resource);
+
+    // Once its last observer is gone a resource has no observers, while the
+    // observers of the other resource are left in place.
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t)fanToken, sizeof(fanToken)));
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyAllObservers(fan, OC_NA_QOS));
+    EXPECT_TRUE(NULL != GetObserverUsingId(ledId1));
+    EXPECT_TRUE(NULL != GetObserverUsingId(ledId2));
+
+    // A resource can be observed again after its bucket was released.
+    fanId = AddTestObserver(fan, "/a/fan", fanToken, sizeof(fanToken));
+    ASSERT_NE(0, fanId);
+    EXPECT_EQ((OCResource *)fan, GetObserverUsingToken((CAToken_t)fanToken,
+                                                       sizeof(fanToken))->resource);
+
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t)ledToken1, sizeof(ledToken1)));
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t)ledToken2, sizeof(ledToken2)));
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyAllObservers(led, OC_NA_QOS));
+    EXPECT_EQ(fanId, GetObserverUsingToken((CAToken_t)fanToken, sizeof(fanToken))->observeId);
+
+    DeleteObserverList();
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(led));
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(fan));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_NETINET_IN_H) && defined(HAVE_ARPA_INET_H)
+#define FANOUT_OBSERVERS (3)
+#define COAP_OPTION_NUMBER_OBSERVE (6)
+
+/**
+ * Fields of a CoAP notification received by a fan-out observer.
+ */
+typedef struct
+{
+    std::string token;
+    bool hasObserve;
+    uint32_t observe;
+    std::string payload;
+} FanOutNotification;
+
+static OCEntityHandlerResult fanOutEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void *callbackParam)
+{
+    OIC_LOG(INFO, TAG, "Entering fanOutEntityHandler");
+
+    size_t *numCalls = (size_t *)callbackParam;
+    (*numCalls)++;
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return OC_EH_ERROR;
+    }
+    OCRepPayloadSetPropInt(payload, "brightness", 42);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+
+    OCStackResult result = OCDoResponse(&response);
+    OCRepPayloadDestroy(payload);
+    return (OC_STACK_OK == result) ? OC_EH_OK : OC_EH_ERROR;
+}
+
+static int OpenFanOutObserverSocket(uint16_t *port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+
+    struct timeval timeout = { 2, 0 };
+    if (0 != bind(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        0 != getsockname(fd, (struct sockaddr *)&addr, &addrLen) ||
+        0 != setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)))
+    {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static bool ReadCoapValue(const uint8_t *pdu, size_t len, size_t *pos, size_t *value)
+{
+    if (13 == *value)
+    {
+        if (*pos + 1 > len)
+        {
+            return false;
+        }
+        *value = pdu[*pos] + 13;
+        *pos += 1;
+    }
+    else if (14 == *value)
+    {
+        if (*pos + 2 > len)
+        {
+            return false;
+        }
+        *value = ((pdu[*pos] << 8) | pdu[*pos + 1]) + 269;
+        *pos += 2;
+    }
+    return (15 != *value);
+}
+
+static bool ParseFanOutNotification(const uint8_t *pdu, size_t len,
+                                    FanOutNotification *notification)
+{
+    if (len < 4 || 1 != (pdu[0] >> 6))
+    {
+        return false;
+    }
+
+    size_t tokenLength = pdu[0] & 0x0F;
+    size_t pos = 4 + tokenLength;
+    if (tokenLength > CA_MAX_TOKEN_LEN || pos > len)
+    {
+        return false;
+    }
+    notification->token.assign((const char *)pdu + 4, tokenLength);
+    notification->hasObserve = false;
+    notification->observe = 0;
+
+    size_t optionNumber = 0;
+    while (pos < len && 0xFF != pdu[pos])
+    {
+        size_t delta = pdu[pos] >> 4;
+        size_t optionLength = pdu[pos] & 0x0F;
+        pos++;
+        if (!ReadCoapValue(pdu, len, &pos, &delta) ||
+            !ReadCoapValue(pdu, len, &pos, &optionLength) ||
+            pos + optionLength > len)
+        {
+            return false;
+        }
+        optionNumber += delta;
+        if (COAP_OPTION_NUMBER_OBSERVE == optionNumber)
+        {
+            notification->hasObserve = true;
+            for (size_t i = 0; i < optionLength; i++)
+            {
+                notification->observe = (notification->observe << 8) | pdu[pos + i];
+            }
+        }
+        pos += optionLength;
+    }
+
+    notification->payload.clear();
+    if (pos < len)
+    {
+        pos++;
+        notification->payload.assign((const char *)pdu + pos, len - pos);
+    }
+    return true;
+}
+
+TEST(StackResource, ObserveFanOutSendsOnePayloadToEachObserver)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ObserveFanOutSendsOnePayloadToEachObserver test");
+    InitStack(OC_SERVER);
+
+    size_t numCalls = 0;
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.light",
+                                            "core.rw",
+                                            "/a/light",
+                                            fanOutEntityHandler,
+                                            &numCalls,
+                                            OC_OBSERVABLE|OC_OBSERVE_FANOUT));
+
+    int fds[FANOUT_OBSERVERS];
+    char tokens[FANOUT_OBSERVERS][CA_MAX_TOKEN_LEN];
+    for (size_t i = 0; i < FANOUT_OBSERVERS; i++)
+    {
+        uint16_t port = 0;
+        fds[i] = OpenFanOutObserverSocket(&port);
+        ASSERT_LE(0, fds[i]);
+
+        OCDevAddr devAddr;
+        memset(&devAddr, 0, sizeof(devAddr));
+        devAddr.adapter = OC_ADAPTER_IP;
+        devAddr.flags = OC_IP_USE_V4;
+        devAddr.port = port;
+        OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+        for (size_t j = 0; j < CA_MAX_TOKEN_LEN; j++)
+        {
+            tokens[i][j] = (char)(0x10 * (i + 1) + j);
+        }
+
+        OCObservationId obsId = 0;
+        EXPECT_EQ(OC_STACK_OK, GenerateObserverId(&obsId));
+        EXPECT_EQ(OC_STACK_OK, AddObserver("/a/light", NULL, obsId, tokens[i],
+                                           CA_MAX_TOKEN_LEN, (OCResource *)handle,
+                                           OC_LOW_QOS, OC_FORMAT_CBOR, 0, &devAddr));
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+
+    // The entity handler runs once for observers sharing the query and format.
+    EXPECT_EQ(1u, numCalls);
+
+    uint32_t sequenceNum = ((OCResource *)handle)->sequenceNum;
+    FanOutNotification notifications[FANOUT_OBSERVERS];
+    for (size_t i = 0; i < FANOUT_OBSERVERS; i++)
+    {
+        uint8_t pdu[COAP_MAX_PDU_SIZE];
+        ssize_t len = recv(fds[i], pdu, sizeof(pdu), 0);
+        ASSERT_LT(0, len) << "observer " << i << " got no notification";
+        ASSERT_TRUE(ParseFanOutNotification(pdu, (size_t)len, &notifications[i]));
+
+        EXPECT_EQ(std::string(tokens[i], CA_MAX_TOKEN_LEN), notifications[i].token);
+        EXPECT_TRUE(notifications[i].hasObserve);
+        EXPECT_EQ(sequenceNum, notifications[i].observe);
+        EXPECT_FALSE(notifications[i].payload.empty());
+        EXPECT_EQ(notifications[0].payload, notifications[i].payload);
+    }
+
+    for (size_t i = 0; i < FANOUT_OBSERVERS; i++)
+    {
+        close(fds[i]);
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+#endif
+
+TEST(StackResource, GetResourceHandleAtUriAfterDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting GetResourceHandleAtUriAfterDelete test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(handle, OCGetResourceHandleAtUri("/a/led"));
+    EXPECT_TRUE(OCGetResourceHandleAtUri("/a/le") == NULL);
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+    EXPECT_TRUE(OCGetResourceHandleAtUri("/a/led") == NULL);
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(handle, OCGetResourceHandleAtUri("/a/led"));
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackResource, StackTestResourceDiscoverOneResourceBad)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -2208,6 +2690,269 @@ TEST(StackResourceAccess, DeleteMiddleResource)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+#define TEST_CLIENT_CB_COUNT (64)
+
+static ClientCB *AddTestClientCB(const uint8_t *token, uint8_t tokenLength, uint32_t ttl)
+{
+    OCCallbackData cbData;
+    memset(&cbData, 0, sizeof(cbData));
+
+    // AddClientCB takes ownership of the token, the handle and the uri.
+    CAToken_t cbToken = (CAToken_t)OICMalloc(tokenLength);
+    OCDoHandle handle = (OCDoHandle)OICMalloc(sizeof(uint8_t[CA_MAX_TOKEN_LEN]));
+    char *requestUri = OICStrdup("/a/light");
+    if (!cbToken || !handle || !requestUri)
+    {
+        OICFree(cbToken);
+        OICFree(handle);
+        OICFree(requestUri);
+        return NULL;
+    }
+    memcpy(cbToken, token, tokenLength);
+
+    ClientCB *cbNode = NULL;
+    if (OC_STACK_OK != AddClientCB(&cbNode, &cbData, cbToken, tokenLength, &handle,
+                                   OC_REST_GET, NULL, requestUri, NULL, ttl))
+    {
+        return NULL;
+    }
+    return cbNode;
+}
+
+TEST(StackClientCB, GetClientCBByTokenAndHandle)
+{
+    const uint8_t token1[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+    const uint8_t token2[] = { 0x11, 0x12, 0x13, 0x14 };
+    const uint8_t unknown[] = { 0x21, 0x22, 0x23, 0x24 };
+
+    ClientCB *cb1 = AddTestClientCB(token1, sizeof(token1), 0);
+    ClientCB *cb2 = AddTestClientCB(token2, sizeof(token2), 1000);
+    ASSERT_TRUE(NULL != cb1);
+    ASSERT_TRUE(NULL != cb2);
+
+    EXPECT_EQ(cb1, GetClientCB((CAToken_t)token1, sizeof(token1), NULL, NULL));
+    EXPECT_EQ(cb2, GetClientCB((CAToken_t)token2, sizeof(token2), NULL, NULL));
+    EXPECT_EQ(cb1, GetClientCB(NULL, 0, cb1->handle, NULL));
+    EXPECT_EQ(cb2, GetClientCB(NULL, 0, cb2->handle, NULL));
+
+    // The token length is part of the key.
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token1, 4, NULL, NULL));
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)unknown, sizeof(unknown), NULL, NULL));
+
+    OCDoHandle handle2 = cb2->handle;
+    DeleteClientCB(cb2);
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token2, sizeof(token2), NULL, NULL));
+    EXPECT_TRUE(NULL == GetClientCB(NULL, 0, handle2, NULL));
+    EXPECT_EQ(cb1, GetClientCB((CAToken_t)token1, sizeof(token1), NULL, NULL));
+    EXPECT_EQ(cb1, GetClientCB(NULL, 0, cb1->handle, NULL));
+
+    DeleteClientCBList();
+    EXPECT_TRUE(NULL == cbList);
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token1, sizeof(token1), NULL, NULL));
+}
+
+TEST(StackClientCB, GetClientCBWithSharedTokenPrefixes)
+{
+    uint8_t tokens[TEST_CLIENT_CB_COUNT][CA_MAX_TOKEN_LEN];
+    ClientCB *cbNodes[TEST_CLIENT_CB_COUNT];
+    OCDoHandle handles[TEST_CLIENT_CB_COUNT];
+    for (size_t i = 0; i < TEST_CLIENT_CB_COUNT; i++)
+    {
+        SetIndexedTestToken(tokens[i], i);
+        cbNodes[i] = AddTestClientCB(tokens[i], CA_MAX_TOKEN_LEN, (uint32_t)(1000 + i));
+        ASSERT_TRUE(NULL != cbNodes[i]);
+        handles[i] = cbNodes[i]->handle;
+    }
+
+    // A token that is a prefix of all the others is a different key.
+    ClientCB *prefixNode = AddTestClientCB(tokens[0], CA_MAX_TOKEN_LEN - 1, 0);
+    ASSERT_TRUE(NULL != prefixNode);
+
+    for (size_t i = 0; i < TEST_CLIENT_CB_COUNT; i++)
+    {
+        EXPECT_EQ(cbNodes[i], GetClientCB((CAToken_t)tokens[i], CA_MAX_TOKEN_LEN, NULL, NULL));
+        EXPECT_EQ(cbNodes[i], GetClientCB(NULL, 0, handles[i], NULL));
+    }
+    EXPECT_EQ(prefixNode, GetClientCB((CAToken_t)tokens[0], CA_MAX_TOKEN_LEN - 1, NULL, NULL));
+
+    // Remove every other node, through both removal functions.
+    for (size_t i = 0; i < TEST_CLIENT_CB_COUNT; i += 2)
+    {
+        if (i % 4)
+        {
+            FindAndDeleteClientCB(cbNodes[i]);
+        }
+        else
+        {
+            DeleteClientCB(cbNodes[i]);
+        }
+    }
+
+    for (size_t i = 0; i < TEST_CLIENT_CB_COUNT; i++)
+    {
+        ClientCB *expected = (i % 2) ? cbNodes[i] : NULL;
+        EXPECT_EQ(expected, GetClientCB((CAToken_t)tokens[i], CA_MAX_TOKEN_LEN, NULL, NULL));
+        EXPECT_EQ(expected, GetClientCB(NULL, 0, handles[i], NULL));
+    }
+    EXPECT_EQ(prefixNode, GetClientCB((CAToken_t)tokens[0], CA_MAX_TOKEN_LEN - 1, NULL, NULL));
+
+    // The removed tokens can be added again.
+    ClientCB *readded = AddTestClientCB(tokens[0], CA_MAX_TOKEN_LEN, 0);
+    ASSERT_TRUE(NULL != readded);
+    EXPECT_EQ(readded, GetClientCB((CAToken_t)tokens[0], CA_MAX_TOKEN_LEN, NULL, NULL));
+    EXPECT_EQ(readded, GetClientCB(NULL, 0, readded->handle, NULL));
+
+    DeleteClientCBList();
+    EXPECT_TRUE(NULL == cbList);
+    for (size_t i = 0; i < TEST_CLIENT_CB_COUNT; i++)
+    {
+        EXPECT_TRUE(NULL == GetClientCB((CAToken_t)tokens[i], CA_MAX_TOKEN_LEN, NULL, NULL));
+    }
+}
+
+TEST(StackClientCB, FindAndDeleteClientCBIgnoresUnknownNode)
+{
+    const uint8_t token[] = { 0x31, 0x32, 0x33, 0x34 };
+    ClientCB *cbNode = AddTestClientCB(token, sizeof(token), 0);
+    ASSERT_TRUE(NULL != cbNode);
+
+    // A node that is not in the list is left alone.
+    ClientCB unknown;
+    memset(&unknown, 0, sizeof(unknown));
+    FindAndDeleteClientCB(&unknown);
+    FindAndDeleteClientCB(NULL);
+    EXPECT_EQ(cbNode, GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+
+    FindAndDeleteClientCB(cbNode);
+    EXPECT_TRUE(NULL == GetClientCB((CAToken_t)token, sizeof(token), NULL, NULL));
+    EXPECT_TRUE(NULL == cbList);
+}
+
+#ifdef TCP_ADAPTER
+#define TEST_KEEPALIVE_COUNT (64)
+
+static const uint64_t TEST_KEEPALIVE_HOUR_US = 3600ULL * 1000 * 1000;
+
+static void SetTestKeepAliveEndpoint(CAEndpoint_t *endpoint, size_t i)
+{
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->adapter = CA_ADAPTER_TCP;
+    snprintf(endpoint->addr, sizeof(endpoint->addr), "10.0.%u.%u",
+             (unsigned)(i / 8), (unsigned)(i % 8));
+    endpoint->port = (uint16_t)(5683 + (i % 4));
+}
+
+TEST(StackKeepAlive, AddAndGetEntry)
+{
+    ASSERT_EQ(OC_STACK_OK, InitializeKeepAlive(OC_CLIENT));
+
+    CAEndpoint_t endpoints[TEST_KEEPALIVE_COUNT];
+    KeepAliveEntry_t *entries[TEST_KEEPALIVE_COUNT];
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i++)
+    {
+        SetTestKeepAliveEndpoint(&endpoints[i], i);
+        entries[i] = AddKeepAliveEntry(&endpoints[i], OC_SERVER, NULL);
+        ASSERT_TRUE(NULL != entries[i]);
+    }
+
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i++)
+    {
+        EXPECT_EQ(entries[i], GetEntryFromEndpoint(&endpoints[i]));
+        EXPECT_STREQ(endpoints[i].addr, entries[i]->remoteAddr.addr);
+        EXPECT_EQ(endpoints[i].port, entries[i]->remoteAddr.port);
+    }
+
+    // Only the address and the port identify a connection.
+    CAEndpoint_t endpoint = endpoints[0];
+    endpoint.flags = CA_SECURE;
+    endpoint.ifindex = 3;
+    EXPECT_EQ(entries[0], GetEntryFromEndpoint(&endpoint));
+
+    endpoint = endpoints[0];
+    endpoint.port = 1;
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&endpoint));
+    OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "10.0");
+    endpoint.port = endpoints[0].port;
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&endpoint));
+
+    EXPECT_EQ(OC_STACK_OK, TerminateKeepAlive(OC_CLIENT));
+}
+
+TEST(StackKeepAlive, RemoveEntry)
+{
+    ASSERT_EQ(OC_STACK_OK, InitializeKeepAlive(OC_CLIENT));
+
+    CAEndpoint_t endpoints[TEST_KEEPALIVE_COUNT];
+    KeepAliveEntry_t *entries[TEST_KEEPALIVE_COUNT];
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i++)
+    {
+        SetTestKeepAliveEndpoint(&endpoints[i], i);
+        entries[i] = AddKeepAliveEntry(&endpoints[i], OC_SERVER, NULL);
+        ASSERT_TRUE(NULL != entries[i]);
+    }
+
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i += 2)
+    {
+        EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&endpoints[i]));
+    }
+    EXPECT_NE(OC_STACK_OK, RemoveKeepAliveEntry(&endpoints[0]));
+
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i++)
+    {
+        KeepAliveEntry_t *expected = (i % 2) ? entries[i] : NULL;
+        EXPECT_EQ(expected, GetEntryFromEndpoint(&endpoints[i]));
+    }
+
+    // A removed connection can be added again.
+    KeepAliveEntry_t *readded = AddKeepAliveEntry(&endpoints[0], OC_SERVER, NULL);
+    ASSERT_TRUE(NULL != readded);
+    EXPECT_EQ(readded, GetEntryFromEndpoint(&endpoints[0]));
+
+    EXPECT_EQ(OC_STACK_OK, TerminateKeepAlive(OC_CLIENT));
+}
+
+TEST(StackKeepAlive, ProcessRemovesEveryDueEntry)
+{
+    ASSERT_EQ(OC_STACK_OK, InitializeKeepAlive(OC_CLIENT));
+
+    // Deadlines are set out of order, so that the heap has to reorder entries both ways.
+    uint64_t now = OICGetCurrentTime(TIME_IN_US);
+    CAEndpoint_t endpoints[TEST_KEEPALIVE_COUNT];
+    KeepAliveEntry_t *entries[TEST_KEEPALIVE_COUNT];
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i++)
+    {
+        SetTestKeepAliveEndpoint(&endpoints[i], i);
+        entries[i] = AddKeepAliveEntry(&endpoints[i], OC_SERVER, NULL);
+        ASSERT_TRUE(NULL != entries[i]);
+        SetKeepAliveDeadline(entries[i], now + TEST_KEEPALIVE_HOUR_US + (i * 7919) % 1000);
+    }
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i += 3)
+    {
+        SetKeepAliveDeadline(entries[i], now - 1 - i);
+    }
+    SetKeepAliveDeadline(entries[3], now + 2 * TEST_KEEPALIVE_HOUR_US);
+
+    // Due server entries are disconnected, which removes them while the heap is walked.
+    ProcessKeepAlive();
+    for (size_t i = 0; i < TEST_KEEPALIVE_COUNT; i++)
+    {
+        bool due = (0 == i % 3) && (3 != i);
+        EXPECT_EQ(due, NULL == GetEntryFromEndpoint(&endpoints[i])) << "entry " << i;
+    }
+
+    // The heap is still ordered after the removals.
+    SetKeepAliveDeadline(entries[TEST_KEEPALIVE_COUNT - 2], now - 1);
+    SetKeepAliveDeadline(entries[1], now - 1);
+    ProcessKeepAlive();
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&endpoints[TEST_KEEPALIVE_COUNT - 2]));
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&endpoints[1]));
+    EXPECT_EQ(entries[2], GetEntryFromEndpoint(&endpoints[2]));
+    EXPECT_EQ(entries[3], GetEntryFromEndpoint(&endpoints[3]));
+
+    EXPECT_EQ(OC_STACK_OK, TerminateKeepAlive(OC_CLIENT));
+}
+#endif
+
 // Visual Studio versions earlier than 2015 have bugs in is_pod and report the wrong answer.
 #if !defined(_MSC_VER) || (_MSC_VER >= 1900)
 TEST(PODTests, OCHeaderOption)